@@ -196,7 +196,7 @@ QString AgentChatHistory::displayName(const sChatEntry & entry, uint64_t next, i
     case eChatColumn::ColumnSource:
         return _source[static_cast<int>(entry.chatSource)];
     case eChatColumn::ColumnMessage:
-        return entry.chatMessage;
+        return entryMessage(entry);
     case eChatColumn::ColumnTimestamp:
         return fn(entry.chatTime, next);
     case eChatColumn::ColumnStatus:
@@ -213,10 +213,12 @@ void AgentChatHistory::addRequest(const QString& question, uint32_t chatId, uint
 
 void AgentChatHistory::addRequest(const QString& question, uint32_t chatId, uint32_t seqId, uint32_t sessionId, uint64_t when)
 {
-    beginInsertRows(QModelIndex(), mHistory.size(), mHistory.size());
-    sChatEntry entry{eChatSource::SourceHuman, question, when, eMessageStatus::StatusPending, sessionId, chatId, seqId};
-    mHistory.push_back(entry);
-    endInsertRows();
+    insertRequest(sChatEntry{eChatSource::SourceHuman, question, when, eMessageStatus::StatusPending, sessionId, chatId, seqId});
+}
+
+void AgentChatHistory::addRequest(const SharedText& question, uint32_t chatId, uint32_t seqId, uint32_t sessionId, uint64_t when)
+{
+    insertRequest(sChatEntry{eChatSource::SourceHuman, QString(), when, eMessageStatus::StatusPending, sessionId, chatId, seqId, question});
 }
 
 void AgentChatHistory::addResponse(const QString& reply, uint32_t chatId, uint32_t seqId, uint32_t sessionId)
@@ -226,7 +228,24 @@ void AgentChatHistory::addResponse(const QString& reply, uint32_t chatId, uint32
 
 void AgentChatHistory::addResponse(const QString& reply, uint32_t chatId, uint32_t seqId, uint32_t sessionId, uint64_t when)
 {
-    sChatEntry entry{eChatSource::SourceEdgeAi, reply, when, eMessageStatus::StatusReplied, sessionId, chatId, seqId};
+    insertResponse(sChatEntry{eChatSource::SourceEdgeAi, reply, when, eMessageStatus::StatusReplied, sessionId, chatId, seqId});
+}
+
+void AgentChatHistory::addResponse(const SharedText& reply, uint32_t chatId, uint32_t seqId, uint32_t sessionId, uint64_t when)
+{
+    insertResponse(sChatEntry{eChatSource::SourceEdgeAi, QString(), when, eMessageStatus::StatusReplied, sessionId, chatId, seqId, reply});
+}
+
+void AgentChatHistory::insertRequest(sChatEntry&& entry)
+{
+    beginInsertRows(QModelIndex(), mHistory.size(), mHistory.size());
+    mHistory.push_back(std::move(entry));
+    endInsertRows();
+}
+
+void AgentChatHistory::insertResponse(sChatEntry&& entry)
+{
+    const uint32_t sessionId = entry.sessionId;
     int32_t size = static_cast<int32_t>(mHistory.size());
     int32_t idx = findEntry(sessionId);
     if (idx >= 0)
@@ -235,12 +254,12 @@ void AgentChatHistory::addResponse(const QString& reply, uint32_t chatId, uint32
         if ((idx + 1) == size)
         {
             beginInsertRows(QModelIndex(), mHistory.size(), mHistory.size());
-            mHistory.push_back(entry);
+            mHistory.push_back(std::move(entry));
         }
         else
         {
             beginInsertRows(QModelIndex(), idx + 1, idx + 1);
-            mHistory.insert(mHistory.begin() + idx + 1, entry);
+            mHistory.insert(mHistory.begin() + idx + 1, std::move(entry));
         }
 
         endInsertRows();
@@ -249,7 +268,7 @@ void AgentChatHistory::addResponse(const QString& reply, uint32_t chatId, uint32
     {
         beginInsertRows(QModelIndex(), mHistory.size(), mHistory.size());
         entry.chatStatus = eMessageStatus::StatusError;
-        mHistory.push_back(entry);
+        mHistory.push_back(std::move(entry));
         endInsertRows();
     }
 }
@@ -288,5 +307,17 @@ const QString& AgentChatHistory::getRowMessage(int row) const
         return _empty;
 
     const sChatEntry& entry = mHistory[row];
+    return entryMessage(entry);
+}
+
+const QString& AgentChatHistory::entryMessage(const sChatEntry& entry) const
+{
+    if (entry.chatText != nullptr)
+    {
+        // The view displays only the visible rows, the other texts stay in UTF-8.
+        entry.chatMessage = QString::fromUtf8(entry.chatText->getString(), static_cast<qsizetype>(entry.chatText->getLength()));
+        entry.chatText.reset();
+    }
+
     return entry.chatMessage;
 }
@@ -22,6 +22,7 @@
  ************************************************************************/
 
 #include <QAbstractTableModel>
+#include "multiedge/aiagent/agenttext.hpp"
 
 #include <vector>
 #include <QIcon>
@@ -59,12 +60,13 @@ public:
     struct sChatEntry
     {
         eChatSource     chatSource  {eChatSource::SourceUnknown};
-        QString         chatMessage {};
+        mutable QString chatMessage {};     //!< The displayed message, converted from the shared text when displayed first time.
         uint64_t        chatTime    {0u};
         eMessageStatus  chatStatus  {eMessageStatus::StatusInvalid};
         uint32_t        sessionId   {0xFFFFFFFFu};
         uint32_t        chatId      {0xFFFFFFFFu};
         uint32_t        chatSeqId   {0xFFFFFFFFu};
+        mutable SharedText chatText {};     //!< The UTF-8 text shared with the agent until it is converted to display.
     };
 
     static constexpr    uint32_t    INIT_LENGTH {1000u};
@@ -82,6 +84,12 @@ public:
     void addResponse(const QString& reply, uint32_t chatId, uint32_t seqId, uint32_t sessionId);
     
     void addResponse(const QString& reply, uint32_t chatId, uint32_t seqId, uint32_t sessionId, uint64_t when);
+
+    //!< Adds the request, the text is converted only when the row is displayed.
+    void addRequest(const SharedText& question, uint32_t chatId, uint32_t seqId, uint32_t sessionId, uint64_t when);
+
+    //!< Adds the response, the text is converted only when the row is displayed.
+    void addResponse(const SharedText& reply, uint32_t chatId, uint32_t seqId, uint32_t sessionId, uint64_t when);
     
     void addFailure(const QString& text);
     
@@ -108,6 +116,15 @@ private:
     
     int findEntry(uint32_t sessionId);
 
+    //!< Inserts the entry of the request.
+    void insertRequest(sChatEntry&& entry);
+
+    //!< Inserts the entry of the response after the request of the same session.
+    void insertResponse(sChatEntry&& entry);
+
+    //!< Returns the message of the entry, converts the shared text on first call.
+    const QString& entryMessage(const sChatEntry& entry) const;
+
 private:
     ChatHistory mHistory;
     QIcon       mIconHuman;
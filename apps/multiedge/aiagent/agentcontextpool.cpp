@@ -0,0 +1,273 @@
+﻿/************************************************************************
+ * This file is part of the Areg Edge AI project powered by AREG SDK.
+ * The project contains multiple examples of using Edge AI based on Areg communication framework.
+ *
+ *  Areg Edge AI is available as free and open-source software under the MIT License.
+ *
+ *  For detailed licensing terms, please refer to the LICENSE file included
+ *  with this distribution or contact us at info[at]areg.tech.
+ *
+ *  \copyright   © 2025 Aregtech UG. All rights reserved.
+ *  \file        multiedge/aiagent/agentcontextpool.cpp
+ *  \ingroup     Areg Edge AI, AI Multi Edge Device Agent
+ *  \author      Artak Avetyan
+ *  \brief       Edge AI Agent pool of the persistent llama contexts.
+ *
+ ************************************************************************/
+#include "multiedge/aiagent/agentcontextpool.hpp"
+#include "areg/logging/GELog.h"
+
+#include <algorithm>
+
+DEF_LOG_SCOPE(multiedge_aiagent_AgentContextPool_createContext);
+DEF_LOG_SCOPE(multiedge_aiagent_AgentContextPool_purge);
+DEF_LOG_SCOPE(multiedge_aiagent_AgentContextPool_trim);
+
+AgentContextPool::AgentContextPool(void)
+    : mModel    (nullptr)
+    , mIdle     ( )
+    , mBusy     ( )
+    , mBudget   (0u)
+    , mUseStamp (0u)
+{
+}
+
+AgentContextPool::~AgentContextPool(void)
+{
+    ASSERT(mBusy.empty());
+    clear();
+}
+
+void AgentContextPool::setModel(llama_model* model)
+{
+    ASSERT(mBusy.empty());
+    clear();
+    mModel = model;
+}
+
+void AgentContextPool::setBudget(uint64_t budget)
+{
+    mBudget = budget;
+    trim();
+}
+
+bool AgentContextPool::prepare(const sContextKey& key)
+{
+    purge(key);
+    if (mModel == nullptr)
+        return false;
+
+    MapIdle::iterator pos = mIdle.find(key);
+    if (pos != mIdle.end())
+    {
+        pos->second.lastUse = ++ mUseStamp;
+        return true;
+    }
+
+    for (const auto& entry : mBusy)
+    {
+        if (entry.second == key)
+            return true;
+    }
+
+    llama_context* context = createContext(key);
+    if (context != nullptr)
+    {
+        mIdle.emplace(key, sIdleContext{ context, estimateMemory(mModel, key), ++ mUseStamp });
+        trim();
+    }
+
+    return (context != nullptr);
+}
+
+llama_context* AgentContextPool::acquire(const sContextKey& key)
+{
+    llama_context* context{ nullptr };
+    MapIdle::iterator pos = mIdle.find(key);
+    if (pos != mIdle.end())
+    {
+        context = pos->second.context;
+        mIdle.erase(pos);
+    }
+    else if (mModel != nullptr)
+    {
+        context = createContext(key);
+    }
+
+    if (context != nullptr)
+    {
+        mBusy.emplace(context, key);
+    }
+
+    return context;
+}
+
+void AgentContextPool::release(llama_context* context)
+{
+    MapBusy::iterator pos = mBusy.find(context);
+    if (pos != mBusy.end())
+    {
+        const sContextKey key{ pos->second };
+        mBusy.erase(pos);
+        MapIdle::iterator idle = mIdle.find(key);
+        if (idle != mIdle.end())
+        {
+            // One idle context per key is enough, the engine uses one context at a time.
+            llama_free(context);
+            idle->second.lastUse = ++ mUseStamp;
+        }
+        else
+        {
+            // Clear the KV cache to reuse the context without topic mixing.
+            llama_memory_clear(llama_get_memory(context), true);
+            mIdle.emplace(key, sIdleContext{ context, estimateMemory(mModel, key), ++ mUseStamp });
+        }
+
+        trim();
+    }
+}
+
+void AgentContextPool::purge(const sContextKey& key)
+{
+    LOG_SCOPE(multiedge_aiagent_AgentContextPool_purge);
+    for (MapIdle::iterator pos = mIdle.begin(); pos != mIdle.end(); )
+    {
+        // The contexts of other sizes are reused when the size class changes back.
+        sContextKey sized{ key };
+        sized.ctxSize = pos->first.ctxSize;
+        if (pos->first != sized)
+        {
+            LOG_DBG("Releasing pooled context of size [ %u ], batch [ %u ], threads [ %u ], KV cache [ %s / %s ]"
+                        , pos->first.ctxSize, pos->first.batchSize, pos->first.threads, getString(pos->first.typeK), getString(pos->first.typeV));
+            llama_free(pos->second.context);
+            pos = mIdle.erase(pos);
+        }
+        else
+        {
+            ++ pos;
+        }
+    }
+}
+
+void AgentContextPool::clear(void)
+{
+    for (auto& entry : mIdle)
+    {
+        llama_free(entry.second.context);
+    }
+
+    mIdle.clear();
+}
+
+void AgentContextPool::trim(void)
+{
+    LOG_SCOPE(multiedge_aiagent_AgentContextPool_trim);
+
+    uint64_t total{ 0u };
+    for (const auto& entry : mIdle)
+    {
+        total += entry.second.size;
+    }
+
+    while ((total > mBudget) && (mIdle.size() > 1u))
+    {
+        // The most recently used context is never released, it is the one of the current size class.
+        MapIdle::iterator oldest = std::min_element(mIdle.begin(), mIdle.end(), [](const MapIdle::value_type& lhs, const MapIdle::value_type& rhs)
+                                    { return (lhs.second.lastUse < rhs.second.lastUse); });
+        LOG_DBG("Releasing least recently used pooled context of size [ %u ], [ %llu ] bytes exceed the budget of [ %llu ] bytes"
+                    , oldest->first.ctxSize, static_cast<unsigned long long>(total - mBudget), static_cast<unsigned long long>(mBudget));
+        total -= oldest->second.size;
+        llama_free(oldest->second.context);
+        mIdle.erase(oldest);
+    }
+}
+
+uint64_t AgentContextPool::estimateMemory(const llama_model* model, const AgentContextPool::sContextKey& key)
+{
+    if (model == nullptr)
+        return 0u;
+
+    // The KV cache keeps the key and the value of every layer per token, the quantized types are stored in blocks.
+    const uint64_t nLayer   = static_cast<uint64_t>(std::max(llama_model_n_layer(model), 0));
+    const uint64_t nHead    = static_cast<uint64_t>(std::max(llama_model_n_head(model), 1));
+    const uint64_t nHeadKv  = static_cast<uint64_t>(std::max(llama_model_n_head_kv(model), 0));
+    const uint64_t nEmbd    = static_cast<uint64_t>(std::max(llama_model_n_embd(model), 0));
+    const uint64_t nValues  = (nEmbd / nHead) * nHeadKv;
+    const ggml_type typeK   = getDataType(key.typeK);
+    const ggml_type typeV   = getDataType(key.typeV);
+    const uint64_t sizeK    = nValues * ggml_type_size(typeK) / static_cast<uint64_t>(ggml_blck_size(typeK));
+    const uint64_t sizeV    = nValues * ggml_type_size(typeV) / static_cast<uint64_t>(ggml_blck_size(typeV));
+    return static_cast<uint64_t>(key.ctxSize) * nLayer * (sizeK + sizeV);
+}
+
+llama_context* AgentContextPool::createContext(const sContextKey& key) const
+{
+    LOG_SCOPE(multiedge_aiagent_AgentContextPool_createContext);
+
+    llama_context_params ctx_params = llama_context_default_params();
+    ctx_params.n_ctx            = key.ctxSize;
+    ctx_params.n_batch          = key.batchSize;
+    ctx_params.n_seq_max        = key.sequences;
+    ctx_params.n_threads        = static_cast<int32_t>(key.threads);
+    ctx_params.n_threads_batch  = static_cast<int32_t>(key.threads);
+    ctx_params.type_k           = getDataType(key.typeK);
+    ctx_params.type_v           = getDataType(key.typeV);
+    ctx_params.flash_attn_type  = (key.flashAttn == FlashOn ? LLAMA_FLASH_ATTN_TYPE_ENABLED : (key.flashAttn == FlashOff ? LLAMA_FLASH_ATTN_TYPE_DISABLED : LLAMA_FLASH_ATTN_TYPE_AUTO));
+    ctx_params.no_perf          = true;
+    llama_context* context = llama_init_from_model(mModel, ctx_params);
+    if (context == nullptr)
+    {
+        LOG_ERR("Failed to create llama context, KV cache [ %s / %s ], flash attention [ %s ]", getString(key.typeK), getString(key.typeV), getString(key.flashAttn));
+    }
+    else
+    {
+        LOG_DBG("Created llama context, context size [ %u ], batch [ %u ], threads [ %u ], sequences [ %u ], KV cache [ %s / %s ], flash attention [ %s ]"
+                    , key.ctxSize, key.batchSize, key.threads, key.sequences, getString(key.typeK), getString(key.typeV), getString(key.flashAttn));
+    }
+
+    return context;
+}
+
+ggml_type AgentContextPool::getDataType(AgentContextPool::eCacheType type)
+{
+    switch (type)
+    {
+    case CacheQ8:
+        return GGML_TYPE_Q8_0;
+    case CacheQ4:
+        return GGML_TYPE_Q4_0;
+    case CacheF16:
+    default:
+        return GGML_TYPE_F16;
+    }
+}
+
+const char* AgentContextPool::getString(AgentContextPool::eCacheType type)
+{
+    switch (type)
+    {
+    case CacheF16:
+        return "F16";
+    case CacheQ8:
+        return "Q8_0";
+    case CacheQ4:
+        return "Q4_0";
+    default:
+        return "Unknown";
+    }
+}
+
+const char* AgentContextPool::getString(AgentContextPool::eFlashAttention mode)
+{
+    switch (mode)
+    {
+    case FlashAuto:
+        return "Auto";
+    case FlashOff:
+        return "Off";
+    case FlashOn:
+        return "On";
+    default:
+        return "Unknown";
+    }
+}
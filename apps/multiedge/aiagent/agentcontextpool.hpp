@@ -0,0 +1,249 @@
+﻿#ifndef MULTIEDGE_AIAGENT_AGENTCONTEXTPOOL_HPP
+#define MULTIEDGE_AIAGENT_AGENTCONTEXTPOOL_HPP
+/************************************************************************
+ * This file is part of the Areg Edge AI project powered by AREG SDK.
+ * The project contains multiple examples of using Edge AI based on Areg communication framework.
+ *
+ *  Areg Edge AI is available as free and open-source software under the MIT License.
+ *
+ *  For detailed licensing terms, please refer to the LICENSE file included
+ *  with this distribution or contact us at info[at]areg.tech.
+ *
+ *  \copyright   © 2025 Aregtech UG. All rights reserved.
+ *  \file        multiedge/aiagent/agentcontextpool.hpp
+ *  \ingroup     Areg Edge AI, AI Multi Edge Device Agent
+ *  \author      Artak Avetyan
+ *  \brief       Edge AI Agent pool of the persistent llama contexts.
+ *
+ ************************************************************************/
+
+/************************************************************************
+ * Includes
+ ************************************************************************/
+
+#include "areg/base/GEGlobal.h"
+#include "llama.h"
+
+#include <map>
+
+//////////////////////////////////////////////////////////////////////////
+// AgentContextPool class declaration
+//////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief   The pool of pre-created llama contexts of the active model.
+ *          Creating a context allocates and zeroes the KV cache, which
+ *          is expensive to do per request. The pool keeps the created
+ *          contexts and reuses them after their memory is cleared.
+ *          The contexts are keyed by the parameters they are created with,
+ *          one idle context is kept per key. The idle contexts exceeding
+ *          the memory budget are released, the least recently used first.
+ *          The pool is not thread safe.
+ **/
+class AgentContextPool
+{
+//////////////////////////////////////////////////////////////////////////
+// Internal types
+//////////////////////////////////////////////////////////////////////////
+public:
+    //!< The data type of the keys or of the values in the KV cache.
+    enum eCacheType : uint32_t
+    {
+          CacheF16          = 0 //!< 16-bit floats, the default.
+        , CacheQ8               //!< 8-bit quantization, about a half of the memory of 16-bit floats.
+        , CacheQ4               //!< 4-bit quantization, about a quarter of the memory of 16-bit floats.
+        , CacheCount            //!< The number of data types.
+    };
+
+    //!< The mode of the flash attention.
+    enum eFlashAttention : uint32_t
+    {
+          FlashAuto         = 0 //!< Enabled if supported by the backend.
+        , FlashOff              //!< Disabled.
+        , FlashOn               //!< Enabled.
+        , FlashCount            //!< The number of modes.
+    };
+
+    //!< The parameters of the context used as a key in the pool.
+    struct sContextKey
+    {
+        uint32_t        ctxSize     { 0u };         //!< The total size of the context in tokens.
+        uint32_t        batchSize   { 0u };         //!< The maximum number of tokens per batch.
+        uint32_t        threads     { 0u };         //!< The number of decoding threads.
+        uint32_t        sequences   { 0u };         //!< The maximum number of parallel sequences.
+        eCacheType      typeK       { CacheF16 };   //!< The data type of the keys in the KV cache.
+        eCacheType      typeV       { CacheF16 };   //!< The data type of the values in the KV cache.
+        eFlashAttention flashAttn   { FlashAuto };  //!< The mode of the flash attention.
+
+        inline bool operator == (const sContextKey& other) const;
+        inline bool operator != (const sContextKey& other) const;
+        inline bool operator <  (const sContextKey& other) const;
+    };
+
+private:
+    //!< The idle context of the key.
+    struct sIdleContext
+    {
+        llama_context*  context     { nullptr };    //!< The idle context.
+        uint64_t        size        { 0u };         //!< The estimated size of the KV cache in bytes.
+        uint64_t        lastUse     { 0u };         //!< The stamp of the last use to release the least recently used context.
+    };
+
+    using MapIdle   = std::map<sContextKey, sIdleContext>;
+    using MapBusy   = std::map<llama_context*, sContextKey>;
+
+//////////////////////////////////////////////////////////////////////////
+// Constructor / Destructor
+//////////////////////////////////////////////////////////////////////////
+public:
+    AgentContextPool(void);
+    ~AgentContextPool(void);
+
+//////////////////////////////////////////////////////////////////////////
+// Attributes and operations
+//////////////////////////////////////////////////////////////////////////
+public:
+
+    /**
+     * \brief   Sets the model to create the contexts. All pooled contexts of
+     *          the previous model are released. There should be no context in use.
+     * \param   model   The model to create contexts. Can be nullptr.
+     **/
+    void setModel(llama_model* model);
+
+    /**
+     * \brief   Sets the memory budget of the idle contexts. The least recently used idle
+     *          contexts exceeding the budget are released, except the most recently used one.
+     * \param   budget  The maximum size in bytes of the KV caches of the idle contexts.
+     **/
+    void setBudget(uint64_t budget);
+
+    /**
+     * \brief   Pre-creates the idle context with specified parameters, if the pool does not
+     *          have one yet. The idle contexts, which differ from the key not only by the size,
+     *          are released, the contexts of other sizes are kept within the memory budget.
+     * \param   key     The parameters of the context to prepare.
+     * \return  Returns true if the pool has idle or in use context with specified parameters.
+     **/
+    bool prepare(const sContextKey& key);
+
+    /**
+     * \brief   Returns the context with specified parameters. If the pool has no idle
+     *          context with the parameters, creates new one.
+     * \param   key     The parameters of the context.
+     * \return  Returns valid pointer to the context or nullptr if failed to create.
+     **/
+    llama_context* acquire(const sContextKey& key);
+
+    /**
+     * \brief   Clears the memory of the context and returns it back to the pool.
+     * \param   context The context previously acquired from the pool.
+     **/
+    void release(llama_context* context);
+
+    /**
+     * \brief   Releases the idle contexts, which cannot be used anymore, because the batch,
+     *          the threads, the sequences or the data types differ from the specified key.
+     * \param   key     The parameters of the contexts to keep, the size of the context is ignored.
+     **/
+    void purge(const sContextKey& key);
+
+    /**
+     * \brief   Frees all idle contexts. There should be no context in use.
+     **/
+    void clear(void);
+
+    /**
+     * \brief   Returns the number of idle contexts in the pool.
+     **/
+    inline uint32_t getIdleCount(void) const;
+
+    /**
+     * \brief   Returns the estimated size in bytes of the KV cache of the context of the model.
+     * \param   model   The model of the context.
+     * \param   key     The parameters of the context.
+     **/
+    static uint64_t estimateMemory(const llama_model* model, const AgentContextPool::sContextKey& key);
+
+    /**
+     * \brief   Returns the data type of the tensors of the KV cache.
+     **/
+    static ggml_type getDataType(AgentContextPool::eCacheType type);
+
+    /**
+     * \brief   Returns the human readable name of the data type of the KV cache.
+     **/
+    static const char* getString(AgentContextPool::eCacheType type);
+
+    /**
+     * \brief   Returns the human readable name of the mode of the flash attention.
+     **/
+    static const char* getString(AgentContextPool::eFlashAttention mode);
+
+//////////////////////////////////////////////////////////////////////////
+// Hidden methods
+//////////////////////////////////////////////////////////////////////////
+private:
+
+    //!< Creates new context with specified parameters.
+    llama_context* createContext(const sContextKey& key) const;
+
+    //!< Releases the least recently used idle contexts exceeding the budget, except the most recently used one.
+    void trim(void);
+
+//////////////////////////////////////////////////////////////////////////
+// Member variables
+//////////////////////////////////////////////////////////////////////////
+private:
+    llama_model*    mModel;     //!< The model to create contexts.
+    MapIdle         mIdle;      //!< The idle contexts ready to use, one per key.
+    MapBusy         mBusy;      //!< The contexts in use.
+    uint64_t        mBudget;    //!< The memory budget of the idle contexts in bytes.
+    uint64_t        mUseStamp;  //!< The stamp of the last use of the context.
+
+//////////////////////////////////////////////////////////////////////////
+// Forbidden calls
+//////////////////////////////////////////////////////////////////////////
+private:
+    DECLARE_NOCOPY_NOMOVE(AgentContextPool);
+};
+
+//////////////////////////////////////////////////////////////////////////
+// Inline methods
+//////////////////////////////////////////////////////////////////////////
+
+inline bool AgentContextPool::sContextKey::operator == (const AgentContextPool::sContextKey& other) const
+{
+    return (ctxSize == other.ctxSize) && (batchSize == other.batchSize) && (threads == other.threads) && (sequences == other.sequences)
+        && (typeK == other.typeK) && (typeV == other.typeV) && (flashAttn == other.flashAttn);
+}
+
+inline bool AgentContextPool::sContextKey::operator != (const AgentContextPool::sContextKey& other) const
+{
+    return (operator == (other) == false);
+}
+
+inline bool AgentContextPool::sContextKey::operator < (const AgentContextPool::sContextKey& other) const
+{
+    if (ctxSize != other.ctxSize)
+        return (ctxSize < other.ctxSize);
+    else if (batchSize != other.batchSize)
+        return (batchSize < other.batchSize);
+    else if (threads != other.threads)
+        return (threads < other.threads);
+    else if (sequences != other.sequences)
+        return (sequences < other.sequences);
+    else if (typeK != other.typeK)
+        return (typeK < other.typeK);
+    else if (typeV != other.typeV)
+        return (typeV < other.typeV);
+    else
+        return (flashAttn < other.flashAttn);
+}
+
+inline uint32_t AgentContextPool::getIdleCount(void) const
+{
+    return static_cast<uint32_t>(mIdle.size());
+}
+
+#endif // MULTIEDGE_AIAGENT_AGENTCONTEXTPOOL_HPP
@@ -0,0 +1,371 @@
+﻿/************************************************************************
+ * This file is part of the Areg Edge AI project powered by AREG SDK.
+ * The project contains multiple examples of using Edge AI based on Areg communication framework.
+ *
+ *  Areg Edge AI is available as free and open-source software under the MIT License.
+ *
+ *  For detailed licensing terms, please refer to the LICENSE file included
+ *  with this distribution or contact us at info[at]areg.tech.
+ *
+ *  \copyright   © 2025 Aregtech UG. All rights reserved.
+ *  \file        multiedge/aiagent/agentdraft.cpp
+ *  \ingroup     Areg Edge AI, AI Multi Edge Device Agent
+ *  \author      Artak Avetyan
+ *  \brief       Edge AI Agent draft model of the speculative decoding.
+ *
+ ************************************************************************/
+#include "multiedge/aiagent/agentdraft.hpp"
+#include "areg/logging/GELog.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+DEF_LOG_SCOPE(multiedge_aiagent_AgentDraft_loadModel);
+DEF_LOG_SCOPE(multiedge_aiagent_AgentDraft_propose);
+
+namespace
+{
+    //!< Adds the token to the batch.
+    inline void _batchAdd(llama_batch& batch, llama_token token, llama_pos pos, llama_seq_id seqId, bool logits)
+    {
+        const int32_t i = batch.n_tokens;
+        batch.token   [i]   = token;
+        batch.pos     [i]   = pos;
+        batch.n_seq_id[i]   = 1;
+        batch.seq_id  [i][0]= seqId;
+        batch.logits  [i]   = logits ? 1 : 0;
+        ++ batch.n_tokens;
+    }
+
+    //!< The minimum probability of the proposed token, the less confident draft stops proposing.
+    constexpr float     DRAFT_MIN_PROBABILITY   { 0.75f };
+
+    //!< The maximum difference of vocabulary sizes, the models often pad the vocabulary.
+    constexpr int32_t   VOCAB_MAX_DIFFERENCE    { 128 };
+
+    //!< The first token to compare the texts, the special tokens at the beginning may differ.
+    constexpr int32_t   VOCAB_CHECK_START       { 5 };
+}
+
+AgentDraft::AgentDraft(void)
+    : mModel        (nullptr)
+    , mContextPool  ( )
+    , mContext      (nullptr)
+    , mBatch        ( )
+    , mBatchSize    (0u)
+    , mVocabSize    (0)
+    , mStates       ( )
+{
+}
+
+AgentDraft::~AgentDraft(void)
+{
+    freeModel();
+    if (mBatch.token != nullptr)
+    {
+        llama_batch_free(mBatch);
+    }
+}
+
+bool AgentDraft::loadModel(const String& modelPath, const llama_model* target)
+{
+    LOG_SCOPE(multiedge_aiagent_AgentDraft_loadModel);
+
+    freeModel();
+
+    llama_model_params params = llama_model_default_params();
+    params.n_gpu_layers = 99; // safe default, ignored on CPU
+    params.use_mmap     = true;
+    params.use_mlock    = true;
+
+    mModel = llama_model_load_from_file(modelPath.getString(), params);
+    if (mModel == nullptr)
+    {
+        LOG_ERR("Draft model load failed: %s", modelPath.getString());
+        return false;
+    }
+
+    if ((target != nullptr) && (isCompatible(target) == false))
+    {
+        LOG_ERR("The vocabulary of the draft model [ %s ] differs from the target model", modelPath.getString());
+        freeModel();
+        return false;
+    }
+
+    // The draft must not propose the tokens, which the target model does not have.
+    mVocabSize = llama_vocab_n_tokens(llama_model_get_vocab(mModel));
+    mVocabSize = (target != nullptr ? std::min(mVocabSize, llama_vocab_n_tokens(llama_model_get_vocab(target))) : mVocabSize);
+    mContextPool.setModel(mModel);
+    LOG_DBG("Draft model activated: %s", modelPath.getString());
+    return true;
+}
+
+void AgentDraft::freeModel(void)
+{
+    releaseContext();
+    mContextPool.setModel(nullptr);
+    if (mModel != nullptr)
+    {
+        llama_model_free(mModel);
+        mModel = nullptr;
+    }
+
+    mVocabSize = 0;
+}
+
+bool AgentDraft::isCompatible(const llama_model* target) const
+{
+    if ((mModel == nullptr) || (target == nullptr))
+        return false;
+
+    const llama_vocab* draft = llama_model_get_vocab(mModel);
+    const llama_vocab* vocab = llama_model_get_vocab(target);
+    if ((llama_vocab_type(draft) != llama_vocab_type(vocab)) || (llama_vocab_bos(draft) != llama_vocab_bos(vocab)) || (llama_vocab_eos(draft) != llama_vocab_eos(vocab)))
+        return false;
+
+    const int32_t nDraft  = llama_vocab_n_tokens(draft);
+    const int32_t nTarget = llama_vocab_n_tokens(vocab);
+    if (std::abs(nDraft - nTarget) > VOCAB_MAX_DIFFERENCE)
+        return false;
+
+    // The proposed token must have the same meaning for both models.
+    const int32_t nCommon = std::min(nDraft, nTarget);
+    for (int32_t i = VOCAB_CHECK_START; i < nCommon; ++ i)
+    {
+        if (std::strcmp(llama_vocab_get_text(draft, i), llama_vocab_get_text(vocab, i)) != 0)
+            return false;
+    }
+
+    return true;
+}
+
+bool AgentDraft::createContext(const AgentContextPool::sContextKey& key)
+{
+    if (mModel == nullptr)
+        return false;
+
+    if (mContext != nullptr)
+        return true;
+
+    mContext = mContextPool.acquire(key);
+    if (mContext == nullptr)
+    {
+        LOG_ERR("Failed to acquire the context of the draft model");
+        return false;
+    }
+
+    if ((mBatch.token == nullptr) || (mBatchSize != key.batchSize))
+    {
+        if (mBatch.token != nullptr)
+        {
+            llama_batch_free(mBatch);
+        }
+
+        mBatch = llama_batch_init(static_cast<int32_t>(key.batchSize), 0, 1);
+        mBatchSize = key.batchSize;
+    }
+
+    mStates.assign(key.sequences, sDraftState{ });
+    return true;
+}
+
+void AgentDraft::releaseContext(void)
+{
+    mStates.clear();
+    mBatch.n_tokens = 0;
+    if (mContext != nullptr)
+    {
+        mContextPool.release(mContext);
+        mContext = nullptr;
+    }
+}
+
+void AgentDraft::startSequence(llama_seq_id seqId, const std::vector<llama_token>& prompt)
+{
+    if ((mContext == nullptr) || (seqId < 0) || (static_cast<size_t>(seqId) >= mStates.size()))
+        return;
+
+    llama_memory_seq_rm(llama_get_memory(mContext), seqId, -1, -1);
+    sDraftState& state = mStates[seqId];
+    state = sDraftState{ };
+    state.pending   = prompt;
+    state.active    = (prompt.empty() == false);
+}
+
+void AgentDraft::stopSequence(llama_seq_id seqId)
+{
+    if ((mContext == nullptr) || (seqId < 0) || (static_cast<size_t>(seqId) >= mStates.size()))
+        return;
+
+    if (mStates[seqId].active)
+    {
+        llama_memory_seq_rm(llama_get_memory(mContext), seqId, -1, -1);
+    }
+
+    mStates[seqId] = sDraftState{ };
+}
+
+void AgentDraft::propose(AgentDraft::ListProposals& proposals)
+{
+    LOG_SCOPE(multiedge_aiagent_AgentDraft_propose);
+
+    if (mContext == nullptr)
+    {
+        proposals.clear();
+        return;
+    }
+
+    // The verified tokens are decoded first, the prompt may need several batches.
+    // The last verified token of each sequence gives the first proposed token.
+    mBatch.n_tokens = 0;
+    for (sProposal& proposal : proposals)
+    {
+        sDraftState& state = mStates[proposal.seqId];
+        proposal.tokens.clear();
+        proposal.iBatch = -1;
+        proposal.done   = (state.active == false) || state.pending.empty() || (proposal.limit == 0u);
+        state.drafted.clear();
+        state.nFed = 0u;
+        if (proposal.done)
+            continue;
+
+        for (size_t i = 0; i < state.pending.size(); ++ i)
+        {
+            if ((static_cast<uint32_t>(mBatch.n_tokens) == mBatchSize) && (decodeBatch(proposals) == false))
+            {
+                dropProposals(proposals);
+                return;
+            }
+
+            const bool last = (i + 1u == state.pending.size());
+            proposal.iBatch = last ? mBatch.n_tokens : -1;
+            _batchAdd(mBatch, state.pending[i], state.nPast ++, proposal.seqId, last);
+        }
+
+        state.pending.clear();
+    }
+
+    if ((mBatch.n_tokens != 0) && (decodeBatch(proposals) == false))
+    {
+        dropProposals(proposals);
+        return;
+    }
+
+    // Every next step decodes the last proposed token of each sequence.
+    for (uint32_t step = 1u; step < AgentDraft::MAX_TOKENS; ++ step)
+    {
+        for (sProposal& proposal : proposals)
+        {
+            if ((proposal.done == false) && (proposal.tokens.size() < proposal.limit))
+            {
+                sDraftState& state = mStates[proposal.seqId];
+                proposal.iBatch = mBatch.n_tokens;
+                _batchAdd(mBatch, proposal.tokens.back(), state.nPast + static_cast<llama_pos>(state.nFed ++), proposal.seqId, true);
+            }
+        }
+
+        if (mBatch.n_tokens == 0)
+            break;
+
+        if (decodeBatch(proposals) == false)
+        {
+            dropProposals(proposals);
+            return;
+        }
+    }
+
+    for (sProposal& proposal : proposals)
+    {
+        mStates[proposal.seqId].drafted = proposal.tokens;
+    }
+}
+
+void AgentDraft::accept(llama_seq_id seqId, uint32_t accepted, llama_token next)
+{
+    if ((mContext == nullptr) || (seqId < 0) || (static_cast<size_t>(seqId) >= mStates.size()))
+        return;
+
+    sDraftState& state = mStates[seqId];
+    if (state.active == false)
+        return;
+
+    // The accepted tokens already decoded by the draft stay in the KV cache, the rejected are removed.
+    // The accepted tokens not decoded yet and the token of the target model are decoded on the next proposal.
+    accepted = std::min(accepted, static_cast<uint32_t>(state.drafted.size()));
+    const uint32_t keep = std::min(accepted, state.nFed);
+    state.nPast += static_cast<llama_pos>(keep);
+    if (keep < state.nFed)
+    {
+        llama_memory_seq_rm(llama_get_memory(mContext), seqId, state.nPast, -1);
+    }
+
+    state.pending.insert(state.pending.end(), state.drafted.begin() + keep, state.drafted.begin() + accepted);
+    state.pending.push_back(next);
+    state.drafted.clear();
+    state.nFed = 0u;
+}
+
+bool AgentDraft::decodeBatch(AgentDraft::ListProposals& proposals)
+{
+    const int32_t status = llama_decode(mContext, mBatch);
+    mBatch.n_tokens = 0;
+    if (status != 0)
+    {
+        LOG_ERR("Failed to decode the batch of the draft model, status [ %d ]", status);
+        return false;
+    }
+
+    const llama_vocab* vocab = llama_model_get_vocab(mModel);
+    for (sProposal& proposal : proposals)
+    {
+        if (proposal.iBatch < 0)
+            continue;
+
+        float probability{ 0.0f };
+        const llama_token token = sampleGreedy(proposal.iBatch, probability);
+        proposal.iBatch = -1;
+        if ((token == LLAMA_TOKEN_NULL) || (probability < DRAFT_MIN_PROBABILITY))
+        {
+            proposal.done = true;
+            continue;
+        }
+
+        proposal.tokens.push_back(token);
+        // Nothing to propose after the end of generation.
+        proposal.done = llama_vocab_is_eog(vocab, token) || (proposal.tokens.size() >= proposal.limit);
+    }
+
+    return true;
+}
+
+llama_token AgentDraft::sampleGreedy(int32_t index, float& probability) const
+{
+    const float* logits = llama_get_logits_ith(mContext, index);
+    if ((logits == nullptr) || (mVocabSize <= 0))
+    {
+        probability = 0.0f;
+        return LLAMA_TOKEN_NULL;
+    }
+
+    const float* best = std::max_element(logits, logits + mVocabSize);
+    double sum{ 0.0 };
+    for (int32_t i = 0; i < mVocabSize; ++ i)
+    {
+        sum += std::exp(static_cast<double>(logits[i] - *best));
+    }
+
+    probability = static_cast<float>(1.0 / sum);
+    return static_cast<llama_token>(best - logits);
+}
+
+void AgentDraft::dropProposals(AgentDraft::ListProposals& proposals)
+{
+    for (const sProposal& proposal : proposals)
+    {
+        stopSequence(proposal.seqId);
+    }
+
+    proposals.clear();
+}
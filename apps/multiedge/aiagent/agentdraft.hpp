@@ -0,0 +1,208 @@
+﻿#ifndef MULTIEDGE_AIAGENT_AGENTDRAFT_HPP
+#define MULTIEDGE_AIAGENT_AGENTDRAFT_HPP
+/************************************************************************
+ * This file is part of the Areg Edge AI project powered by AREG SDK.
+ * The project contains multiple examples of using Edge AI based on Areg communication framework.
+ *
+ *  Areg Edge AI is available as free and open-source software under the MIT License.
+ *
+ *  For detailed licensing terms, please refer to the LICENSE file included
+ *  with this distribution or contact us at info[at]areg.tech.
+ *
+ *  \copyright   © 2025 Aregtech UG. All rights reserved.
+ *  \file        multiedge/aiagent/agentdraft.hpp
+ *  \ingroup     Areg Edge AI, AI Multi Edge Device Agent
+ *  \author      Artak Avetyan
+ *  \brief       Edge AI Agent draft model of the speculative decoding.
+ *
+ ************************************************************************/
+
+/************************************************************************
+ * Includes
+ ************************************************************************/
+
+#include "areg/base/GEGlobal.h"
+#include "areg/base/String.hpp"
+#include "multiedge/aiagent/agentcontextpool.hpp"
+#include "llama.h"
+
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////
+// AgentDraft class declaration
+//////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief   The small draft model of the speculative decoding. The decoding
+ *          of the target model is bound by the memory bandwidth, a single
+ *          decoding step costs almost the same for one or several tokens of
+ *          a sequence. The draft model cheaply proposes the next tokens of
+ *          every sequence, the target model verifies them in one batched
+ *          decoding step and keeps the longest accepted run.
+ *          The draft context mirrors the sequences of the target context,
+ *          but holds only the tokens of the current prompt and reply.
+ *          The draft must share the vocabulary of the target model.
+ *          The draft is not thread safe.
+ **/
+class AgentDraft
+{
+//////////////////////////////////////////////////////////////////////////
+// Internal types and constants
+//////////////////////////////////////////////////////////////////////////
+public:
+    static constexpr uint32_t   MAX_TOKENS  { 8u };     //!< The maximum number of draft tokens per decoding step.
+    static constexpr uint32_t   MIN_TOKENS  { 0u };     //!< The minimum number of draft tokens, zero disables the speculation.
+    static constexpr uint32_t   DEF_TOKENS  { 4u };     //!< The default number of draft tokens per decoding step.
+
+    //!< The request to propose the draft tokens of the sequence.
+    struct sProposal
+    {
+        llama_seq_id                seqId   { -1 };     //!< The sequence to propose the tokens.
+        uint32_t                    limit   { 0u };     //!< The maximum number of tokens to propose.
+        std::vector<llama_token>    tokens  { };        //!< The proposed tokens.
+        int32_t                     iBatch  { -1 };     //!< The index of logits in the current batch, -1 if none.
+        bool                        done    { false };  //!< Flag, indicating that no more tokens are proposed.
+    };
+
+    using ListProposals = std::vector<sProposal>;
+
+private:
+    //!< The state of the draft sequence.
+    struct sDraftState
+    {
+        llama_pos                   nPast   { 0 };      //!< The number of verified tokens in the KV cache of the sequence.
+        std::vector<llama_token>    pending { };        //!< The verified tokens to decode before proposing.
+        std::vector<llama_token>    drafted { };        //!< The last proposed tokens.
+        uint32_t                    nFed    { 0u };     //!< The number of proposed tokens decoded in the KV cache.
+        bool                        active  { false };  //!< Flag, indicating that the sequence is speculated.
+    };
+
+//////////////////////////////////////////////////////////////////////////
+// Constructor / Destructor
+//////////////////////////////////////////////////////////////////////////
+public:
+    AgentDraft(void);
+    ~AgentDraft(void);
+
+//////////////////////////////////////////////////////////////////////////
+// Attributes and operations
+//////////////////////////////////////////////////////////////////////////
+public:
+
+    /**
+     * \brief   Loads the draft model from the file. The previously loaded draft is released.
+     * \param   modelPath   The absolute path to the GGUF model file.
+     * \param   target      The target model to check the vocabulary.
+     * \return  Returns true if the model is loaded and its vocabulary is compatible with the target.
+     **/
+    bool loadModel(const String& modelPath, const llama_model* target);
+
+    /**
+     * \brief   Releases the draft model and its context.
+     **/
+    void freeModel(void);
+
+    /**
+     * \brief   Returns true if the draft model is loaded.
+     **/
+    inline bool isLoaded(void) const;
+
+    /**
+     * \brief   Returns true if the draft context is created and the sequences can be speculated.
+     **/
+    inline bool isReady(void) const;
+
+    /**
+     * \brief   Returns true if the vocabulary of the draft model is compatible with the target model.
+     **/
+    bool isCompatible(const llama_model* target) const;
+
+    /**
+     * \brief   Acquires the draft context with the same sequences and sizes as the target context.
+     * \param   key     The parameters of the target context.
+     * \return  Returns true if the context is created.
+     **/
+    bool createContext(const AgentContextPool::sContextKey& key);
+
+    /**
+     * \brief   Returns the draft context back to the pool.
+     **/
+    void releaseContext(void);
+
+    /**
+     * \brief   Starts speculating the sequence. The prompt is decoded on the first proposal.
+     * \param   seqId   The sequence to speculate.
+     * \param   prompt  The tokens of the prompt.
+     **/
+    void startSequence(llama_seq_id seqId, const std::vector<llama_token>& prompt);
+
+    /**
+     * \brief   Stops speculating the sequence and clears its KV cache.
+     **/
+    void stopSequence(llama_seq_id seqId);
+
+    /**
+     * \brief   Proposes the draft tokens of the sequences. All sequences are decoded
+     *          in the same batch, one token per sequence and step. The proposal stops
+     *          on the limit, on the end of generation or when the draft is not confident.
+     * \param   proposals   The sequences to propose the tokens. On output contain the proposed tokens.
+     **/
+    void propose(ListProposals& proposals);
+
+    /**
+     * \brief   Accepts the result of the verification by the target model.
+     * \param   seqId       The verified sequence.
+     * \param   accepted    The number of proposed tokens accepted by the target model.
+     * \param   next        The next token sampled by the target model.
+     **/
+    void accept(llama_seq_id seqId, uint32_t accepted, llama_token next);
+
+//////////////////////////////////////////////////////////////////////////
+// Hidden methods
+//////////////////////////////////////////////////////////////////////////
+private:
+
+    //!< Decodes the batch and samples the next token of the proposals with logits in the batch.
+    //!< Returns false if the decoding failed.
+    bool decodeBatch(ListProposals& proposals);
+
+    //!< Returns the most probable token at the index of logits and its probability.
+    llama_token sampleGreedy(int32_t index, float& probability) const;
+
+    //!< Stops speculating all proposed sequences, their KV state is not reliable anymore.
+    void dropProposals(ListProposals& proposals);
+
+//////////////////////////////////////////////////////////////////////////
+// Member variables
+//////////////////////////////////////////////////////////////////////////
+private:
+    llama_model*            mModel;         //!< The loaded draft model.
+    AgentContextPool        mContextPool;   //!< The pool of the draft contexts.
+    llama_context*          mContext;       //!< The draft context.
+    llama_batch             mBatch;         //!< The batch of tokens to decode.
+    uint32_t                mBatchSize;     //!< The capacity of the allocated batch.
+    int32_t                 mVocabSize;     //!< The number of tokens common for the draft and target vocabularies.
+    std::vector<sDraftState> mStates;       //!< The states of the draft sequences.
+
+//////////////////////////////////////////////////////////////////////////
+// Forbidden calls
+//////////////////////////////////////////////////////////////////////////
+private:
+    DECLARE_NOCOPY_NOMOVE(AgentDraft);
+};
+
+//////////////////////////////////////////////////////////////////////////
+// Inline methods
+//////////////////////////////////////////////////////////////////////////
+
+inline bool AgentDraft::isLoaded(void) const
+{
+    return (mModel != nullptr);
+}
+
+inline bool AgentDraft::isReady(void) const
+{
+    return (mContext != nullptr);
+}
+
+#endif // MULTIEDGE_AIAGENT_AGENTDRAFT_HPP
@@ -0,0 +1,241 @@
+﻿/************************************************************************
+ * This file is part of the Areg Edge AI project powered by AREG SDK.
+ * The project contains multiple examples of using Edge AI based on Areg communication framework.
+ *
+ *  Areg Edge AI is available as free and open-source software under the MIT License.
+ *
+ *  For detailed licensing terms, please refer to the LICENSE file included
+ *  with this distribution or contact us at info[at]areg.tech.
+ *
+ *  \copyright   © 2025 Aregtech UG. All rights reserved.
+ *  \file        multiedge/aiagent/agentembedder.cpp
+ *  \ingroup     Areg Edge AI, AI Multi Edge Device Agent
+ *  \author      Artak Avetyan
+ *  \brief       Edge AI Agent embedding model of the prompts.
+ *
+ ************************************************************************/
+#include "multiedge/aiagent/agentembedder.hpp"
+#include "multiedge/aiagent/agenttokenizer.hpp"
+#include "areg/logging/GELog.h"
+
+#include <algorithm>
+#include <cmath>
+
+DEF_LOG_SCOPE(multiedge_aiagent_AgentEmbedder_loadModel);
+DEF_LOG_SCOPE(multiedge_aiagent_AgentEmbedder_compute);
+
+AgentEmbedder::AgentEmbedder(void)
+    : mModel        (nullptr)
+    , mContext      (nullptr)
+    , mBatch        ( )
+    , mModelPath    ( )
+    , mDimension    (0u)
+    , mTokens       ( )
+    , mSequences    ( )
+{
+}
+
+AgentEmbedder::~AgentEmbedder(void)
+{
+    freeModel();
+    if (mBatch.token != nullptr)
+    {
+        llama_batch_free(mBatch);
+    }
+}
+
+bool AgentEmbedder::loadModel(const String& modelPath, uint32_t threads)
+{
+    LOG_SCOPE(multiedge_aiagent_AgentEmbedder_loadModel);
+
+    freeModel();
+
+    llama_model_params params = llama_model_default_params();
+    params.n_gpu_layers = 99; // safe default, ignored on CPU
+    params.use_mmap     = true;
+
+    mModel = llama_model_load_from_file(modelPath.getString(), params);
+    if (mModel == nullptr)
+    {
+        LOG_ERR("Embedding model load failed: %s", modelPath.getString());
+        return false;
+    }
+
+    if (createContext(threads) == false)
+    {
+        LOG_ERR("Failed to create the context of the embedding model [ %s ]", modelPath.getString());
+        freeModel();
+        return false;
+    }
+
+    if (mBatch.token == nullptr)
+    {
+        mBatch = llama_batch_init(static_cast<int32_t>(BATCH_TOKENS), 0, 1);
+    }
+
+    mModelPath = modelPath;
+    mDimension = static_cast<uint32_t>(llama_model_n_embd(mModel));
+    LOG_DBG("Embedding model activated: %s, dimensions [ %u ]", modelPath.getString(), mDimension);
+    return true;
+}
+
+void AgentEmbedder::freeModel(void)
+{
+    if (mContext != nullptr)
+    {
+        llama_free(mContext);
+        mContext = nullptr;
+    }
+
+    if (mModel != nullptr)
+    {
+        llama_model_free(mModel);
+        mModel = nullptr;
+    }
+
+    mModelPath.clear();
+    mDimension = 0u;
+}
+
+bool AgentEmbedder::compute(const String& text, std::vector<float>& embedding)
+{
+    std::vector<std::vector<float>> embeddings;
+    const bool result = compute(std::vector<String>{ text }, embeddings);
+    embedding = std::move(embeddings.front());
+    return result;
+}
+
+bool AgentEmbedder::compute(const std::vector<String>& texts, std::vector<std::vector<float>>& embeddings)
+{
+    LOG_SCOPE(multiedge_aiagent_AgentEmbedder_compute);
+
+    embeddings.assign(texts.size(), std::vector<float>{ });
+    if (mContext == nullptr)
+        return false;
+
+    // The pooled output needs all tokens of the text in one batch, the texts fill the batch until the limits.
+    bool result{ true };
+    mSequences.clear();
+    mBatch.n_tokens = 0;
+    for (size_t i = 0; i < texts.size(); ++ i)
+    {
+        if (tokenize(texts[i]) == false)
+        {
+            result = false;
+            continue;
+        }
+
+        if ((mSequences.size() == MAX_SEQUENCES) || (static_cast<size_t>(mBatch.n_tokens) + mTokens.size() > BATCH_TOKENS))
+        {
+            result = decodeBatch(mSequences, embeddings) && result;
+        }
+
+        const llama_seq_id seqId = static_cast<llama_seq_id>(mSequences.size());
+        mSequences.push_back(i);
+        for (size_t pos = 0; pos < mTokens.size(); ++ pos)
+        {
+            const int32_t k = mBatch.n_tokens;
+            mBatch.token   [k]   = mTokens[pos];
+            mBatch.pos     [k]   = static_cast<llama_pos>(pos);
+            mBatch.n_seq_id[k]   = 1;
+            mBatch.seq_id  [k][0]= seqId;
+            mBatch.logits  [k]   = 1;
+            ++ mBatch.n_tokens;
+        }
+    }
+
+    if (mSequences.empty() == false)
+    {
+        result = decodeBatch(mSequences, embeddings) && result;
+    }
+
+    return result;
+}
+
+bool AgentEmbedder::createContext(uint32_t threads)
+{
+    llama_context_params ctx_params = llama_context_default_params();
+    ctx_params.n_ctx            = BATCH_TOKENS;
+    ctx_params.n_batch          = BATCH_TOKENS;
+    ctx_params.n_ubatch         = BATCH_TOKENS;
+    ctx_params.n_seq_max        = MAX_SEQUENCES;
+    // The sequences of the batch share the cells of the context, the texts are of different lengths.
+    ctx_params.kv_unified       = true;
+    ctx_params.n_threads        = static_cast<int32_t>(threads);
+    ctx_params.n_threads_batch  = static_cast<int32_t>(threads);
+    ctx_params.embeddings       = true;
+    ctx_params.pooling_type     = LLAMA_POOLING_TYPE_UNSPECIFIED;
+    ctx_params.no_perf          = true;
+
+    mContext = llama_init_from_model(mModel, ctx_params);
+    if ((mContext != nullptr) && (llama_pooling_type(mContext) == LLAMA_POOLING_TYPE_NONE))
+    {
+        // The text generation models have no pooling, the mean of the token embeddings represents the text.
+        llama_free(mContext);
+        ctx_params.pooling_type = LLAMA_POOLING_TYPE_MEAN;
+        mContext = llama_init_from_model(mModel, ctx_params);
+    }
+
+    return (mContext != nullptr);
+}
+
+bool AgentEmbedder::tokenize(const String& text)
+{
+    if (AgentTokenizer::tokenize(llama_model_get_vocab(mModel), text, mTokens, true, false) == false)
+        return false;
+
+    // The similar texts differ mostly in the beginning, the rest is truncated.
+    mTokens.resize(std::min(mTokens.size(), static_cast<size_t>(MAX_TOKENS)));
+    return true;
+}
+
+bool AgentEmbedder::decodeBatch(std::vector<size_t>& sequences, std::vector<std::vector<float>>& embeddings)
+{
+    // Every batch is independent, the sequences of the previous batch are removed.
+    llama_memory_clear(llama_get_memory(mContext), true);
+
+    // The encoder models, like BERT, have no decoder.
+    const int32_t status = llama_model_has_encoder(mModel) && (llama_model_has_decoder(mModel) == false) ? llama_encode(mContext, mBatch) : llama_decode(mContext, mBatch);
+    mBatch.n_tokens = 0;
+    bool result{ status == 0 };
+    if (result == false)
+    {
+        LOG_ERR("Failed to compute the embeddings of [ %u ] texts, status [ %d ]", static_cast<uint32_t>(sequences.size()), status);
+    }
+
+    for (size_t seqId = 0; result && (seqId < sequences.size()); ++ seqId)
+    {
+        const float* pooled = llama_get_embeddings_seq(mContext, static_cast<llama_seq_id>(seqId));
+        if (pooled == nullptr)
+        {
+            LOG_ERR("The embedding model did not return the pooled embedding");
+            result = false;
+            break;
+        }
+
+        std::vector<float>& embedding = embeddings[sequences[seqId]];
+        embedding.assign(pooled, pooled + mDimension);
+        _normalize(embedding);
+    }
+
+    sequences.clear();
+    return result;
+}
+
+void AgentEmbedder::_normalize(std::vector<float>& embedding)
+{
+    double sum{ 0.0 };
+    for (float value : embedding)
+    {
+        sum += static_cast<double>(value) * static_cast<double>(value);
+    }
+
+    if (sum > 0.0)
+    {
+        const float scale = static_cast<float>(1.0 / std::sqrt(sum));
+        for (float& value : embedding)
+        {
+            value *= scale;
+        }
+    }
+}
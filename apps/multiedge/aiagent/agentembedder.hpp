@@ -0,0 +1,169 @@
+﻿#ifndef MULTIEDGE_AIAGENT_AGENTEMBEDDER_HPP
+#define MULTIEDGE_AIAGENT_AGENTEMBEDDER_HPP
+/************************************************************************
+ * This file is part of the Areg Edge AI project powered by AREG SDK.
+ * The project contains multiple examples of using Edge AI based on Areg communication framework.
+ *
+ *  Areg Edge AI is available as free and open-source software under the MIT License.
+ *
+ *  For detailed licensing terms, please refer to the LICENSE file included
+ *  with this distribution or contact us at info[at]areg.tech.
+ *
+ *  \copyright   © 2025 Aregtech UG. All rights reserved.
+ *  \file        multiedge/aiagent/agentembedder.hpp
+ *  \ingroup     Areg Edge AI, AI Multi Edge Device Agent
+ *  \author      Artak Avetyan
+ *  \brief       Edge AI Agent embedding model of the prompts.
+ *
+ ************************************************************************/
+
+/************************************************************************
+ * Includes
+ ************************************************************************/
+
+#include "areg/base/GEGlobal.h"
+#include "areg/base/String.hpp"
+#include "llama.h"
+
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////
+// AgentEmbedder class declaration
+//////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief   The model computing the embeddings of the texts. The embedding
+ *          is the pooled output of the model, normalized to the unit length,
+ *          so that the cosine similarity of two texts is the dot product of
+ *          their embeddings. Several texts are decoded in one batch, every
+ *          text in own sequence of the context. The dedicated embedding model gives the best
+ *          similarity, the text generation model computes the mean pooled
+ *          embeddings. The model is loaded with the memory mapping, the same
+ *          model file loaded by the engine shares the pages of the weights.
+ *          The embedder is not thread safe.
+ **/
+class AgentEmbedder
+{
+//////////////////////////////////////////////////////////////////////////
+// Internal types and constants
+//////////////////////////////////////////////////////////////////////////
+public:
+    static constexpr uint32_t   MAX_TOKENS  { 512u };   //!< The maximum number of tokens of the text, the longer texts are truncated.
+    static constexpr uint32_t   MAX_SEQUENCES{ 16u };   //!< The maximum number of texts decoded in one batch.
+    static constexpr uint32_t   BATCH_TOKENS{ 2048u };  //!< The maximum number of tokens decoded in one batch.
+
+//////////////////////////////////////////////////////////////////////////
+// Constructor / Destructor
+//////////////////////////////////////////////////////////////////////////
+public:
+    AgentEmbedder(void);
+    ~AgentEmbedder(void);
+
+//////////////////////////////////////////////////////////////////////////
+// Attributes and operations
+//////////////////////////////////////////////////////////////////////////
+public:
+
+    /**
+     * \brief   Loads the model from the file and creates the context of the embeddings.
+     *          The previously loaded model is released.
+     * \param   modelPath   The absolute path to the GGUF model file.
+     * \param   threads     The number of threads to compute the embeddings.
+     * \return  Returns true if the model is loaded and the context is created.
+     **/
+    bool loadModel(const String& modelPath, uint32_t threads);
+
+    /**
+     * \brief   Releases the model and its context.
+     **/
+    void freeModel(void);
+
+    /**
+     * \brief   Returns true if the model is loaded and the embeddings can be computed.
+     **/
+    inline bool isLoaded(void) const;
+
+    /**
+     * \brief   Returns the path of the loaded model file, empty if none is loaded.
+     **/
+    inline const String& getModelPath(void) const;
+
+    /**
+     * \brief   Returns the number of dimensions of the embeddings, zero if no model is loaded.
+     **/
+    inline uint32_t getDimension(void) const;
+
+    /**
+     * \brief   Computes the embedding of the text normalized to the unit length.
+     * \param   text        The text to compute the embedding.
+     * \param   embedding   On output contains the embedding of the text.
+     * \return  Returns true if the embedding is computed.
+     **/
+    bool compute(const String& text, std::vector<float>& embedding);
+
+    /**
+     * \brief   Computes the embeddings of the texts normalized to the unit length. The texts
+     *          are decoded in batches, as many texts as fit the limits of the batch.
+     * \param   texts       The texts to compute the embeddings.
+     * \param   embeddings  On output contains the embeddings in the order of the texts.
+     *                      The embedding of the failed text is empty.
+     * \return  Returns true if the embeddings of all texts are computed.
+     **/
+    bool compute(const std::vector<String>& texts, std::vector<std::vector<float>>& embeddings);
+
+//////////////////////////////////////////////////////////////////////////
+// Hidden methods
+//////////////////////////////////////////////////////////////////////////
+private:
+
+    //!< Creates the context with the pooling of the model, the mean pooling if the model has none.
+    bool createContext(uint32_t threads);
+
+    //!< Tokenizes the text and truncates the tokens to the maximum. Returns false if failed.
+    bool tokenize(const String& text);
+
+    //!< Decodes the batch and takes the pooled embeddings of the sequences. The sequence is the index in the list of texts.
+    bool decodeBatch(std::vector<size_t>& sequences, std::vector<std::vector<float>>& embeddings);
+
+    //!< Normalizes the vector to the unit length.
+    static void _normalize(std::vector<float>& embedding);
+
+//////////////////////////////////////////////////////////////////////////
+// Member variables
+//////////////////////////////////////////////////////////////////////////
+private:
+    llama_model*            mModel;         //!< The loaded model.
+    llama_context*          mContext;       //!< The context computing the embeddings.
+    llama_batch             mBatch;         //!< The batch of tokens to decode.
+    String                  mModelPath;     //!< The path of the loaded model file.
+    uint32_t                mDimension;     //!< The number of dimensions of the embeddings.
+    std::vector<llama_token> mTokens;       //!< The tokens of the text.
+    std::vector<size_t>     mSequences;     //!< The index of the text of each sequence of the batch.
+
+//////////////////////////////////////////////////////////////////////////
+// Forbidden calls
+//////////////////////////////////////////////////////////////////////////
+private:
+    DECLARE_NOCOPY_NOMOVE(AgentEmbedder);
+};
+
+//////////////////////////////////////////////////////////////////////////
+// Inline methods
+//////////////////////////////////////////////////////////////////////////
+
+inline bool AgentEmbedder::isLoaded(void) const
+{
+    return (mContext != nullptr);
+}
+
+inline const String& AgentEmbedder::getModelPath(void) const
+{
+    return mModelPath;
+}
+
+inline uint32_t AgentEmbedder::getDimension(void) const
+{
+    return mDimension;
+}
+
+#endif // MULTIEDGE_AIAGENT_AGENTEMBEDDER_HPP
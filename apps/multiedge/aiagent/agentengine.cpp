@@ -0,0 +1,1324 @@
+﻿/************************************************************************
+ * This file is part of the Areg Edge AI project powered by AREG SDK.
+ * The project contains multiple examples of using Edge AI based on Areg communication framework.
+ *
+ *  Areg Edge AI is available as free and open-source software under the MIT License.
+ *
+ *  For detailed licensing terms, please refer to the LICENSE file included
+ *  with this distribution or contact us at info[at]areg.tech.
+ *
+ *  \copyright   © 2025 Aregtech UG. All rights reserved.
+ *  \file        multiedge/aiagent/agentengine.cpp
+ *  \ingroup     Areg Edge AI, AI Multi Edge Device Agent
+ *  \author      Artak Avetyan
+ *  \brief       Edge AI Agent continuous batching LLM inference engine.
+ *
+ ************************************************************************/
+#include "multiedge/aiagent/agentengine.hpp"
+#include "areg/logging/GELog.h"
+
+#include <algorithm>
+#include <functional>
+#include <string_view>
+
+DEF_LOG_SCOPE(multiedge_aiagent_AgentEngine_loadModel);
+DEF_LOG_SCOPE(multiedge_aiagent_AgentEngine_loadAdapter);
+DEF_LOG_SCOPE(multiedge_aiagent_AgentEngine_loadDraft);
+DEF_LOG_SCOPE(multiedge_aiagent_AgentEngine_switchModel);
+DEF_LOG_SCOPE(multiedge_aiagent_AgentEngine_installModel);
+DEF_LOG_SCOPE(multiedge_aiagent_AgentEngine_setKvCache);
+DEF_LOG_SCOPE(multiedge_aiagent_AgentEngine_createContext);
+DEF_LOG_SCOPE(multiedge_aiagent_AgentEngine_decodeStep);
+DEF_LOG_SCOPE(multiedge_aiagent_AgentEngine_completeSequence);
+
+namespace
+{
+    //!< Adds the token to the batch.
+    inline void _batchAdd(llama_batch& batch, llama_token token, llama_pos pos, llama_seq_id seqId, bool logits)
+    {
+        const int32_t i = batch.n_tokens;
+        batch.token   [i]   = token;
+        batch.pos     [i]   = pos;
+        batch.n_seq_id[i]   = 1;
+        batch.seq_id  [i][0]= seqId;
+        batch.logits  [i]   = logits ? 1 : 0;
+        ++ batch.n_tokens;
+    }
+
+    //!< The size of the buffer to convert token to piece.
+    constexpr int   PIECE_LENGTH    { 256 };
+
+    //!< The maximum length of the sentence without punctuation to flush.
+    constexpr uint32_t  SENTENCE_LENGTH { 300u };
+
+    //!< The number of tokens to generate in the precise modes.
+    constexpr uint32_t  PRECISE_TOKENS  { 64u };
+
+    //!< The scale of the LoRA adapter set to the context.
+    constexpr float     ADAPTER_SCALE   { 1.0f };
+
+    //!< Returns the key of the conversation continued with the LoRA adapter. The stateless prompt remains stateless.
+    inline uint64_t _adapterConversation(uint64_t conversation, const String& adapter)
+    {
+        if (conversation == AgentEngine::NO_CONVERSATION)
+            return conversation;
+
+        const uint64_t result = conversation ^ static_cast<uint64_t>(std::hash<std::string_view>{ }(std::string_view(adapter.getString(), adapter.getLength())));
+        return (result != AgentEngine::NO_CONVERSATION ? result : conversation);
+    }
+
+    //!< Returns the time in microseconds passed since the given time point.
+    inline uint64_t _elapsed(const std::chrono::steady_clock::time_point& since)
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - since).count());
+    }
+}
+
+AgentEngine::AgentEngine(IEAgentEngineListener& listener)
+    : mListener     (listener)
+    , mLLMModel     (nullptr)
+    , mNextModel    (nullptr)
+    , mNextPath     ( )
+    , mContextPool  ( )
+    , mCtxKey       ( )
+    , mPrefixCache  ( )
+    , mSessions     ( )
+    , mDraft        ( )
+    , mProposals    ( )
+    , mAdapters     ( )
+    , mAdapter      (NO_ADAPTER)
+    , mUseStamp     (0u)
+    , mContext      (nullptr)
+    , mBatch        ( )
+    , mBatchSize    (0u)
+    , mTextLimit    (1024u)
+    , mContextSize  (1024u)
+    , mContextBudget(0u)
+    , mShrinkDrains (0u)
+    , mCacheTypeK   (AgentContextPool::CacheF16)
+    , mCacheTypeV   (AgentContextPool::CacheF16)
+    , mFlashAttn    (AgentContextPool::FlashAuto)
+    , mTokenLimit   (512u)
+    , mBatching     (512u)
+    , mThreads      (4u)
+    , mSequences    (DEF_SEQUENCES)
+    , mTemperature  (0.1f)
+    , mProbability  (0.08f)
+    , mDraftLimit   (AgentDraft::DEF_TOKENS)
+    , mLookup       (false)
+    , mPending      ( )
+    , mSlots        ( )
+    , mAbort        (false)
+{
+}
+
+AgentEngine::~AgentEngine(void)
+{
+    freeModel();
+    if (mBatch.token != nullptr)
+    {
+        llama_batch_free(mBatch);
+    }
+}
+
+bool AgentEngine::loadModel(const String& modelPath)
+{
+    LOG_SCOPE(multiedge_aiagent_AgentEngine_loadModel);
+
+    freeModel();
+
+    llama_model* model = openModel(modelPath);
+    if (model == nullptr)
+    {
+        LOG_ERR("Model load failed");
+        return false;
+    }
+
+    installModel(model);
+    LOG_DBG("Model activated: %s", modelPath.getString());
+    return true;
+}
+
+llama_model* AgentEngine::openModel(const String& modelPath, const std::atomic_bool* cancel /*= nullptr*/)
+{
+    llama_model_params params = llama_model_default_params();
+    params.n_gpu_layers = 99; // safe default, ignored on CPU
+    params.use_mmap     = true;
+    params.use_mlock    = true;
+    if (cancel != nullptr)
+    {
+        // Returning false from the progress callback aborts the loading.
+        params.progress_callback_user_data = const_cast<std::atomic_bool*>(cancel);
+        params.progress_callback = [](float /*progress*/, void* data) -> bool { return (static_cast<const std::atomic_bool*>(data)->load() == false); };
+    }
+
+    return llama_model_load_from_file(modelPath.getString(), params);
+}
+
+void AgentEngine::switchModel(llama_model* model, const String& modelPath)
+{
+    LOG_SCOPE(multiedge_aiagent_AgentEngine_switchModel);
+    if (mNextModel != nullptr)
+    {
+        LOG_INFO("Model [ %s ] waiting for the switch is replaced by [ %s ]", mNextPath.getString(), modelPath.getString());
+        llama_model_free(mNextModel);
+    }
+
+    mNextModel = model;
+    mNextPath  = modelPath;
+    if (activeCount() == 0u)
+    {
+        switchPending();
+    }
+    else
+    {
+        LOG_INFO("Model [ %s ] waits for [ %u ] sequences in progress", modelPath.getString(), activeCount());
+    }
+}
+
+void AgentEngine::attachModel(llama_model* model)
+{
+    LOG_SCOPE(multiedge_aiagent_AgentEngine_switchModel);
+    if (mNextModel != nullptr)
+    {
+        llama_model_free(mNextModel);
+        mNextModel = nullptr;
+        mNextPath.clear();
+    }
+
+    // The sequences of the previous model complete with the text generated so far.
+    for (sSequence& seq : mSlots)
+    {
+        if (seq.sessionId != INVALID_SESSION)
+        {
+            seq.response += seq.sentence;
+            completeSequence(seq, true, false);
+        }
+    }
+
+    installModel(model);
+}
+
+bool AgentEngine::loadAdapter(const String& name, const String& adapterPath)
+{
+    LOG_SCOPE(multiedge_aiagent_AgentEngine_loadAdapter);
+    if ((mLLMModel == nullptr) || name.isEmpty())
+        return false;
+
+    if (findAdapter(name) != NO_ADAPTER)
+        return true;
+
+    // The adapter holds only the low-rank deltas, the weights of the model are shared.
+    llama_adapter_lora* adapter = llama_adapter_lora_init(mLLMModel, adapterPath.getString());
+    if (adapter == nullptr)
+    {
+        LOG_ERR("Failed to load LoRA adapter [ %s ]", adapterPath.getString());
+        return false;
+    }
+
+    mAdapters.push_back(sAdapter{ name, adapter });
+    LOG_INFO("Loaded LoRA adapter [ %s ], [ %u ] adapters are loaded", name.getString(), static_cast<uint32_t>(mAdapters.size()));
+    return true;
+}
+
+bool AgentEngine::loadDraft(const String& modelPath)
+{
+    LOG_SCOPE(multiedge_aiagent_AgentEngine_loadDraft);
+
+    freeDraft();
+    if (modelPath.isEmpty())
+        return false;
+
+    if (mDraft.loadModel(modelPath, mLLMModel) == false)
+        return false;
+
+    // The running sequences are not speculated, the new sequences are.
+    if ((mContext != nullptr) && (mDraft.createContext(mCtxKey) == false))
+    {
+        LOG_WARN("Failed to create the context of the draft model, the speculation is disabled");
+    }
+
+    return true;
+}
+
+void AgentEngine::freeDraft(void)
+{
+    for (sSequence& seq : mSlots)
+    {
+        if (seq.speculation == SpeculateDraft)
+        {
+            seq.speculation = SpeculateNone;
+            seq.drafts.clear();
+        }
+    }
+
+    mDraft.freeModel();
+}
+
+void AgentEngine::setDraftLimit(uint32_t tokens)
+{
+    mDraftLimit = std::min(tokens, AgentDraft::MAX_TOKENS);
+}
+
+void AgentEngine::freeModel(void)
+{
+    completeAll();
+    dropConversations();
+    releaseContext();
+    freeAdapters();
+    mContextPool.setModel(nullptr);
+    // The cached KV states are valid only for the model, which created them.
+    mPrefixCache.clear();
+    if (mLLMModel != nullptr)
+    {
+        llama_model_free(mLLMModel);
+        mLLMModel = nullptr;
+    }
+
+    if (mNextModel != nullptr)
+    {
+        llama_model_free(mNextModel);
+        mNextModel = nullptr;
+        mNextPath.clear();
+    }
+}
+
+void AgentEngine::setLimits(uint32_t textLimit, uint32_t tokenLimit, uint32_t batching, uint32_t threads, uint32_t sequences)
+{
+    mTextLimit  = textLimit;
+    mTokenLimit = tokenLimit;
+    mBatching   = batching;
+    mThreads    = threads;
+    mSequences  = std::clamp(sequences, MIN_SEQUENCES, MAX_SEQUENCES);
+    if ((activeCount() == 0u) && (mLLMModel != nullptr))
+    {
+        // No sequence in progress, rebuild the pool if the limits are changed.
+        releaseContext();
+        mContextPool.prepare(contextKey());
+    }
+}
+
+void AgentEngine::setContextBudget(uint64_t budget)
+{
+    mContextBudget = budget;
+    // The idle contexts of other size classes are kept within the same budget.
+    mContextPool.setBudget(budget);
+}
+
+uint64_t AgentEngine::estimateMemory(uint32_t ctxSize) const
+{
+    AgentContextPool::sContextKey key{ contextKey() };
+    key.ctxSize = ctxSize;
+    return AgentContextPool::estimateMemory(mLLMModel, key);
+}
+
+void AgentEngine::setKvCache(AgentContextPool::eCacheType typeK, AgentContextPool::eCacheType typeV, AgentContextPool::eFlashAttention flashAttn)
+{
+    LOG_SCOPE(multiedge_aiagent_AgentEngine_setKvCache);
+    if ((typeV != AgentContextPool::CacheF16) && (flashAttn == AgentContextPool::FlashOff))
+    {
+        LOG_WARN("The quantized values of the KV cache require the flash attention, using [ %s ] values", AgentContextPool::getString(AgentContextPool::CacheF16));
+        typeV = AgentContextPool::CacheF16;
+    }
+
+    mCacheTypeK = typeK;
+    mCacheTypeV = typeV;
+    mFlashAttn  = flashAttn;
+    if ((activeCount() == 0u) && (mLLMModel != nullptr))
+    {
+        // No sequence in progress, rebuild the pool if the data types are changed.
+        releaseContext();
+        mContextPool.prepare(contextKey());
+    }
+}
+
+void AgentEngine::setCacheBudget(uint64_t budget)
+{
+    mPrefixCache.setBudget(budget);
+}
+
+void AgentEngine::setSampling(float temperature, float probability)
+{
+    mTemperature = temperature;
+    mProbability = probability;
+}
+
+void AgentEngine::setSessionLimits(uint64_t budget, uint64_t diskBudget, const String& directory)
+{
+    mSessions.setBudget(budget);
+    mSessions.setDirectory(directory, diskBudget);
+}
+
+void AgentEngine::queuePrompt(uint32_t sessionId, uint64_t conversation, const String& adapter, const SharedText& prompt, std::vector<llama_token>&& tokens /*= std::vector<llama_token>()*/)
+{
+    if ((adapter.isEmpty() == false) && (mLLMModel != nullptr) && (mNextModel == nullptr) && (findAdapter(adapter) == NO_ADAPTER))
+    {
+        LOG_WARN("LoRA adapter [ %s ] is not loaded, the prompt of session [ %u ] is decoded without adapter", adapter.getString(), sessionId);
+    }
+
+    // The KV state of the conversation is decoded with the adapter, the turns with other adapter continue other conversation.
+    const uint64_t key = (adapter.isEmpty() ? conversation : _adapterConversation(conversation, adapter));
+    mPending.push_back(sPendingPrompt{ sessionId, key, prompt, adapter, Clock::now(), mLookup, std::move(tokens) });
+}
+
+bool AgentEngine::hasWork(void) const
+{
+    return ((mPending.empty() == false) || (activeCount() != 0u) || (mNextModel != nullptr));
+}
+
+bool AgentEngine::decodeStep(void)
+{
+    LOG_SCOPE(multiedge_aiagent_AgentEngine_decodeStep);
+
+    if ((mNextModel != nullptr) && (activeCount() == 0u))
+    {
+        // The last sequence of the previous model is completed.
+        switchPending();
+    }
+
+    if (mLLMModel == nullptr)
+    {
+        LOG_ERR("Model is not activated, completing [ %u ] pending prompts", static_cast<uint32_t>(mPending.size()));
+        completeAll();
+        return false;
+    }
+
+    if ((activeCount() == 0u) && (mPending.empty() == false))
+    {
+        // No sequence in progress, the context is sized for the next prompts. The larger class
+        // is used at once, the smaller one only if the prompts need less for several drains.
+        const uint32_t required = requiredContext();
+        mShrinkDrains = (required < mContextSize) ? mShrinkDrains + 1u : 0u;
+        if ((required > mContextSize) || (mShrinkDrains >= SHRINK_DRAINS))
+        {
+            LOG_INFO("Switching the context from [ %u ] to [ %u ] tokens per sequence, the KV cache takes [ %llu ] bytes"
+                        , mContextSize, required, static_cast<unsigned long long>(estimateMemory(required * mSequences)));
+            mContextSize = required;
+            mShrinkDrains = 0u;
+        }
+    }
+
+    if ((activeCount() == 0u) && (mContext != nullptr) && (mCtxKey != contextKey()))
+    {
+        // The limits or the size class are changed while the sequences were decoded.
+        // The context of the previous size stays in the pool within the memory budget.
+        releaseContext();
+        mContextPool.prepare(contextKey());
+    }
+
+    if (createContext() == false)
+    {
+        completeAll();
+        return false;
+    }
+
+    // Decoding sequences contribute single token and the proposed tokens to verify,
+    // the joining sequences contribute the prompt.
+    proposeDrafts();
+    mBatch.n_tokens = 0;
+    for (sSequence& seq : mSlots)
+    {
+        seq.iBatch = -1;
+        if ((seq.sessionId != INVALID_SESSION) && seq.tokens.empty())
+        {
+            seq.iBatch = mBatch.n_tokens;
+            seq.nStart = seq.nPast;
+            _batchAdd(mBatch, seq.lastToken, seq.nPast ++, seq.seqId, true);
+            for (llama_token token : seq.drafts)
+            {
+                _batchAdd(mBatch, token, seq.nPast ++, seq.seqId, true);
+            }
+        }
+    }
+
+    // The prompts are prefilled in chunks within the rest of the batch, so that a long prompt
+    // does not stop the generation of the other sequences.
+    const uint32_t admitted = admitPending();
+    const uint32_t prefill  = prefillPrompts(static_cast<uint32_t>(mBatch.n_tokens));
+    if (mBatch.n_tokens == 0)
+    {
+        return hasWork();
+    }
+
+    LOG_DBG("Decoding batch of [ %d ] tokens, [ %u ] tokens of prompts, [ %u ] new and [ %u ] active sequences"
+                , mBatch.n_tokens, prefill, admitted, activeCount());
+
+    const int32_t status = llama_decode(mContext, mBatch);
+    if (status != 0)
+    {
+        if (status == 2)
+        {
+            LOG_WARN("Decoding of the batch of [ %d ] tokens is aborted", mBatch.n_tokens);
+        }
+        else
+        {
+            LOG_ERR("Failed to decode the batch of [ %d ] tokens", mBatch.n_tokens);
+        }
+
+        llama_memory_t memory = llama_get_memory(mContext);
+        for (sSequence& seq : mSlots)
+        {
+            if ((seq.sessionId == INVALID_SESSION) || (seq.iBatch < 0))
+                continue;
+
+            if (status == 2)
+            {
+                // The tokens of the aborted batch are removed, the sequence continues from the previous step.
+                // The canceled sequences are completed when the canceling is processed.
+                llama_memory_seq_rm(memory, seq.seqId, seq.nStart, -1);
+                if (seq.tokens.empty() == false)
+                {
+                    seq.nPrefill -= static_cast<uint32_t>(seq.nPast - seq.nStart);
+                }
+                else if (seq.speculation == SpeculateDraft)
+                {
+                    // The draft state of the aborted step is not reliable, the sequence continues without speculation.
+                    mDraft.stopSequence(seq.seqId);
+                    seq.speculation = SpeculateNone;
+                }
+
+                seq.nPast = seq.nStart;
+                seq.drafts.clear();
+            }
+            else
+            {
+                // The turn failed, the conversation continues from the previous turn.
+                llama_memory_seq_rm(memory, seq.seqId, seq.nBase, -1);
+                seq.nPast       = seq.nBase;
+                seq.lastToken   = seq.baseToken;
+                seq.response   += seq.sentence;
+                completeSequence(seq, true, false);
+            }
+        }
+
+        return hasWork();
+    }
+
+    for (sSequence& seq : mSlots)
+    {
+        if ((seq.sessionId != INVALID_SESSION) && (seq.iBatch >= 0))
+        {
+            if (seq.tokens.empty() == false)
+            {
+                // The rest of the prompt is decoded on the next steps.
+                if (seq.nPrefill < static_cast<uint32_t>(seq.tokens.size()))
+                    continue;
+
+                cachePrompt(seq);
+                seq.tokens.clear();
+                seq.stats.prefillTime = _elapsed(seq.stamp);
+                seq.stamp = Clock::now();
+            }
+
+            if (sampleNext(seq) == false)
+            {
+                completeSequence(seq, true, true);
+            }
+        }
+    }
+
+    if (hasWork() == false)
+    {
+        // Nothing to decode, clear the memory and keep the context in the pool.
+        // The context is kept while idle conversations hold their KV states in the sequences.
+        if (std::none_of(mSlots.begin(), mSlots.end(), [](const sSequence& seq) { return (seq.conversation != NO_CONVERSATION); }))
+        {
+            releaseContext();
+        }
+
+        return false;
+    }
+
+    return true;
+}
+
+bool AgentEngine::cancelPrompt(uint32_t sessionId)
+{
+    ListPending::iterator pos = std::find_if(mPending.begin(), mPending.end(), [sessionId](const sPendingPrompt& entry) { return (entry.sessionId == sessionId); });
+    if (pos != mPending.end())
+    {
+        LOG_DBG("Canceled pending prompt of session [ %u ]", sessionId);
+        IEAgentEngineListener::sTextStats stats;
+        stats.waitTime = _elapsed(pos->queued);
+        mPending.erase(pos);
+        mListener.onTextReplied(sessionId, NEAgentText::emptyText(), stats);
+        return true;
+    }
+
+    for (sSequence& seq : mSlots)
+    {
+        if (seq.sessionId == sessionId)
+        {
+            if ((seq.tokens.empty() == false) && (mContext != nullptr))
+            {
+                // The prompt is partially prefilled, the conversation continues from the previous turn.
+                llama_memory_seq_rm(llama_get_memory(mContext), seq.seqId, seq.nBase, -1);
+                seq.nPast = seq.nBase;
+            }
+
+            // The sampled token is not decoded, it is decoded with the next turn of the conversation.
+            LOG_DBG("Canceled session [ %u ] after [ %u ] generated tokens", sessionId, seq.nGenerated);
+            seq.response += seq.sentence;
+            completeSequence(seq, true, false);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool AgentEngine::createContext(void)
+{
+    if (mContext != nullptr)
+        return true;
+
+    LOG_SCOPE(multiedge_aiagent_AgentEngine_createContext);
+
+    const AgentContextPool::sContextKey key{ contextKey() };
+    if ((mCtxKey.ctxSize != 0u) && ((mCtxKey.typeK != key.typeK) || (mCtxKey.typeV != key.typeV)))
+    {
+        // The stored KV states cannot be restored to the cache of other data types.
+        LOG_INFO("KV cache is changed to [ %s / %s ], dropping the stored KV states", AgentContextPool::getString(key.typeK), AgentContextPool::getString(key.typeV));
+        dropConversations();
+        mPrefixCache.clear();
+    }
+
+    // Every sequence has its own part of the KV cache with the size of its size class.
+    mCtxKey  = key;
+    mContext = mContextPool.acquire(mCtxKey);
+    if (mContext == nullptr)
+    {
+        LOG_ERR("Failed to acquire llama context");
+        return false;
+    }
+
+    if ((mBatch.token == nullptr) || (mBatchSize != mCtxKey.batchSize))
+    {
+        if (mBatch.token != nullptr)
+        {
+            llama_batch_free(mBatch);
+        }
+
+        mBatch = llama_batch_init(static_cast<int32_t>(mCtxKey.batchSize), 0, 1);
+        mBatchSize = mCtxKey.batchSize;
+    }
+
+    // The decoding of the pooled context can be aborted only by this engine.
+    llama_set_abort_callback(mContext, &AgentEngine::_abortCallback, this);
+    mSlots.resize(mCtxKey.sequences);
+    for (uint32_t i = 0; i < mCtxKey.sequences; ++ i)
+    {
+        mSlots[i] = sSequence{ };
+        mSlots[i].seqId = static_cast<llama_seq_id>(i);
+    }
+
+    if (mDraft.isLoaded() && (mDraft.createContext(mCtxKey) == false))
+    {
+        LOG_WARN("Failed to create the context of the draft model, decoding without speculation");
+    }
+
+    LOG_DBG("Acquired llama context, context size [ %u ], batch [ %u ], sequences [ %u ]", mCtxKey.ctxSize, mCtxKey.batchSize, mCtxKey.sequences);
+    return true;
+}
+
+void AgentEngine::releaseContext(void)
+{
+    for (sSequence& seq : mSlots)
+    {
+        // The memory of the context is cleared, move the idle conversations to the store.
+        if ((seq.sessionId == INVALID_SESSION) && (seq.conversation != NO_CONVERSATION))
+        {
+            parkConversation(seq);
+        }
+
+        if (seq.sampler != nullptr)
+        {
+            llama_sampler_free(seq.sampler);
+        }
+    }
+
+    mSlots.clear();
+    mBatch.n_tokens = 0;
+    mDraft.releaseContext();
+    if (mContext != nullptr)
+    {
+        // The pooled context is returned without adapter.
+        if (mAdapter != NO_ADAPTER)
+        {
+            llama_clear_adapter_lora(mContext);
+            mAdapter = NO_ADAPTER;
+        }
+
+        llama_set_abort_callback(mContext, nullptr, nullptr);
+        mContextPool.release(mContext);
+        mContext = nullptr;
+    }
+}
+
+void AgentEngine::installModel(llama_model* model)
+{
+    LOG_SCOPE(multiedge_aiagent_AgentEngine_installModel);
+
+    // The KV states and the contexts are valid only for the model, which created them.
+    releaseContext();
+    dropConversations();
+    freeAdapters();
+    mContextPool.setModel(model);
+    mPrefixCache.clear();
+    if (mLLMModel != nullptr)
+    {
+        llama_model_free(mLLMModel);
+    }
+
+    // The contexts are pre-created once per model and limits, and reused by all requests.
+    // The sequences of the context are cleaned on completion to avoid topic mixing.
+    mLLMModel = model;
+    mContextPool.prepare(contextKey());
+    if (mDraft.isLoaded() && (mDraft.isCompatible(mLLMModel) == false))
+    {
+        LOG_WARN("The draft model does not match the vocabulary of the activated model, the speculation is disabled");
+        freeDraft();
+    }
+}
+
+void AgentEngine::switchPending(void)
+{
+    llama_model* model = mNextModel;
+    const String modelPath(mNextPath);
+    mNextModel = nullptr;
+    mNextPath.clear();
+
+    // The waiting prompts are tokenized by the vocabulary of the previous model.
+    for (sPendingPrompt& pending : mPending)
+    {
+        pending.tokens.clear();
+    }
+
+    installModel(model);
+    LOG_DBG("Model switched: %s", modelPath.getString());
+    mListener.onModelSwitched(modelPath);
+}
+
+void AgentEngine::freeAdapters(void)
+{
+    applyAdapter(NO_ADAPTER);
+    for (sAdapter& entry : mAdapters)
+    {
+        llama_adapter_lora_free(entry.adapter);
+    }
+
+    mAdapters.clear();
+}
+
+int32_t AgentEngine::findAdapter(const String& name) const
+{
+    if (name.isEmpty())
+        return NO_ADAPTER;
+
+    ListAdapters::const_iterator pos = std::find_if(mAdapters.begin(), mAdapters.end(), [&name](const sAdapter& entry) { return (entry.name == name); });
+    return (pos != mAdapters.end() ? static_cast<int32_t>(pos - mAdapters.begin()) : NO_ADAPTER);
+}
+
+void AgentEngine::applyAdapter(int32_t adapter)
+{
+    if ((mContext == nullptr) || (adapter == mAdapter))
+        return;
+
+    llama_clear_adapter_lora(mContext);
+    mAdapter = NO_ADAPTER;
+    if (adapter == NO_ADAPTER)
+    {
+        LOG_DBG("Decoding without LoRA adapter");
+    }
+    else if (llama_set_adapter_lora(mContext, mAdapters[adapter].adapter, ADAPTER_SCALE) != 0)
+    {
+        LOG_ERR("Failed to set LoRA adapter [ %s ], decoding without adapter", mAdapters[adapter].name.getString());
+    }
+    else
+    {
+        LOG_DBG("Decoding with LoRA adapter [ %s ]", mAdapters[adapter].name.getString());
+        mAdapter = adapter;
+    }
+}
+
+AgentContextPool::sContextKey AgentEngine::contextKey(void) const
+{
+    return AgentContextPool::sContextKey{ mContextSize * mSequences, mBatching, mThreads, mSequences, mCacheTypeK, mCacheTypeV, mFlashAttn };
+}
+
+uint32_t AgentEngine::tokenBudget(void) const
+{
+    return (mTemperature <= 0.2f) ? PRECISE_TOKENS : mTokenLimit;
+}
+
+uint32_t AgentEngine::contextClass(uint32_t tokens) const
+{
+    const uint32_t trained = (mLLMModel != nullptr ? static_cast<uint32_t>(std::max(llama_model_n_ctx_train(mLLMModel), 0)) : 0u);
+    uint32_t result{ MIN_CONTEXT };
+    while ((result < tokens) && (result < MAX_CONTEXT))
+    {
+        // The larger class is used only if the model is trained for it and its KV cache fits the budget.
+        const uint32_t next = result * 2u;
+        if (((trained != 0u) && (next > trained)) || ((next > BASE_CONTEXT) && (estimateMemory(next * mSequences) > mContextBudget)))
+            break;
+
+        result = next;
+    }
+
+    return result;
+}
+
+uint32_t AgentEngine::promptDemand(sPendingPrompt& pending)
+{
+    if (pending.tokens.empty() && (pending.prompt != nullptr) && (pending.prompt->isEmpty() == false))
+    {
+        // The BOS token is added on admission, only if the prompt starts the sequence.
+        AgentTokenizer::tokenize(llama_model_get_vocab(mLLMModel), *pending.prompt, pending.tokens, false, true);
+    }
+
+    // The idle conversation keeps the tokens of the previous turns in the sequence.
+    uint32_t nBase{ 0u };
+    for (const sSequence& seq : mSlots)
+    {
+        if ((pending.conversation != NO_CONVERSATION) && (seq.conversation == pending.conversation))
+        {
+            nBase = static_cast<uint32_t>(seq.nPast);
+            break;
+        }
+    }
+
+    return nBase + static_cast<uint32_t>(pending.tokens.size()) + 1u + tokenBudget();
+}
+
+uint32_t AgentEngine::requiredContext(void)
+{
+    // The prompts, which join the batch first, decide the size.
+    uint32_t demand{ 0u };
+    uint32_t count{ 0u };
+    for (ListPending::iterator pos = mPending.begin(); (pos != mPending.end()) && (count < mSequences); ++ pos, ++ count)
+    {
+        demand = std::max(demand, promptDemand(*pos));
+    }
+
+    return contextClass(demand);
+}
+
+llama_sampler* AgentEngine::createSampler(void) const
+{
+    // Sampler chain (correct order)
+    llama_sampler* smpl = llama_sampler_chain_init(llama_sampler_chain_default_params());
+    // Light repetition control (important for agents)
+    llama_sampler*  penalties = llama_sampler_init_penalties( /* repeat_last_n */ 64
+                                                             , /* repeat_penalty */ 1.10f
+                                                             , /* freq_penalty   */ 0.0f
+                                                             , /* present_penalty*/ 0.0f);
+    llama_sampler_chain_add(smpl, penalties );
+    if (mTemperature == 0.0f)
+    {
+        llama_sampler_chain_add(smpl, llama_sampler_init_greedy());
+    }
+    else
+    {
+        // Temperature (low = precise)
+        llama_sampler_chain_add(smpl, llama_sampler_init_temp(mTemperature));
+        // min_p filtering (FIXED: min_keep > 1)
+        llama_sampler_chain_add(smpl, llama_sampler_init_min_p(mProbability, 5));
+        // Final distribution
+        llama_sampler_chain_add(smpl, llama_sampler_init_dist(LLAMA_DEFAULT_SEED));
+    }
+
+    return smpl;
+}
+
+uint32_t AgentEngine::admitPending(void)
+{
+    uint32_t result{ 0u };
+    if (mNextModel != nullptr)
+    {
+        // The prompts wait for the next model, the sequences in progress complete with the active one.
+        return result;
+    }
+
+    for (ListPending::iterator pos = mPending.begin(); pos != mPending.end(); )
+    {
+        // The turns of the same conversation are decoded one after another.
+        if ((pos->conversation != NO_CONVERSATION) && isDecoding(pos->conversation))
+        {
+            ++ pos;
+            continue;
+        }
+
+        // The prompt, which needs a larger context, waits until the running sequences complete.
+        const uint32_t demand = promptDemand(*pos);
+        if ((demand > contextPerSequence()) && (contextClass(demand) > contextPerSequence()) && (activeCount() != 0u))
+        {
+            LOG_DBG("Prompt of session [ %u ] needs [ %u ] tokens, waits for the larger context", pos->sessionId, demand);
+            break;
+        }
+
+        // The adapter is set to the whole context, the prompt of other adapter waits until the running sequences complete.
+        const int32_t adapter = findAdapter(pos->adapter);
+        if (adapter != mAdapter)
+        {
+            if (activeCount() != 0u)
+            {
+                LOG_DBG("Prompt of session [ %u ] waits for the sequences of other LoRA adapter", pos->sessionId);
+                break;
+            }
+
+            applyAdapter(adapter);
+        }
+
+        sSequence* slot = findSlot(pos->conversation);
+        if (slot == nullptr)
+            break;
+
+        sSequence& seq = *slot;
+        if (seq.conversation != pos->conversation)
+        {
+            // The free sequence, restore the state of the idle conversation, if it is stored.
+            seq.conversation= pos->conversation;
+            seq.lastToken   = LLAMA_TOKEN_NULL;
+            seq.nPast       = (seq.conversation != NO_CONVERSATION ? mSessions.restore(mContext, seq.seqId, seq.conversation, seq.lastToken) : 0);
+        }
+
+        // The conversation continues from the tokens of the previous turns.
+        seq.sessionId   = pos->sessionId;
+        seq.nBase       = seq.nPast;
+        seq.stats       = IEAgentEngineListener::sTextStats{ };
+        seq.stats.waitTime = _elapsed(pos->queued);
+        seq.stamp       = Clock::now();
+        const bool tokenized = (pos->tokens.empty() == false);
+        const uint32_t nResumed = ((seq.nBase != 0) && (seq.lastToken != LLAMA_TOKEN_NULL) ? 1u : 0u);
+        if (tokenized && (seq.nBase != 0) && (static_cast<uint32_t>(seq.nBase) + nResumed + static_cast<uint32_t>(pos->tokens.size()) >= contextPerSequence()))
+        {
+            LOG_WARN("Conversation of session [ %u ] exceeds the context [ %u ], starting it from scratch", seq.sessionId, contextPerSequence());
+            llama_memory_seq_rm(llama_get_memory(mContext), seq.seqId, -1, -1);
+            seq.nBase = seq.nPast = 0;
+            seq.lastToken = LLAMA_TOKEN_NULL;
+        }
+
+        // The next turns of conversation have no BOS token. The last token of the previous reply
+        // is not decoded yet if the reply was interrupted by a limit, it is decoded before the prompt.
+        const llama_vocab* vocab = llama_model_get_vocab(mLLMModel);
+        seq.tokens.clear();
+        if ((seq.nBase == 0) && llama_vocab_get_add_bos(vocab))
+        {
+            seq.tokens.push_back(llama_vocab_bos(vocab));
+        }
+        else if ((seq.nBase != 0) && (seq.lastToken != LLAMA_TOKEN_NULL))
+        {
+            seq.tokens.push_back(seq.lastToken);
+        }
+
+        seq.baseToken = (seq.nBase != 0 ? seq.lastToken : LLAMA_TOKEN_NULL);
+
+        seq.tokens.insert(seq.tokens.end(), pos->tokens.begin(), pos->tokens.end());
+        if (tokenized == false)
+        {
+            LOG_ERR("Prompt of session [ %u ] is empty or failed to tokenize", pos->sessionId);
+            pos = mPending.erase(pos);
+            completeSequence(seq, true, false);
+            continue;
+        }
+
+        // The prompt longer than the batch is prefilled in chunks, it must fit only the context.
+        const uint32_t nTokens = static_cast<uint32_t>(seq.tokens.size());
+        if (static_cast<uint32_t>(seq.nBase) + nTokens >= contextPerSequence())
+        {
+            LOG_ERR("Prompt of session [ %u ] has [ %u ] tokens, exceeds context [ %u ]", pos->sessionId, nTokens, contextPerSequence());
+            pos = mPending.erase(pos);
+            completeSequence(seq, true, false);
+            continue;
+        }
+
+        // The cached prefix of the prompt is restored, only the rest is decoded.
+        // The states decoded with the adapter are tagged by the adapter.
+        const uint32_t tag{ static_cast<uint32_t>(mAdapter + 1) };
+        const uint32_t nPrefix = (seq.nBase == 0 ? mPrefixCache.match(seq.tokens, tag) : 0u);
+        seq.nCached = (nPrefix != 0u ? mPrefixCache.restore(mContext, seq.seqId, seq.tokens, tag) : 0u);
+
+        LOG_DBG("Session [ %u ] joins the batch as sequence [ %d ], prompt tokens [ %u ], cached [ %u ], conversation tokens [ %d ]"
+                    , seq.sessionId, seq.seqId, nTokens, seq.nCached, seq.nBase);
+        seq.stats.tokenizeTime  = _elapsed(seq.stamp);
+        seq.stats.promptTokens  = nTokens;
+        seq.stats.cachedTokens  = seq.nCached;
+        seq.stats.contextTokens = static_cast<uint32_t>(seq.nBase);
+        seq.stamp       = Clock::now();
+        seq.sampler     = createSampler();
+        seq.nPast       = seq.nBase + static_cast<llama_pos>(seq.nCached);
+        seq.nPrefill    = seq.nCached;
+        seq.nGenerated  = 0u;
+        seq.tokenLimit  = tokenBudget();
+        seq.response.clear();
+        seq.response.reserve(mTextLimit);
+        seq.sentence.clear();
+        seq.speculation = SpeculateNone;
+        if ((mDraftLimit != 0u) && pos->lookup)
+        {
+            // The prompt lookup searches the tokens of the prompt and of the reply.
+            seq.speculation = SpeculateLookup;
+            seq.history     = seq.tokens;
+            seq.history.reserve(seq.tokens.size() + seq.tokenLimit);
+        }
+        else if ((mDraftLimit != 0u) && mDraft.isReady())
+        {
+            // The draft model decodes the whole prompt, it has no prefix cache.
+            seq.speculation = SpeculateDraft;
+            mDraft.startSequence(seq.seqId, seq.tokens);
+        }
+
+        ++ result;
+        pos = mPending.erase(pos);
+    }
+
+    return result;
+}
+
+uint32_t AgentEngine::prefillPrompts(uint32_t batchUsed)
+{
+    uint32_t result{ 0u };
+    for (sSequence& seq : mSlots)
+    {
+        if (batchUsed >= mCtxKey.batchSize)
+            break;
+
+        if ((seq.sessionId == INVALID_SESSION) || seq.tokens.empty())
+            continue;
+
+        // The next chunk of the prompt, the logits are required only for the last token of the prompt.
+        const uint32_t nTokens  = static_cast<uint32_t>(seq.tokens.size());
+        const uint32_t nChunk   = std::min(nTokens - seq.nPrefill, mCtxKey.batchSize - batchUsed);
+        if (nChunk == 0u)
+            continue;
+
+        seq.nStart = seq.nPast;
+        for (uint32_t i = 0u; i < nChunk; ++ i, ++ seq.nPrefill)
+        {
+            _batchAdd(mBatch, seq.tokens[seq.nPrefill], seq.nPast ++, seq.seqId, seq.nPrefill + 1u == nTokens);
+        }
+
+        seq.iBatch = mBatch.n_tokens - 1;
+        batchUsed += nChunk;
+        result    += nChunk;
+    }
+
+    return result;
+}
+
+AgentEngine::sSequence* AgentEngine::findSlot(uint64_t conversation)
+{
+    sSequence* freeSlot{ nullptr };
+    sSequence* idleSlot{ nullptr };
+    for (sSequence& seq : mSlots)
+    {
+        if (seq.sessionId != INVALID_SESSION)
+            continue;
+
+        if ((conversation != NO_CONVERSATION) && (seq.conversation == conversation))
+        {
+            return &seq;
+        }
+        else if (seq.conversation == NO_CONVERSATION)
+        {
+            freeSlot = (freeSlot == nullptr ? &seq : freeSlot);
+        }
+        else if ((idleSlot == nullptr) || (seq.lastUse < idleSlot->lastUse))
+        {
+            idleSlot = &seq;
+        }
+    }
+
+    if ((freeSlot == nullptr) && (idleSlot != nullptr))
+    {
+        parkConversation(*idleSlot);
+        freeSlot = idleSlot;
+    }
+
+    return freeSlot;
+}
+
+bool AgentEngine::isDecoding(uint64_t conversation) const
+{
+    return std::any_of(mSlots.begin(), mSlots.end(), [conversation](const sSequence& seq) { return (seq.sessionId != INVALID_SESSION) && (seq.conversation == conversation); });
+}
+
+void AgentEngine::parkConversation(sSequence& seq)
+{
+    if ((mContext != nullptr) && (seq.conversation != NO_CONVERSATION))
+    {
+        LOG_DBG("Moving idle conversation of sequence [ %d ] with [ %d ] tokens to the store", seq.seqId, seq.nPast);
+        mSessions.save(mContext, seq.seqId, seq.conversation, seq.nPast, seq.lastToken);
+        llama_memory_seq_rm(llama_get_memory(mContext), seq.seqId, -1, -1);
+    }
+
+    seq.conversation= NO_CONVERSATION;
+    seq.nPast       = 0;
+    seq.lastUse     = 0u;
+    seq.lastToken   = LLAMA_TOKEN_NULL;
+}
+
+void AgentEngine::dropConversations(void)
+{
+    for (sSequence& seq : mSlots)
+    {
+        seq.conversation = NO_CONVERSATION;
+        seq.lastToken    = LLAMA_TOKEN_NULL;
+    }
+
+    mSessions.clear();
+}
+
+void AgentEngine::cachePrompt(const sSequence& seq)
+{
+    // Nothing new to cache if the whole prompt, except the last token, was restored.
+    // The turns of the conversation do not start at the beginning of the sequence.
+    if ((seq.nBase == 0) && (seq.nCached + 1u < static_cast<uint32_t>(seq.tokens.size())))
+    {
+        mPrefixCache.store(mContext, seq.seqId, seq.tokens, static_cast<uint32_t>(mAdapter + 1));
+    }
+}
+
+bool AgentEngine::appendPiece(sSequence& seq, const char* piece, int length) const
+{
+    constexpr std::string_view space{" "};
+
+    seq.sentence.append(piece, length);
+    const char ch{ seq.sentence.isEmpty() ? '\0' : seq.sentence.getData().back()};
+    if ((ch == '.') || (ch == '!') || (ch == '?'))
+    {
+        seq.sentence.trimAll();
+        LOG_INFO("Appending sentence: [ %s ]", seq.sentence.getString());
+        seq.response += seq.sentence;
+        if (mTemperature == 0.0f)
+        {
+            // On greedy mode, flush per sentence
+            LOG_WARN("Greedy mode - flushing per sentence.");
+            seq.sentence.clear();
+            return false;
+        }
+        else if (seq.response.getLength() >= mTextLimit)
+        {
+            LOG_WARN("Maximum character limit reached, interrupting text processing.");
+            seq.sentence.clear();
+            return false;
+        }
+
+        seq.response += space;
+        seq.sentence.clear();
+    }
+    else if (seq.sentence.getLength() >= SENTENCE_LENGTH)
+    {
+        seq.sentence.trimAll();
+        LOG_INFO("Appending sentence: [ %s ]", seq.sentence.getString());
+        seq.response += seq.sentence;
+        seq.response += space;
+        seq.sentence.clear();
+    }
+
+    return true;
+}
+
+void AgentEngine::proposeDrafts(void)
+{
+    mProposals.clear();
+    if (mDraftLimit == 0u)
+        return;
+
+    // The proposed tokens of all sequences must leave the room in the batch for the joining prompts.
+    const uint32_t perSequence  = (mCtxKey.sequences != 0u ? mCtxKey.batchSize / (2u * mCtxKey.sequences) : 0u);
+    const uint32_t maxDrafts    = std::min(mDraftLimit, perSequence > 1u ? perSequence - 1u : 0u);
+    for (sSequence& seq : mSlots)
+    {
+        seq.drafts.clear();
+        if ((seq.sessionId == INVALID_SESSION) || (seq.speculation == SpeculateNone) || (seq.tokens.empty() == false))
+            continue;
+
+        // The last token and the proposed tokens must fit the context and the token limit.
+        const uint32_t nPast    = static_cast<uint32_t>(seq.nPast);
+        const uint32_t room     = (nPast + 2u < contextPerSequence() ? contextPerSequence() - nPast - 2u : 0u);
+        const uint32_t left     = (seq.nGenerated + 1u < seq.tokenLimit ? seq.tokenLimit - seq.nGenerated - 1u : 0u);
+        const uint32_t limit    = std::min(maxDrafts, std::min(room, left));
+        if (seq.speculation == SpeculateLookup)
+        {
+            AgentLookup::propose(seq.history, limit, seq.drafts);
+        }
+        else if ((limit != 0u) && mDraft.isReady())
+        {
+            mProposals.push_back(AgentDraft::sProposal{ seq.seqId, limit });
+        }
+    }
+
+    if (mProposals.empty())
+        return;
+
+    mDraft.propose(mProposals);
+    for (AgentDraft::sProposal& proposal : mProposals)
+    {
+        mSlots[static_cast<uint32_t>(proposal.seqId)].drafts = std::move(proposal.tokens);
+    }
+}
+
+bool AgentEngine::sampleNext(sSequence& seq)
+{
+    // The last token and the proposed tokens are decoded. Every sampled token matching the proposed
+    // token is accepted, the first mismatch is the token of the target model. This keeps the
+    // sampling distribution of the target model, the proposals only save the decoding steps.
+    const uint32_t nDrafts = static_cast<uint32_t>(seq.drafts.size());
+    seq.nPast -= static_cast<llama_pos>(nDrafts);
+    uint32_t accepted{ 0u };
+    bool result{ true };
+    for (uint32_t i = 0u; ; ++ i)
+    {
+        const llama_token token = llama_sampler_sample(seq.sampler, mContext, seq.iBatch + static_cast<int32_t>(i));
+        result = appendToken(seq, token);
+        if ((result == false) || (i == nDrafts) || (token != seq.drafts[i]))
+            break;
+
+        // The KV state of the accepted token is valid.
+        ++ accepted;
+        ++ seq.nPast;
+    }
+
+    if (nDrafts != 0u)
+    {
+        if (accepted < nDrafts)
+        {
+            llama_memory_seq_rm(llama_get_memory(mContext), seq.seqId, seq.nPast, -1);
+        }
+
+        seq.stats.draftTokens   += nDrafts;
+        seq.stats.acceptedTokens+= accepted;
+        seq.drafts.clear();
+    }
+
+    if (result && (seq.speculation == SpeculateDraft))
+    {
+        mDraft.accept(seq.seqId, accepted, seq.lastToken);
+    }
+
+    return result;
+}
+
+bool AgentEngine::appendToken(sSequence& seq, llama_token token)
+{
+    const llama_vocab* vocab = llama_model_get_vocab(mLLMModel);
+    if (llama_vocab_is_eog(vocab, token))
+    {
+        seq.sentence.trimAll();
+        LOG_INFO("Adding last piece [ %s ]", seq.sentence.getString());
+        seq.response += seq.sentence;
+        LOG_DBG("End of generation token reached, interrupting text processing of session [ %u ].", seq.sessionId);
+        // The previous token is decoded, nothing is left to decode in the next turn.
+        seq.lastToken = LLAMA_TOKEN_NULL;
+        return false;
+    }
+
+    char buf[PIECE_LENGTH];
+    int n = llama_token_to_piece(vocab, token, buf, sizeof(buf), 0, true);
+    if (n <= 0)
+    {
+        LOG_ERR("Failed to convert token to piece, token %d, ret value [ %d ]", token, n);
+        seq.lastToken = LLAMA_TOKEN_NULL;
+        return false;
+    }
+
+    seq.lastToken = token;
+    if (seq.speculation == SpeculateLookup)
+    {
+        seq.history.push_back(token);
+    }
+
+    mListener.onTextFragment(seq.sessionId, String(buf, n));
+    if (appendPiece(seq, buf, n) == false)
+        return false;
+
+    if ((++ seq.nGenerated >= seq.tokenLimit) || (static_cast<uint32_t>(seq.nPast) + 1u >= contextPerSequence()))
+    {
+        LOG_WARN("Token limit of session [ %u ] reached, interrupting text processing.", seq.sessionId);
+        return false;
+    }
+
+    return true;
+}
+
+void AgentEngine::completeSequence(sSequence& seq, bool retain, bool completed)
+{
+    LOG_SCOPE(multiedge_aiagent_AgentEngine_completeSequence);
+    LOG_DBG("Completed session [ %u ], sequence [ %d ], generated [ %u ] tokens", seq.sessionId, seq.seqId, seq.nGenerated);
+
+    const uint32_t sessionId = seq.sessionId;
+    // The reply is moved to the shared text, the sequence is reset below.
+    const SharedText reply(NEAgentText::makeText(std::move(seq.response)));
+    IEAgentEngineListener::sTextStats stats{ seq.stats };
+    stats.generatedTokens = seq.nGenerated;
+    stats.completed = completed;
+    stats.decodeTime = (stats.prefillTime != 0u ? _elapsed(seq.stamp) : 0u);
+
+    if (seq.sampler != nullptr)
+    {
+        llama_sampler_free(seq.sampler);
+    }
+
+    if (seq.speculation == SpeculateDraft)
+    {
+        mDraft.stopSequence(seq.seqId);
+    }
+
+    // The KV state of the conversation remains in the sequence for the next turn.
+    const bool keep = retain && (seq.conversation != NO_CONVERSATION) && (mContext != nullptr);
+    if ((keep == false) && (mContext != nullptr) && (seq.seqId >= 0))
+    {
+        // Clean the KV cache of the sequence to avoid topic mixing.
+        llama_memory_seq_rm(llama_get_memory(mContext), seq.seqId, -1, -1);
+    }
+
+    const llama_seq_id seqId        = seq.seqId;
+    const uint64_t     conversation = seq.conversation;
+    const llama_pos    nPast        = seq.nPast;
+    const llama_token  lastToken    = seq.lastToken;
+    seq = sSequence{ };
+    seq.seqId = seqId;
+    if (keep)
+    {
+        // The reply interrupted by a limit ends with the sampled token, which is not in the KV state.
+        // It is kept with the conversation and decoded with the next turn, so the KV state matches the reply.
+        seq.conversation= conversation;
+        seq.nPast       = nPast;
+        seq.lastToken   = lastToken;
+        seq.lastUse     = ++ mUseStamp;
+    }
+
+    mListener.onTextReplied(sessionId, reply, stats);
+}
+
+void AgentEngine::completeAll(void)
+{
+    for (sSequence& seq : mSlots)
+    {
+        if (seq.sessionId != INVALID_SESSION)
+        {
+            seq.response += seq.sentence;
+            completeSequence(seq, true, false);
+        }
+    }
+
+    while (mPending.empty() == false)
+    {
+        const uint32_t sessionId = mPending.front().sessionId;
+        IEAgentEngineListener::sTextStats stats;
+        stats.waitTime = _elapsed(mPending.front().queued);
+        mPending.pop_front();
+        mListener.onTextReplied(sessionId, NEAgentText::emptyText(), stats);
+    }
+}
+
+uint32_t AgentEngine::activeCount(void) const
+{
+    return static_cast<uint32_t>(std::count_if(mSlots.begin(), mSlots.end(), [](const sSequence& seq) { return (seq.sessionId != INVALID_SESSION); }));
+}
+
+bool AgentEngine::_abortCallback(void* data)
+{
+    return static_cast<const AgentEngine*>(data)->mAbort.load();
+}
@@ -0,0 +1,631 @@
+﻿#ifndef MULTIEDGE_AIAGENT_AGENTENGINE_HPP
+#define MULTIEDGE_AIAGENT_AGENTENGINE_HPP
+/************************************************************************
+ * This file is part of the Areg Edge AI project powered by AREG SDK.
+ * The project contains multiple examples of using Edge AI based on Areg communication framework.
+ *
+ *  Areg Edge AI is available as free and open-source software under the MIT License.
+ *
+ *  For detailed licensing terms, please refer to the LICENSE file included
+ *  with this distribution or contact us at info[at]areg.tech.
+ *
+ *  \copyright   © 2025 Aregtech UG. All rights reserved.
+ *  \file        multiedge/aiagent/agentengine.hpp
+ *  \ingroup     Areg Edge AI, AI Multi Edge Device Agent
+ *  \author      Artak Avetyan
+ *  \brief       Edge AI Agent continuous batching LLM inference engine.
+ *
+ ************************************************************************/
+
+/************************************************************************
+ * Includes
+ ************************************************************************/
+
+#include "areg/base/GEGlobal.h"
+#include "areg/base/String.hpp"
+#include "multiedge/aiagent/agentcontextpool.hpp"
+#include "multiedge/aiagent/agentdraft.hpp"
+#include "multiedge/aiagent/agentlookup.hpp"
+#include "multiedge/aiagent/agentprefixcache.hpp"
+#include "multiedge/aiagent/agentsessionstore.hpp"
+#include "multiedge/aiagent/agenttext.hpp"
+#include "multiedge/aiagent/agenttokenizer.hpp"
+#include "llama.h"
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////
+// IEAgentEngineListener interface declaration
+//////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief   The listener of the agent engine, which receives the results
+ *          of processed prompts. The callbacks are triggered in the
+ *          thread, which runs the decoding steps of the engine.
+ **/
+class IEAgentEngineListener
+{
+public:
+    //!< The statistics of the processed prompt, reported with the reply. The times are in microseconds.
+    struct sTextStats
+    {
+        uint32_t    promptTokens    { 0u }; //!< The number of tokens of the prompt.
+        uint32_t    cachedTokens    { 0u }; //!< The number of tokens of the prompt restored from the prefix cache.
+        uint32_t    contextTokens   { 0u }; //!< The number of tokens of the previous turns of the conversation.
+        uint32_t    generatedTokens { 0u }; //!< The number of generated tokens.
+        uint64_t    waitTime        { 0u }; //!< The time the prompt waited for the sequence slot.
+        uint64_t    tokenizeTime    { 0u }; //!< The time to tokenize the prompt.
+        uint64_t    prefillTime     { 0u }; //!< The time to decode the prompt and sample the first token.
+        uint64_t    decodeTime      { 0u }; //!< The time to generate the rest of the reply.
+        uint32_t    draftTokens     { 0u }; //!< The number of tokens proposed by the draft model or by the prompt lookup.
+        uint32_t    acceptedTokens  { 0u }; //!< The number of proposed tokens accepted by the target model.
+        bool        completed       { false };//!< Flag, indicating that the reply is generated until the end or the limit. False if canceled or failed.
+    };
+
+protected:
+    IEAgentEngineListener(void) = default;
+    virtual ~IEAgentEngineListener(void) = default;
+
+public:
+    /**
+     * \brief   Triggered when the next piece of the reply is generated.
+     *          The pieces are reported in the order of generation.
+     * \param   sessionId   The ID of the session set when the prompt was queued.
+     * \param   fragment    The generated piece of the text.
+     **/
+    virtual void onTextFragment(uint32_t sessionId, const String& fragment) = 0;
+
+    /**
+     * \brief   Triggered when the generation of the reply is completed.
+     * \param   sessionId   The ID of the session set when the prompt was queued.
+     * \param   reply       The text generated by the LLM. Empty if failed. The listener can keep the shared text.
+     * \param   stats       The statistics of processing the prompt.
+     **/
+    virtual void onTextReplied(uint32_t sessionId, const SharedText& reply, const IEAgentEngineListener::sTextStats& stats) = 0;
+
+    /**
+     * \brief   Triggered when the engine switched to the model passed to switchModel().
+     *          The prompts queued after the switch are decoded with the new model.
+     * \param   modelPath   The path of the activated model file.
+     **/
+    virtual void onModelSwitched(const String& modelPath) = 0;
+};
+
+//////////////////////////////////////////////////////////////////////////
+// AgentEngine class declaration
+//////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief   The LLM inference engine with continuous batching. Several queued
+ *          prompts are decoded at once, each as a separate sequence of a single
+ *          llama_batch. The finished sequences leave the batch and the pending
+ *          prompts join it between the decoding steps, so that the throughput
+ *          grows with the number of concurrently served edge devices.
+ *          The prompts longer than the batch are prefilled in chunks,
+ *          together with the generated tokens of the other sequences.
+ *          The size of the context is chosen from the size classes by the
+ *          tokens of the prompts and the token budget of the replies, the
+ *          larger classes are used only if their KV cache fits the budget.
+ *          If the draft model is loaded or the prompt lookup is enabled,
+ *          each decoding sequence verifies the proposed tokens in the same
+ *          batch and may generate several tokens per decoding step.
+ *          The LoRA adapters of the model are applied per prompt. The adapter
+ *          is set to the whole context, so that the prompts of other adapters
+ *          wait until the running sequences complete.
+ *          The engine is not thread safe, all methods must be called
+ *          from the same thread.
+ **/
+class AgentEngine
+{
+//////////////////////////////////////////////////////////////////////////
+// Internal types and constants
+//////////////////////////////////////////////////////////////////////////
+public:
+    static constexpr uint32_t   MAX_SEQUENCES   { 8u };             //!< The maximum number of parallel decoded sequences.
+    static constexpr uint32_t   MIN_SEQUENCES   { 1u };             //!< The minimum number of parallel decoded sequences.
+    static constexpr uint32_t   DEF_SEQUENCES   { 4u };             //!< The default number of parallel decoded sequences.
+    static constexpr uint32_t   INVALID_SESSION { 0xFFFFFFFFu };    //!< Invalid session ID, marks free sequence slot.
+    static constexpr uint64_t   NO_CONVERSATION { 0u };             //!< The key of the stateless prompt, which has no conversation.
+    static constexpr uint32_t   MIN_CONTEXT     { 512u };           //!< The smallest size class of the context per sequence in tokens.
+    static constexpr uint32_t   BASE_CONTEXT    { 4096u };          //!< The largest size class of the context per sequence used without the memory check.
+    static constexpr uint32_t   MAX_CONTEXT     { 65536u };         //!< The largest size class of the context per sequence in tokens.
+    static constexpr uint32_t   SHRINK_DRAINS   { 4u };             //!< The number of drains of the batch needing the smaller class before the context shrinks.
+    static constexpr int32_t    NO_ADAPTER      { -1 };             //!< The index of the adapter, which decodes the prompt by the model without LoRA adapter.
+
+    //!< The source of the proposed tokens of the speculative decoding.
+    enum eSpeculation : uint8_t
+    {
+          SpeculateNone     //!< The sequence is decoded one token per step.
+        , SpeculateDraft    //!< The draft model proposes the tokens.
+        , SpeculateLookup   //!< The tokens are looked up in the prompt and in the reply.
+    };
+
+private:
+    using Clock         = std::chrono::steady_clock;
+
+    //!< The prompt waiting for a free sequence slot.
+    struct sPendingPrompt
+    {
+        uint32_t            sessionId   { INVALID_SESSION };
+        uint64_t            conversation{ NO_CONVERSATION };
+        SharedText          prompt      { };        //!< The text of the prompt shared with the sender.
+        String              adapter     { };        //!< The name of the LoRA adapter to decode the prompt, empty if none.
+        Clock::time_point   queued      { };
+        bool                lookup      { false };  //!< Flag, indicating that the prompt lookup proposes the tokens.
+        std::vector<llama_token> tokens { };        //!< The tokens of the prompt without BOS, empty until tokenized, tokenized by the engine if not set on queue.
+    };
+
+    //!< The state of a decoded sequence.
+    struct sSequence
+    {
+        uint32_t                    sessionId   { INVALID_SESSION };//!< The session ID, invalid if the slot is free.
+        uint64_t                    conversation{ NO_CONVERSATION };//!< The conversation, which KV state the sequence holds.
+        uint64_t                    lastUse     { 0u };             //!< The stamp of the last use of the conversation.
+        llama_pos                   nBase       { 0 };              //!< The number of conversation tokens before the prompt.
+        llama_token                 baseToken   { LLAMA_TOKEN_NULL };//!< The last token of the previous reply decoded with the prompt, LLAMA_TOKEN_NULL if none.
+        llama_seq_id                seqId       { -1 };             //!< The sequence ID within the batch.
+        llama_sampler*              sampler     { nullptr };        //!< The sampler chain of the sequence.
+        std::vector<llama_token>    tokens      { };                //!< The tokens of the prompt to prefill.
+        uint32_t                    nCached     { 0u };             //!< The number of prompt tokens restored from the prefix cache.
+        uint32_t                    nPrefill    { 0u };             //!< The number of prompt tokens in the KV cache, the prompt is prefilled in chunks.
+        llama_token                 lastToken   { LLAMA_TOKEN_NULL };//!< The last sampled token to decode. In the idle conversation, the last token of the reply not decoded yet.
+        llama_pos                   nPast       { 0 };              //!< The number of tokens in the KV cache of the sequence.
+        llama_pos                   nStart      { 0 };              //!< The number of tokens in the KV cache before the current batch.
+        int32_t                     iBatch      { -1 };             //!< The index of the last token in the current batch, -1 if none.
+        eSpeculation                speculation { SpeculateNone };  //!< The source of the proposed tokens.
+        std::vector<llama_token>    drafts      { };                //!< The proposed tokens to verify in the current batch.
+        std::vector<llama_token>    history     { };                //!< The tokens of the prompt and of the reply to look up.
+        uint32_t                    nGenerated  { 0u };             //!< The number of generated tokens.
+        uint32_t                    tokenLimit  { 0u };             //!< The maximum number of tokens to generate.
+        String                      response    { };                //!< The accumulated reply.
+        String                      sentence    { };                //!< The currently generated sentence.
+        Clock::time_point           stamp       { };                //!< The start time of the current processing phase.
+        IEAgentEngineListener::sTextStats stats { };                //!< The statistics of processing the prompt.
+    };
+
+    //!< The LoRA adapter loaded for the model.
+    struct sAdapter
+    {
+        String              name        { };        //!< The name of the adapter to set in the prompt.
+        llama_adapter_lora* adapter     { nullptr };//!< The loaded adapter.
+    };
+
+    using ListPending   = std::deque<sPendingPrompt>;
+    using ListSequences = std::vector<sSequence>;
+    using ListAdapters  = std::vector<sAdapter>;
+
+//////////////////////////////////////////////////////////////////////////
+// Constructor / Destructor
+//////////////////////////////////////////////////////////////////////////
+public:
+    explicit AgentEngine(IEAgentEngineListener& listener);
+    ~AgentEngine(void);
+
+//////////////////////////////////////////////////////////////////////////
+// Attributes and operations
+//////////////////////////////////////////////////////////////////////////
+public:
+
+    /**
+     * \brief   Loads the LLM model from the file. The previously loaded model is released
+     *          and all prompts in progress are completed with the text generated so far.
+     * \param   modelPath   The absolute path to the GGUF model file.
+     * \return  Returns true if model is loaded.
+     **/
+    bool loadModel(const String& modelPath);
+
+    /**
+     * \brief   Loads the LLM model from the file with the parameters of the engine. Does not
+     *          access the engine and can be called in any thread, so that the next model is
+     *          loaded while the engine decodes the prompts with the active model.
+     * \param   modelPath   The absolute path to the GGUF model file.
+     * \param   cancel      The flag to cancel the loading, checked while loading. Can be nullptr.
+     * \return  Returns the loaded model or nullptr if failed or canceled. The caller owns the model.
+     **/
+    static llama_model* openModel(const String& modelPath, const std::atomic_bool* cancel = nullptr);
+
+    /**
+     * \brief   Switches to the model loaded by openModel() between the requests. The prompts in
+     *          progress complete with the active model, the queued prompts wait for the switch.
+     *          Once no sequence is decoded, the new model is activated, the active model is
+     *          released and the listener is notified. If the previous model is waiting for
+     *          the switch, it is replaced.
+     * \param   model       The loaded model. The engine takes the ownership.
+     * \param   modelPath   The path of the model file to report to the listener.
+     **/
+    void switchModel(llama_model* model, const String& modelPath);
+
+    /**
+     * \brief   Installs the model loaded by openModel() without notifying the listener. Used by the
+     *          engines of the resident models, which are created for the model and never switch it.
+     *          The prompts queued before are decoded with the installed model.
+     * \param   model       The loaded model. The engine takes the ownership.
+     **/
+    void attachModel(llama_model* model);
+
+    /**
+     * \brief   Releases the model, the context and completes all prompts in progress.
+     **/
+    void freeModel(void);
+
+    /**
+     * \brief   Returns true if the model is loaded.
+     **/
+    inline bool isModelLoaded(void) const;
+
+    /**
+     * \brief   Returns the size of the weights of the loaded model in bytes, zero if no model is loaded.
+     **/
+    inline uint64_t getModelSize(void) const;
+
+    /**
+     * \brief   Loads the LoRA adapter of the active model. The adapters are released when the model
+     *          is switched or released. The adapter with the same name is loaded once.
+     * \param   name        The name of the adapter to set in the queued prompts.
+     * \param   adapterPath The absolute path to the GGUF adapter file.
+     * \return  Returns true if the adapter is loaded.
+     **/
+    bool loadAdapter(const String& name, const String& adapterPath);
+
+    /**
+     * \brief   Returns the number of loaded LoRA adapters of the active model.
+     **/
+    inline uint32_t getAdapterCount(void) const;
+
+    /**
+     * \brief   Loads the draft model of the speculative decoding. The draft must share the vocabulary
+     *          of the target model. The sequences started after loading are speculated.
+     * \param   modelPath   The absolute path to the GGUF model file. Empty to release the draft model.
+     * \return  Returns true if the draft model is loaded.
+     **/
+    bool loadDraft(const String& modelPath);
+
+    /**
+     * \brief   Releases the draft model, the running sequences continue without speculation.
+     **/
+    void freeDraft(void);
+
+    /**
+     * \brief   Returns true if the draft model is loaded.
+     **/
+    inline bool isDraftLoaded(void) const;
+
+    /**
+     * \brief   Sets the maximum number of tokens proposed by the draft model or by the prompt lookup per decoding step.
+     * \param   tokens  The number of draft tokens. Zero disables the speculation.
+     **/
+    void setDraftLimit(uint32_t tokens);
+
+    /**
+     * \brief   Enables or disables the prompt lookup of the speculative decoding for the queued prompts.
+     *          The prompts with the lookup do not use the draft model.
+     * \param   enable  The flag to enable the prompt lookup.
+     **/
+    inline void setPromptLookup(bool enable);
+
+    /**
+     * \brief   Returns true if the prompt lookup is enabled for the queued prompts.
+     **/
+    inline bool isPromptLookup(void) const;
+
+    /**
+     * \brief   Sets the limits of processing. If the limits differ from the current,
+     *          the pool of contexts is rebuilt as soon as no sequence is decoded.
+     * \param   textLimit   The maximum length of generated text in characters.
+     * \param   tokenLimit  The maximum number of tokens to generate per reply.
+     * \param   batching    The maximum number of tokens to submit per decoding step.
+     * \param   threads     The number of threads to use for decoding.
+     * \param   sequences   The maximum number of parallel decoded sequences.
+     **/
+    void setLimits(uint32_t textLimit, uint32_t tokenLimit, uint32_t batching, uint32_t threads, uint32_t sequences);
+
+    /**
+     * \brief   Sets the memory budget of the KV cache of the context. The size classes
+     *          larger than BASE_CONTEXT are used only if their KV cache fits the budget.
+     *          The idle contexts of other size classes are pooled within the same budget.
+     * \param   budget  The maximum size in bytes of the KV cache of the large contexts.
+     **/
+    void setContextBudget(uint64_t budget);
+
+    /**
+     * \brief   Returns the estimated size in bytes of the KV cache of the context of the active model.
+     * \param   ctxSize     The total size of the context in tokens.
+     **/
+    uint64_t estimateMemory(uint32_t ctxSize) const;
+
+    /**
+     * \brief   Returns the size class of the context per sequence in use.
+     **/
+    inline uint32_t getContextSize(void) const;
+
+    /**
+     * \brief   Sets the data types of the KV cache and the mode of the flash attention. The quantized
+     *          KV cache takes less memory, so that more contexts or larger contexts fit the RAM.
+     *          The quantized values require the flash attention, they are not quantized if it is off.
+     *          The stored KV states of other data types are dropped when the context is rebuilt.
+     * \param   typeK       The data type of the keys.
+     * \param   typeV       The data type of the values.
+     * \param   flashAttn   The mode of the flash attention.
+     **/
+    void setKvCache(AgentContextPool::eCacheType typeK, AgentContextPool::eCacheType typeV, AgentContextPool::eFlashAttention flashAttn);
+
+    /**
+     * \brief   Sets the memory budget of the prompt prefix cache.
+     * \param   budget  The maximum size in bytes of the cached KV states. Zero disables the cache.
+     **/
+    void setCacheBudget(uint64_t budget);
+
+    /**
+     * \brief   Sets the sampling parameters applied to the newly started sequences.
+     * \param   temperature The sampling temperature. Zero sets the greedy sampling.
+     * \param   probability The min-p sampling probability.
+     **/
+    void setSampling(float temperature, float probability);
+
+    /**
+     * \brief   Sets the limits of the store of idle conversations.
+     * \param   budget      The maximum size in bytes of the KV states of idle conversations kept in memory.
+     * \param   diskBudget  The maximum size in bytes of the KV states written to the directory.
+     * \param   directory   The directory to write the evicted states. Empty to drop them.
+     **/
+    void setSessionLimits(uint64_t budget, uint64_t diskBudget, const String& directory);
+
+    /**
+     * \brief   Queues the prompt to process. The prompt joins the batch on the next decoding step,
+     *          if there is a free sequence slot.
+     * \param   sessionId       The ID of the session to pass back when the reply is generated.
+     * \param   conversation    The key of the conversation to continue or NO_CONVERSATION if stateless.
+     *                          The conversation continued with other adapter is separate, it has its own KV state.
+     * \param   adapter         The name of the LoRA adapter to decode the prompt. Empty to decode without adapter.
+     * \param   prompt          The text of the prompt to process, the engine keeps the shared text until the prompt is tokenized.
+     * \param   tokens          The tokens of the prompt without BOS, tokenized by the vocabulary of the model
+     *                          of the engine. Empty to tokenize the prompt by the engine.
+     **/
+    void queuePrompt(uint32_t sessionId, uint64_t conversation, const String& adapter, const SharedText& prompt, std::vector<llama_token>&& tokens = std::vector<llama_token>());
+
+    /**
+     * \brief   Cancels the prompt of the session. The pending prompt is removed from the queue,
+     *          the decoded sequence is completed with the text generated so far.
+     *          In both cases the listener receives the reply.
+     * \param   sessionId   The ID of the session set when the prompt was queued.
+     * \return  Returns true if the prompt is found and canceled.
+     **/
+    bool cancelPrompt(uint32_t sessionId);
+
+    /**
+     * \brief   Sets or resets the flag to abort the running decoding step. The flag can be set from any thread.
+     *          The aborted step completes all sequences in the batch, therefore the flag should be set
+     *          only if all decoded sequences are canceled.
+     * \param   abort   The flag to set.
+     **/
+    inline void abortDecode(bool abort);
+
+    /**
+     * \brief   Returns the key of the conversation of the edge device.
+     * \param   agentId         The ID of the edge device.
+     * \param   conversationId  The ID of the conversation set by the edge device. Zero if stateless.
+     **/
+    static inline uint64_t makeConversation(uint32_t agentId, uint32_t conversationId);
+
+    /**
+     * \brief   Runs single decoding step: admits the pending prompts into free slots,
+     *          decodes one token of every active sequence together with the next
+     *          chunks of the prompts to prefill, samples the next tokens and completes
+     *          the finished sequences.
+     * \return  Returns true if there are active or pending sequences and the next step is required.
+     **/
+    bool decodeStep(void);
+
+    /**
+     * \brief   Returns true if there are active or pending sequences to process.
+     **/
+    bool hasWork(void) const;
+
+//////////////////////////////////////////////////////////////////////////
+// Hidden methods
+//////////////////////////////////////////////////////////////////////////
+private:
+
+    //!< Acquires decoding context from the pool and creates the batch, if they do not exist.
+    bool createContext(void);
+
+    //!< Returns decoding context back to the pool.
+    void releaseContext(void);
+
+    //!< Returns the key of the context with current limits.
+    AgentContextPool::sContextKey contextKey(void) const;
+
+    //!< Activates the model instead of the current one, the stored KV states and the contexts of the current model are released.
+    //!< There should be no sequence in progress.
+    void installModel(llama_model* model);
+
+    //!< Activates the model waiting for the switch and notifies the listener.
+    void switchPending(void);
+
+    //!< Releases the LoRA adapters of the active model. No sequence should be in progress.
+    void freeAdapters(void);
+
+    //!< Returns the index of the loaded adapter or NO_ADAPTER if the name is empty or not found.
+    int32_t findAdapter(const String& name) const;
+
+    //!< Sets the adapter to the context instead of the current one. No sequence should be in progress.
+    void applyAdapter(int32_t adapter);
+
+    //!< Returns the size of the context per sequence.
+    inline uint32_t contextPerSequence(void) const;
+
+    //!< Returns the maximum number of tokens to generate per reply with the current sampling.
+    uint32_t tokenBudget(void) const;
+
+    //!< Returns the smallest size class of the context per sequence for the number of tokens.
+    //!< The class does not exceed the trained context of the model and the memory budget.
+    uint32_t contextClass(uint32_t tokens) const;
+
+    //!< Tokenizes the pending prompt, if it is not tokenized yet, and returns the number of tokens
+    //!< the sequence needs for the prompt, the reply and the previous turns of the conversation.
+    uint32_t promptDemand(sPendingPrompt& pending);
+
+    //!< Returns the size class of the context for the prompts to be admitted next.
+    uint32_t requiredContext(void);
+
+    //!< Creates sampler chain with current sampling parameters.
+    llama_sampler* createSampler(void) const;
+
+    //!< Returns the slot to decode the prompt of the conversation or nullptr if all slots are busy.
+    //!< The idle sequence of the conversation is preferred, then the free sequence, then the least recently used idle conversation.
+    sSequence* findSlot(uint64_t conversation);
+
+    //!< Returns true if a prompt of the conversation is being decoded.
+    bool isDecoding(uint64_t conversation) const;
+
+    //!< Moves the KV state of the idle conversation of the sequence to the store and frees the sequence.
+    void parkConversation(sSequence& seq);
+
+    //!< Drops the KV states of all conversations.
+    void dropConversations(void);
+
+    //!< Moves the pending prompts into free sequence slots. Returns the number of admitted prompts.
+    uint32_t admitPending(void);
+
+    //!< Adds the next chunks of the prompts to prefill within the rest of the batch.
+    //!< Returns the number of tokens added to the batch.
+    uint32_t prefillPrompts(uint32_t batchUsed);
+
+    //!< Saves the KV state of the prefilled prompt of the sequence in the prefix cache.
+    void cachePrompt(const sSequence& seq);
+
+    //!< Appends the converted token piece to the reply. Returns false if generation should stop.
+    bool appendPiece(sSequence& seq, const char* piece, int length) const;
+
+    //!< Proposes the tokens of the speculated sequences by the prompt lookup or by the draft model.
+    void proposeDrafts(void);
+
+    //!< Samples the next token of the sequence and verifies the proposed tokens.
+    //!< Every sampled token is accepted while it matches the proposed token.
+    //!< Returns false if the sequence is finished.
+    bool sampleNext(sSequence& seq);
+
+    //!< Appends the sampled token to the reply of the sequence. Returns false if the sequence is finished.
+    bool appendToken(sSequence& seq, llama_token token);
+
+    //!< Completes the sequence, notifies the listener and releases the slot.
+    //!< If retain is true, the KV state of the conversation remains in the sequence for the next turn.
+    //!< If completed is true, the reply is generated until the end or the limit, otherwise it is canceled or failed.
+    void completeSequence(sSequence& seq, bool retain, bool completed);
+
+    //!< Completes all pending and active sequences.
+    void completeAll(void);
+
+    //!< Returns the number of active sequences.
+    uint32_t activeCount(void) const;
+
+    //!< The abort callback of llama_decode, returns true if the running decoding step should be aborted.
+    static bool _abortCallback(void* data);
+
+//////////////////////////////////////////////////////////////////////////
+// Member variables
+//////////////////////////////////////////////////////////////////////////
+private:
+    IEAgentEngineListener&  mListener;      //!< The listener of processed prompts.
+    llama_model*            mLLMModel;      //!< The loaded LLM model.
+    llama_model*            mNextModel;     //!< The loaded model waiting for the switch, nullptr if none.
+    String                  mNextPath;      //!< The path of the model waiting for the switch.
+    AgentContextPool        mContextPool;   //!< The pool of the persistent contexts.
+    AgentContextPool::sContextKey mCtxKey;  //!< The parameters of the context in use.
+    AgentPrefixCache        mPrefixCache;   //!< The KV states of the processed prompts.
+    AgentSessionStore       mSessions;      //!< The KV states of the idle conversations.
+    AgentDraft              mDraft;         //!< The draft model of the speculative decoding.
+    AgentDraft::ListProposals mProposals;   //!< The proposals of the current decoding step.
+    ListAdapters            mAdapters;      //!< The LoRA adapters of the active model.
+    int32_t                 mAdapter;       //!< The index of the adapter set to the context, NO_ADAPTER if none.
+    uint64_t                mUseStamp;      //!< The stamp of the last use of conversation.
+    llama_context*          mContext;       //!< The decoding context shared by all sequences.
+    llama_batch             mBatch;         //!< The batch of tokens to decode.
+    uint32_t                mBatchSize;     //!< The capacity of the allocated batch.
+
+    uint32_t                mTextLimit;     //!< The text limit in characters.
+    uint32_t                mContextSize;   //!< The size class of the context per sequence in tokens.
+    uint64_t                mContextBudget; //!< The memory budget of the KV cache of the large contexts.
+    uint32_t                mShrinkDrains;  //!< The number of consecutive drains of the batch, which needed the smaller size class.
+    AgentContextPool::eCacheType        mCacheTypeK;    //!< The data type of the keys in the KV cache.
+    AgentContextPool::eCacheType        mCacheTypeV;    //!< The data type of the values in the KV cache.
+    AgentContextPool::eFlashAttention   mFlashAttn;     //!< The mode of the flash attention.
+    uint32_t                mTokenLimit;    //!< The maximum number of tokens to generate.
+    uint32_t                mBatching;      //!< The maximum number of tokens per batch.
+    uint32_t                mThreads;       //!< The number of decoding threads.
+    uint32_t                mSequences;     //!< The number of parallel sequences.
+    float                   mTemperature;   //!< The sampling temperature.
+    float                   mProbability;   //!< The min-p sampling probability.
+    uint32_t                mDraftLimit;    //!< The maximum number of draft tokens per decoding step.
+    bool                    mLookup;        //!< Flag, indicating that the queued prompts use the prompt lookup.
+
+    ListPending             mPending;       //!< The prompts waiting for the free slot.
+    ListSequences           mSlots;         //!< The sequence slots of the created context.
+    std::atomic_bool        mAbort;         //!< The flag to abort the running decoding step.
+
+//////////////////////////////////////////////////////////////////////////
+// Forbidden calls
+//////////////////////////////////////////////////////////////////////////
+private:
+    AgentEngine(void) = delete;
+    DECLARE_NOCOPY_NOMOVE(AgentEngine);
+};
+
+//////////////////////////////////////////////////////////////////////////
+// Inline methods
+//////////////////////////////////////////////////////////////////////////
+
+inline bool AgentEngine::isModelLoaded(void) const
+{
+    return (mLLMModel != nullptr);
+}
+
+inline uint64_t AgentEngine::getModelSize(void) const
+{
+    return (mLLMModel != nullptr ? llama_model_size(mLLMModel) : 0u);
+}
+
+inline uint32_t AgentEngine::getAdapterCount(void) const
+{
+    return static_cast<uint32_t>(mAdapters.size());
+}
+
+inline bool AgentEngine::isDraftLoaded(void) const
+{
+    return mDraft.isLoaded();
+}
+
+inline void AgentEngine::setPromptLookup(bool enable)
+{
+    mLookup = enable;
+}
+
+inline bool AgentEngine::isPromptLookup(void) const
+{
+    return mLookup;
+}
+
+inline void AgentEngine::abortDecode(bool abort)
+{
+    mAbort.store(abort);
+}
+
+inline uint64_t AgentEngine::makeConversation(uint32_t agentId, uint32_t conversationId)
+{
+    return (conversationId != 0u ? ((static_cast<uint64_t>(agentId) << 32) | static_cast<uint64_t>(conversationId)) : NO_CONVERSATION);
+}
+
+inline uint32_t AgentEngine::contextPerSequence(void) const
+{
+    return (mCtxKey.sequences != 0u ? mCtxKey.ctxSize / mCtxKey.sequences : 0u);
+}
+
+inline uint32_t AgentEngine::getContextSize(void) const
+{
+    return mContextSize;
+}
+
+#endif // MULTIEDGE_AIAGENT_AGENTENGINE_HPP
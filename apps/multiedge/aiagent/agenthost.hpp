@@ -0,0 +1,135 @@
+﻿#ifndef MULTIEDGE_AIAGENT_AGENTHOST_HPP
+#define MULTIEDGE_AIAGENT_AGENTHOST_HPP
+/************************************************************************
+ * This file is part of the Areg Edge AI project powered by AREG SDK.
+ * The project contains multiple examples of using Edge AI based on Areg communication framework.
+ *
+ *  Areg Edge AI is available as free and open-source software under the MIT License.
+ *
+ *  For detailed licensing terms, please refer to the LICENSE file included
+ *  with this distribution or contact us at info[at]areg.tech.
+ *
+ *  \copyright   © 2025 Aregtech UG. All rights reserved.
+ *  \file        multiedge/aiagent/agenthost.hpp
+ *  \ingroup     Areg Edge AI, AI Multi Edge Device Agent
+ *  \author      Artak Avetyan
+ *  \brief       The interface of the application hosting the Edge AI Agent service provider.
+ *
+ ************************************************************************/
+
+/************************************************************************
+ * Includes
+ ************************************************************************/
+
+#include "areg/base/GEGlobal.h"
+#include "areg/base/String.hpp"
+#include "multiedge/aiagent/agentcontextpool.hpp"
+#include "multiedge/aiagent/agentscheduler.hpp"
+
+class AgentProvider;
+
+//////////////////////////////////////////////////////////////////////////
+// IEAgentHost interface declaration
+//////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief   The application hosting the Edge AI Agent service provider. The host
+ *          is set as the data of the provider component. It gives the model and
+ *          the settings to start serving with, and is notified when the provider
+ *          starts and stops. The notifications are triggered in the thread of the
+ *          provider component, the host may connect to the provider signals there.
+ **/
+class IEAgentHost
+{
+//////////////////////////////////////////////////////////////////////////
+// Constructor / Destructor
+//////////////////////////////////////////////////////////////////////////
+protected:
+    IEAgentHost(void) = default;
+    virtual ~IEAgentHost(void) = default;
+
+//////////////////////////////////////////////////////////////////////////
+// Overrides
+//////////////////////////////////////////////////////////////////////////
+public:
+
+    //!< Returns the path to the model file to activate on start. Empty if no model is selected.
+    virtual String getActiveModelPath(void) const = 0;
+
+    //!< Returns the path to the draft model of the speculative decoding. Empty if no draft is selected.
+    virtual String getDraftModelPath(void) const = 0;
+
+    //!< Returns the path to the model of the embeddings of the semantic cache. Empty to use the active model.
+    virtual String getEmbedModelPath(void) const = 0;
+
+    //!< Returns the minimum similarity of the prompts in percent to reply from the semantic cache. Zero disables the cache.
+    virtual uint32_t getSimilarity(void) const = 0;
+
+    //!< Returns the sampling temperature.
+    virtual float getTemperature(void) const = 0;
+
+    //!< Returns the min-p sampling probability.
+    virtual float getProbability(void) const = 0;
+
+    //!< Returns true if the prompt lookup proposes the tokens of the speculative decoding.
+    virtual bool getPromptLookup(void) const = 0;
+
+    //!< Returns the maximum length of the text in characters.
+    virtual uint32_t getTextLength(void) const = 0;
+
+    //!< Returns the maximum number of tokens to generate per reply.
+    virtual uint32_t getTokens(void) const = 0;
+
+    //!< Returns the batch size.
+    virtual uint32_t getBatching(void) const = 0;
+
+    //!< Returns the number of threads to decode.
+    virtual uint32_t getThreads(void) const = 0;
+
+    //!< Returns the budget of the prompt prefix cache in megabytes.
+    virtual uint32_t getCacheSize(void) const = 0;
+
+    //!< Returns the budget of the conversation states in megabytes.
+    virtual uint32_t getSessionSize(void) const = 0;
+
+    //!< Returns the budget of the KV cache of the context larger than default in megabytes.
+    virtual uint32_t getContextSize(void) const = 0;
+
+    //!< Returns the memory budget of the loaded models in megabytes.
+    virtual uint32_t getModelsSize(void) const = 0;
+
+    //!< Returns the maximum number of cached replies of the repeated prompts.
+    virtual uint32_t getReplyCache(void) const = 0;
+
+    //!< Returns the data type of the keys in the KV cache.
+    virtual AgentContextPool::eCacheType getCacheTypeK(void) const = 0;
+
+    //!< Returns the data type of the values in the KV cache.
+    virtual AgentContextPool::eCacheType getCacheTypeV(void) const = 0;
+
+    //!< Returns the mode of the flash attention.
+    virtual AgentContextPool::eFlashAttention getFlashAttention(void) const = 0;
+
+    //!< Returns the policy to schedule the queued text prompts.
+    virtual AgentScheduler::ePolicy getSchedulingPolicy(void) const = 0;
+
+    /**
+     * \brief   Triggered when the service provider starts, before the model is activated.
+     * \param   provider    The started service provider.
+     **/
+    virtual void onProviderStarted(AgentProvider& provider) = 0;
+
+    /**
+     * \brief   Triggered when the service provider stops.
+     * \param   provider    The stopped service provider.
+     **/
+    virtual void onProviderStopped(AgentProvider& provider) = 0;
+
+//////////////////////////////////////////////////////////////////////////
+// Forbidden calls
+//////////////////////////////////////////////////////////////////////////
+private:
+    DECLARE_NOCOPY_NOMOVE(IEAgentHost);
+};
+
+#endif // MULTIEDGE_AIAGENT_AGENTHOST_HPP
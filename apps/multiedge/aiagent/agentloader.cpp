@@ -0,0 +1,114 @@
+﻿/************************************************************************
+ * This file is part of the Areg Edge AI project powered by AREG SDK.
+ * The project contains multiple examples of using Edge AI based on Areg communication framework.
+ *
+ *  Areg Edge AI is available as free and open-source software under the MIT License.
+ *
+ *  For detailed licensing terms, please refer to the LICENSE file included
+ *  with this distribution or contact us at info[at]areg.tech.
+ *
+ *  \copyright   © 2025 Aregtech UG. All rights reserved.
+ *  \file        multiedge/aiagent/agentloader.cpp
+ *  \ingroup     Areg Edge AI, AI Multi Edge Device Agent
+ *  \author      Artak Avetyan
+ *  \brief       Edge AI Agent worker thread consumer object to load LLM models.
+ *
+ ************************************************************************/
+#include "multiedge/aiagent/agentloader.hpp"
+#include "multiedge/aiagent/agenttokenizer.hpp"
+#include "multiedge/resources/NEMultiEdgeSettings.hpp"
+#include "areg/component/ComponentThread.hpp"
+#include "areg/component/WorkerThread.hpp"
+#include "areg/logging/GELog.h"
+
+#include <QFileInfo>
+
+DEF_LOG_SCOPE(multiedge_aiagent_AgentLoader_processEvent);
+DEF_LOG_SCOPE(multiedge_aiagent_AgentLoader_loadModel);
+
+AgentLoader::AgentLoader(void)
+    : IEWorkerThreadConsumer(NEMultiEdgeSettings::LOADER_CONSUMER)
+    , IEAgentProcessorEventConsumer( )
+    , mCompThread   (nullptr)
+    , mCancel       (false)
+{
+}
+
+void AgentLoader::registerEventConsumers(WorkerThread& workThread, ComponentThread& masterThread)
+{
+    mCompThread = &masterThread;
+    mCancel.store(false);
+    AgentProcessorEvent::addListener(static_cast<IEAgentProcessorEventConsumer&>(*this), static_cast<DispatcherThread&>(workThread));
+}
+
+void AgentLoader::unregisterEventConsumers(WorkerThread& workThread)
+{
+    mCompThread = nullptr;
+    AgentProcessorEvent::removeListener(static_cast<IEAgentProcessorEventConsumer&>(*this), static_cast<DispatcherThread&>(workThread));
+}
+
+void AgentLoader::processEvent(const AgentProcessorEventData& data)
+{
+    LOG_SCOPE(multiedge_aiagent_AgentLoader_processEvent);
+    if (mCompThread == nullptr)
+        return;
+
+    // The activated model replaces the active one, the resident model is loaded next to it.
+    switch (data.getAction())
+    {
+    case AgentProcessorEventData::ActionActivateModel:
+    {
+        const String& modelPath = data.getPayload<AgentProcessorEventData::ActionActivateModel>().modelPath;
+        LOG_INFO("Loading model [ %s ] in background", modelPath.getString());
+        llama_model* model = loadModel(modelPath);
+        AgentProcessorEvent::sendEvent(AgentProcessorEventData::create<AgentProcessorEventData::ActionModelLoaded>(modelPath, model), static_cast<DispatcherThread&>(*mCompThread));
+    }
+    break;
+
+    case AgentProcessorEventData::ActionLoadResident:
+    {
+        const String& modelPath = data.getPayload<AgentProcessorEventData::ActionLoadResident>().modelPath;
+        LOG_INFO("Loading model [ %s ] in background", modelPath.getString());
+        llama_model* model = loadModel(modelPath);
+        AgentProcessorEvent::sendEvent(AgentProcessorEventData::create<AgentProcessorEventData::ActionResidentLoaded>(modelPath, model), static_cast<DispatcherThread&>(*mCompThread));
+    }
+    break;
+
+    case AgentProcessorEventData::ActionLoadVocab:
+    {
+        // The vocabulary has no weights, it is loaded quickly and is not canceled.
+        const String& modelPath = data.getPayload<AgentProcessorEventData::ActionLoadVocab>().modelPath;
+        LOG_DBG("Loading vocabulary of model [ %s ]", modelPath.getString());
+        llama_model* vocab = AgentTokenizer::openVocab(modelPath);
+        AgentProcessorEvent::sendEvent(AgentProcessorEventData::create<AgentProcessorEventData::ActionVocabLoaded>(modelPath, vocab), static_cast<DispatcherThread&>(*mCompThread));
+    }
+    break;
+
+    default:
+        break;
+    }
+}
+
+llama_model* AgentLoader::loadModel(const String& modelPath)
+{
+    LOG_SCOPE(multiedge_aiagent_AgentLoader_loadModel);
+
+    if (modelPath.isEmpty())
+        return nullptr;
+
+    QFileInfo fi(QString::fromUtf8(modelPath.getString()));
+    if (!fi.exists() || !fi.isFile())
+    {
+        LOG_WARN("Model [ %s ] does not exist", modelPath.getString());
+        return nullptr;
+    }
+
+    const QByteArray path = fi.absoluteFilePath().toUtf8();
+    llama_model* model = AgentEngine::openModel(String(path.constData()), &mCancel);
+    if (model == nullptr)
+    {
+        LOG_ERR("Failed to load model [ %s ]%s", modelPath.getString(), mCancel.load() ? ", the loading is canceled" : "");
+    }
+
+    return model;
+}
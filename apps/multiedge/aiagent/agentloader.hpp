@@ -0,0 +1,111 @@
+﻿#ifndef MULTIEDGE_AIAGENT_AGENTLOADER_HPP
+#define MULTIEDGE_AIAGENT_AGENTLOADER_HPP
+/************************************************************************
+ * This file is part of the Areg Edge AI project powered by AREG SDK.
+ * The project contains multiple examples of using Edge AI based on Areg communication framework.
+ *
+ *  Areg Edge AI is available as free and open-source software under the MIT License.
+ *
+ *  For detailed licensing terms, please refer to the LICENSE file included
+ *  with this distribution or contact us at info[at]areg.tech.
+ *
+ *  \copyright   © 2025 Aregtech UG. All rights reserved.
+ *  \file        multiedge/aiagent/agentloader.hpp
+ *  \ingroup     Areg Edge AI, AI Multi Edge Device Agent
+ *  \author      Artak Avetyan
+ *  \brief       Edge AI Agent worker thread consumer object to load LLM models.
+ *
+ ************************************************************************/
+
+/************************************************************************
+ * Includes
+ ************************************************************************/
+
+#include "areg/base/GEGlobal.h"
+#include "areg/component/IEWorkerThreadConsumer.hpp"
+#include "multiedge/aiagent/agentprocessor.hpp"
+
+#include <atomic>
+
+//////////////////////////////////////////////////////////////////////////
+// AgentLoader class declaration
+//////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief   The consumer of the loader worker thread. Loading the model
+ *          takes seconds, it is loaded in the separate thread, while the
+ *          processor keeps decoding the prompts with the active model.
+ *          The loaded model is sent to the component thread, which passes
+ *          it to the processor to switch the models between the requests.
+ *          The vocabularies to tokenize the prompts in the component thread
+ *          are loaded the same way.
+ **/
+class AgentLoader   : public IEWorkerThreadConsumer
+                    , public IEAgentProcessorEventConsumer
+{
+public:
+    AgentLoader(void);
+    virtual ~AgentLoader(void) = default;
+
+public:
+
+    /**
+     * \brief   Cancels the loading of the model in progress. Can be called from any thread.
+     *          The loading is allowed again when the loader thread is restarted.
+     **/
+    inline void cancelLoad(void);
+
+protected:
+
+/************************************************************************/
+// IEWorkerThreadConsumer overrides
+/************************************************************************/
+
+    /**
+     * \brief   Triggered by Worker Thread when starts running.
+     * \param   workThread      The Worker Thread object to notify startup
+     * \param   masterThread    The component thread, which owns worker thread.
+     **/
+    virtual void registerEventConsumers( WorkerThread & workThread, ComponentThread & masterThread ) override;
+
+    /**
+     * \brief   Triggered by Worker Thread when stops running.
+     * \param   workThread  The Worker Thread object to notify stop
+     **/
+    virtual void unregisterEventConsumers( WorkerThread & workThread ) override;
+
+    /**
+     * \brief   Loads the model requested by the ActionActivateModel or ActionLoadResident event
+     *          and sends it with the ActionModelLoaded or ActionResidentLoaded event to the
+     *          component thread.
+     * \param   data    The data, which was passed as an event.
+     **/
+    virtual void processEvent( const AgentProcessorEventData & data ) override;
+
+private:
+
+    /**
+     * \brief   Loads the LLM model from the file.
+     * \param   modelPath   Filesystem path to the LLM model to load.
+     * \return  Returns the loaded model or nullptr if failed.
+     **/
+    llama_model* loadModel(const String& modelPath);
+
+private:
+    ComponentThread*    mCompThread;    //!< The component thread to send the loaded models.
+    std::atomic_bool    mCancel;        //!< The flag to cancel the loading in progress.
+
+private:
+    DECLARE_NOCOPY_NOMOVE(AgentLoader);
+};
+
+//////////////////////////////////////////////////////////////////////////
+// AgentLoader class inline methods
+//////////////////////////////////////////////////////////////////////////
+
+inline void AgentLoader::cancelLoad(void)
+{
+    mCancel.store(true);
+}
+
+#endif // MULTIEDGE_AIAGENT_AGENTLOADER_HPP
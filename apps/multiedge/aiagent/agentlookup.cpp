@@ -0,0 +1,48 @@
+﻿/************************************************************************
+ * This file is part of the Areg Edge AI project powered by AREG SDK.
+ * The project contains multiple examples of using Edge AI based on Areg communication framework.
+ *
+ *  Areg Edge AI is available as free and open-source software under the MIT License.
+ *
+ *  For detailed licensing terms, please refer to the LICENSE file included
+ *  with this distribution or contact us at info[at]areg.tech.
+ *
+ *  \copyright   © 2025 Aregtech UG. All rights reserved.
+ *  \file        multiedge/aiagent/agentlookup.cpp
+ *  \ingroup     Areg Edge AI, AI Multi Edge Device Agent
+ *  \author      Artak Avetyan
+ *  \brief       Edge AI Agent prompt lookup of the speculative decoding.
+ *
+ ************************************************************************/
+#include "multiedge/aiagent/agentlookup.hpp"
+
+#include <algorithm>
+
+uint32_t AgentLookup::propose(const std::vector<llama_token>& history, uint32_t limit, std::vector<llama_token>& drafts)
+{
+    drafts.clear();
+    const size_t size = history.size();
+    if ((limit == 0u) || (size <= static_cast<size_t>(NGRAM_MIN)))
+        return 0u;
+
+    // The longer n-gram gives the more reliable continuation.
+    const uint32_t longest = static_cast<uint32_t>(std::min(static_cast<size_t>(NGRAM_MAX), size - 1u));
+    for (uint32_t n = longest; n >= NGRAM_MIN; -- n)
+    {
+        const std::vector<llama_token>::const_iterator tail = history.end() - n;
+        // The most recent match is the most relevant, it must be followed by at least one token.
+        for (size_t start = size - n; start -- > 0u; )
+        {
+            const std::vector<llama_token>::const_iterator pos = history.begin() + start;
+            if (std::equal(tail, history.end(), pos))
+            {
+                const size_t from  = start + n;
+                const size_t count = std::min(static_cast<size_t>(limit), size - from);
+                drafts.assign(history.begin() + from, history.begin() + from + count);
+                return static_cast<uint32_t>(count);
+            }
+        }
+    }
+
+    return 0u;
+}
@@ -0,0 +1,75 @@
+﻿#ifndef MULTIEDGE_AIAGENT_AGENTLOOKUP_HPP
+#define MULTIEDGE_AIAGENT_AGENTLOOKUP_HPP
+/************************************************************************
+ * This file is part of the Areg Edge AI project powered by AREG SDK.
+ * The project contains multiple examples of using Edge AI based on Areg communication framework.
+ *
+ *  Areg Edge AI is available as free and open-source software under the MIT License.
+ *
+ *  For detailed licensing terms, please refer to the LICENSE file included
+ *  with this distribution or contact us at info[at]areg.tech.
+ *
+ *  \copyright   © 2025 Aregtech UG. All rights reserved.
+ *  \file        multiedge/aiagent/agentlookup.hpp
+ *  \ingroup     Areg Edge AI, AI Multi Edge Device Agent
+ *  \author      Artak Avetyan
+ *  \brief       Edge AI Agent prompt lookup of the speculative decoding.
+ *
+ ************************************************************************/
+
+/************************************************************************
+ * Includes
+ ************************************************************************/
+
+#include "areg/base/GEGlobal.h"
+#include "llama.h"
+
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////
+// AgentLookup class declaration
+//////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief   The prompt lookup of the speculative decoding without draft model.
+ *          The replies to summarize or rewrite the text often repeat the
+ *          phrases of the prompt. The last tokens of the sequence are searched
+ *          in the prompt and in the reply generated so far, the tokens following
+ *          the found n-gram are proposed for verification by the target model.
+ *          The lookup needs no memory except the tokens of the sequence.
+ **/
+class AgentLookup
+{
+//////////////////////////////////////////////////////////////////////////
+// Internal types and constants
+//////////////////////////////////////////////////////////////////////////
+public:
+    static constexpr uint32_t   NGRAM_MAX   { 4u }; //!< The length of the longest n-gram to search.
+    static constexpr uint32_t   NGRAM_MIN   { 2u }; //!< The length of the shortest n-gram to search.
+
+//////////////////////////////////////////////////////////////////////////
+// Operations
+//////////////////////////////////////////////////////////////////////////
+public:
+
+    /**
+     * \brief   Proposes the tokens continuing the sequence. The longest n-gram ending
+     *          the sequence is searched backwards in the earlier tokens, the tokens
+     *          following the most recent match are proposed.
+     * \param   history The tokens of the prompt and of the generated reply.
+     * \param   limit   The maximum number of tokens to propose.
+     * \param   drafts  On output contains the proposed tokens, empty if nothing matched.
+     * \return  Returns the number of proposed tokens.
+     **/
+    static uint32_t propose(const std::vector<llama_token>& history, uint32_t limit, std::vector<llama_token>& drafts);
+
+//////////////////////////////////////////////////////////////////////////
+// Forbidden calls
+//////////////////////////////////////////////////////////////////////////
+private:
+    AgentLookup(void) = delete;
+    ~AgentLookup(void) = delete;
+    DECLARE_NOCOPY_NOMOVE(AgentLookup);
+};
+
+#endif // MULTIEDGE_AIAGENT_AGENTLOOKUP_HPP
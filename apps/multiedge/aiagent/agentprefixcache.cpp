@@ -0,0 +1,168 @@
+﻿/************************************************************************
+ * This file is part of the Areg Edge AI project powered by AREG SDK.
+ * The project contains multiple examples of using Edge AI based on Areg communication framework.
+ *
+ *  Areg Edge AI is available as free and open-source software under the MIT License.
+ *
+ *  For detailed licensing terms, please refer to the LICENSE file included
+ *  with this distribution or contact us at info[at]areg.tech.
+ *
+ *  \copyright   © 2025 Aregtech UG. All rights reserved.
+ *  \file        multiedge/aiagent/agentprefixcache.cpp
+ *  \ingroup     Areg Edge AI, AI Multi Edge Device Agent
+ *  \author      Artak Avetyan
+ *  \brief       Edge AI Agent cache of the KV states of processed prompts.
+ *
+ ************************************************************************/
+#include "multiedge/aiagent/agentprefixcache.hpp"
+#include "areg/logging/GELog.h"
+
+#include <algorithm>
+
+DEF_LOG_SCOPE(multiedge_aiagent_AgentPrefixCache_restore);
+DEF_LOG_SCOPE(multiedge_aiagent_AgentPrefixCache_store);
+
+AgentPrefixCache::AgentPrefixCache(void)
+    : mEntries  ( )
+    , mBudget   (0u)
+    , mSize     (0u)
+{
+}
+
+void AgentPrefixCache::setBudget(uint64_t budget)
+{
+    mBudget = budget;
+    _evict(mBudget);
+}
+
+uint32_t AgentPrefixCache::match(const std::vector<llama_token>& tokens, uint32_t tag) const
+{
+    uint32_t length{ 0u };
+    _findLongest(tokens, tag, length);
+    return length;
+}
+
+uint32_t AgentPrefixCache::restore(llama_context* ctx, llama_seq_id seqId, const std::vector<llama_token>& tokens, uint32_t tag)
+{
+    uint32_t length{ 0u };
+    ListEntries::const_iterator pos = _findLongest(tokens, tag, length);
+    if (pos == mEntries.end())
+        return 0u;
+
+    LOG_SCOPE(multiedge_aiagent_AgentPrefixCache_restore);
+
+    llama_memory_t mem = llama_get_memory(ctx);
+    if (llama_state_seq_set_data(ctx, pos->state.data(), pos->state.size(), seqId) == 0)
+    {
+        LOG_ERR("Failed to restore the KV state of [ %u ] tokens, removing the entry", static_cast<uint32_t>(pos->tokens.size()));
+        llama_memory_seq_rm(mem, seqId, -1, -1);
+        mSize -= pos->state.size();
+        mEntries.erase(pos);
+        return 0u;
+    }
+
+    // Keep only the common part, the rest of the prompt is decoded.
+    if (llama_memory_seq_rm(mem, seqId, static_cast<llama_pos>(length), -1) == false)
+    {
+        // The memory of the model does not support partial removal.
+        LOG_WARN("Failed to trim the restored KV state to [ %u ] tokens", length);
+        llama_memory_seq_rm(mem, seqId, -1, -1);
+        return 0u;
+    }
+
+    mEntries.splice(mEntries.begin(), mEntries, pos);
+    LOG_DBG("Restored KV state of [ %u ] tokens of the prompt with [ %u ] tokens", length, static_cast<uint32_t>(tokens.size()));
+    return length;
+}
+
+bool AgentPrefixCache::store(llama_context* ctx, llama_seq_id seqId, const std::vector<llama_token>& tokens, uint32_t tag)
+{
+    if ((mBudget == 0u) || (tokens.size() < MIN_PREFIX))
+        return false;
+
+    LOG_SCOPE(multiedge_aiagent_AgentPrefixCache_store);
+
+    const size_t size = llama_state_seq_get_size(ctx, seqId);
+    if ((size == 0u) || (size > mBudget))
+    {
+        LOG_DBG("The KV state of [ %zu ] bytes does not fit the budget of [ %llu ] bytes", size, static_cast<unsigned long long>(mBudget));
+        return false;
+    }
+
+    sPrefixEntry entry;
+    entry.state.resize(size);
+    if (llama_state_seq_get_data(ctx, entry.state.data(), entry.state.size(), seqId) != size)
+    {
+        LOG_ERR("Failed to save KV state of the sequence [ %d ]", seqId);
+        return false;
+    }
+
+    // The entries of the tag, which are prefixes of the prompt, are covered by the new entry.
+    for (ListEntries::iterator pos = mEntries.begin(); pos != mEntries.end(); )
+    {
+        if ((pos->tag == tag) && (_commonPrefix(pos->tokens, tokens) == static_cast<uint32_t>(pos->tokens.size())))
+        {
+            mSize -= pos->state.size();
+            pos = mEntries.erase(pos);
+        }
+        else
+        {
+            ++ pos;
+        }
+    }
+
+    _evict(mBudget - size);
+    entry.tokens = tokens;
+    entry.tag    = tag;
+    mSize += size;
+    mEntries.push_front(std::move(entry));
+    LOG_DBG("Cached KV state of [ %u ] tokens, [ %zu ] bytes, cache size [ %llu ] bytes"
+                , static_cast<uint32_t>(tokens.size()), size, static_cast<unsigned long long>(mSize));
+    return true;
+}
+
+void AgentPrefixCache::clear(void)
+{
+    mEntries.clear();
+    mSize = 0u;
+}
+
+uint32_t AgentPrefixCache::_commonPrefix(const std::vector<llama_token>& lhs, const std::vector<llama_token>& rhs)
+{
+    const size_t count = std::min(lhs.size(), rhs.size());
+    return static_cast<uint32_t>(std::mismatch(lhs.begin(), lhs.begin() + count, rhs.begin()).first - lhs.begin());
+}
+
+AgentPrefixCache::ListEntries::const_iterator AgentPrefixCache::_findLongest(const std::vector<llama_token>& tokens, uint32_t tag, uint32_t& length) const
+{
+    ListEntries::const_iterator result = mEntries.end();
+    length = 0u;
+    if (tokens.size() <= MIN_PREFIX)
+        return result;
+
+    // At least one token should remain to decode and get the logits.
+    const uint32_t maxLength = static_cast<uint32_t>(tokens.size()) - 1u;
+    for (ListEntries::const_iterator pos = mEntries.begin(); pos != mEntries.end(); ++ pos)
+    {
+        if (pos->tag != tag)
+            continue;
+
+        const uint32_t common = std::min(_commonPrefix(pos->tokens, tokens), maxLength);
+        if ((common >= MIN_PREFIX) && (common > length))
+        {
+            length = common;
+            result = pos;
+        }
+    }
+
+    return result;
+}
+
+void AgentPrefixCache::_evict(uint64_t budget)
+{
+    while ((mSize > budget) && (mEntries.empty() == false))
+    {
+        mSize -= mEntries.back().state.size();
+        mEntries.pop_back();
+    }
+}
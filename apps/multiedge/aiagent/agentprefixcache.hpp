@@ -0,0 +1,176 @@
+﻿#ifndef MULTIEDGE_AIAGENT_AGENTPREFIXCACHE_HPP
+#define MULTIEDGE_AIAGENT_AGENTPREFIXCACHE_HPP
+/************************************************************************
+ * This file is part of the Areg Edge AI project powered by AREG SDK.
+ * The project contains multiple examples of using Edge AI based on Areg communication framework.
+ *
+ *  Areg Edge AI is available as free and open-source software under the MIT License.
+ *
+ *  For detailed licensing terms, please refer to the LICENSE file included
+ *  with this distribution or contact us at info[at]areg.tech.
+ *
+ *  \copyright   © 2025 Aregtech UG. All rights reserved.
+ *  \file        multiedge/aiagent/agentprefixcache.hpp
+ *  \ingroup     Areg Edge AI, AI Multi Edge Device Agent
+ *  \author      Artak Avetyan
+ *  \brief       Edge AI Agent cache of the KV states of processed prompts.
+ *
+ ************************************************************************/
+
+/************************************************************************
+ * Includes
+ ************************************************************************/
+
+#include "areg/base/GEGlobal.h"
+#include "llama.h"
+
+#include <list>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////
+// AgentPrefixCache class declaration
+//////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief   The cache of the KV states of processed prompts. The prompts of edge
+ *          devices often start with the same instruction preamble. Instead of
+ *          decoding the preamble again, the sequence restores the KV state of
+ *          the cached prompt with the longest common token prefix and decodes
+ *          only the rest of the prompt. The cache has a memory budget, the least
+ *          recently used states are evicted when the budget is exceeded.
+ *          The states are valid only for the model they are created with,
+ *          the cache must be cleared when the model changes. The states of the
+ *          same tokens decoded with different LoRA adapters differ, they are
+ *          separated by the tag.
+ *          The cache is not thread safe.
+ **/
+class AgentPrefixCache
+{
+//////////////////////////////////////////////////////////////////////////
+// Internal types and constants
+//////////////////////////////////////////////////////////////////////////
+public:
+    static constexpr uint32_t   MIN_PREFIX  { 16u };    //!< The minimum number of tokens of the prefix to cache or restore.
+
+private:
+    //!< The cached KV state of the prompt.
+    struct sPrefixEntry
+    {
+        std::vector<llama_token>    tokens  { };    //!< The tokens of the prompt in the KV state.
+        uint32_t                    tag     { 0u }; //!< The tag of the decoding of the prompt, only the entries of the same tag match.
+        std::vector<uint8_t>        state   { };    //!< The serialized KV state of the sequence.
+    };
+
+    //!< The list of entries, the most recently used is at the front.
+    using ListEntries   = std::list<sPrefixEntry>;
+
+//////////////////////////////////////////////////////////////////////////
+// Constructor / Destructor
+//////////////////////////////////////////////////////////////////////////
+public:
+    AgentPrefixCache(void);
+    ~AgentPrefixCache(void) = default;
+
+//////////////////////////////////////////////////////////////////////////
+// Attributes and operations
+//////////////////////////////////////////////////////////////////////////
+public:
+
+    /**
+     * \brief   Sets the memory budget of the cache. The least recently used states
+     *          are evicted if the cache exceeds the new budget.
+     * \param   budget  The maximum size in bytes of cached states. Zero disables the cache.
+     **/
+    void setBudget(uint64_t budget);
+
+    /**
+     * \brief   Returns the memory budget of the cache in bytes.
+     **/
+    inline uint64_t getBudget(void) const;
+
+    /**
+     * \brief   Returns the size in bytes of all cached states.
+     **/
+    inline uint64_t getSize(void) const;
+
+    /**
+     * \brief   Returns the number of tokens, which KV state can be restored for the prompt.
+     *          At least one token of the prompt is left to decode to get the logits.
+     * \param   tokens  The tokens of the prompt to search the prefix.
+     * \param   tag     The tag of the decoding of the prompt.
+     * \return  Returns the length of the longest cached prefix or zero if none.
+     **/
+    uint32_t match(const std::vector<llama_token>& tokens, uint32_t tag) const;
+
+    /**
+     * \brief   Restores the KV state of the longest cached prefix of the prompt into the sequence.
+     *          The sequence should be empty. On failure the sequence is cleaned and the entry
+     *          is removed from the cache.
+     * \param   ctx     The context to restore the state.
+     * \param   seqId   The ID of the sequence to restore the state.
+     * \param   tokens  The tokens of the prompt.
+     * \param   tag     The tag of the decoding of the prompt.
+     * \return  Returns the number of tokens restored in the sequence. Zero if nothing restored.
+     **/
+    uint32_t restore(llama_context* ctx, llama_seq_id seqId, const std::vector<llama_token>& tokens, uint32_t tag);
+
+    /**
+     * \brief   Saves the KV state of the sequence, which contains exactly the tokens of the prompt.
+     *          The cached states, which are prefixes of the prompt, are replaced.
+     * \param   ctx     The context to save the state.
+     * \param   seqId   The ID of the sequence to save.
+     * \param   tokens  The tokens of the prompt decoded in the sequence.
+     * \param   tag     The tag of the decoding of the prompt.
+     * \return  Returns true if the state is cached.
+     **/
+    bool store(llama_context* ctx, llama_seq_id seqId, const std::vector<llama_token>& tokens, uint32_t tag);
+
+    /**
+     * \brief   Removes all cached states.
+     **/
+    void clear(void);
+
+//////////////////////////////////////////////////////////////////////////
+// Hidden methods
+//////////////////////////////////////////////////////////////////////////
+private:
+
+    //!< Returns the number of common leading tokens of two lists.
+    static uint32_t _commonPrefix(const std::vector<llama_token>& lhs, const std::vector<llama_token>& rhs);
+
+    //!< Returns the entry of the tag with the longest common prefix and sets the length of prefix.
+    ListEntries::const_iterator _findLongest(const std::vector<llama_token>& tokens, uint32_t tag, uint32_t& length) const;
+
+    //!< Evicts the least recently used entries until the cache fits into budget.
+    void _evict(uint64_t budget);
+
+//////////////////////////////////////////////////////////////////////////
+// Member variables
+//////////////////////////////////////////////////////////////////////////
+private:
+    ListEntries mEntries;   //!< The cached states.
+    uint64_t    mBudget;    //!< The memory budget in bytes.
+    uint64_t    mSize;      //!< The size of cached states in bytes.
+
+//////////////////////////////////////////////////////////////////////////
+// Forbidden calls
+//////////////////////////////////////////////////////////////////////////
+private:
+    DECLARE_NOCOPY_NOMOVE(AgentPrefixCache);
+};
+
+//////////////////////////////////////////////////////////////////////////
+// Inline methods
+//////////////////////////////////////////////////////////////////////////
+
+inline uint64_t AgentPrefixCache::getBudget(void) const
+{
+    return mBudget;
+}
+
+inline uint64_t AgentPrefixCache::getSize(void) const
+{
+    return mSize;
+}
+
+#endif // MULTIEDGE_AIAGENT_AGENTPREFIXCACHE_HPP
@@ -20,6 +20,8 @@
 #include "areg/component/ComponentThread.hpp"
 #include "areg/logging/GELog.h"
 
+#include <QCoreApplication>
+#include <QDir>
 #include <QFileInfo>
 #include <algorithm>
 #include <thread>
@@ -30,61 +32,25 @@
 
 AgentProcessorEventData::AgentProcessorEventData(void)
     : mAction   (ActionUnknown)
-    , mData     ()
+    , mPayload  ()
 {
 }
 
-AgentProcessorEventData::AgentProcessorEventData(AgentProcessorEventData::eAction action, const String& modelPath)
+AgentProcessorEventData::AgentProcessorEventData(AgentProcessorEventData::eAction action, std::shared_ptr<Payload>&& payload)
     : mAction   (action)
-    , mData     ()
+    , mPayload  (std::move(payload))
 {
-    mData << modelPath;
-}
-
-AgentProcessorEventData::AgentProcessorEventData(AgentProcessorEventData::eAction action, float temperature, float probability)
-    : mAction   (action)
-    , mData     ()
-{
-    mData << temperature;
-    mData << probability;
-}
-
-AgentProcessorEventData::AgentProcessorEventData(AgentProcessorEventData::eAction action, uint32_t sessionId, const String& prompt)
-    : mAction   (action)
-    , mData     ()
-{
-    mData << sessionId;
-    mData << prompt;
-}
-
-AgentProcessorEventData::AgentProcessorEventData(AgentProcessorEventData::eAction action, uint32_t sessionId, const String& prompt, const SharedBuffer& video)
-    : mAction   (action)
-    , mData     ()
-{
-    mData << sessionId;
-    mData << prompt;
-    mData << video;
-}
-
-AgentProcessorEventData::AgentProcessorEventData(AgentProcessorEventData::eAction action, uint32_t maxText, uint32_t maxTokens, uint32_t maxBatch, uint32_t maxThreads)
-    : mAction   (action)
-    , mData     ()
-{
-    mData << maxText;
-    mData << maxTokens;
-    mData << maxBatch;
-    mData << maxThreads;
 }
 
 AgentProcessorEventData::AgentProcessorEventData(const AgentProcessorEventData& data)
     : mAction   (data.mAction)
-    , mData     (data.mData)
+    , mPayload  (data.mPayload)
 {
 }
 
 AgentProcessorEventData::AgentProcessorEventData(AgentProcessorEventData&& data) noexcept
     : mAction   (data.mAction)
-    , mData     (std::move(data.mData))
+    , mPayload  (std::move(data.mPayload))
 {
 }
 
@@ -93,7 +59,7 @@ AgentProcessorEventData& AgentProcessorEventData::operator = (const AgentProcess
     if (this != &data)
     {
         mAction = data.mAction;
-        mData   = data.mData;
+        mPayload= data.mPayload;
     }
 
     return (*this);
@@ -104,7 +70,7 @@ AgentProcessorEventData& AgentProcessorEventData::operator = (AgentProcessorEven
     if (this != &data)
     {
         mAction = data.mAction;
-        mData   = std::move(data.mData);
+        mPayload= std::move(data.mPayload);
     }
 
     return (*this);
@@ -115,7 +81,14 @@ AgentProcessorEventData& AgentProcessorEventData::operator = (AgentProcessorEven
 //////////////////////////////////////////////////////////////////////////
 DEF_LOG_SCOPE(multiedge_aiagent_AgentProcessor_processEvent);
 DEF_LOG_SCOPE(multiedge_aiagent_AgentProcessor_processText);
-DEF_LOG_SCOPE(multiedge_aiagent_AgentProcessor_activateModel);
+DEF_LOG_SCOPE(multiedge_aiagent_AgentProcessor_routeText);
+DEF_LOG_SCOPE(multiedge_aiagent_AgentProcessor_residentLoaded);
+DEF_LOG_SCOPE(multiedge_aiagent_AgentProcessor_loadAdapters);
+DEF_LOG_SCOPE(multiedge_aiagent_AgentProcessor_decodeStep);
+DEF_LOG_SCOPE(multiedge_aiagent_AgentProcessor_activateDraft);
+DEF_LOG_SCOPE(multiedge_aiagent_AgentProcessor_searchSimilar);
+DEF_LOG_SCOPE(multiedge_aiagent_AgentProcessor_activateEmbedder);
+DEF_LOG_SCOPE(multiedge_aiagent_AgentProcessor_computeEmbeddings);
 
 uint32_t AgentProcessor::optThreadCount(void)
 {
@@ -132,28 +105,57 @@ uint32_t AgentProcessor::defThreadCount(void)
 AgentProcessor::AgentProcessor(void)
     : IEWorkerThreadConsumer(NEMultiEdgeSettings::CONSUMER_NAME)
     , IEAgentProcessorEventConsumer( )
+    , IEAgentEngineListener ( )
     , mCompThread           (nullptr)
-    , mSessionId            (0xFFFFFFFF)
-    , mModelParams          (llama_model_default_params())
+    , mWorkerThread         (nullptr)
+    , mModelPath            ( )
+    , mDraftPath            ( )
     , mTextLimit            (DEF_CHARS)
     , mTokenLimit           (DEF_TOKENS)
     , mBatching             (DEF_BATCHING)
     , mThreads              (AgentProcessor::defThreadCount())
+    , mCacheSize            (DEF_CACHE_MB)
+    , mSessionSize          (DEF_SESSION_MB)
+    , mContextSize          (DEF_CONTEXT_MB)
+    , mModelsSize           (DEF_MODELS_MB)
+    , mCacheTypeK           (AgentContextPool::CacheF16)
+    , mCacheTypeV           (AgentContextPool::CacheF16)
+    , mFlashAttn            (AgentContextPool::FlashAuto)
+    // The KV states of idle conversations exceeding the memory budget are kept in the temporary directory.
+    // The files are named by the keys of the conversations, every process of the agent has its own directory.
+    , mSessionDir           (QDir(QDir::tempPath()).filePath(QString("areg-edgeai-sessions/%1").arg(QCoreApplication::applicationPid())).toUtf8().constData())
     , mTemperature          (DEF_TEMPERATURE)
     , mProbability          (DEF_PROBABILITY)
-    , mLLMModel             (nullptr)
+    , mLookup               (false)
+    , mEmbedPath            ( )
+    , mSimilarity           (AgentSemanticCache::DEF_SIMILARITY)
+    , mEngine               (static_cast<IEAgentEngineListener &>(self()))
+    , mEmbedder             ( )
+    , mSemanticCache        ( )
+    , mRoutedModels         ( )
+    , mSimilarPrompts       ( )
+    , mSimilarRequests      ( )
+    , mEmbedRequests        ( )
+    , mEmbedUsed            (false)
+    , mResidents            ( )
+    , mUseStamp             (0u)
+    , mStepQueued           (false)
 {
+    configureEngine(mEngine, mSessionDir);
 }
 
 void AgentProcessor::registerEventConsumers(WorkerThread& workThread, ComponentThread& masterThread)
 {
-    mCompThread = &masterThread;
+    mCompThread     = &masterThread;
+    mWorkerThread   = &workThread;
+    mStepQueued     = false;
     AgentProcessorEvent::addListener(static_cast<IEAgentProcessorEventConsumer&>(*this), static_cast<DispatcherThread &>(workThread));
 }
 
 void AgentProcessor::unregisterEventConsumers(WorkerThread& workThread)
 {
-    mCompThread = nullptr;
+    mCompThread     = nullptr;
+    mWorkerThread   = nullptr;
     AgentProcessorEvent::removeListener(static_cast<IEAgentProcessorEventConsumer&>(*this), static_cast<DispatcherThread&>(workThread));
     freeModel();
 }
@@ -168,53 +170,156 @@ void AgentProcessor::processEvent(const AgentProcessorEventData& data)
     {
     case AgentProcessorEventData::ActionProcessText:
     {
-        const SharedBuffer& evData = data.getData();
-        String prompt;
-        evData >> mSessionId;
-        evData >> prompt;
-        LOG_DBG("Processing prompt [ %s ]", prompt.getString());
-        String response = processText(prompt);
-        AgentProcessorEvent::sendEvent(AgentProcessorEventData(AgentProcessorEventData::ActionReplyText, mSessionId, response), static_cast<DispatcherThread&>(*mCompThread));
+        // The tokens are moved to the engine, the event is empty after the move.
+        AgentProcessorEventData::sPrompt evData{ data.movePayload<AgentProcessorEventData::ActionProcessText>() };
+        ASSERT(evData.prompt != nullptr);
+        LOG_DBG("Processing prompt [ %s ] of [ %u ] tokens by model [ %s ] with adapter [ %s ]", evData.prompt->getString(), static_cast<uint32_t>(evData.tokens.size())
+                    , evData.modelName.isEmpty() ? "active" : evData.modelName.getString(), evData.adapterName.isEmpty() ? "none" : evData.adapterName.getString());
+        processText(evData.sessionId, evData.conversation, evData.modelName, evData.adapterName, evData.prompt, evData.vocabName, std::move(evData.tokens));
+    }
+    break;
+
+    case AgentProcessorEventData::ActionComputeEmbedding:
+    {
+        AgentProcessorEventData::sText evData{ data.movePayload<AgentProcessorEventData::ActionComputeEmbedding>() };
+        // The embedding model is loaded on the first request, the texts received until the next step are batched.
+        mEmbedUsed = true;
+        activateEmbedder();
+        mEmbedRequests.push_back(sEmbedRequest{ evData.sessionId, std::move(evData.text) });
+        triggerDecodeStep();
+    }
+    break;
+
+    case AgentProcessorEventData::ActionDecodeStep:
+    {
+        mStepQueued = false;
+        decodeStep();
+    }
+    break;
+
+    case AgentProcessorEventData::ActionCancelText:
+    {
+        const uint32_t sessionId{ data.getPayload<AgentProcessorEventData::ActionCancelText>().sessionId };
+        // The canceled prompt is replied with the partial text, which is not cached.
+        mSimilarPrompts.erase(sessionId);
+        ListSimilarRequests::iterator pos = std::find_if(mSimilarRequests.begin(), mSimilarRequests.end()
+                                                            , [sessionId](const AgentProcessorEventData::sPrompt& entry) { return (entry.sessionId == sessionId); });
+        if (pos != mSimilarRequests.end())
+        {
+            mSimilarRequests.erase(pos);
+            onTextReplied(sessionId, NEAgentText::emptyText(), IEAgentEngineListener::sTextStats{ });
+        }
+        else if (mEngine.cancelPrompt(sessionId) == false)
+        {
+            for (sResident& entry : mResidents)
+            {
+                if (entry.engine->cancelPrompt(sessionId))
+                    break;
+            }
+        }
+
+        // The aborted step is already completed, continue decoding of new prompts.
+        mEngine.abortDecode(false);
+    }
+    break;
+
+    case AgentProcessorEventData::ActionModelLoaded:
+    {
+        const AgentProcessorEventData::sModel& evData = data.getPayload<AgentProcessorEventData::ActionModelLoaded>();
+        const String& modelPath = evData.modelPath;
+        llama_model* model = evData.model;
+        if (model == nullptr)
+        {
+            LOG_WARN("Failed to load model [ %s ], the model [ %s ] remains active", modelPath.getString(), mModelPath.getString());
+            AgentProcessorEvent::sendEvent(AgentProcessorEventData::create<AgentProcessorEventData::ActionModelFailed>(modelPath), static_cast<DispatcherThread&>(*mCompThread));
+        }
+        else
+        {
+            // The model is switched when the prompts in progress complete, the listener is notified.
+            mEngine.switchModel(model, modelPath);
+            if (mEngine.hasWork())
+            {
+                triggerDecodeStep();
+            }
+        }
+    }
+    break;
+
+    case AgentProcessorEventData::ActionResidentLoaded:
+    {
+        const AgentProcessorEventData::sModel& evData = data.getPayload<AgentProcessorEventData::ActionResidentLoaded>();
+        residentLoaded(evData.modelPath, evData.model);
+    }
+    break;
+
+    case AgentProcessorEventData::ActionActivateDraft:
+    {
+        const String& draftPath = data.getPayload<AgentProcessorEventData::ActionActivateDraft>().modelPath;
+        // The draft model stays loaded when the target model is switched, if the vocabulary matches.
+        if ((draftPath != mDraftPath) || (mEngine.isDraftLoaded() == false))
+        {
+            LOG_INFO("Loading draft model [ %s ]", draftPath.isEmpty() ? "none" : draftPath.getString());
+            mDraftPath = activateDraft(draftPath);
+        }
     }
     break;
 
-    case AgentProcessorEventData::ActionActivateModel:
+    case AgentProcessorEventData::ActionActivateEmbedder:
     {
-        const SharedBuffer& evData = data.getData();
-        String modelPath;
-        evData >> modelPath;
-        LOG_INFO("Loading model [ %s ]", modelPath.getString());
-        mModelPath = activateModel(modelPath);
-        AgentProcessorEvent::sendEvent(AgentProcessorEventData(AgentProcessorEventData::ActionModelActivated, mModelPath), static_cast<DispatcherThread&>(*mCompThread));
+        const AgentProcessorEventData::sEmbedder& evData = data.getPayload<AgentProcessorEventData::ActionActivateEmbedder>();
+        mSimilarity = std::clamp(evData.similarity, AgentSemanticCache::MIN_SIMILARITY, AgentSemanticCache::MAX_SIMILARITY);
+        mEmbedPath  = evData.modelPath;
+        mSemanticCache.setSimilarity(mSimilarity);
+        LOG_INFO("Set semantic cache similarity to [ %u %% ], embedding model [ %s ]", mSimilarity, mEmbedPath.isEmpty() ? "active" : mEmbedPath.getString());
+        activateEmbedder();
     }
     break;
 
     case AgentProcessorEventData::ActionTemperature:
     {
-        const SharedBuffer& evData = data.getData();
-        float temperature = 0.5f;
-        float probability = 0.05f;
-        evData >> temperature;
-        evData >> probability;
-        mTemperature = std::clamp(temperature, MIN_TEMPERATURE, MAX_TEMPERATURE);
-        mProbability = std::clamp(probability, MIN_PROBABILITY, MAX_PROBABILITY);
-        LOG_INFO("Set temperature to [ %.2f ] and probability to [ %.2f ]", mTemperature, mProbability);
+        const AgentProcessorEventData::sSampling& evData = data.getPayload<AgentProcessorEventData::ActionTemperature>();
+        mTemperature = std::clamp(evData.temperature, MIN_TEMPERATURE, MAX_TEMPERATURE);
+        mProbability = std::clamp(evData.probability, MIN_PROBABILITY, MAX_PROBABILITY);
+        mLookup      = evData.lookup;
+        mEngine.setSampling(mTemperature, mProbability);
+        // The prompts queued from now on use the lookup of the profile, the running prompts keep their mode.
+        mEngine.setPromptLookup(mLookup);
+        for (sResident& entry : mResidents)
+        {
+            entry.engine->setSampling(mTemperature, mProbability);
+            entry.engine->setPromptLookup(mLookup);
+        }
+
+        LOG_INFO("Set temperature to [ %.2f ], probability to [ %.2f ] and prompt lookup [ %s ]", mTemperature, mProbability, mLookup ? "on" : "off");
     }
     break;
         
     case AgentProcessorEventData::ActionSetLimits:
     {
-        const SharedBuffer& evData = data.getData();
-        uint32_t maxText    { DEF_CHARS };
-        uint32_t maxToken   { DEF_TOKENS };
-        uint32_t maxBatch   { DEF_BATCHING };
-        uint32_t maxThread  { DEF_THREADS };
-        evData >> maxText >> maxToken >> maxBatch >> maxThread;
-        mTextLimit  = std::clamp(maxText    , MIN_CHARS     , MAX_CHARS);
-        mTokenLimit = std::clamp(maxToken   , MIN_TOKENS    , MAX_TOKENS);
-        mBatching   = std::clamp(maxBatch   , MIN_BATCHING  , MAX_BATCHING);
-        mThreads    = std::clamp(maxThread  , MIN_THREADS   , AgentProcessor::optThreadCount());
-        LOG_INFO("Set limits - Text: [ %u ], Tokens: [ %u ], Batching: [ %u ], Threads: [ %u ]", mTextLimit, mTokenLimit, mBatching, mThreads);
+        const AgentProcessorEventData::sLimits& evData = data.getPayload<AgentProcessorEventData::ActionSetLimits>();
+        mTextLimit  = std::clamp(evData.maxText     , MIN_CHARS     , MAX_CHARS);
+        mTokenLimit = std::clamp(evData.maxTokens   , MIN_TOKENS    , MAX_TOKENS);
+        mBatching   = std::clamp(evData.maxBatch    , MIN_BATCHING  , MAX_BATCHING);
+        mThreads    = std::clamp(evData.maxThreads  , MIN_THREADS   , AgentProcessor::optThreadCount());
+        mCacheSize  = std::clamp(evData.maxCache    , MIN_CACHE_MB  , MAX_CACHE_MB);
+        mSessionSize= std::clamp(evData.maxSessions , MIN_SESSION_MB, MAX_SESSION_MB);
+        mContextSize= std::clamp(evData.maxContext  , MIN_CONTEXT_MB, MAX_CONTEXT_MB);
+        mModelsSize = std::clamp(evData.maxModels   , MIN_MODELS_MB , MAX_MODELS_MB);
+        mCacheTypeK = static_cast<AgentContextPool::eCacheType>(evData.cacheTypeK < AgentContextPool::CacheCount ? evData.cacheTypeK : AgentContextPool::CacheF16);
+        mCacheTypeV = static_cast<AgentContextPool::eCacheType>(evData.cacheTypeV < AgentContextPool::CacheCount ? evData.cacheTypeV : AgentContextPool::CacheF16);
+        mFlashAttn  = static_cast<AgentContextPool::eFlashAttention>(evData.flashAttn < AgentContextPool::FlashCount ? evData.flashAttn : AgentContextPool::FlashAuto);
+        configureEngine(mEngine, mSessionDir);
+        for (sResident& entry : mResidents)
+        {
+            configureEngine(*entry.engine, entry.sessionDir);
+        }
+
+        // The idle models exceeding the reduced budget are released.
+        reserveMemory(0u);
+        LOG_INFO("Set limits - Text: [ %u ], Tokens: [ %u ], Batching: [ %u ], Threads: [ %u ], Cache: [ %u MB ], Sessions: [ %u MB ], Context: [ %u MB ], KV cache: [ %s / %s ], Flash attention: [ %s ], Models: [ %u MB ]"
+                    , mTextLimit, mTokenLimit, mBatching, mThreads, mCacheSize, mSessionSize, mContextSize
+                    , AgentContextPool::getString(mCacheTypeK), AgentContextPool::getString(mCacheTypeV), AgentContextPool::getString(mFlashAttn)
+                    , mModelsSize);
     }
     break;
 
@@ -226,198 +331,464 @@ void AgentProcessor::processEvent(const AgentProcessorEventData& data)
     }
 }
 
-String AgentProcessor::processText(const String& prompt)
+void AgentProcessor::onTextFragment(uint32_t sessionId, const String& fragment)
 {
-    LOG_SCOPE(multiedge_aiagent_AgentProcessor_processText);
+    if (mCompThread != nullptr)
+    {
+        AgentProcessorEvent::sendEvent(AgentProcessorEventData::create<AgentProcessorEventData::ActionReplyFragment>(sessionId, fragment), static_cast<DispatcherThread&>(*mCompThread));
+    }
+}
 
-    String response;
-    if (prompt.isEmpty() || mLLMModel == nullptr)
+void AgentProcessor::onTextReplied(uint32_t sessionId, const SharedText& reply, const IEAgentEngineListener::sTextStats& stats)
+{
+    // The active model may switch while the prompt waits, the name is resolved when replied.
+    String modelName;
+    MapRoutedModels::iterator routed = mRoutedModels.find(sessionId);
+    if (routed != mRoutedModels.end())
     {
-        LOG_ERR("Prompt empty or model not activated");
-        return response;
+        if (stats.completed)
+        {
+            modelName = routed->second.isEmpty() ? String(QFileInfo(QString::fromUtf8(mModelPath.getString())).fileName().toUtf8().constData()) : routed->second;
+        }
+
+        mRoutedModels.erase(routed);
     }
 
-    const llama_vocab* vocab = llama_model_get_vocab(mLLMModel);
+    MapSimilarPrompts::iterator pos = mSimilarPrompts.find(sessionId);
+    if (pos != mSimilarPrompts.end())
+    {
+        // The truncated replies of the canceled or failed prompts are not cached.
+        if (stats.completed && (reply->isEmpty() == false))
+        {
+            mSemanticCache.store(pos->second.profile, pos->second.embedding, reply);
+        }
+
+        mSimilarPrompts.erase(pos);
+    }
 
-    // Create a fresh context per request
-    llama_context_params ctx_params = llama_context_default_params();
-    ctx_params.n_ctx    = mTextLimit;
-    ctx_params.n_batch  = mBatching;
-    ctx_params.n_threads= mThreads;
-    ctx_params.no_perf  = true;
-    llama_context* ctx = llama_init_from_model(mLLMModel, ctx_params);
-    if (ctx == nullptr)
+    if (mCompThread != nullptr)
     {
-        LOG_ERR("Failed to create llama context");
-        return response;
+        AgentProcessorEvent::sendEvent(AgentProcessorEventData::create<AgentProcessorEventData::ActionReplyText>(sessionId, reply, stats, std::move(modelName)), static_cast<DispatcherThread&>(*mCompThread));
     }
+}
 
-    // Sampler chain (correct order)
-    llama_sampler* smpl = llama_sampler_chain_init(llama_sampler_chain_default_params());
-    // Light repetition control (important for agents)
-    llama_sampler*  penalties = llama_sampler_init_penalties( /* repeat_last_n */ 64
-                                                             , /* repeat_penalty */ 1.10f
-                                                             , /* freq_penalty   */ 0.0f
-                                                             , /* present_penalty*/ 0.0f);
-    llama_sampler_chain_add(smpl, penalties );
-    if (mTemperature == 0.0f)
+void AgentProcessor::onModelSwitched(const String& modelPath)
+{
+    LOG_INFO("Switched to model [ %s ]", modelPath.getString());
+    mModelPath = modelPath;
+    // The texts routed to the new active model are decoded by the main engine.
+    const String modelName(QFileInfo(QString::fromUtf8(mModelPath.getString())).fileName().toUtf8().constData());
+    mResidents.erase(std::remove_if(mResidents.begin(), mResidents.end(), [&modelName](const sResident& entry)
+                        { return (entry.name == modelName) && (entry.loading == false) && (entry.engine->hasWork() == false); })
+                    , mResidents.end());
+    // The adapters of the previous model are released with it.
+    loadAdapters(mEngine, mModelPath);
+    // The replies of the previous model are not valid anymore.
+    LOG_INFO("Clearing [ %u ] replies of the semantic cache, hit rate [ %.2f ], average lookup [ %.1f us ]"
+                , mSemanticCache.getSize(), mSemanticCache.getHitRate(), mSemanticCache.getLookupTime());
+    mSemanticCache.clear();
+    mSimilarPrompts.clear();
+    activateEmbedder();
+    if (mCompThread != nullptr)
     {
-        llama_sampler_chain_add(smpl, llama_sampler_init_greedy());
+        AgentProcessorEvent::sendEvent(AgentProcessorEventData::create<AgentProcessorEventData::ActionModelActivated>(mModelPath), static_cast<DispatcherThread&>(*mCompThread));
+    }
+}
+
+void AgentProcessor::processText(uint32_t sessionId, uint64_t conversation, const String& modelName, const String& adapterName, const SharedText& prompt, const String& vocabName, std::vector<llama_token>&& tokens)
+{
+    LOG_SCOPE(multiedge_aiagent_AgentProcessor_processText);
+
+    AgentProcessorEventData::sPrompt request{ sessionId, conversation, modelName, adapterName, prompt, vocabName, std::move(tokens) };
+    // The reply of the conversation depends on the previous turns, only the greedy sampling replies the same text.
+    // The embeddings are computed in batches on the decoding steps, so that the prompts in progress are not blocked.
+    if ((conversation == AgentEngine::NO_CONVERSATION) && (mTemperature <= 0.0f) && mSemanticCache.isEnabled() && mEmbedder.isLoaded())
+    {
+        mSimilarRequests.push_back(std::move(request));
     }
     else
     {
-        // Temperature (low = precise)
-        llama_sampler_chain_add(smpl, llama_sampler_init_temp(mTemperature));
-        // min_p filtering (FIXED: min_keep > 1)
-        llama_sampler_chain_add(smpl, llama_sampler_init_min_p(mProbability, 5));
-        // Final distribution
-        llama_sampler_chain_add(smpl, llama_sampler_init_dist(LLAMA_DEFAULT_SEED));
+        queueText(request);
     }
 
-    // Tokenize prompt
-    const bool add_bos = true;
-    const int n_prompt = -llama_tokenize(vocab, prompt.getString(), prompt.getLength(), nullptr, 0, add_bos, true);
+    triggerDecodeStep();
+}
 
-    if (n_prompt <= 0)
+String AgentProcessor::queueText(AgentProcessorEventData::sPrompt& request)
+{
+    // The tokens of other vocabulary are not valid, the engine tokenizes the prompt again.
+    AgentEngine& engine = routeText(request.modelName);
+    const String routedName((&engine == &mEngine) ? String(QFileInfo(QString::fromUtf8(mModelPath.getString())).fileName().toUtf8().constData()) : request.modelName);
+    if ((request.tokens.empty() == false) && (request.vocabName != routedName))
     {
-        LOG_ERR("Failed to tokenize prompt, returned value %d", n_prompt);
-        llama_sampler_free(smpl);
-        llama_free(ctx);
-        return response;
+        LOG_DBG("Prompt of session [ %u ] is tokenized by model [ %s ], tokenizing by [ %s ]", request.sessionId, request.vocabName.getString(), routedName.getString());
+        request.tokens.clear();
+    }
+
+    // The prompt joins the batch of the model on the next decoding step.
+    // The steps are events, so that new prompts are received between them.
+    engine.queuePrompt(request.sessionId, request.conversation, request.adapterName, request.prompt, std::move(request.tokens));
+    mRoutedModels[request.sessionId] = (&engine == &mEngine) ? String() : request.modelName;
+    return routedName;
+}
+
+uint32_t AgentProcessor::searchSimilar(uint32_t maxTexts)
+{
+    if (mSimilarRequests.empty() || (maxTexts == 0u))
+        return 0u;
+
+    LOG_SCOPE(multiedge_aiagent_AgentProcessor_searchSimilar);
+
+    const uint32_t count{ std::min(maxTexts, static_cast<uint32_t>(mSimilarRequests.size())) };
+    std::vector<String> texts;
+    texts.reserve(count);
+    for (uint32_t i = 0; i < count; ++ i)
+    {
+        texts.push_back(*mSimilarRequests[i].prompt);
+    }
+
+    // The prompts without embedding are decoded, but their replies are not cached.
+    std::vector<std::vector<float>> embeddings;
+    if (mEmbedder.compute(texts, embeddings) == false)
+    {
+        LOG_WARN("Failed to compute the embeddings of some of [ %u ] prompts to search the semantic cache", count);
+    }
+
+    const String activeName(QFileInfo(QString::fromUtf8(mModelPath.getString())).fileName().toUtf8().constData());
+    for (uint32_t i = 0; i < count; ++ i)
+    {
+        AgentProcessorEventData::sPrompt request{ std::move(mSimilarRequests.front()) };
+        mSimilarRequests.pop_front();
+
+        sSimilarPrompt similar;
+        similar.profile.model       = request.modelName.isEmpty() ? activeName : request.modelName;
+        similar.profile.adapter     = request.adapterName;
+        similar.profile.temperature = mTemperature;
+        similar.profile.probability = mProbability;
+        similar.profile.textLimit   = mTextLimit;
+        similar.profile.tokenLimit  = mTokenLimit;
+        similar.embedding           = std::move(embeddings[i]);
+
+        SharedText reply;
+        if ((similar.embedding.empty() == false) && mSemanticCache.find(similar.profile, similar.embedding, reply))
+        {
+            LOG_DBG("Replying session [ %u ] from the semantic cache, hit rate [ %.2f ], average lookup [ %.1f us ]"
+                        , request.sessionId, mSemanticCache.getHitRate(), mSemanticCache.getLookupTime());
+            IEAgentEngineListener::sTextStats stats{ };
+            stats.completed = true;
+            mRoutedModels[request.sessionId] = similar.profile.model;
+            onTextReplied(request.sessionId, reply, stats);
+            continue;
+        }
+
+        // The reply is cached with the model, which processes the prompt, the requested model may be not available.
+        similar.profile.model = queueText(request);
+        if (similar.embedding.empty() == false)
+        {
+            mSimilarPrompts[request.sessionId] = std::move(similar);
+        }
     }
 
-    std::vector<llama_token> tokens(n_prompt);
-    if (llama_tokenize(vocab, prompt.getString(), prompt.getLength(), tokens.data(), tokens.size(), add_bos, true) < 0)
+    return count;
+}
+
+void AgentProcessor::activateEmbedder(void)
+{
+    LOG_SCOPE(multiedge_aiagent_AgentProcessor_activateEmbedder);
+
+    if ((mSemanticCache.isEnabled() == false) && (mEmbedUsed == false))
     {
-        LOG_ERR("Tokenization failed");
-        llama_sampler_free(smpl);
-        llama_free(ctx);
-        return response;
+        mEmbedder.freeModel();
+        mSemanticCache.clear();
+        mSimilarPrompts.clear();
+        return;
     }
 
-    // Decode prompt
-    llama_batch batch = llama_batch_get_one(tokens.data(), tokens.size());
-    if (llama_decode(ctx, batch) != 0)
+    const String modelPath(mEmbedPath.isEmpty() ? mModelPath : mEmbedPath);
+    if (modelPath.isEmpty() || (modelPath == mEmbedder.getModelPath()))
+        return;
+
+    // The embeddings of different models are not comparable.
+    mSemanticCache.clear();
+    mSimilarPrompts.clear();
+    if (mEmbedder.loadModel(modelPath, mThreads) == false)
     {
-        LOG_ERR("Failed to decode prompt");
-        llama_sampler_free(smpl);
-        llama_free(ctx);
-        return response;
+        LOG_WARN("Failed to load embedding model [ %s ], the semantic cache is not used", modelPath.getString());
     }
+}
 
-    // Generation loop
-    response.reserve(mTextLimit);
-    char buf[DEF_CHARS];
-    String sentence;
-    sentence.reserve(DEF_CHARS);
-    constexpr std::string_view space{" "};
+AgentEngine& AgentProcessor::routeText(const String& modelName)
+{
+    LOG_SCOPE(multiedge_aiagent_AgentProcessor_routeText);
+
+    const QString activeName(QFileInfo(QString::fromUtf8(mModelPath.getString())).fileName());
+    if (modelName.isEmpty() || (activeName == QString::fromUtf8(modelName.getString())))
+        return mEngine;
 
-    const uint32_t tokenLimit = (mTemperature <= 0.2f) ? MIN_TOKENS : mTokenLimit;
-    for (uint32_t i = 0; i < tokenLimit; ++i)
+    ListResidents::iterator pos = std::find_if(mResidents.begin(), mResidents.end(), [&modelName](const sResident& entry) { return (entry.name == modelName); });
+    if (pos == mResidents.end())
     {
-        llama_token token = llama_sampler_sample(smpl, ctx, -1);
+        const String modelPath(residentPath(modelName));
+        if (modelPath.isEmpty())
+        {
+            LOG_WARN("Model [ %s ] is not available, the text is processed by the active model", modelName.getString());
+            return mEngine;
+        }
 
-        if (llama_vocab_is_eog(vocab, token))
+        // The size of the file estimates the size of the model until it is loaded.
+        const uint64_t size = static_cast<uint64_t>(QFileInfo(QString::fromUtf8(modelPath.getString())).size());
+        if (reserveMemory(size) == false)
         {
-            sentence.trimAll();
-            LOG_INFO("Adding last piece [ %s ]", sentence.getString());
-            response += sentence;
-            LOG_DBG("End of generation token reached, interrupting text processing.");
-            break;
+            LOG_WARN("Model [ %s ] of [ %llu ] MB does not fit the budget of [ %u ] MB, the text is processed by the active model"
+                        , modelName.getString(), static_cast<unsigned long long>(size / BYTES_IN_MB), mModelsSize);
+            return mEngine;
         }
 
-        int n = llama_token_to_piece(vocab, token, buf, sizeof(buf), 0, true);
-        if (n <= 0)
+        sResident entry;
+        entry.name      = modelName;
+        entry.path      = modelPath;
+        // The conversations of the models are stored separately, the keys of the conversations are the same.
+        entry.sessionDir= QDir(QString::fromUtf8(mSessionDir.getString())).filePath(QString::fromUtf8(modelName.getString())).toUtf8().constData();
+        entry.engine    = std::make_unique<AgentEngine>(static_cast<IEAgentEngineListener&>(self()));
+        entry.size      = size;
+        entry.loading   = true;
+        configureEngine(*entry.engine, entry.sessionDir);
+        mResidents.push_back(std::move(entry));
+        pos = mResidents.end() - 1;
+
+        LOG_INFO("Loading model [ %s ] to process the routed texts", modelPath.getString());
+        AgentProcessorEvent::sendEvent(AgentProcessorEventData::create<AgentProcessorEventData::ActionLoadResident>(modelPath), static_cast<DispatcherThread&>(*mCompThread));
+    }
+
+    pos->lastUse = ++ mUseStamp;
+    return *(pos->engine);
+}
+
+void AgentProcessor::residentLoaded(const String& modelPath, llama_model* model)
+{
+    LOG_SCOPE(multiedge_aiagent_AgentProcessor_residentLoaded);
+
+    ListResidents::iterator pos = std::find_if(mResidents.begin(), mResidents.end(), [&modelPath](const sResident& entry) { return entry.loading && (entry.path == modelPath); });
+    if (pos == mResidents.end())
+    {
+        LOG_WARN("Model [ %s ] is not waited anymore, releasing it", modelPath.getString());
+        if (model != nullptr)
         {
-            LOG_ERR("Failed to convert token to piece, token %d, ret value [ %d ]", token, n);
-            break;
+            llama_model_free(model);
         }
 
-        sentence.append(buf, n);
-        const char ch{ sentence.isEmpty() ? '\0' : sentence.getData().back()};
-        if ((ch == '.') || (ch == '!') || (ch == '?'))
+        return;
+    }
+
+    if (model == nullptr)
+    {
+        // The engine without model replies the waiting texts not completed when it is released, the provider reports the failure.
+        LOG_WARN("Failed to load model [ %s ], the routed texts are not processed", modelPath.getString());
+        mResidents.erase(pos);
+        return;
+    }
+
+    sResident& entry = *pos;
+    entry.engine->attachModel(model);
+    loadAdapters(*entry.engine, entry.path);
+    entry.size      = entry.engine->getModelSize();
+    entry.loading   = false;
+    LOG_INFO("Model [ %s ] of [ %llu ] MB is resident, [ %u ] models are loaded"
+                , entry.name.getString(), static_cast<unsigned long long>(entry.size / BYTES_IN_MB), static_cast<uint32_t>(mResidents.size()) + 1u);
+
+    if (entry.engine->hasWork())
+    {
+        triggerDecodeStep();
+    }
+}
+
+bool AgentProcessor::reserveMemory(uint64_t size)
+{
+    const uint64_t budget = static_cast<uint64_t>(mModelsSize) * BYTES_IN_MB;
+    uint64_t used = mEngine.getModelSize();
+    for (const sResident& entry : mResidents)
+    {
+        used += entry.size;
+    }
+
+    while (used + size > budget)
+    {
+        // The models decoding the texts or loading are not evicted.
+        ListResidents::iterator lru = mResidents.end();
+        for (ListResidents::iterator pos = mResidents.begin(); pos != mResidents.end(); ++ pos)
         {
-            sentence.trimAll();
-            LOG_INFO("Appending sentence: [ %s ]", sentence.getString());
-            response += sentence;
-            if (mTemperature == 0.0f)
+            if ((pos->loading == false) && (pos->engine->hasWork() == false) && ((lru == mResidents.end()) || (pos->lastUse < lru->lastUse)))
             {
-                // On greedy mode, flush per sentence
-                LOG_WARN("Greedy mode - flushing per sentence.");
-                break;
+                lru = pos;
             }
-            else if (response.getLength() >= mTextLimit)
-            {
-                LOG_WARN("Maximum character limit reached, interrupting text processing.");
-                break;
-            }
-            
-            response += space;
-            sentence.clear();
-            sentence.reserve(DEF_CHARS);
         }
-        else if (sentence.getLength() >= 300)
+
+        if (lru == mResidents.end())
+            return false;
+
+        LOG_INFO("Evicting the least recently used model [ %s ] of [ %llu ] MB", lru->name.getString(), static_cast<unsigned long long>(lru->size / BYTES_IN_MB));
+        used -= lru->size;
+        mResidents.erase(lru);
+    }
+
+    return true;
+}
+
+String AgentProcessor::residentPath(const String& modelName) const
+{
+    if (mModelPath.isEmpty())
+        return String();
+
+    // The name of the model is the name of the file, the paths to other directories are not accepted.
+    const QString name(QString::fromUtf8(modelName.getString()));
+    const QFileInfo active(QString::fromUtf8(mModelPath.getString()));
+    const QFileInfo fi(active.absoluteDir(), name);
+    if ((fi.fileName() != name) || (fi.isFile() == false) || (fi.suffix().compare(QString::fromUtf8("gguf"), Qt::CaseInsensitive) != 0))
+        return String();
+
+    return String(fi.absoluteFilePath().toUtf8().constData());
+}
+
+void AgentProcessor::loadAdapters(AgentEngine& engine, const String& modelPath)
+{
+    LOG_SCOPE(multiedge_aiagent_AgentProcessor_loadAdapters);
+
+    const QFileInfo model(QString::fromUtf8(modelPath.getString()));
+    const QDir dir(model.absoluteDir().filePath(model.completeBaseName() + QString::fromUtf8(NEMultiEdgeSettings::ADAPTER_SUFFIX.data())));
+    if (modelPath.isEmpty() || (dir.exists() == false))
+        return;
+
+    // The adapters are small, they are loaded in the worker thread without the background loader.
+    const QFileInfoList files{ dir.entryInfoList(QStringList{ QString::fromUtf8("*.gguf") }, QDir::Files | QDir::Readable, QDir::Name | QDir::IgnoreCase) };
+    for (const QFileInfo& fi : files)
+    {
+        engine.loadAdapter(String(fi.fileName().toUtf8().constData()), String(fi.absoluteFilePath().toUtf8().constData()));
+    }
+
+    LOG_INFO("Loaded [ %u ] of [ %u ] LoRA adapters of model [ %s ]", engine.getAdapterCount(), static_cast<uint32_t>(files.size()), modelPath.getString());
+}
+
+void AgentProcessor::configureEngine(AgentEngine& engine, const String& sessionDir)
+{
+    engine.setLimits(mTextLimit, mTokenLimit, mBatching, mThreads, AgentEngine::DEF_SEQUENCES);
+    engine.setSampling(mTemperature, mProbability);
+    engine.setPromptLookup(mLookup);
+    engine.setCacheBudget(static_cast<uint64_t>(mCacheSize) * BYTES_IN_MB);
+    engine.setSessionLimits(static_cast<uint64_t>(mSessionSize) * BYTES_IN_MB, static_cast<uint64_t>(DISK_SESSION_MB) * BYTES_IN_MB, sessionDir);
+    engine.setContextBudget(static_cast<uint64_t>(mContextSize) * BYTES_IN_MB);
+    engine.setKvCache(mCacheTypeK, mCacheTypeV, mFlashAttn);
+}
+
+void AgentProcessor::decodeStep(void)
+{
+    LOG_SCOPE(multiedge_aiagent_AgentProcessor_decodeStep);
+
+    // The embeddings are limited per step, so that the batches of the models keep decoding.
+    const uint32_t embedded{ searchSimilar(MAX_EMBED_STEP) };
+    computeEmbeddings(MAX_EMBED_STEP - embedded);
+
+    // Each engine decodes the batch of own model, the steps of the models alternate.
+    bool hasWork{ mEngine.hasWork() && mEngine.decodeStep() };
+    for (sResident& entry : mResidents)
+    {
+        if ((entry.loading == false) && entry.engine->hasWork())
         {
-            sentence.trimAll();
-            LOG_INFO("Appending sentence: [ %s ]", sentence.getString());
-            response += sentence;
-            response += space;
-            sentence.clear();
-            sentence.reserve(DEF_CHARS);
+            hasWork = entry.engine->decodeStep() || hasWork;
         }
+    }
+
+    if (hasWork || (mSimilarRequests.empty() == false) || (mEmbedRequests.empty() == false))
+    {
+        triggerDecodeStep();
+    }
+}
+
+void AgentProcessor::computeEmbeddings(uint32_t maxTexts)
+{
+    if (mEmbedRequests.empty() || (maxTexts == 0u))
+        return;
 
-        batch = llama_batch_get_one(&token, 1);
-        if (llama_decode(ctx, batch) != 0)
+    LOG_SCOPE(multiedge_aiagent_AgentProcessor_computeEmbeddings);
+
+    const uint32_t count{ std::min(maxTexts, static_cast<uint32_t>(mEmbedRequests.size())) };
+    std::vector<String> texts;
+    texts.reserve(count);
+    for (uint32_t i = 0; i < count; ++ i)
+    {
+        texts.push_back(mEmbedRequests[i].text);
+    }
+
+    std::vector<std::vector<float>> embeddings;
+    if (mEmbedder.compute(texts, embeddings) == false)
+    {
+        LOG_WARN("Failed to compute the embeddings of some of [ %u ] texts", static_cast<uint32_t>(texts.size()));
+    }
+
+    LOG_DBG("Computed the embeddings of [ %u ] texts, dimensions [ %u ]", static_cast<uint32_t>(texts.size()), mEmbedder.getDimension());
+    for (uint32_t i = 0; i < count; ++ i)
+    {
+        const std::vector<float>& embedding = embeddings[i];
+        if (mCompThread != nullptr)
         {
-            response += sentence;
-            LOG_ERR("Failed to decode token");
-            break;
+            SharedBuffer vector(reinterpret_cast<const unsigned char*>(embedding.data()), static_cast<unsigned int>(embedding.size() * sizeof(float)));
+            AgentProcessorEvent::sendEvent(AgentProcessorEventData::create<AgentProcessorEventData::ActionReplyEmbedding>(mEmbedRequests[i].sessionId, std::move(vector)), static_cast<DispatcherThread&>(*mCompThread));
         }
     }
 
-    // cleanup
-    llama_sampler_free(smpl);
-    llama_free(ctx);
+    mEmbedRequests.erase(mEmbedRequests.begin(), mEmbedRequests.begin() + count);
+}
 
-    return response;
+void AgentProcessor::triggerDecodeStep(void)
+{
+    if ((mStepQueued == false) && (mWorkerThread != nullptr))
+    {
+        mStepQueued = true;
+        AgentProcessorEvent::sendEvent(AgentProcessorEventData::create<AgentProcessorEventData::ActionDecodeStep>(), static_cast<DispatcherThread&>(*mWorkerThread));
+    }
 }
 
-String AgentProcessor::activateModel(const String& modelPath)
+String AgentProcessor::activateDraft(const String& modelPath)
 {
-    LOG_SCOPE(multiedge_aiagent_AgentProcessor_activateModel);
+    LOG_SCOPE(multiedge_aiagent_AgentProcessor_activateDraft);
 
     if (modelPath.isEmpty())
+    {
+        mEngine.freeDraft();
         return String();
+    }
 
     QFileInfo fi(QString::fromUtf8(modelPath.getString()));
     if (!fi.exists() || !fi.isFile())
-        return String();
-
-    freeModel();
-
-    mModelParams.n_gpu_layers= 99; // safe default, ignored on CPU
-    mModelParams.use_mmap    = true;
-    mModelParams.use_mlock   = true;
-
-    const QByteArray path = fi.absoluteFilePath().toUtf8();
-    mLLMModel = llama_model_load_from_file(path.constData(), mModelParams);
-    if (mLLMModel == nullptr)
     {
-        LOG_ERR("Model load failed");
+        LOG_WARN("Draft model [ %s ] does not exist, the speculation is disabled", modelPath.getString());
+        mEngine.freeDraft();
         return String();
     }
 
-    // Context is NOT created here on purpose
-    // Contexts are per-request to avoid topic mixing
-    LOG_DBG("Model activated: %s", path.constData());
-    return modelPath;
+    const QByteArray path = fi.absoluteFilePath().toUtf8();
+    return (mEngine.loadDraft(String(path.constData())) ? modelPath : String());
 }
 
 void AgentProcessor::freeModel()
 {
-    if (mLLMModel != nullptr)
+    mSimilarPrompts.clear();
+    mSemanticCache.clear();
+    mEmbedRequests.clear();
+    mRoutedModels.clear();
+    // The waiting prompts are replied empty, as the engine replies the prompts in progress.
+    for (const AgentProcessorEventData::sPrompt& request : mSimilarRequests)
     {
-        llama_model_free(mLLMModel);
-        mLLMModel = nullptr;
+        onTextReplied(request.sessionId, NEAgentText::emptyText(), IEAgentEngineListener::sTextStats{ });
     }
+
+    mSimilarRequests.clear();
+    mEmbedder.freeModel();
+    mResidents.clear();
+    mEngine.freeModel();
+    mEngine.freeDraft();
+}
+
+inline AgentProcessor& AgentProcessor::self()
+{
+    return *this;
 }
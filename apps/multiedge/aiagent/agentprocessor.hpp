@@ -25,7 +25,18 @@
 #include "areg/component/IEWorkerThreadConsumer.hpp"
 #include "areg/component/TEEvent.hpp"
 #include "areg/base/SharedBuffer.hpp"
-#include "llama.h"
+#include "multiedge/aiagent/agentembedder.hpp"
+#include "multiedge/aiagent/agentengine.hpp"
+#include "multiedge/aiagent/agentsemanticcache.hpp"
+#include "multiedge/aiagent/agenttext.hpp"
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
 
 class AgentProvider;
 
@@ -33,6 +44,13 @@ class AgentProvider;
 // AgentProcessorEventData event data class declaration
 //////////////////////////////////////////////////////////////////////////
 
+/**
+ * \brief   The event exchanged by the threads of the agent. The threads share one process,
+ *          so the arguments are passed as the typed payload of the action instead of
+ *          serializing them. Every action has one payload type, the event is created
+ *          and the payload is read by the action given at compile time. The dispatcher
+ *          copies the event data, the copies share the payload instead of copying it.
+ **/
 class AgentProcessorEventData
 {
 public:
@@ -40,44 +58,205 @@ public:
     {
           ActionUnknown
         , ActionProcessText
-        , ActionProcessVideo
         , ActionReplyText
-        , ActionReplyVideo
         , ActionActivateModel
         , ActionModelActivated
+        , ActionModelFailed
         , ActionTemperature
         , ActionSetLimits
+        , ActionDecodeStep
+        , ActionReplyFragment
+        , ActionCancelText
+        , ActionSetPolicy
+        , ActionActivateDraft
+        , ActionModelLoaded
+        , ActionLoadResident
+        , ActionResidentLoaded
+        , ActionActivateEmbedder
+        , ActionComputeEmbedding
+        , ActionReplyEmbedding
+        , ActionLoadVocab
+        , ActionVocabLoaded
+    };
+
+    //!< The session of the prompt to cancel.
+    struct sSession
+    {
+        uint32_t                    sessionId   { 0u };     //!< The ID of the session.
+    };
+
+    //!< The model file to load or to activate.
+    struct sModelPath
+    {
+        String                      modelPath   { };        //!< The path of the model file. Empty if none.
+    };
+
+    //!< The model loaded by the loader thread. The event owns the model until it is taken.
+    struct sModel
+    {
+        String                      modelPath   { };        //!< The path of the loaded model file.
+        llama_model*                model       { nullptr };//!< The loaded model or nullptr if failed.
+    };
+
+    //!< The sampling of the replies.
+    struct sSampling
+    {
+        float                       temperature { 0.0f };   //!< The sampling temperature.
+        float                       probability { 0.0f };   //!< The min-p sampling probability.
+        bool                        lookup      { false };  //!< Flag, indicating to speculate by the prompt lookup.
+    };
+
+    //!< The limits and the budgets of the engines.
+    struct sLimits
+    {
+        uint32_t                    maxText     { 0u };     //!< The maximum length of the text.
+        uint32_t                    maxTokens   { 0u };     //!< The maximum number of tokens to generate.
+        uint32_t                    maxBatch    { 0u };     //!< The batch size.
+        uint32_t                    maxThreads  { 0u };     //!< The number of threads.
+        uint32_t                    maxCache    { 0u };     //!< The budget of the prompt prefix cache in megabytes.
+        uint32_t                    maxSessions { 0u };     //!< The budget of the stored conversations in megabytes.
+        uint32_t                    maxContext  { 0u };     //!< The budget of the KV cache of the larger context in megabytes.
+        uint32_t                    cacheTypeK  { 0u };     //!< The data type of the keys of the KV cache.
+        uint32_t                    cacheTypeV  { 0u };     //!< The data type of the values of the KV cache.
+        uint32_t                    flashAttn   { 0u };     //!< The mode of the flash attention.
+        uint32_t                    maxModels   { 0u };     //!< The budget of the resident models in megabytes.
     };
 
+    //!< The scheduling policy of the prompts.
+    struct sPolicy
+    {
+        uint32_t                    policy      { 0u };     //!< The policy, one of AgentScheduler::ePolicy values.
+    };
+
+    //!< The model of the embeddings.
+    struct sEmbedder
+    {
+        uint32_t                    similarity  { 0u };     //!< The minimal similarity of the semantic cache in percent.
+        String                      modelPath   { };        //!< The path of the embedding model. Empty to use the active model.
+    };
+
+    //!< The text of the session, the piece of the reply or the text to compute the embedding.
+    struct sText
+    {
+        uint32_t                    sessionId   { 0u };     //!< The ID of the session.
+        String                      text        { };        //!< The text.
+    };
+
+    //!< The prompt to process.
+    struct sPrompt
+    {
+        uint32_t                    sessionId   { 0u };     //!< The ID of the session to reply.
+        uint64_t                    conversation{ 0u };     //!< The key of the conversation to continue or AgentEngine::NO_CONVERSATION.
+        String                      modelName   { };        //!< The name of the model to process the text. Empty to process by the active model.
+        String                      adapterName { };        //!< The name of the LoRA adapter. Empty to process without adapter.
+        SharedText                  prompt      { };        //!< The text of the prompt, shared with the provider.
+        String                      vocabName   { };        //!< The name of the model, which vocabulary tokenized the prompt. Empty if not tokenized.
+        std::vector<llama_token>    tokens      { };        //!< The tokens of the prompt.
+    };
+
+    //!< The reply of the prompt.
+    struct sReply
+    {
+        uint32_t                    sessionId   { 0u };     //!< The ID of the replied session.
+        SharedText                  reply       { };        //!< The text of the reply, shared with the engine.
+        IEAgentEngineListener::sTextStats stats { };        //!< The statistics of processing the prompt.
+        String                      modelName   { };        //!< The name of the model, which replied. Empty if the reply is not completed.
+    };
+
+    //!< The computed embedding.
+    struct sEmbedding
+    {
+        uint32_t                    sessionId   { 0u };     //!< The ID of the session to reply.
+        SharedBuffer                embedding   { };        //!< The raw floats of the embedding. Empty if failed.
+    };
+
+    //!< The payload of the event, the actions without arguments have no payload.
+    using Payload = std::variant< std::monostate, sSession, sModelPath, sModel, sSampling, sLimits, sPolicy
+                                , sEmbedder, sText, sPrompt, sReply, sEmbedding>;
+
+    //!< The payload type of the action, specialized for every action below the class.
+    template<eAction Action>
+    struct ActionPayload;
+
+    //!< The payload type of the action.
+    template<eAction Action>
+    using PayloadType = typename ActionPayload<Action>::Type;
+
 public:
     AgentProcessorEventData(void);
-    AgentProcessorEventData(AgentProcessorEventData::eAction action, const String& modelPath);
-    AgentProcessorEventData(AgentProcessorEventData::eAction action, float temperature, float probability);
-    AgentProcessorEventData(AgentProcessorEventData::eAction action, uint32_t sessionId, const String& prompt, const SharedBuffer& video);
-    AgentProcessorEventData(AgentProcessorEventData::eAction action, uint32_t sessionId, const String& prompt);
-    AgentProcessorEventData(AgentProcessorEventData::eAction action, uint32_t maxText, uint32_t maxTokens, uint32_t maxBatch, uint32_t maxThreads);
     AgentProcessorEventData(const AgentProcessorEventData& data);
     AgentProcessorEventData(AgentProcessorEventData&& data) noexcept;
     ~AgentProcessorEventData(void) = default;
 
+    /**
+     * \brief   Creates the event of the action, the payload of the action is initialized by the arguments
+     *          in the order of its fields. The arguments not matching the payload fail to compile.
+     * \tparam  Action  The action of the event.
+     * \param   args    The values of the fields of the payload.
+     **/
+    template<eAction Action, typename ... Args>
+    static inline AgentProcessorEventData create(Args && ... args);
+
 public:
     AgentProcessorEventData& operator = (const AgentProcessorEventData& data);
 
     AgentProcessorEventData& operator = (AgentProcessorEventData&& data) noexcept;
 
     inline AgentProcessorEventData::eAction getAction(void) const;
-    
-    inline SharedBuffer & getData(void);
 
-    inline const SharedBuffer& getData(void) const;
+    //!< Returns the payload of the action. The action should be the action of the event.
+    template<eAction Action>
+    inline const PayloadType<Action>& getPayload(void) const;
+
+    /**
+     * \brief   Moves the payload of the action out of the event and empties the shared payload,
+     *          so that a consumer reading the event after the move fails the payload check.
+     *          It is allowed only for the events that have a single consumer, i.e. the events
+     *          sent to the worker thread of AgentProcessor, and the consumer may call it once per event.
+     * \tparam  Action  The action of the event, should be the action of the event.
+     **/
+    template<eAction Action>
+    inline PayloadType<Action> movePayload(void) const;
 
     inline void reset(void);
 
 private:
-    eAction         mAction;
-    SharedBuffer    mData;
+    AgentProcessorEventData(AgentProcessorEventData::eAction action, std::shared_ptr<Payload>&& payload);
+
+private:
+    eAction                     mAction;    //!< The action of the event.
+    std::shared_ptr<Payload>    mPayload;   //!< The payload of the action shared by the copies of the event. Empty if the action has no payload.
 };
 
+//!< Maps the action to the payload type.
+#define AGENT_ACTION_PAYLOAD(Action, Payload)                                                       \
+    template<> struct AgentProcessorEventData::ActionPayload<AgentProcessorEventData::Action>       \
+    {   using Type = Payload;   }
+
+AGENT_ACTION_PAYLOAD(ActionUnknown          , std::monostate);
+AGENT_ACTION_PAYLOAD(ActionProcessText      , AgentProcessorEventData::sPrompt);
+AGENT_ACTION_PAYLOAD(ActionReplyText        , AgentProcessorEventData::sReply);
+AGENT_ACTION_PAYLOAD(ActionActivateModel    , AgentProcessorEventData::sModelPath);
+AGENT_ACTION_PAYLOAD(ActionModelActivated   , AgentProcessorEventData::sModelPath);
+AGENT_ACTION_PAYLOAD(ActionModelFailed      , AgentProcessorEventData::sModelPath);
+AGENT_ACTION_PAYLOAD(ActionTemperature      , AgentProcessorEventData::sSampling);
+AGENT_ACTION_PAYLOAD(ActionSetLimits        , AgentProcessorEventData::sLimits);
+AGENT_ACTION_PAYLOAD(ActionDecodeStep       , std::monostate);
+AGENT_ACTION_PAYLOAD(ActionReplyFragment    , AgentProcessorEventData::sText);
+AGENT_ACTION_PAYLOAD(ActionCancelText       , AgentProcessorEventData::sSession);
+AGENT_ACTION_PAYLOAD(ActionSetPolicy        , AgentProcessorEventData::sPolicy);
+AGENT_ACTION_PAYLOAD(ActionActivateDraft    , AgentProcessorEventData::sModelPath);
+AGENT_ACTION_PAYLOAD(ActionModelLoaded      , AgentProcessorEventData::sModel);
+AGENT_ACTION_PAYLOAD(ActionLoadResident     , AgentProcessorEventData::sModelPath);
+AGENT_ACTION_PAYLOAD(ActionResidentLoaded   , AgentProcessorEventData::sModel);
+AGENT_ACTION_PAYLOAD(ActionActivateEmbedder , AgentProcessorEventData::sEmbedder);
+AGENT_ACTION_PAYLOAD(ActionComputeEmbedding , AgentProcessorEventData::sText);
+AGENT_ACTION_PAYLOAD(ActionReplyEmbedding   , AgentProcessorEventData::sEmbedding);
+AGENT_ACTION_PAYLOAD(ActionLoadVocab        , AgentProcessorEventData::sModelPath);
+AGENT_ACTION_PAYLOAD(ActionVocabLoaded      , AgentProcessorEventData::sModel);
+
+#undef AGENT_ACTION_PAYLOAD
+
 DECLARE_EVENT(AgentProcessorEventData, AgentProcessorEvent, IEAgentProcessorEventConsumer);
 
 //////////////////////////////////////////////////////////////////////////
@@ -86,6 +265,7 @@ DECLARE_EVENT(AgentProcessorEventData, AgentProcessorEvent, IEAgentProcessorEven
 
 class AgentProcessor    : public IEWorkerThreadConsumer
                         , public IEAgentProcessorEventConsumer
+                        , private IEAgentEngineListener
 {
 public:
     static constexpr uint32_t MAX_CHARS         { 4096u };
@@ -105,6 +285,26 @@ public:
     static constexpr uint32_t MIN_THREADS       { 2u    };
     static constexpr uint32_t DEF_THREADS       { 8u    };
     
+    static constexpr uint32_t MAX_CACHE_MB      { 4096u };
+    static constexpr uint32_t MIN_CACHE_MB      { 0u    };
+    static constexpr uint32_t DEF_CACHE_MB      { 256u  };
+    static constexpr uint64_t BYTES_IN_MB       { 1024u * 1024u };
+    
+    static constexpr uint32_t MAX_SESSION_MB    { 8192u };
+    static constexpr uint32_t MIN_SESSION_MB    { 0u    };
+    static constexpr uint32_t DEF_SESSION_MB    { 512u  };
+    static constexpr uint32_t DISK_SESSION_MB   { 8192u };  //!< The budget of the KV states of idle conversations written to the disk.
+    
+    static constexpr uint32_t MAX_CONTEXT_MB    { 16384u};
+    static constexpr uint32_t MIN_CONTEXT_MB    { 0u    };
+    static constexpr uint32_t DEF_CONTEXT_MB    { 2048u };
+    
+    static constexpr uint32_t MAX_MODELS_MB     { 65536u};
+    static constexpr uint32_t MIN_MODELS_MB     { 0u    };
+    static constexpr uint32_t DEF_MODELS_MB     { 8192u };
+    
+    static constexpr uint32_t MAX_EMBED_STEP    { AgentEmbedder::MAX_SEQUENCES };   //!< The maximum number of texts embedded per decoding step.
+    
     
     static constexpr float    MAX_TEMPERATURE   { 1.20f };
     static constexpr float    MIN_TEMPERATURE   { 0.00f };
@@ -114,6 +314,49 @@ public:
     static constexpr float    MIN_PROBABILITY   { 0.00f };
     static constexpr float    DEF_PROBABILITY   { 0.08f };
 
+private:
+    //!< The engine of the model kept loaded to process the texts routed to the model by name.
+    struct sResident
+    {
+        String                          name        { };        //!< The file name of the model to route the texts.
+        String                          path        { };        //!< The absolute path of the model file.
+        String                          sessionDir  { };        //!< The directory of the stored conversations of the model.
+        std::unique_ptr<AgentEngine>    engine      { };        //!< The engine decoding the texts of the model.
+        uint64_t                        size        { 0u };     //!< The size of the model in bytes, estimated by the file size while loading.
+        uint64_t                        lastUse     { 0u };     //!< The stamp of the last routed text to evict the least recently used model.
+        bool                            loading     { true };   //!< Flag, indicating that the model is loading, the routed texts wait in the engine.
+    };
+
+    //!< The resident models. The active model is not in the list, it is decoded by the main engine.
+    using ListResidents = std::vector<sResident>;
+
+    //!< The prompt searched in the semantic cache, which reply is cached when received.
+    struct sSimilarPrompt
+    {
+        AgentResponseCache::sProfile    profile     { };        //!< The profile of processing the prompt.
+        std::vector<float>              embedding   { };        //!< The normalized embedding of the prompt.
+    };
+
+    //!< The prompts waiting for the reply to cache, the key is the ID of the session.
+    using MapSimilarPrompts = std::map<uint32_t, sSimilarPrompt>;
+
+    //!< The names of the models processing the prompts, the key is the ID of the session.
+    //!< The name is empty if the prompt is processed by the active model.
+    using MapRoutedModels = std::map<uint32_t, String>;
+
+    //!< The stateless prompts waiting for the embedding to search the semantic cache.
+    using ListSimilarRequests = std::deque<AgentProcessorEventData::sPrompt>;
+
+    //!< The text waiting for the embedding.
+    struct sEmbedRequest
+    {
+        uint32_t                        sessionId   { 0u };     //!< The ID of the session to reply.
+        String                          text        { };        //!< The text to compute the embedding.
+    };
+
+    //!< The queued texts computed in batches on the next decoding steps.
+    using ListEmbedRequests = std::deque<sEmbedRequest>;
+
 public:
     AgentProcessor(void);
     virtual ~AgentProcessor(void) = default;
@@ -123,6 +366,15 @@ public:
     static uint32_t optThreadCount(void);
     
     static uint32_t defThreadCount(void);
+
+    /**
+     * \brief   Aborts the running decoding step. Can be called from any thread.
+     *          Should be called only if all prompts in progress are canceled,
+     *          the flag is reset when the canceling is processed. Only the step
+     *          of the active model is aborted, the resident models are created
+     *          and released in the worker thread.
+     **/
+    inline void abortDecode(void);
     
 protected:
 
@@ -152,25 +404,135 @@ protected:
      * \param  data    The data, which was passed as an event.
      **/
     virtual void processEvent( const AgentProcessorEventData & data ) override;
+
+/************************************************************************/
+// IEAgentEngineListener overrides
+/************************************************************************/
+
+    /**
+     * \brief   Triggered by the engine when the next piece of the reply is generated.
+     *          Sends the fragment to the component thread while decoding continues.
+     * \param   sessionId   The ID of the session set when the prompt was queued.
+     * \param   fragment    The generated piece of the text.
+     **/
+    virtual void onTextFragment(uint32_t sessionId, const String& fragment) override;
+
+    /**
+     * \brief   Triggered by the engine when the generation of the reply is completed.
+     *          Sends the reply to the component thread.
+     * \param   sessionId   The ID of the session set when the prompt was queued.
+     * \param   reply       The text generated by the LLM. Empty if failed.
+     * \param   stats       The statistics of processing the prompt.
+     **/
+    virtual void onTextReplied(uint32_t sessionId, const SharedText& reply, const IEAgentEngineListener::sTextStats& stats) override;
+
+    /**
+     * \brief   Triggered by the engine when it switched to the loaded model.
+     *          Notifies the component thread to update the active model.
+     * \param   modelPath   The path of the activated model file.
+     **/
+    virtual void onModelSwitched(const String& modelPath) override;
     
 private:
-    String processText(const String & prompt);
-    
+
+    /**
+     * \brief   Queues the prompt in the batching engine of the model and triggers the decoding step,
+     *          if it is not triggered yet. The stateless prompts processed with the greedy sampling
+     *          wait for the embedding to search the semantic cache first.
+     * \param   sessionId       The ID of the session to reply.
+     * \param   conversation    The key of the conversation to continue or AgentEngine::NO_CONVERSATION.
+     * \param   modelName       The name of the model to process the text. Empty to process by the active model.
+     * \param   adapterName     The name of the LoRA adapter of the model to process the text. Empty to process without adapter.
+     * \param   prompt          The text to process, shared with the provider.
+     * \param   vocabName       The name of the model, which vocabulary tokenized the prompt. Empty if not tokenized.
+     * \param   tokens          The tokens of the prompt. Ignored and tokenized again if the text is routed to other model.
+     **/
+    void processText(uint32_t sessionId, uint64_t conversation, const String & modelName, const String & adapterName, const SharedText & prompt, const String & vocabName, std::vector<llama_token> && tokens);
+
+    /**
+     * \brief   Routes the prompt to the engine of the model and queues it to join the batch on the next step.
+     * \param   request         The prompt to queue, the tokens are moved to the engine.
+     * \return  Returns the name of the model, which processes the prompt. It is the active model,
+     *          if the requested model is not available or does not fit the budget.
+     **/
+    String queueText(AgentProcessorEventData::sPrompt & request);
+
+    /**
+     * \brief   Computes the embeddings of the waiting prompts in one batch and searches the replies of
+     *          the similar prompts in the semantic cache. The found replies are sent without decoding,
+     *          the rest of prompts are queued to decode and their embeddings are kept to cache the replies.
+     * \param   maxTexts        The maximum number of prompts to embed, the rest wait for the next step.
+     * \return  Returns the number of embedded prompts.
+     **/
+    uint32_t searchSimilar(uint32_t maxTexts);
+
+    /**
+     * \brief   Loads the model of the embeddings, if the semantic cache is enabled or the edge
+     *          devices requested the embeddings of the texts. The dedicated embedding model is used
+     *          if set, otherwise the active model. The cached replies are removed when the model
+     *          of the embeddings changes.
+     **/
+    void activateEmbedder(void);
+
+    /**
+     * \brief   Computes the embeddings of the queued texts in one batch and sends them to the
+     *          component thread as the arrays of floats. The empty array is sent if failed.
+     * \param   maxTexts        The maximum number of texts to embed, the rest wait for the next step.
+     **/
+    void computeEmbeddings(uint32_t maxTexts);
+
+    /**
+     * \brief   Returns the engine of the model to process the text. If the model is not resident,
+     *          the least recently used models are evicted to fit the memory budget and the model
+     *          is requested to load, the texts wait in its engine. If the model is not available
+     *          or does not fit the budget, the text is processed by the active model.
+     * \param   modelName       The name of the model in the directory of the active model.
+     **/
+    AgentEngine& routeText(const String& modelName);
+
+    /**
+     * \brief   Makes the model resident, when it is loaded by the loader thread.
+     *          If failed to load, the waiting texts are replied as failed.
+     * \param   modelPath       The path of the loaded model.
+     * \param   model           The loaded model or nullptr if failed.
+     **/
+    void residentLoaded(const String& modelPath, llama_model* model);
+
     /**
-     * \brief   Activates or loads the LLM model to be used by the agent.
-     *
-     * This function prepares the internal LLM context for inference using the
-     * model specified by \a modelPath. It may release any previously loaded
-     * model and update the internal state (e.g. model path, context handle
-     * and related parameters) to reflect the newly activated model.
-     *
-     * \param   modelPath   Filesystem path to the LLM model to activate.
-     *
-     * \return  A status or informational string related to the activation
-     *          operation (for example, the effective model path or error
-     *          description).
+     * \brief   Evicts the least recently used resident models, which decode nothing, until the
+     *          models fit the memory budget. The active model is never evicted.
+     * \param   size    The size of the model to load in bytes.
+     * \return  Returns true if the model of the given size fits the budget.
      **/
-    String activateModel(const String& modelPath);
+    bool reserveMemory(uint64_t size);
+
+    //!< Returns the absolute path of the model in the directory of the active model. Empty if the name is not a model file.
+    String residentPath(const String& modelName) const;
+
+    /**
+     * \brief   Loads the LoRA adapters of the model to the engine. The adapters are the GGUF files
+     *          of the directory next to the model, named as the model file without extension
+     *          and with the suffix NEMultiEdgeSettings::ADAPTER_SUFFIX.
+     * \param   engine      The engine with the loaded model.
+     * \param   modelPath   The path of the model file.
+     **/
+    void loadAdapters(AgentEngine& engine, const String& modelPath);
+
+    //!< Sets the limits, the sampling and the budgets to the engine.
+    void configureEngine(AgentEngine& engine, const String& sessionDir);
+
+    //!< Runs single decoding step of the engines and triggers the next step if there are pending sequences.
+    void decodeStep(void);
+
+    //!< Sends the event to the worker thread to run the next decoding step.
+    void triggerDecodeStep(void);
+
+    /**
+     * \brief   Activates the draft model of the speculative decoding.
+     * \param   modelPath   Filesystem path to the draft model. Empty to disable the speculation.
+     * \return  Returns the path of the activated draft model, empty if none is activated.
+     **/
+    String activateDraft(const String& modelPath);
     
     //!< Releases the currently active LLM model and associated context.
     void freeModel();
@@ -179,44 +541,89 @@ private:
     
 private:
     ComponentThread*        mCompThread;
-    uint32_t                mSessionId;
-    uint32_t                mUserId;
+    WorkerThread*           mWorkerThread;
     String                  mModelPath;
-    llama_model_params      mModelParams;
+    String                  mDraftPath;
 
     uint32_t                mTextLimit;
     uint32_t                mTokenLimit;
     uint32_t                mBatching;
     uint32_t                mThreads;
+    uint32_t                mCacheSize;
+    uint32_t                mSessionSize;
+    uint32_t                mContextSize;
+    uint32_t                mModelsSize;
+    AgentContextPool::eCacheType        mCacheTypeK;
+    AgentContextPool::eCacheType        mCacheTypeV;
+    AgentContextPool::eFlashAttention   mFlashAttn;
+    String                  mSessionDir;
     float                   mTemperature;
     float                   mProbability;
+    bool                    mLookup;
+    String                  mEmbedPath;
+    uint32_t                mSimilarity;
 
-    llama_model*            mLLMModel;
+    AgentEngine             mEngine;
+    AgentEmbedder           mEmbedder;
+    AgentSemanticCache      mSemanticCache;
+    MapRoutedModels         mRoutedModels;
+    MapSimilarPrompts       mSimilarPrompts;
+    ListSimilarRequests     mSimilarRequests;
+    ListEmbedRequests       mEmbedRequests;
+    bool                    mEmbedUsed;
+    ListResidents           mResidents;
+    uint64_t                mUseStamp;
+    bool                    mStepQueued;
 };
 
 //////////////////////////////////////////////////////////////////////////
 // Inline methods
 //////////////////////////////////////////////////////////////////////////
 
+inline void AgentProcessor::abortDecode(void)
+{
+    mEngine.abortDecode(true);
+}
+
 inline AgentProcessorEventData::eAction AgentProcessorEventData::getAction(void) const
 {
     return mAction;
 }
 
-inline SharedBuffer& AgentProcessorEventData::getData(void)
+template<AgentProcessorEventData::eAction Action, typename ... Args>
+inline AgentProcessorEventData AgentProcessorEventData::create(Args && ... args)
+{
+    if constexpr (std::is_same_v<PayloadType<Action>, std::monostate>)
+    {
+        static_assert(sizeof...(Args) == 0, "The action has no payload");
+        return AgentProcessorEventData(Action, std::shared_ptr<Payload>());
+    }
+    else
+    {
+        return AgentProcessorEventData(Action, std::make_shared<Payload>(std::in_place_type<PayloadType<Action>>, PayloadType<Action>{ std::forward<Args>(args)... }));
+    }
+}
+
+template<AgentProcessorEventData::eAction Action>
+inline const AgentProcessorEventData::PayloadType<Action>& AgentProcessorEventData::getPayload(void) const
 {
-    return mData;
+    ASSERT((mAction == Action) && (mPayload != nullptr));
+    return std::get<PayloadType<Action>>(*mPayload);
 }
 
-inline const SharedBuffer& AgentProcessorEventData::getData(void) const
+template<AgentProcessorEventData::eAction Action>
+inline AgentProcessorEventData::PayloadType<Action> AgentProcessorEventData::movePayload(void) const
 {
-    return mData;
+    ASSERT((mAction == Action) && (mPayload != nullptr));
+    PayloadType<Action> result{ std::move(std::get<PayloadType<Action>>(*mPayload)) };
+    *mPayload = std::monostate{ };
+    return result;
 }
 
 inline void AgentProcessorEventData::reset(void)
 {
     mAction = ActionUnknown;
-    mData.invalidate();
+    mPayload.reset();
 }
 
 #endif // MULTIEDGE_AIAGENT_AGENTPROCESSOR_HPP
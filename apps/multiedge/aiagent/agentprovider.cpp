@@ -20,18 +20,47 @@
  ************************************************************************/
 #include "multiedge/aiagent/agentprovider.hpp"
 #include "multiedge/resources/nemultiedgesettings.hpp"
-#include "multiedge/aiagent/aiagent.hpp"
 #include "areg/base/DateTime.hpp"
+#include "areg/component/ComponentLoader.hpp"
 #include "areg/component/ComponentThread.hpp"
+#include "areg/component/ServiceRequestEvent.hpp"
 #include "areg/logging/GELog.h"
 
+#include <QDir>
 #include <QFileInfo>
+#include <algorithm>
+
+BEGIN_MODEL(NEMultiEdgeSettings::MODEL_PROVIDER.data())
+    BEGIN_REGISTER_THREAD(NEMultiEdgeSettings::AGENT_THREAD.data())
+        BEGIN_REGISTER_COMPONENT(NEMultiEdgeSettings::SERVICE_PROVIDER.data(), AgentProvider)
+            REGISTER_IMPLEMENT_SERVICE(NEMultiEdge::ServiceName, NEMultiEdge::InterfaceVersion)
+            REGISTER_WORKER_THREAD(NEMultiEdgeSettings::WORKER_THREAD.data(), NEMultiEdgeSettings::CONSUMER_NAME.data())
+            REGISTER_WORKER_THREAD(NEMultiEdgeSettings::LOADER_THREAD.data(), NEMultiEdgeSettings::LOADER_CONSUMER.data())
+        END_REGISTER_COMPONENT(NEMultiEdgeSettings::SERVICE_PROVIDER.data())
+    END_REGISTER_THREAD(NEMultiEdgeSettings::AGENT_THREAD.data())
+END_MODEL(NEMultiEdgeSettings::MODEL_PROVIDER.data())
 
 DEF_LOG_SCOPE(multiedge_aiagent_AgentProvider_startupServiceInterface);
 DEF_LOG_SCOPE(multiedge_aiagent_AgentProvider_shutdownServiceInterface);
 DEF_LOG_SCOPE(multiedge_aiagent_AgentProvider_requestProcessText);
 DEF_LOG_SCOPE(multiedge_aiagent_AgentProvider_requestProcessVideo);
+DEF_LOG_SCOPE(multiedge_aiagent_AgentProvider_requestCancelText);
+DEF_LOG_SCOPE(multiedge_aiagent_AgentProvider_requestStreamText);
+DEF_LOG_SCOPE(multiedge_aiagent_AgentProvider_requestComputeEmbedding);
+DEF_LOG_SCOPE(multiedge_aiagent_AgentProvider_clientConnected);
 DEF_LOG_SCOPE(multiedge_aiagent_AgentProvider_processEvent);
+DEF_LOG_SCOPE(multiedge_aiagent_AgentProvider_reportQueueWait);
+DEF_LOG_SCOPE(multiedge_aiagent_AgentProvider_reportLatency);
+DEF_LOG_SCOPE(multiedge_aiagent_AgentProvider_replyCached);
+
+namespace
+{
+    //!< Returns the time in microseconds between two time points.
+    inline uint64_t _micros(const std::chrono::steady_clock::time_point& from, const std::chrono::steady_clock::time_point& to)
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(to - from).count());
+    }
+}
 
 AgentProvider* AgentProvider::getService(void)
 {
@@ -47,29 +76,81 @@ void AgentProvider::activateModel(const QString & modelPath)
     }
 }
 
-void AgentProvider::setTemperature(float newTemp, float newMinP)
+void AgentProvider::activateDraft(const QString & draftPath)
+{
+    AgentProvider* service = getService();
+    if ((service != nullptr) && (service->mWorkerThread != nullptr))
+    {
+        AgentProcessorEvent::sendEvent( AgentProcessorEventData::create<AgentProcessorEventData::eAction::ActionActivateDraft>(String(draftPath.toStdString()))
+                                      , *(service->mWorkerThread)
+                                      , Event::eEventPriority::EventPriorityHigh);
+    }
+}
+
+void AgentProvider::activateEmbedder(const QString& embedPath, uint32_t similarity)
 {
     AgentProvider* service = getService();
     if ((service != nullptr) && (service->mWorkerThread != nullptr))
     {
-        AgentProcessorEvent::sendEvent( AgentProcessorEventData(AgentProcessorEventData::eAction::ActionTemperature, newTemp, newMinP)
+        AgentProcessorEvent::sendEvent( AgentProcessorEventData::create<AgentProcessorEventData::eAction::ActionActivateEmbedder>(similarity, String(embedPath.toStdString()))
                                       , *(service->mWorkerThread)
                                       , Event::eEventPriority::EventPriorityHigh);
     }
 }
 
+void AgentProvider::setTemperature(float newTemp, float newMinP, bool lookup)
+{
+    AgentProvider* service = getService();
+    if ((service != nullptr) && (service->mWorkerThread != nullptr))
+    {
+        AgentProcessorEvent::sendEvent( AgentProcessorEventData::create<AgentProcessorEventData::eAction::ActionTemperature>(newTemp, newMinP, lookup)
+                                      , *(service->mWorkerThread)
+                                      , Event::eEventPriority::EventPriorityHigh);
+
+        // The profile of the cached replies is accessed only in the thread of the component.
+        AgentProcessorEvent::sendEvent( AgentProcessorEventData::create<AgentProcessorEventData::eAction::ActionTemperature>(newTemp, newMinP, lookup)
+                                      , service->getMasterThread()
+                                      , Event::eEventPriority::EventPriorityHigh);
+    }
+}
+
+void AgentProvider::setSchedulingPolicy(AgentScheduler::ePolicy policy)
+{
+    AgentProvider* service = getService();
+    if (service != nullptr)
+    {
+        // The scheduler is accessed only in the thread of the component.
+        AgentProcessorEvent::sendEvent( AgentProcessorEventData::create<AgentProcessorEventData::eAction::ActionSetPolicy>(static_cast<uint32_t>(policy))
+                                      , service->getMasterThread()
+                                      , Event::eEventPriority::EventPriorityHigh);
+    }
+}
+
 AgentProvider::AgentProvider(const NERegistry::ComponentEntry& entry, ComponentThread& owner)
     : QObject       (nullptr)
     , Component     (entry, owner)
     , MultiEdgeStub (static_cast<Component &>(self()))
     , IEAgentProcessorEventConsumer()
-    , mAIAgent      (std::any_cast<AIAgent*>(entry.getComponentData()))
+    , mHost         (std::any_cast<IEAgentHost*>(entry.getComponentData()))
     , mAgentState   (eAgentState::StateReady)
     , mListSessions ()
+    , mListEmbeddings()
+    , mTokenizer    ( )
+    , mVocabPaths   ( )
+    , mActivePath   ( )
+    , mScheduler    (mHost->getSchedulingPolicy())
+    , mStatistics   ( )
+    , mReplyCache   ( )
+    , mProfile      ( )
+    , mPublished    ( )
+    , mDispatched   (0u)
     , mWorkerThread (nullptr)
+    , mLoaderThread (nullptr)
+    , mRequestSource( )
     , mAgentProcessor()
+    , mAgentLoader  ()
 {
-    ASSERT(mAIAgent != nullptr);
+    ASSERT(mHost != nullptr);
 }
 
 void AgentProvider::startupServiceInterface(Component& holder)
@@ -81,20 +162,20 @@ void AgentProvider::startupServiceInterface(Component& holder)
     AgentProcessorEvent::addListener(static_cast<IEAgentProcessorEventConsumer&>(self()), holder.getMasterThread());
     setEdgeAgent(NEMultiEdge::AgentLLM);
     setQueueSize(0);
+    setTextLatency(NEMultiEdge::sTextLatency());
+    mStatistics.clear();
+    mDispatched = 0u;
+    mAgentState = eAgentState::StateReady;
     
-    connect(this, &AgentProvider::signalServiceStarted    , mAIAgent, &AIAgent::slotServiceStarted    , Qt::ConnectionType::QueuedConnection);
-    connect(this, &AgentProvider::signalActiveModelChanged, mAIAgent, &AIAgent::slotActiveModelChanged, Qt::ConnectionType::QueuedConnection);
-    connect(this, &AgentProvider::signalQueueSize         , mAIAgent, &AIAgent::slotAgentQueueSize    , Qt::ConnectionType::QueuedConnection);
-    connect(this, &AgentProvider::signalEdgeAgent         , mAIAgent, &AIAgent::slotAgentType         , Qt::ConnectionType::QueuedConnection);
-    connect(this, &AgentProvider::signalTextRequested     , mAIAgent, &AIAgent::slotTextRequested     , Qt::ConnectionType::QueuedConnection);
-    connect(this, &AgentProvider::signalTextProcessed     , mAIAgent, &AIAgent::slotTextProcessed     , Qt::ConnectionType::QueuedConnection);
+    ASSERT(mHost != nullptr);
+    mHost->onProviderStarted(self());
     
     emit signalServiceStarted(true);
     emit signalEdgeAgent(NEMultiEdge::AgentLLM);
     emit signalQueueSize(0);
     
     ASSERT(mWorkerThread != nullptr);
-    _activateModel(mAIAgent->getActiveModelPath());
+    _activateModel(QString::fromStdString(mHost->getActiveModelPath().getData()));
 }
 
 void AgentProvider::shutdownServiceInterface(Component& holder)
@@ -104,42 +185,51 @@ void AgentProvider::shutdownServiceInterface(Component& holder)
     invalidateEdgeAgent();
     invalidateQueueSize();
     invalidateActiveModel();
+    invalidateAvailableModels();
+    invalidateAvailableAdapters();
+    invalidateTextLatency();
 
     emit signalEdgeAgent(NEMultiEdge::AgentUnknown);
     emit signalQueueSize(0);
     emit signalActiveModelChanged(QString("N/A"));
 
+    // The model, which is loading, is not needed anymore.
+    mAgentLoader.cancelLoad();
+    mListEmbeddings.clear();
+    mTokenizer.clear();
+    mVocabPaths.clear();
+    mActivePath.clear();
     mWorkerThread = nullptr;
+    mLoaderThread = nullptr;
     emit signalServiceStarted(false);
-    
-    disconnect(this, &AgentProvider::signalServiceStarted    , mAIAgent, &AIAgent::slotServiceStarted);
-    disconnect(this, &AgentProvider::signalActiveModelChanged, mAIAgent, &AIAgent::slotActiveModelChanged);
-    disconnect(this, &AgentProvider::signalQueueSize         , mAIAgent, &AIAgent::slotAgentQueueSize);
-    disconnect(this, &AgentProvider::signalEdgeAgent         , mAIAgent, &AIAgent::slotAgentType     );
-    disconnect(this, &AgentProvider::signalTextRequested     , mAIAgent, &AIAgent::slotTextRequested );
-    disconnect(this, &AgentProvider::signalTextProcessed     , mAIAgent, &AIAgent::slotTextProcessed );
+    mHost->onProviderStopped(self());
 
     AgentProcessorEvent::removeListener(static_cast<IEAgentProcessorEventConsumer&>(self()), holder.getMasterThread());
     MultiEdgeStub::shutdownServiceInterface(holder);
 }
 
-void AgentProvider::requestProcessText(unsigned int sessionId, unsigned int agentId, const String& textProcess)
+void AgentProvider::requestProcessText(unsigned int sessionId, unsigned int agentId, unsigned int conversationId, NEMultiEdge::eTextPriority priority, const String& modelName, const String& adapterName, const String& textProcess)
 {
     LOG_SCOPE(multiedge_aiagent_AgentProvider_requestProcessText);
     SessionID unblock = unblockCurrentRequest();
-    mListSessions.push_back({ unblock, sessionId, agentId, textProcess });
+    // The only copy of the prompt, the threads, the caches and the GUI share it.
+    sTextPrompt prompt{ unblock, sessionId, agentId, conversationId, modelName, adapterName, NEAgentText::makeText(textProcess), false, 0u, mRequestSource, false, Clock::now() };
+    if (replyCached(prompt))
+        return;
+
+    const uint32_t cost = tokenizePrompt(prompt);
+    const SharedText text(prompt.prompt);
+    mListSessions[unblock] = std::move(prompt);
+    mScheduler.push(unblock, agentId, static_cast<uint32_t>(priority), cost);
     setQueueSize(static_cast<uint32_t>(mListSessions.size()));
 
-    LOG_DBG("Requested to process text. Agent ID [ %u ], session ID [ %u ], agent state [ %s ]", agentId, sessionId, mAgentState == eAgentState::StateReady ? "Ready" : "Busy");
+    LOG_DBG("Requested to process text. Agent ID [ %u ], session ID [ %u ], priority [ %s ], model [ %s ], adapter [ %s ], agent state [ %s ]"
+                , agentId, sessionId, NEMultiEdge::getString(priority), modelName.isEmpty() ? "active" : modelName.getString()
+                , adapterName.isEmpty() ? "none" : adapterName.getString(), mAgentState == eAgentState::StateReady ? "Ready" : "Busy");
 
     emit signalQueueSize(static_cast<uint32_t>(mListSessions.size()));
-    emit signalTextRequested(unblock, sessionId, agentId, QString::fromStdString(textProcess.getString()), DateTime::getNow());
-    if (mAgentState == eAgentState::StateReady)
-    {
-        mAgentState = eAgentState::StateBusy;
-        ASSERT(mWorkerThread != nullptr);
-        AgentProcessorEvent::sendEvent(AgentProcessorEventData(AgentProcessorEventData::eAction::ActionProcessText, unblock, textProcess), *mWorkerThread);
-    }
+    emit signalTextRequested(unblock, sessionId, agentId, text, DateTime::getNow());
+    dispatchPrompts();
 }
 
 void AgentProvider::requestProcessVideo(unsigned int sessionId, bool agentId, const String& cmdText, const SharedBuffer& dataVideo)
@@ -147,16 +237,145 @@ void AgentProvider::requestProcessVideo(unsigned int sessionId, bool agentId, co
     LOG_SCOPE(multiedge_aiagent_AgentProvider_requestProcessVideo);
 }
 
-IEWorkerThreadConsumer* AgentProvider::workerThreadConsumer(const String& /*consumerName*/, const String& /*workerThreadName*/)
+void AgentProvider::requestCancelText(unsigned int sessionId, unsigned int agentId)
 {
-    return &mAgentProcessor;
+    LOG_SCOPE(multiedge_aiagent_AgentProvider_requestCancelText);
+    ListSession::iterator pos = std::find_if(mListSessions.begin(), mListSessions.end(), [sessionId, agentId](const ListSession::value_type& entry)
+                                            { return (entry.second.agentSession == sessionId) && (entry.second.agentId == agentId) && (entry.second.canceled == false); });
+    if (pos != mListSessions.end())
+    {
+        LOG_DBG("Canceling text prompt of Agent [ %u ], session [ %u ]", agentId, sessionId);
+        if (pos->second.dispatched)
+        {
+            // The decoding is aborted before the worker receives the canceling, which resets the flag.
+            pos->second.canceled = true;
+            abortCanceled();
+        }
+
+        cancelPrompt(pos);
+    }
+    else
+    {
+        LOG_DBG("No text prompt of Agent [ %u ], session [ %u ] to cancel", agentId, sessionId);
+    }
 }
 
-void AgentProvider::notifyWorkerThreadStarted(IEWorkerThreadConsumer& /*consumer*/, WorkerThread& workerThread)
+void AgentProvider::requestStreamText(unsigned int sessionId, unsigned int agentId)
+{
+    LOG_SCOPE(multiedge_aiagent_AgentProvider_requestStreamText);
+    SessionID unblock = unblockCurrentRequest();
+    const ProxyAddress& source{ mRequestSource };
+    ListSession::iterator pos = std::find_if(mListSessions.begin(), mListSessions.end(), [sessionId, agentId, &source](const ListSession::value_type& entry)
+                                            { return (entry.second.agentSession == sessionId) && (entry.second.agentId == agentId) && (entry.second.source == source); });
+    if (pos == mListSessions.end())
+    {
+        // The prompt is already replied, for example, from the cache. Nothing to stream.
+        LOG_DBG("No text prompt of Agent [ %u ], session [ %u ] to stream, closing the stream", agentId, sessionId);
+        if (prepareResponse(unblock))
+        {
+            responseStreamText(sessionId, agentId, 0u, String(), true);
+        }
+
+        return;
+    }
+
+    sTextPrompt& prompt = pos->second;
+    if (prompt.streaming && prepareResponse(prompt.stream))
+    {
+        // Only one request waits for the next fragment, the previous one is replied with the text so far.
+        LOG_WARN("Agent [ %u ] requested to stream session [ %u ] twice, replying the previous request", agentId, sessionId);
+        responseStreamText(prompt.agentSession, prompt.agentId, prompt.fragments ++, prompt.streamed, false);
+        prompt.streamed.clear();
+    }
+
+    prompt.stream   = unblock;
+    prompt.streaming= true;
+    streamFragment(prompt, false);
+}
+
+void AgentProvider::requestComputeEmbedding(unsigned int sessionId, unsigned int agentId, const String& textEmbed)
+{
+    LOG_SCOPE(multiedge_aiagent_AgentProvider_requestComputeEmbedding);
+    SessionID unblock = unblockCurrentRequest();
+    LOG_DBG("Requested to compute embedding. Agent ID [ %u ], session ID [ %u ], text length [ %u ]", agentId, sessionId, textEmbed.getLength());
+    if (mWorkerThread == nullptr)
+    {
+        LOG_WARN("No worker thread to compute embedding of Agent [ %u ], session [ %u ]", agentId, sessionId);
+        if (prepareResponse(unblock))
+        {
+            responseComputeEmbedding(sessionId, agentId, 0u, SharedBuffer());
+        }
+
+        return;
+    }
+
+    mListEmbeddings[unblock] = sEmbedRequest{ sessionId, agentId };
+    AgentProcessorEvent::sendEvent(AgentProcessorEventData::create<AgentProcessorEventData::eAction::ActionComputeEmbedding>(unblock, textEmbed)
+                                   , *mWorkerThread
+                                   , Event::eEventPriority::EventPriorityHigh);
+}
+
+bool AgentProvider::clientConnected(const ProxyAddress& client, NEService::eServiceConnection connectionStatus)
+{
+    LOG_SCOPE(multiedge_aiagent_AgentProvider_clientConnected);
+    bool result = MultiEdgeStub::clientConnected(client, connectionStatus);
+    if (connectionStatus != NEService::eServiceConnection::ServiceConnected)
+    {
+        // Nobody waits for the replies of the disconnected client.
+        // The decoding is aborted before the worker receives the canceling, which resets the flag.
+        std::vector<SessionID> canceled;
+        bool dispatched{ false };
+        for (ListSession::value_type& entry : mListSessions)
+        {
+            if ((entry.second.source == client) && (entry.second.canceled == false))
+            {
+                LOG_DBG("Client disconnected, canceling text prompt of Agent [ %u ], session [ %u ]", entry.second.agentId, entry.second.agentSession);
+                canceled.push_back(entry.first);
+                dispatched |= entry.second.dispatched;
+                entry.second.canceled = entry.second.dispatched;
+            }
+        }
+
+        if (dispatched)
+        {
+            abortCanceled();
+        }
+
+        for (SessionID sessionId : canceled)
+        {
+            cancelPrompt(mListSessions.find(sessionId));
+        }
+    }
+
+    return result;
+}
+
+void AgentProvider::processRequestEvent(ServiceRequestEvent& eventElem)
+{
+    mRequestSource = eventElem.getEventSource();
+    MultiEdgeStub::processRequestEvent(eventElem);
+}
+
+IEWorkerThreadConsumer* AgentProvider::workerThreadConsumer(const String& consumerName, const String& /*workerThreadName*/)
+{
+    if (consumerName == NEMultiEdgeSettings::LOADER_CONSUMER.data())
+        return &mAgentLoader;
+    else
+        return &mAgentProcessor;
+}
+
+void AgentProvider::notifyWorkerThreadStarted(IEWorkerThreadConsumer& consumer, WorkerThread& workerThread)
 {
     ASSERT(workerThread.isValid());
     ASSERT(workerThread.isRunning());
-    mWorkerThread = &workerThread;
+    if (&consumer == static_cast<IEWorkerThreadConsumer*>(&mAgentLoader))
+    {
+        mLoaderThread = &workerThread;
+    }
+    else
+    {
+        mWorkerThread = &workerThread;
+    }
 }
 
 void AgentProvider::processEvent(const AgentProcessorEventData& data)
@@ -167,68 +386,260 @@ void AgentProvider::processEvent(const AgentProcessorEventData& data)
     case AgentProcessorEventData::eAction::ActionReplyText:
     {
         LOG_DBG("Processed text....");
-        const SharedBuffer& evData = data.getData();
-        String reply;
-        uint32_t sessionId{0xFFFFFFFFu};
-        evData >> sessionId;
-        evData >> reply;
+        const AgentProcessorEventData::sReply& evData = data.getPayload<AgentProcessorEventData::eAction::ActionReplyText>();
+        const SharedText& reply = evData.reply;
+        const IEAgentEngineListener::sTextStats& stats = evData.stats;
+        const uint32_t sessionId{ evData.sessionId };
+        ASSERT(reply != nullptr);
 
-        if (!mListSessions.empty())
+        ListSession::iterator pos = mListSessions.find(sessionId);
+        if (pos != mListSessions.end())
         {
-            const sTextPrompt& prompt = mListSessions.front();
-            ASSERT(sessionId == prompt.sessionId);
+            sTextPrompt& prompt = pos->second;
+            ASSERT(prompt.dispatched);
+            uint64_t response{ 0u };
 
-            emit signalTextProcessed(sessionId, prompt.agentSession, prompt.agentId, QString::fromStdString(reply.getData()), DateTime::getNow());
+            // The final marker closes the stream of fragments, the complete reply follows in response.
+            streamFragment(prompt, true);
+            emit signalTextProcessed(sessionId, prompt.agentSession, prompt.agentId, reply, DateTime::getNow());
             if (prepareResponse(sessionId))
             {
                 LOG_DBG("Prepared response, sending response to the Agent [ %u ], session [ %u ], response text length [ %u ]"
                     , prompt.agentId
                     , prompt.agentSession
-                    , reply.getLength());
+                    , reply->getLength());
 
-                responseProcessText(prompt.agentSession, prompt.agentId, reply);
+                // The reply not completed by the model is canceled by the edge device or failed.
+                const NEMultiEdge::eTextResult result{ stats.completed ? NEMultiEdge::eTextResult::TextCompleted : (prompt.canceled ? NEMultiEdge::eTextResult::TextCanceled : NEMultiEdge::eTextResult::TextFailed) };
+                const Clock::time_point start{ Clock::now() };
+                responseProcessText(prompt.agentSession, prompt.agentId, *reply, result);
+                response = _micros(start, Clock::now());
             }
             else
             {
                 LOG_WARN("No response for Agent [ %u ], session [ %u ]", prompt.agentId, prompt.agentSession);
             }
 
-            mListSessions.erase(mListSessions.begin());
+            // The canceled and failed prompts would distort the statistics.
+            if ((prompt.canceled == false) && (reply->isEmpty() == false))
+            {
+                reportLatency(prompt, stats, response);
+                // The reply truncated by the failure is not cached, the reply of other model is cached with the model that replied.
+                if (prompt.cacheable && stats.completed && (evData.modelName.isEmpty() == false))
+                {
+                    prompt.profile.model = evData.modelName;
+                    mReplyCache.store(prompt.profile, prompt.prompt, reply);
+                }
+            }
+
+            mListSessions.erase(pos);
+            mDispatched -= (mDispatched != 0u ? 1u : 0u);
             setQueueSize(static_cast<uint32_t>(mListSessions.size()));
             emit signalQueueSize(static_cast<uint32_t>(mListSessions.size()));
-            if (!mListSessions.empty())
+            dispatchPrompts();
+            if (mListSessions.empty())
             {
-                const sTextPrompt& nextPrompt = mListSessions.front();
-                LOG_DBG("Processing next text prompt in the queue, Agent [ %u ], session [ %u ], current queue size [ %u ]"
-                    , nextPrompt.agentId
-                    , nextPrompt.agentSession
-                    , static_cast<uint32_t>(mListSessions.size()));
-
-                ASSERT(mWorkerThread != nullptr);
-                ASSERT(mWorkerThread->isRunning());
-                AgentProcessorEvent::sendEvent(AgentProcessorEventData(AgentProcessorEventData::eAction::ActionProcessText, nextPrompt.sessionId, nextPrompt.prompt), *mWorkerThread);
+                LOG_INFO("No more text prompts in the queue, agent state set to Ready");
+            }
+        }
+        else
+        {
+            LOG_WARN("Received reply of unknown session [ %u ], ignoring", sessionId);
+        }
+    }
+    break;
+
+    case AgentProcessorEventData::eAction::ActionReplyFragment:
+    {
+        const AgentProcessorEventData::sText& evData = data.getPayload<AgentProcessorEventData::eAction::ActionReplyFragment>();
+        const String& fragment = evData.text;
+
+        ListSession::iterator pos = mListSessions.find(evData.sessionId);
+        if ((pos != mListSessions.end()) && (pos->second.canceled == false))
+        {
+            sTextPrompt& prompt = pos->second;
+            if (prompt.hasToken == false)
+            {
+                prompt.firstToken   = Clock::now();
+                prompt.hasToken     = true;
+            }
+
+            prompt.streamed += fragment;
+            streamFragment(prompt, false);
+        }
+    }
+    break;
+
+    case AgentProcessorEventData::eAction::ActionReplyEmbedding:
+    {
+        const AgentProcessorEventData::sEmbedding& evData = data.getPayload<AgentProcessorEventData::eAction::ActionReplyEmbedding>();
+        const uint32_t sessionId{ evData.sessionId };
+        const SharedBuffer& embedding = evData.embedding;
+
+        ListEmbeddings::iterator pos = mListEmbeddings.find(sessionId);
+        if (pos != mListEmbeddings.end())
+        {
+            // The vector is sent as the raw floats, the dimension is the number of values.
+            const uint32_t dimension{ static_cast<uint32_t>(embedding.getSizeUsed() / sizeof(float)) };
+            LOG_DBG("Computed embedding of Agent [ %u ], session [ %u ], dimension [ %u ]", pos->second.agentId, pos->second.agentSession, dimension);
+            if (prepareResponse(sessionId))
+            {
+                responseComputeEmbedding(pos->second.agentSession, pos->second.agentId, dimension, embedding);
             }
             else
             {
-                mAgentState = eAgentState::StateReady;
-                LOG_INFO("No more text prompts in the queue, agent state set to Ready");
+                LOG_WARN("No response for Agent [ %u ], session [ %u ]", pos->second.agentId, pos->second.agentSession);
             }
+
+            mListEmbeddings.erase(pos);
+        }
+        else
+        {
+            LOG_WARN("Received embedding of unknown session [ %u ], ignoring", sessionId);
         }
     }
     break;
 
     case AgentProcessorEventData::eAction::ActionModelActivated:
     {
-        String path;
-        data.getData() >> path;
+        const String& path = data.getPayload<AgentProcessorEventData::eAction::ActionModelActivated>().modelPath;
         QString modelPath(QString::fromStdString(path.getData()));
         if (modelPath.isEmpty() == false)
         {
             QFileInfo fi(modelPath);
             QString fileName(fi.fileName());
             setActiveModel(fileName.toStdString());
+            publishModels(modelPath);
+            // The vocabularies of the previous directory are not valid anymore, the active one is needed first.
+            mActivePath = path;
+            mTokenizer.clear();
+            mVocabPaths.clear();
+            loadVocab(String(fileName.toStdString()));
+            // The replies of the previous model are not valid anymore.
+            invalidateReplies(true);
+            // The latency of the previous model is not relevant anymore.
+            mStatistics.clear();
+            setTextLatency(NEMultiEdge::sTextLatency());
             emit signalActiveModelChanged(fileName);
         }
+
+        if (mWorkerThread != nullptr)
+        {
+            // The draft is activated after the target model to check the vocabulary.
+            AgentProcessorEvent::sendEvent(AgentProcessorEventData::create<AgentProcessorEventData::eAction::ActionActivateDraft>(mHost->getDraftModelPath())
+                                           , *mWorkerThread
+                                           , Event::eEventPriority::EventPriorityHigh);
+            // The semantic cache computes the embeddings by the active model, if no dedicated model is set.
+            AgentProcessorEvent::sendEvent(AgentProcessorEventData::create<AgentProcessorEventData::eAction::ActionActivateEmbedder>(mHost->getSimilarity(), mHost->getEmbedModelPath())
+                                           , *mWorkerThread
+                                           , Event::eEventPriority::EventPriorityHigh);
+        }
+    }
+    break;
+
+    case AgentProcessorEventData::eAction::ActionModelFailed:
+    {
+        // The active model, the draft and the embedding model remain as they are.
+        const String& path = data.getPayload<AgentProcessorEventData::eAction::ActionModelFailed>().modelPath;
+        LOG_ERR("Failed to activate model [ %s ], the model [ %s ] remains active", path.getString(), mActivePath.isEmpty() ? "none" : mActivePath.getString());
+        emit signalActiveModelFailed(QString::fromStdString(path.getData()));
+    }
+    break;
+
+    case AgentProcessorEventData::eAction::ActionLoadResident:
+    {
+        if (mLoaderThread != nullptr)
+        {
+            // The model routed by the edge device is loaded while the worker decodes the other models.
+            // The forwarded event shares the payload of the received one.
+            AgentProcessorEvent::sendEvent(data
+                                           , *mLoaderThread
+                                           , Event::eEventPriority::EventPriorityHigh);
+        }
+        else if (mWorkerThread != nullptr)
+        {
+            const String& path = data.getPayload<AgentProcessorEventData::eAction::ActionLoadResident>().modelPath;
+            AgentProcessorEvent::sendEvent(AgentProcessorEventData::create<AgentProcessorEventData::eAction::ActionResidentLoaded>(path, nullptr)
+                                           , *mWorkerThread
+                                           , Event::eEventPriority::EventPriorityHigh);
+        }
+    }
+    break;
+
+    case AgentProcessorEventData::eAction::ActionModelLoaded:
+    case AgentProcessorEventData::eAction::ActionResidentLoaded:
+    {
+        if (mWorkerThread != nullptr)
+        {
+            // The processor switches the models between the requests or makes the model resident.
+            // The forwarded event shares the payload, the model is owned by the worker.
+            AgentProcessorEvent::sendEvent(data
+                                           , *mWorkerThread
+                                           , Event::eEventPriority::EventPriorityHigh);
+        }
+        else
+        {
+            const AgentProcessorEventData::sModel& evData = (data.getAction() == AgentProcessorEventData::eAction::ActionModelLoaded)
+                                                          ? data.getPayload<AgentProcessorEventData::eAction::ActionModelLoaded>()
+                                                          : data.getPayload<AgentProcessorEventData::eAction::ActionResidentLoaded>();
+            if (evData.model != nullptr)
+            {
+                LOG_WARN("The service is stopped, releasing loaded model [ %s ]", evData.modelPath.getString());
+                llama_model_free(evData.model);
+            }
+        }
+    }
+    break;
+
+    case AgentProcessorEventData::eAction::ActionVocabLoaded:
+    {
+        const AgentProcessorEventData::sModel& evData = data.getPayload<AgentProcessorEventData::eAction::ActionVocabLoaded>();
+        const String& path = evData.modelPath;
+        llama_model* vocab = evData.model;
+        std::vector<String>::iterator pos = std::find(mVocabPaths.begin(), mVocabPaths.end(), path);
+        if (pos == mVocabPaths.end())
+        {
+            // The other model is activated while loading.
+            if (vocab != nullptr)
+            {
+                llama_model_free(vocab);
+            }
+        }
+        else if (vocab != nullptr)
+        {
+            LOG_DBG("Loaded vocabulary of model [ %s ], the prompts are tokenized before dispatching", path.getString());
+            mVocabPaths.erase(pos);
+            mTokenizer.addVocab(String(QFileInfo(QString::fromUtf8(path.getString())).fileName().toStdString()), vocab);
+        }
+        else
+        {
+            LOG_WARN("Failed to load vocabulary of model [ %s ], the prompts are tokenized by the worker thread", path.getString());
+        }
+    }
+    break;
+
+    case AgentProcessorEventData::eAction::ActionTemperature:
+    {
+        const AgentProcessorEventData::sSampling& evData = data.getPayload<AgentProcessorEventData::eAction::ActionTemperature>();
+        // The sampling is clamped the same way as by the worker thread, the cached replies of other profile are not found.
+        mProfile.temperature = std::clamp(evData.temperature, AgentProcessor::MIN_TEMPERATURE, AgentProcessor::MAX_TEMPERATURE);
+        mProfile.probability = std::clamp(evData.probability, AgentProcessor::MIN_PROBABILITY, AgentProcessor::MAX_PROBABILITY);
+        invalidateReplies(false);
+    }
+    break;
+
+    case AgentProcessorEventData::eAction::ActionSetPolicy:
+    {
+        const uint32_t policy{ data.getPayload<AgentProcessorEventData::eAction::ActionSetPolicy>().policy };
+        if (static_cast<AgentScheduler::ePolicy>(policy) != mScheduler.getPolicy())
+        {
+            reportQueueWait();
+            LOG_INFO("Changing scheduling policy from [ %s ] to [ %s ]"
+                        , AgentScheduler::getString(mScheduler.getPolicy())
+                        , AgentScheduler::getString(static_cast<AgentScheduler::ePolicy>(policy)));
+            mScheduler.setPolicy(static_cast<AgentScheduler::ePolicy>(policy));
+            reportQueueWait();
+        }
     }
     break;
 
@@ -237,6 +648,277 @@ void AgentProvider::processEvent(const AgentProcessorEventData& data)
     }
 }
 
+void AgentProvider::dispatchPrompts(void)
+{
+    bool dispatched{ false };
+    uint32_t key{ 0u };
+    while ((mDispatched < MAX_DISPATCHED) && (mWorkerThread != nullptr) && mScheduler.pop(key))
+    {
+        ListSession::iterator pos = mListSessions.find(key);
+        if (pos == mListSessions.end())
+            continue;
+
+        sTextPrompt& prompt = pos->second;
+        LOG_DBG("Dispatching text prompt to the worker, Agent [ %u ], session [ %u ], prompts in progress [ %u ]"
+            , prompt.agentId
+            , prompt.agentSession
+            , mDispatched);
+
+        ASSERT(mWorkerThread->isRunning());
+        ASSERT(prompt.dispatched == false);
+        prompt.dispatched = true;
+        prompt.sent = Clock::now();
+        dispatched = true;
+        ++ mDispatched;
+        // The tokens are moved to the event, the prompt in progress does not need them.
+        AgentProcessorEvent::sendEvent(AgentProcessorEventData::create<AgentProcessorEventData::eAction::ActionProcessText>(prompt.sessionId, AgentEngine::makeConversation(prompt.agentId, prompt.conversationId)
+                                                              , prompt.modelName, prompt.adapterName, prompt.prompt, prompt.vocabName, std::move(prompt.tokens))
+                                       , *mWorkerThread);
+    }
+
+    if (dispatched)
+    {
+        reportQueueWait();
+    }
+
+    mAgentState = (mDispatched != 0u) ? eAgentState::StateBusy : eAgentState::StateReady;
+}
+
+AgentProvider::ListSession::iterator AgentProvider::cancelPrompt(ListSession::iterator pos)
+{
+    sTextPrompt& prompt = pos->second;
+    if (prompt.dispatched)
+    {
+        // The worker replies the text generated so far, the entry is removed on reply.
+        prompt.canceled = true;
+        if (mWorkerThread != nullptr)
+        {
+            AgentProcessorEvent::sendEvent( AgentProcessorEventData::create<AgentProcessorEventData::eAction::ActionCancelText>(static_cast<uint32_t>(prompt.sessionId))
+                                          , *mWorkerThread
+                                          , Event::eEventPriority::EventPriorityHigh);
+        }
+
+        return (++ pos);
+    }
+
+    mScheduler.remove(prompt.sessionId);
+    streamFragment(prompt, true);
+    emit signalTextProcessed(prompt.sessionId, prompt.agentSession, prompt.agentId, NEAgentText::emptyText(), DateTime::getNow());
+    if (prepareResponse(prompt.sessionId))
+    {
+        responseProcessText(prompt.agentSession, prompt.agentId, String(), NEMultiEdge::eTextResult::TextCanceled);
+    }
+
+    pos = mListSessions.erase(pos);
+    setQueueSize(static_cast<uint32_t>(mListSessions.size()));
+    emit signalQueueSize(static_cast<uint32_t>(mListSessions.size()));
+    return pos;
+}
+
+void AgentProvider::streamFragment(sTextPrompt& prompt, bool isFinal)
+{
+    if (prompt.streaming && (isFinal || (prompt.streamed.isEmpty() == false)))
+    {
+        prompt.streaming = false;
+        if (prepareResponse(prompt.stream))
+        {
+            responseStreamText(prompt.agentSession, prompt.agentId, prompt.fragments ++, prompt.streamed, isFinal);
+        }
+
+        prompt.streamed.clear();
+    }
+}
+
+void AgentProvider::abortCanceled(void)
+{
+    // The decoding step decodes all prompts in progress together, it is aborted only if nobody waits for any of them.
+    if ((mDispatched != 0u) && std::none_of(mListSessions.begin(), mListSessions.end(), [](const ListSession::value_type& entry) { return entry.second.dispatched && (entry.second.canceled == false); }))
+    {
+        LOG_DBG("All [ %u ] prompts in progress are canceled, aborting decoding", mDispatched);
+        mAgentProcessor.abortDecode();
+    }
+}
+
+void AgentProvider::reportQueueWait(void)
+{
+    LOG_SCOPE(multiedge_aiagent_AgentProvider_reportQueueWait);
+    const AgentScheduler::sWaitStats stats{ mScheduler.getWaitStats(mScheduler.getPolicy()) };
+    LOG_DBG("Queue wait of [ %s ] policy, [ %u ] prompts, p50 [ %llu ] us, p99 [ %llu ] us"
+                , AgentScheduler::getString(mScheduler.getPolicy())
+                , stats.count
+                , static_cast<unsigned long long>(stats.p50)
+                , static_cast<unsigned long long>(stats.p99));
+
+    emit signalQueueWait(stats.p50, stats.p99);
+}
+
+bool AgentProvider::replyCached(sTextPrompt& prompt)
+{
+    // The reply of the conversation depends on the previous turns, only the greedy sampling replies the same text.
+    if ((prompt.conversationId != 0u) || (mProfile.temperature > 0.0f) || (mReplyCache.isEnabled() == false))
+        return false;
+
+    prompt.cacheable        = true;
+    prompt.profile          = mProfile;
+    // The text of the model, which is not available, is processed by the active model.
+    prompt.profile.model    = (prompt.modelName.isEmpty() || (getAvailableModels().contains(prompt.modelName) == false) ? getActiveModel() : prompt.modelName);
+    prompt.profile.adapter  = prompt.adapterName;
+
+    SharedText reply;
+    if (mReplyCache.find(prompt.profile, *prompt.prompt, reply) == false)
+        return false;
+
+    LOG_SCOPE(multiedge_aiagent_AgentProvider_replyCached);
+    LOG_DBG("Replying Agent [ %u ], session [ %u ] from the cache, hits [ %llu ], misses [ %llu ]"
+                , prompt.agentId
+                , prompt.agentSession
+                , static_cast<unsigned long long>(mReplyCache.getHits())
+                , static_cast<unsigned long long>(mReplyCache.getMisses()));
+
+    // The cached reply is not streamed, the request to stream it is replied by the final marker.
+    emit signalTextRequested(prompt.sessionId, prompt.agentSession, prompt.agentId, prompt.prompt, DateTime::getNow());
+    emit signalTextProcessed(prompt.sessionId, prompt.agentSession, prompt.agentId, reply, DateTime::getNow());
+    if (prepareResponse(prompt.sessionId))
+    {
+        responseProcessText(prompt.agentSession, prompt.agentId, *reply, NEMultiEdge::eTextResult::TextCompleted);
+    }
+
+    return true;
+}
+
+void AgentProvider::invalidateReplies(bool clearCache)
+{
+    for (ListSession::value_type& entry : mListSessions)
+    {
+        entry.second.cacheable = false;
+    }
+
+    if (clearCache)
+    {
+        LOG_INFO("Clearing [ %u ] cached replies, hits [ %llu ], misses [ %llu ]"
+                    , mReplyCache.getSize()
+                    , static_cast<unsigned long long>(mReplyCache.getHits())
+                    , static_cast<unsigned long long>(mReplyCache.getMisses()));
+        mReplyCache.clear();
+    }
+}
+
+void AgentProvider::reportLatency(const sTextPrompt& prompt, const IEAgentEngineListener::sTextStats& stats, uint64_t response)
+{
+    LOG_SCOPE(multiedge_aiagent_AgentProvider_reportLatency);
+
+    const Clock::time_point now{ Clock::now() };
+    AgentStatistics::sSample sample;
+    sample.phases[AgentStatistics::PhaseQueue]      = _micros(prompt.received, prompt.sent) + stats.waitTime;
+    sample.phases[AgentStatistics::PhaseTokenize]   = stats.tokenizeTime;
+    sample.phases[AgentStatistics::PhasePrefill]    = stats.prefillTime;
+    sample.phases[AgentStatistics::PhaseFirstToken] = _micros(prompt.received, prompt.hasToken ? prompt.firstToken : now);
+    sample.phases[AgentStatistics::PhaseDecode]     = stats.decodeTime;
+    sample.phases[AgentStatistics::PhaseResponse]   = response;
+    sample.prefillTokens= stats.promptTokens - stats.cachedTokens;
+    // The first token is sampled at the end of the prefill.
+    sample.decodeTokens = (stats.generatedTokens > 1u ? stats.generatedTokens - 1u : 0u);
+    sample.draftTokens  = stats.draftTokens;
+    sample.acceptTokens = stats.acceptedTokens;
+    mStatistics.addSample(sample);
+
+    LOG_DBG("Latency of Agent [ %u ], session [ %u ] in us: queue [ %llu ], tokenize [ %llu ], prefill [ %llu ], first token [ %llu ], decode [ %llu ], response [ %llu ], tokens [ %u / %u ], accepted [ %u / %u ]"
+                , prompt.agentId
+                , prompt.agentSession
+                , static_cast<unsigned long long>(sample.phases[AgentStatistics::PhaseQueue])
+                , static_cast<unsigned long long>(sample.phases[AgentStatistics::PhaseTokenize])
+                , static_cast<unsigned long long>(sample.phases[AgentStatistics::PhasePrefill])
+                , static_cast<unsigned long long>(sample.phases[AgentStatistics::PhaseFirstToken])
+                , static_cast<unsigned long long>(sample.phases[AgentStatistics::PhaseDecode])
+                , static_cast<unsigned long long>(sample.phases[AgentStatistics::PhaseResponse])
+                , stats.promptTokens
+                , stats.generatedTokens
+                , stats.acceptedTokens
+                , stats.draftTokens);
+
+    if ((now - mPublished) >= PUBLISH_INTERVAL)
+    {
+        mPublished = now;
+        const NEMultiEdge::sTextLatency latency{ mStatistics.getLatency() };
+        LOG_INFO("Latency of [ %u ] texts, p50 / p99 in ms: queue [ %u / %u ], first token [ %u / %u ], decode [ %u / %u ], prefill [ %u ] tok/s, decode [ %u ] tok/s, accepted [ %u / %u ] tokens"
+                    , latency.texts
+                    , latency.queueWait.median / 1000u , latency.queueWait.tail / 1000u
+                    , latency.firstToken.median / 1000u, latency.firstToken.tail / 1000u
+                    , latency.decode.median / 1000u    , latency.decode.tail / 1000u
+                    , latency.prefillRate
+                    , latency.decodeRate
+                    , latency.acceptedTokens
+                    , latency.draftTokens);
+
+        setTextLatency(latency);
+    }
+}
+
+uint32_t AgentProvider::tokenizePrompt(sTextPrompt& prompt)
+{
+    const String name(prompt.modelName.isEmpty() ? getActiveModel() : prompt.modelName);
+    if (mTokenizer.tokenize(name, *prompt.prompt, prompt.tokens))
+    {
+        prompt.vocabName = name;
+        return static_cast<uint32_t>(prompt.tokens.size());
+    }
+
+    loadVocab(name);
+    return prompt.prompt->getLength() / BYTES_PER_TOKEN;
+}
+
+void AgentProvider::loadVocab(const String& name)
+{
+    if (name.isEmpty() || mActivePath.isEmpty() || (mLoaderThread == nullptr) || mTokenizer.hasVocab(name))
+        return;
+
+    // The worker thread routes the texts to the models in the directory of the active model.
+    const QString fileName(QString::fromUtf8(name.getString()));
+    const QFileInfo fi(QFileInfo(QString::fromUtf8(mActivePath.getString())).absoluteDir(), fileName);
+    if ((fi.fileName() != fileName) || (fi.isFile() == false))
+        return;
+
+    const String path(fi.absoluteFilePath().toStdString());
+    if (std::find(mVocabPaths.begin(), mVocabPaths.end(), path) != mVocabPaths.end())
+        return;
+
+    mVocabPaths.push_back(path);
+    AgentProcessorEvent::sendEvent(AgentProcessorEventData::create<AgentProcessorEventData::eAction::ActionLoadVocab>(path)
+                                   , *mLoaderThread
+                                   , Event::eEventPriority::EventPriorityHigh);
+}
+
+void AgentProvider::publishModels(const QString& modelPath)
+{
+    // The edge devices route the texts to the models next to the active one.
+    QDir dir(QFileInfo(modelPath).absoluteDir());
+    const QStringList files{ dir.entryList(QStringList{ QString::fromUtf8("*.gguf") }, QDir::Files | QDir::Readable, QDir::Name | QDir::IgnoreCase) };
+    NEMultiEdge::ModelList models;
+    for (const QString& file : files)
+    {
+        models.add(String(file.toStdString()));
+    }
+
+    LOG_DBG("Publishing [ %u ] available models of directory [ %s ]", static_cast<uint32_t>(files.size()), dir.absolutePath().toStdString().c_str());
+    setAvailableModels(models);
+
+    // The adapters of the active model are loaded by the worker thread from the same directory.
+    const QFileInfo model(modelPath);
+    QDir lora(dir.filePath(model.completeBaseName() + QString::fromUtf8(NEMultiEdgeSettings::ADAPTER_SUFFIX.data())));
+    NEMultiEdge::ModelList adapters;
+    if (lora.exists())
+    {
+        const QStringList names{ lora.entryList(QStringList{ QString::fromUtf8("*.gguf") }, QDir::Files | QDir::Readable, QDir::Name | QDir::IgnoreCase) };
+        for (const QString& name : names)
+        {
+            adapters.add(String(name.toStdString()));
+        }
+    }
+
+    LOG_DBG("Publishing [ %u ] available adapters of model [ %s ]", adapters.getSize(), model.fileName().toStdString().c_str());
+    setAvailableAdapters(adapters);
+}
+
 inline AgentProvider& AgentProvider::self(void)
 {
     return *this;
@@ -248,24 +930,44 @@ inline void AgentProvider::_activateModel(const QString& modelPath)
         return;
     
     ASSERT(mWorkerThread->isReady());
-    ASSERT(mAIAgent != nullptr);
+    ASSERT(mHost != nullptr);
     String model(modelPath.toStdString());
-    float temperature = mAIAgent->getTemperature();
-    float probability = mAIAgent->getProbability();
-    uint32_t length = mAIAgent->getTextLength();
-    uint32_t batch  = mAIAgent->getBatching();
-    uint32_t token  = mAIAgent->getTokens();
-    uint32_t thread = mAIAgent->getThreads();
+    float temperature = mHost->getTemperature();
+    float probability = mHost->getProbability();
+    bool  lookup      = mHost->getPromptLookup();
+    uint32_t length = mHost->getTextLength();
+    uint32_t batch  = mHost->getBatching();
+    uint32_t token  = mHost->getTokens();
+    uint32_t thread = mHost->getThreads();
+    uint32_t cache  = mHost->getCacheSize();
+    uint32_t session= mHost->getSessionSize();
+    uint32_t context= mHost->getContextSize();
+    uint32_t cacheK = static_cast<uint32_t>(mHost->getCacheTypeK());
+    uint32_t cacheV = static_cast<uint32_t>(mHost->getCacheTypeV());
+    uint32_t flash  = static_cast<uint32_t>(mHost->getFlashAttention());
+    uint32_t models = mHost->getModelsSize();
+
+    // The replies depend on the sampling and on the limits, the worker clamps them the same way.
+    mProfile.temperature= std::clamp(temperature, AgentProcessor::MIN_TEMPERATURE, AgentProcessor::MAX_TEMPERATURE);
+    mProfile.probability= std::clamp(probability, AgentProcessor::MIN_PROBABILITY, AgentProcessor::MAX_PROBABILITY);
+    mProfile.textLimit  = std::clamp(length, AgentProcessor::MIN_CHARS, AgentProcessor::MAX_CHARS);
+    mProfile.tokenLimit = std::clamp(token, AgentProcessor::MIN_TOKENS, AgentProcessor::MAX_TOKENS);
+    mReplyCache.setCapacity(std::clamp(mHost->getReplyCache(), AgentResponseCache::MIN_ENTRIES, AgentResponseCache::MAX_ENTRIES));
+    invalidateReplies(false);
     
-    AgentProcessorEvent::sendEvent(AgentProcessorEventData(AgentProcessorEventData::eAction::ActionActivateModel, model)
-                                   , *mWorkerThread
-                                   , Event::eEventPriority::EventPriorityHigh);
+    // The model is loaded in background, the active model serves the prompts until the switch.
+    if (mLoaderThread != nullptr)
+    {
+        AgentProcessorEvent::sendEvent(AgentProcessorEventData::create<AgentProcessorEventData::eAction::ActionActivateModel>(model)
+                                       , *mLoaderThread
+                                       , Event::eEventPriority::EventPriorityHigh);
+    }
     
-    AgentProcessorEvent::sendEvent(AgentProcessorEventData(AgentProcessorEventData::eAction::ActionTemperature, temperature, probability)
+    AgentProcessorEvent::sendEvent(AgentProcessorEventData::create<AgentProcessorEventData::eAction::ActionTemperature>(temperature, probability, lookup)
                                    , *mWorkerThread
                                    , Event::eEventPriority::EventPriorityHigh);
     
-    AgentProcessorEvent::sendEvent(AgentProcessorEventData(AgentProcessorEventData::eAction::ActionSetLimits, length, token, batch, thread)
+    AgentProcessorEvent::sendEvent(AgentProcessorEventData::create<AgentProcessorEventData::eAction::ActionSetLimits>(length, token, batch, thread, cache, session, context, cacheK, cacheV, flash, models)
                                    , *mWorkerThread
                                    , Event::eEventPriority::EventPriorityHigh);
 }
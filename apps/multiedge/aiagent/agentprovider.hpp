@@ -25,9 +25,19 @@
 #include "areg/component/Component.hpp"
 #include "multiedge/resources/MultiEdgeStub.hpp"
 #include <QObject>
+#include "multiedge/aiagent/agenthost.hpp"
+#include "multiedge/aiagent/agentloader.hpp"
 #include "multiedge/aiagent/agentprocessor.hpp"
+#include "multiedge/aiagent/agentresponsecache.hpp"
+#include "multiedge/aiagent/agentscheduler.hpp"
+#include "multiedge/aiagent/agentstatistics.hpp"
+#include "multiedge/aiagent/agenttext.hpp"
+#include "multiedge/aiagent/agenttokenizer.hpp"
 
-class AIAgent;
+#include <chrono>
+
+#include <unordered_map>
+#include <vector>
 
 class AgentProvider : public QObject
                     , public Component
@@ -37,21 +47,59 @@ class AgentProvider : public QObject
     Q_OBJECT
 
 private:
+    using Clock = std::chrono::steady_clock;
+
     struct sTextPrompt
     {
         SessionID   sessionId{ 0 };
         uint32_t    agentSession{0};
         uint32_t    agentId{0};
-        String      prompt{};
+        uint32_t    conversationId{0};
+        String      modelName{};                //!< The name of the model to process the text, empty for the active model.
+        String      adapterName{};              //!< The name of the LoRA adapter to process the text, empty for none.
+        SharedText  prompt{};                   //!< The text of the prompt, copied once from the request and shared by the threads.
+        bool        dispatched{false};
+        uint32_t    fragments{0};
+        ProxyAddress source{};
+        bool        canceled{false};
+        Clock::time_point   received{};     //!< The time the request is received.
+        Clock::time_point   sent{};         //!< The time the prompt is sent to the worker thread.
+        Clock::time_point   firstToken{};   //!< The time the first piece of the reply is received.
+        bool                hasToken{false};//!< Flag, indicating that the first piece of the reply is received.
+        bool                cacheable{false};//!< Flag, indicating that the reply is cached when received.
+        AgentResponseCache::sProfile profile{}; //!< The profile of processing the prompt to cache the reply.
+        String              vocabName{};    //!< The name of the model, which vocabulary tokenized the prompt, empty if not tokenized.
+        std::vector<llama_token> tokens{};  //!< The tokens of the prompt until it is sent to the worker thread.
+        String              streamed{};     //!< The text of the reply generated since the last fragment sent to the edge device.
+        SessionID           stream{ 0 };    //!< The request of the edge device to stream the next fragment.
+        bool                streaming{false};//!< Flag, indicating that the edge device waits for the next fragment.
     };
 
-    using ListSession = std::vector<sTextPrompt>;
+    //!< The prompts in the queue and in progress. The order of dispatching is set by the scheduler.
+    using ListSession = std::unordered_map<SessionID, sTextPrompt>;
+
+    //!< The request to compute the embedding of the text.
+    struct sEmbedRequest
+    {
+        uint32_t    agentSession{0};        //!< The ID of the session set by the edge device.
+        uint32_t    agentId{0};             //!< The ID of the edge device.
+    };
+
+    //!< The requests to compute the embeddings waiting for the reply of the worker thread.
+    using ListEmbeddings = std::unordered_map<SessionID, sEmbedRequest>;
 
     enum eAgentState
     {
           StateReady
         , StateBusy
     };
+
+    //!< The maximum number of prompts decoded by the worker thread in one batch.
+    static constexpr uint32_t   MAX_DISPATCHED  { AgentEngine::DEF_SEQUENCES };
+    //!< The minimum interval to update the latency attribute, so that the devices are not flooded with updates.
+    static constexpr std::chrono::seconds   PUBLISH_INTERVAL{ 1 };
+    //!< The average number of bytes of the text per token to estimate the cost of the prompt.
+    static constexpr uint32_t   BYTES_PER_TOKEN { 4u };
 //////////////////////////////////////////////////////////////////////////
 // Internal types, constants and static methods
 //////////////////////////////////////////////////////////////////////////
@@ -66,12 +114,32 @@ public:
      **/
     static void activateModel(const QString & modelPath);
 
+    /**
+     * \brief   Activates or switches the draft model of the speculative decoding.
+     * \param   draftPath   File system path of the draft model. Empty to disable the speculation.
+     **/
+    static void activateDraft(const QString & draftPath);
+
+    /**
+     * \brief   Activates or switches the embedding model of the semantic cache.
+     * \param   embedPath   File system path of the embedding model. Empty to use the active model.
+     * \param   similarity  The minimum similarity of the prompts in percent. Zero disables the semantic cache.
+     **/
+    static void activateEmbedder(const QString & embedPath, uint32_t similarity);
+
     /**
      * \brief   Sets the temperature parameter for the AI model.
      * \param   newTemp     The new temperature value to set.
      * \param   newMinP     The new minimum probability value to set.
+     * \param   lookup      The flag to speculate the tokens of the next prompts by the prompt lookup.
      **/
-    static void setTemperature(float newTemp, float newMinP);
+    static void setTemperature(float newTemp, float newMinP, bool lookup);
+
+    /**
+     * \brief   Sets the policy to schedule the queued text prompts.
+     * \param   policy      The scheduling policy to set.
+     **/
+    static void setSchedulingPolicy(AgentScheduler::ePolicy policy);
     
 public:
     AgentProvider(const NERegistry::ComponentEntry& entry, ComponentThread& owner);
@@ -86,11 +154,15 @@ public:
      * \brief   Request call.
      *          The request sent by edge device to process the text.
      * \param   sessionId   A unique ID of the session to distinguish the requests. The ID is sent back by the response.
-     * \param   agentId     The ID of edge device. It is sent back to the edge device to confirm target device that the request is processed.
-     * \param   textProcess The text to process.
+     * \param   agentId         The ID of edge device. It is sent back to the edge device to confirm target device that the request is processed.
+     * \param   conversationId  The ID of the conversation set by the edge device. The Edge AI keeps the context of the conversation of the edge device, so that only the new text is processed. Zero if the text has no conversation context.
+     * \param   priority        The priority class of the text. Within the class the Edge AI shares the processing fairly between the edge devices.
+     * \param   modelName       The name of the model to process the text, one of the AvailableModels. Empty to process the text by the active model.
+     * \param   adapterName     The name of the LoRA adapter of the model to process the text, one of the AvailableAdapters. Empty to process the text by the model without adapter.
+     * \param   textProcess     The text to process.
      * \see     responseProcessText
      **/
-    virtual void requestProcessText(unsigned int sessionId, unsigned int agentId, const String& textProcess) override;
+    virtual void requestProcessText(unsigned int sessionId, unsigned int agentId, unsigned int conversationId, NEMultiEdge::eTextPriority priority, const String& modelName, const String& adapterName, const String& textProcess) override;
 
     /**
      * \brief   Request call.
@@ -103,6 +175,34 @@ public:
      **/
     virtual void requestProcessVideo(unsigned int sessionId, bool agentId, const String& cmdText, const SharedBuffer& dataVideo) override;
 
+    /**
+     * \brief   Request call.
+     *          The request sent by edge device to cancel the processing of the text. The Edge AI stops generating the text and replies the text generated so far.
+     * \param   sessionId   The ID of the session set by the edge device in the request to process the text.
+     * \param   agentId     The ID of edge device set in the request to process the text.
+     **/
+    virtual void requestCancelText(unsigned int sessionId, unsigned int agentId) override;
+
+    /**
+     * \brief   Request call.
+     *          The request sent by edge device to receive the next fragment of the reply of the text it requested to process.
+     *          Replied when the next text is generated, only to the edge device, which sent the prompt.
+     * \param   sessionId   The ID of the session set by the edge device in the request to process the text.
+     * \param   agentId     The ID of edge device set in the request to process the text.
+     * \see     responseStreamText
+     **/
+    virtual void requestStreamText(unsigned int sessionId, unsigned int agentId) override;
+
+    /**
+     * \brief   Request call.
+     *          The request sent by edge device to compute the sentence embedding of the text, for example, to search the texts by meaning. The queued requests are computed in one batch.
+     * \param   sessionId   A unique ID of the session to distinguish the requests. The ID is sent back by the response.
+     * \param   agentId     The ID of edge device. It is sent back to the edge device to confirm target device that the request is processed.
+     * \param   textEmbed   The text to compute the embedding. The long texts are truncated.
+     * \see     responseComputeEmbedding
+     **/
+    virtual void requestComputeEmbedding(unsigned int sessionId, unsigned int agentId, const String& textEmbed) override;
+
 protected:
 
     /**
@@ -153,6 +253,22 @@ protected:
      **/
     virtual void shutdownServiceInterface ( Component & holder ) override;
 
+    /**
+     * \brief   Triggered when the proxy client either connected or disconnected to stub.
+     *          The text prompts of the disconnected client are canceled.
+     * \param   client              The address of proxy client, which connection status is changed.
+     * \param   connectionStatus    The connection status of the client.
+     * \return  Returns true if connected service is the client of the stub.
+     **/
+    virtual bool clientConnected( const ProxyAddress & client, NEService::eServiceConnection connectionStatus ) override;
+
+    /**
+     * \brief   Triggered to process the request event. Saves the address of the source
+     *          proxy of the request to cancel its prompts when the proxy disconnects.
+     * \param   eventElem   The request event to process.
+     **/
+    virtual void processRequestEvent( ServiceRequestEvent & eventElem ) override;
+
 signals:
     
     void signalServiceStarted(bool isStarted);
@@ -160,25 +276,124 @@ signals:
     void signalEdgeAgent(NEMultiEdge::eEdgeAgent newValue);
     
     void signalActiveModelChanged(QString modelName);
+
+    //!< The model failed to load, the previously active model remains active.
+    void signalActiveModelFailed(QString modelPath);
     
     void signalQueueSize(uint32_t queueSize);
 
-    void signalTextRequested(uint32_t sessionId, uint32_t seqId, uint32_t id, QString question, uint64_t stamp);
+    //!< The text is shared with the provider, the receiver converts it only to display.
+    void signalTextRequested(uint32_t sessionId, uint32_t seqId, uint32_t id, SharedText question, uint64_t stamp);
+
+    //!< The text is shared with the provider, the receiver converts it only to display.
+    void signalTextProcessed(uint32_t sessionId, uint32_t seqId, uint32_t id, SharedText reply, uint64_t stamp);
 
-    void signalTextProcessed(uint32_t sessionId, uint32_t seqId, uint32_t id, QString reply, uint64_t stamp);
+    void signalQueueWait(uint64_t waitMedian, uint64_t waitTail);
 
 private:
 
     inline AgentProvider& self(void);
     
     inline void _activateModel(const QString& modelPath);
+
+    /**
+     * \brief   Publishes the model files in the directory of the active model as the available models
+     *          and the adapter files of the active model as the available adapters.
+     * \param   modelPath   The path of the active model file.
+     **/
+    void publishModels(const QString& modelPath);
+
+    /**
+     * \brief   Sends the queued prompts to the worker thread in the order of the scheduler,
+     *          as long as the number of prompts in progress is less than the batch capacity.
+     **/
+    void dispatchPrompts(void);
+
+    /**
+     * \brief   Cancels the text prompt. The queued prompt is removed and replied,
+     *          the prompt in progress is canceled by the worker thread.
+     * \param   pos     The position of the prompt to cancel.
+     * \return  Returns the position of the next prompt.
+     **/
+    ListSession::iterator cancelPrompt(ListSession::iterator pos);
+
+    /**
+     * \brief   Sends the text generated since the last fragment to the edge device, if it waits for it.
+     *          The pieces generated while the edge device does not wait are joined to one fragment.
+     * \param   prompt      The prompt in progress.
+     * \param   isFinal     Flag, indicating the final marker of the stream.
+     **/
+    void streamFragment(sTextPrompt& prompt, bool isFinal);
+
+    //!< Aborts the running decoding step, if all prompts in progress are canceled.
+    //!< Should be called after marking the prompts in progress canceled and before sending the canceling to the worker,
+    //!< which resets the flag when processes the canceling.
+    void abortCanceled(void);
+
+    //!< Logs and notifies the queue wait statistics of the active scheduling policy.
+    void reportQueueWait(void);
+
+    /**
+     * \brief   Replies the stateless prompt processed with the greedy sampling from the cache,
+     *          without sending it to the worker thread. If not found, the prompt is marked
+     *          to cache the reply when received. The reply is searched with the active model,
+     *          if the requested model is not available.
+     * \param   prompt      The received prompt.
+     * \return  Returns true if the prompt is replied from the cache.
+     **/
+    bool replyCached(sTextPrompt& prompt);
+
+    /**
+     * \brief   The replies of the prompts in progress are not cached anymore, since the model
+     *          or the profile are changed while they are processed.
+     * \param   clearCache  Flag, indicating to remove the cached replies of the previous model.
+     **/
+    void invalidateReplies(bool clearCache);
+
+    /**
+     * \brief   Adds the latency of the processed prompt to the statistics, logs it and
+     *          updates the latency attribute if the publishing interval is elapsed.
+     * \param   prompt      The processed prompt.
+     * \param   stats       The statistics of processing the prompt reported by the engine.
+     * \param   response    The time to serialize and send the response in microseconds.
+     **/
+    void reportLatency(const sTextPrompt& prompt, const IEAgentEngineListener::sTextStats& stats, uint64_t response);
+
+    /**
+     * \brief   Tokenizes the prompt by the vocabulary of the model, which processes it, so that the worker
+     *          thread only decodes it. If the vocabulary is not loaded yet, it is loaded in background
+     *          and the worker thread tokenizes the prompt.
+     * \param   prompt      The received prompt.
+     * \return  Returns the number of tokens of the prompt, estimated by the length if not tokenized.
+     **/
+    uint32_t tokenizePrompt(sTextPrompt& prompt);
+
+    /**
+     * \brief   Requests the loader thread to load the vocabulary of the model, if it is not loaded
+     *          or requested yet. The model is searched in the directory of the active model.
+     * \param   name    The file name of the model.
+     **/
+    void loadVocab(const String& name);
     
 private:
-    AIAgent*        mAIAgent;
+    IEAgentHost*    mHost;
     eAgentState     mAgentState;
     ListSession     mListSessions;
+    ListEmbeddings  mListEmbeddings;
+    AgentTokenizer  mTokenizer;             //!< The tokenizer of the received prompts.
+    std::vector<String> mVocabPaths;        //!< The paths of the requested vocabularies, the failed ones are not requested again.
+    String          mActivePath;            //!< The path of the active model.
+    AgentScheduler  mScheduler;
+    AgentStatistics mStatistics;
+    AgentResponseCache mReplyCache;
+    AgentResponseCache::sProfile mProfile;  //!< The sampling and the limits of the processed prompts.
+    Clock::time_point mPublished;
+    uint32_t        mDispatched;
     WorkerThread*   mWorkerThread;
+    WorkerThread*   mLoaderThread;
+    ProxyAddress    mRequestSource;
     AgentProcessor  mAgentProcessor;
+    AgentLoader     mAgentLoader;
 };
 
 #endif // MULTIEDGE_AIAGENT_AGENTPROVIDER_HPP
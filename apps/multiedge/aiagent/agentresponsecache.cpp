@@ -0,0 +1,123 @@
+﻿/************************************************************************
+ * This file is part of the Areg Edge AI project powered by AREG SDK.
+ * The project contains multiple examples of using Edge AI based on Areg communication framework.
+ *
+ *  Areg Edge AI is available as free and open-source software under the MIT License.
+ *
+ *  For detailed licensing terms, please refer to the LICENSE file included
+ *  with this distribution or contact us at info[at]areg.tech.
+ *
+ *  \copyright   © 2025 Aregtech UG. All rights reserved.
+ *  \file        multiedge/aiagent/agentresponsecache.cpp
+ *  \ingroup     Areg Edge AI, AI Multi Edge Device Agent
+ *  \author      Artak Avetyan
+ *  \brief       Edge AI Agent cache of the replies of repeated prompts.
+ *
+ ************************************************************************/
+#include "multiedge/aiagent/agentresponsecache.hpp"
+
+namespace
+{
+    //!< The offset basis and the prime of the 64-bit FNV-1a hash.
+    constexpr uint64_t  FNV_OFFSET  { 14695981039346656037ull };
+    constexpr uint64_t  FNV_PRIME   { 1099511628211ull };
+
+    //!< Adds the bytes to the FNV-1a hash.
+    inline uint64_t _hash(uint64_t hash, const void* data, size_t length)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0u; i < length; ++ i)
+        {
+            hash = (hash ^ static_cast<uint64_t>(bytes[i])) * FNV_PRIME;
+        }
+
+        return hash;
+    }
+
+    //!< Adds the text with the terminating zero to the hash, so that the fields are separated.
+    inline uint64_t _hash(uint64_t hash, const String& text)
+    {
+        return _hash(hash, text.getString(), static_cast<size_t>(text.getLength()) + 1u);
+    }
+}
+
+AgentResponseCache::AgentResponseCache(void)
+    : mEntries  ( )
+    , mIndex    ( )
+    , mCapacity (DEF_ENTRIES)
+    , mHits     (0u)
+    , mMisses   (0u)
+{
+}
+
+void AgentResponseCache::setCapacity(uint32_t capacity)
+{
+    mCapacity = capacity;
+    _evict(mCapacity);
+}
+
+bool AgentResponseCache::find(const AgentResponseCache::sProfile& profile, const String& prompt, SharedText& reply)
+{
+    MapEntries::iterator pos = mIndex.find(_makeKey(profile, prompt));
+    if ((pos == mIndex.end()) || (_isEqual(*pos->second, profile, prompt) == false))
+    {
+        ++ mMisses;
+        return false;
+    }
+
+    mEntries.splice(mEntries.begin(), mEntries, pos->second);
+    reply = pos->second->reply;
+    ++ mHits;
+    return true;
+}
+
+void AgentResponseCache::store(const AgentResponseCache::sProfile& profile, const SharedText& prompt, const SharedText& reply)
+{
+    if (mCapacity == 0u)
+        return;
+
+    // The entry of the same key is replaced, either it is the same prompt or the rare collision.
+    const uint64_t key = _makeKey(profile, *prompt);
+    MapEntries::iterator pos = mIndex.find(key);
+    if (pos != mIndex.end())
+    {
+        mEntries.erase(pos->second);
+        mIndex.erase(pos);
+    }
+
+    _evict(mCapacity - 1u);
+    mEntries.push_front(sReplyEntry{ key, profile, prompt, reply });
+    mIndex[key] = mEntries.begin();
+}
+
+void AgentResponseCache::clear(void)
+{
+    mIndex.clear();
+    mEntries.clear();
+}
+
+uint64_t AgentResponseCache::_makeKey(const AgentResponseCache::sProfile& profile, const String& prompt)
+{
+    uint64_t hash{ FNV_OFFSET };
+    hash = _hash(hash, profile.model);
+    hash = _hash(hash, profile.adapter);
+    hash = _hash(hash, &profile.temperature, sizeof(profile.temperature));
+    hash = _hash(hash, &profile.probability, sizeof(profile.probability));
+    hash = _hash(hash, &profile.textLimit, sizeof(profile.textLimit));
+    hash = _hash(hash, &profile.tokenLimit, sizeof(profile.tokenLimit));
+    return _hash(hash, prompt);
+}
+
+bool AgentResponseCache::_isEqual(const AgentResponseCache::sReplyEntry& entry, const AgentResponseCache::sProfile& profile, const String& prompt)
+{
+    return (*entry.prompt == prompt) && (entry.profile == profile);
+}
+
+void AgentResponseCache::_evict(uint32_t capacity)
+{
+    while ((mEntries.size() > capacity) && (mEntries.empty() == false))
+    {
+        mIndex.erase(mEntries.back().key);
+        mEntries.pop_back();
+    }
+}
@@ -0,0 +1,205 @@
+﻿#ifndef MULTIEDGE_AIAGENT_AGENTRESPONSECACHE_HPP
+#define MULTIEDGE_AIAGENT_AGENTRESPONSECACHE_HPP
+/************************************************************************
+ * This file is part of the Areg Edge AI project powered by AREG SDK.
+ * The project contains multiple examples of using Edge AI based on Areg communication framework.
+ *
+ *  Areg Edge AI is available as free and open-source software under the MIT License.
+ *
+ *  For detailed licensing terms, please refer to the LICENSE file included
+ *  with this distribution or contact us at info[at]areg.tech.
+ *
+ *  \copyright   © 2025 Aregtech UG. All rights reserved.
+ *  \file        multiedge/aiagent/agentresponsecache.hpp
+ *  \ingroup     Areg Edge AI, AI Multi Edge Device Agent
+ *  \author      Artak Avetyan
+ *  \brief       Edge AI Agent cache of the replies of repeated prompts.
+ *
+ ************************************************************************/
+
+/************************************************************************
+ * Includes
+ ************************************************************************/
+
+#include "areg/base/GEGlobal.h"
+#include "areg/base/String.hpp"
+#include "multiedge/aiagent/agenttext.hpp"
+
+#include <list>
+#include <unordered_map>
+
+//////////////////////////////////////////////////////////////////////////
+// AgentResponseCache class declaration
+//////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief   The cache of the replies of the stateless prompts. The edge devices
+ *          often repeat the same questions, with the greedy sampling the model
+ *          replies them with the same text. The reply is found by the hash of the
+ *          model, the adapter, the sampling profile and the prompt, and is sent
+ *          without decoding. The number of cached replies is limited, the least
+ *          recently used replies are evicted. The replies are valid only for the
+ *          active model, the cache must be cleared when the model changes.
+ *          The cache is not thread safe.
+ **/
+class AgentResponseCache
+{
+//////////////////////////////////////////////////////////////////////////
+// Internal types and constants
+//////////////////////////////////////////////////////////////////////////
+public:
+    static constexpr uint32_t   MAX_ENTRIES { 4096u };  //!< The maximum number of cached replies.
+    static constexpr uint32_t   MIN_ENTRIES { 0u };     //!< The minimum number of cached replies, zero disables the cache.
+    static constexpr uint32_t   DEF_ENTRIES { 256u };   //!< The default number of cached replies.
+
+    //!< The parameters of processing the prompt, which decide the reply.
+    struct sProfile
+    {
+        String      model       { };        //!< The name of the model, which processes the prompt.
+        String      adapter     { };        //!< The name of the LoRA adapter, empty if none.
+        float       temperature { 0.0f };   //!< The sampling temperature.
+        float       probability { 0.0f };   //!< The min-p sampling probability.
+        uint32_t    textLimit   { 0u };     //!< The maximum length of the reply in characters.
+        uint32_t    tokenLimit  { 0u };     //!< The maximum number of tokens to generate per reply.
+
+        inline bool operator == (const sProfile& other) const;
+    };
+
+private:
+    //!< The cached reply of the prompt.
+    struct sReplyEntry
+    {
+        uint64_t    key     { 0u }; //!< The hash of the profile and the prompt.
+        sProfile    profile { };    //!< The profile of processing the prompt.
+        SharedText  prompt  { };    //!< The text of the prompt shared with the request.
+        SharedText  reply   { };    //!< The reply of the model shared with the response.
+    };
+
+    //!< The list of entries, the most recently used is at the front.
+    using ListEntries   = std::list<sReplyEntry>;
+    //!< The entries indexed by the key.
+    using MapEntries    = std::unordered_map<uint64_t, ListEntries::iterator>;
+
+//////////////////////////////////////////////////////////////////////////
+// Constructor / Destructor
+//////////////////////////////////////////////////////////////////////////
+public:
+    AgentResponseCache(void);
+    ~AgentResponseCache(void) = default;
+
+//////////////////////////////////////////////////////////////////////////
+// Attributes and operations
+//////////////////////////////////////////////////////////////////////////
+public:
+
+    /**
+     * \brief   Sets the maximum number of cached replies. The least recently used
+     *          replies are evicted if the cache exceeds the new capacity.
+     * \param   capacity    The maximum number of replies. Zero disables the cache.
+     **/
+    void setCapacity(uint32_t capacity);
+
+    /**
+     * \brief   Returns true if the cache is enabled.
+     **/
+    inline bool isEnabled(void) const;
+
+    /**
+     * \brief   Returns the number of cached replies.
+     **/
+    inline uint32_t getSize(void) const;
+
+    /**
+     * \brief   Returns the number of prompts replied from the cache.
+     **/
+    inline uint64_t getHits(void) const;
+
+    /**
+     * \brief   Returns the number of searched prompts, which are not found in the cache.
+     **/
+    inline uint64_t getMisses(void) const;
+
+    /**
+     * \brief   Searches the reply of the prompt processed with the profile and counts the hit or the miss.
+     * \param   profile     The profile of processing the prompt.
+     * \param   prompt      The text of the prompt.
+     * \param   reply       On output contains the cached reply shared with the cache, if found.
+     * \return  Returns true if the reply is found.
+     **/
+    bool find(const AgentResponseCache::sProfile& profile, const String& prompt, SharedText& reply);
+
+    /**
+     * \brief   Caches the reply of the prompt processed with the profile. The reply of the same key is replaced.
+     * \param   profile     The profile of processing the prompt.
+     * \param   prompt      The text of the prompt, the cache keeps the shared text.
+     * \param   reply       The reply of the model, the cache keeps the shared text.
+     **/
+    void store(const AgentResponseCache::sProfile& profile, const SharedText& prompt, const SharedText& reply);
+
+    /**
+     * \brief   Removes all cached replies. The counters are not reset.
+     **/
+    void clear(void);
+
+//////////////////////////////////////////////////////////////////////////
+// Hidden methods
+//////////////////////////////////////////////////////////////////////////
+private:
+
+    //!< Returns the hash of the profile and the prompt.
+    static uint64_t _makeKey(const AgentResponseCache::sProfile& profile, const String& prompt);
+
+    //!< Returns true if the entry contains the reply of the prompt processed with the profile.
+    static bool _isEqual(const AgentResponseCache::sReplyEntry& entry, const AgentResponseCache::sProfile& profile, const String& prompt);
+
+    //!< Evicts the least recently used entries until the cache fits into the capacity.
+    void _evict(uint32_t capacity);
+
+//////////////////////////////////////////////////////////////////////////
+// Member variables
+//////////////////////////////////////////////////////////////////////////
+private:
+    ListEntries mEntries;   //!< The cached replies.
+    MapEntries  mIndex;     //!< The index of the cached replies.
+    uint32_t    mCapacity;  //!< The maximum number of cached replies.
+    uint64_t    mHits;      //!< The number of prompts replied from the cache.
+    uint64_t    mMisses;    //!< The number of prompts not found in the cache.
+
+//////////////////////////////////////////////////////////////////////////
+// Forbidden calls
+//////////////////////////////////////////////////////////////////////////
+private:
+    DECLARE_NOCOPY_NOMOVE(AgentResponseCache);
+};
+
+//////////////////////////////////////////////////////////////////////////
+// Inline methods
+//////////////////////////////////////////////////////////////////////////
+
+inline bool AgentResponseCache::sProfile::operator == (const AgentResponseCache::sProfile& other) const
+{
+    return (model == other.model) && (adapter == other.adapter) && (temperature == other.temperature)
+        && (probability == other.probability) && (textLimit == other.textLimit) && (tokenLimit == other.tokenLimit);
+}
+
+inline bool AgentResponseCache::isEnabled(void) const
+{
+    return (mCapacity != 0u);
+}
+
+inline uint32_t AgentResponseCache::getSize(void) const
+{
+    return static_cast<uint32_t>(mEntries.size());
+}
+
+inline uint64_t AgentResponseCache::getHits(void) const
+{
+    return mHits;
+}
+
+inline uint64_t AgentResponseCache::getMisses(void) const
+{
+    return mMisses;
+}
+
+#endif // MULTIEDGE_AIAGENT_AGENTRESPONSECACHE_HPP
@@ -0,0 +1,236 @@
+﻿/************************************************************************
+ * This file is part of the Areg Edge AI project powered by AREG SDK.
+ * The project contains multiple examples of using Edge AI based on Areg communication framework.
+ *
+ *  Areg Edge AI is available as free and open-source software under the MIT License.
+ *
+ *  For detailed licensing terms, please refer to the LICENSE file included
+ *  with this distribution or contact us at info[at]areg.tech.
+ *
+ *  \copyright   © 2025 Aregtech UG. All rights reserved.
+ *  \file        multiedge/aiagent/agentscheduler.cpp
+ *  \ingroup     Areg Edge AI, AI Multi Edge Device Agent
+ *  \author      Artak Avetyan
+ *  \brief       Edge AI Agent scheduler of the queued prompts.
+ *
+ ************************************************************************/
+#include "multiedge/aiagent/agentscheduler.hpp"
+
+#include <algorithm>
+
+AgentScheduler::AgentScheduler(AgentScheduler::ePolicy policy /*= AgentScheduler::PolicyFair*/)
+    : mPolicy   (policy < PolicyCount ? policy : PolicyFair)
+    , mClasses  ( )
+    , mQueued   ( )
+    , mOrder    (0u)
+    , mWaits    ( )
+{
+}
+
+void AgentScheduler::setPolicy(AgentScheduler::ePolicy policy)
+{
+    if ((policy >= PolicyCount) || (policy == mPolicy))
+        return;
+
+    // Collect the queued entries and add them again in the order of arrival.
+    std::vector<sEntry> entries;
+    entries.reserve(mQueued.size());
+    for (sClass& queues : mClasses)
+    {
+        sEntry entry;
+        while (_dequeue(queues, entry))
+        {
+            auto pos = mQueued.find(entry.key);
+            if ((pos != mQueued.end()) && (pos->second == entry.order))
+            {
+                entries.push_back(entry);
+            }
+        }
+    }
+
+    std::sort(entries.begin(), entries.end(), [](const sEntry& lhs, const sEntry& rhs) { return lhs.order < rhs.order; });
+    mPolicy = policy;
+    for (const sEntry& entry : entries)
+    {
+        _enqueue(entry);
+    }
+}
+
+void AgentScheduler::push(uint32_t key, uint32_t agentId, uint32_t priority, uint32_t cost)
+{
+    sEntry entry;
+    entry.key       = key;
+    entry.agentId   = agentId;
+    entry.priority  = std::min(priority, PRIORITY_COUNT - 1u);
+    entry.cost      = cost;
+    entry.order     = ++ mOrder;
+    entry.queued    = Clock::now();
+
+    // If the key is queued again, the previous entry becomes stale.
+    mQueued[key] = entry.order;
+    _enqueue(entry);
+}
+
+bool AgentScheduler::pop(uint32_t& key)
+{
+    for (sClass& queues : mClasses)
+    {
+        sEntry entry;
+        while (_dequeue(queues, entry))
+        {
+            auto pos = mQueued.find(entry.key);
+            if ((pos != mQueued.end()) && (pos->second == entry.order))
+            {
+                mQueued.erase(pos);
+                _measure(entry);
+                key = entry.key;
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+void AgentScheduler::remove(uint32_t key)
+{
+    mQueued.erase(key);
+    if (mQueued.empty())
+    {
+        // Nothing valid is queued, drop the stale entries.
+        for (sClass& queues : mClasses)
+        {
+            queues = sClass();
+        }
+    }
+}
+
+AgentScheduler::sWaitStats AgentScheduler::getWaitStats(AgentScheduler::ePolicy policy) const
+{
+    sWaitStats result;
+    if (policy >= PolicyCount)
+        return result;
+
+    std::vector<uint64_t> samples{ mWaits[policy].samples };
+    if (samples.empty())
+        return result;
+
+    result.count = static_cast<uint32_t>(samples.size());
+    const size_t p50 = samples.size() / 2u;
+    const size_t p99 = (samples.size() * 99u) / 100u;
+    std::nth_element(samples.begin(), samples.begin() + p50, samples.end());
+    result.p50 = samples[p50];
+    std::nth_element(samples.begin() + p50, samples.begin() + p99, samples.end());
+    result.p99 = samples[p99];
+    return result;
+}
+
+const char* AgentScheduler::getString(AgentScheduler::ePolicy policy)
+{
+    switch (policy)
+    {
+    case PolicyFifo:
+        return "FIFO";
+    case PolicyFair:
+        return "Fair share";
+    case PolicyShortest:
+        return "Shortest first";
+    default:
+        return "Unknown";
+    }
+}
+
+void AgentScheduler::_enqueue(const sEntry& entry)
+{
+    sClass& queues = mClasses[entry.priority];
+    ++ queues.stored;
+    switch (mPolicy)
+    {
+    case PolicyFair:
+        {
+            Queue& queue = queues.agents[entry.agentId];
+            if (queue.empty())
+            {
+                queues.ring.push_back(entry.agentId);
+            }
+
+            queue.push_back(entry);
+        }
+        break;
+
+    case PolicyShortest:
+        queues.buckets[_bucket(entry.cost)].push_back(entry);
+        break;
+
+    case PolicyFifo:
+    default:
+        queues.fifo.push_back(entry);
+        break;
+    }
+}
+
+bool AgentScheduler::_dequeue(sClass& queues, sEntry& entry)
+{
+    if (queues.stored == 0u)
+        return false;
+
+    if (queues.fifo.empty() == false)
+    {
+        entry = queues.fifo.front();
+        queues.fifo.pop_front();
+    }
+    else if (queues.ring.empty() == false)
+    {
+        // Take one prompt of the next edge device and move the device to the end of the ring.
+        const uint32_t agentId = queues.ring.front();
+        queues.ring.pop_front();
+        auto pos = queues.agents.find(agentId);
+        entry = pos->second.front();
+        pos->second.pop_front();
+        if (pos->second.empty())
+        {
+            queues.agents.erase(pos);
+        }
+        else
+        {
+            queues.ring.push_back(agentId);
+        }
+    }
+    else
+    {
+        auto pos = std::find_if(queues.buckets.begin(), queues.buckets.end(), [](const Queue& queue) { return (queue.empty() == false); });
+        entry = pos->front();
+        pos->pop_front();
+    }
+
+    -- queues.stored;
+    return true;
+}
+
+uint32_t AgentScheduler::_bucket(uint32_t cost)
+{
+    uint32_t bucket{ 0u };
+    while ((cost > 1u) && (bucket < (COST_BUCKETS - 1u)))
+    {
+        cost >>= 1u;
+        ++ bucket;
+    }
+
+    return bucket;
+}
+
+void AgentScheduler::_measure(const sEntry& entry)
+{
+    sWaits& waits = mWaits[mPolicy];
+    const uint64_t wait = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - entry.queued).count());
+    if (waits.samples.size() < WAIT_SAMPLES)
+    {
+        waits.samples.push_back(wait);
+    }
+    else
+    {
+        waits.samples[waits.next] = wait;
+    }
+
+    waits.next = (waits.next + 1u) % WAIT_SAMPLES;
+}
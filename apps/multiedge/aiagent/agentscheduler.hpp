@@ -0,0 +1,228 @@
+﻿#ifndef MULTIEDGE_AIAGENT_AGENTSCHEDULER_HPP
+#define MULTIEDGE_AIAGENT_AGENTSCHEDULER_HPP
+/************************************************************************
+ * This file is part of the Areg Edge AI project powered by AREG SDK.
+ * The project contains multiple examples of using Edge AI based on Areg communication framework.
+ *
+ *  Areg Edge AI is available as free and open-source software under the MIT License.
+ *
+ *  For detailed licensing terms, please refer to the LICENSE file included
+ *  with this distribution or contact us at info[at]areg.tech.
+ *
+ *  \copyright   © 2025 Aregtech UG. All rights reserved.
+ *  \file        multiedge/aiagent/agentscheduler.hpp
+ *  \ingroup     Areg Edge AI, AI Multi Edge Device Agent
+ *  \author      Artak Avetyan
+ *  \brief       Edge AI Agent scheduler of the queued prompts.
+ *
+ ************************************************************************/
+
+/************************************************************************
+ * Includes
+ ************************************************************************/
+
+#include "areg/base/GEGlobal.h"
+
+#include <array>
+#include <chrono>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////
+// AgentScheduler class declaration
+//////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief   The scheduler of the prompts waiting to be dispatched to the worker thread.
+ *          The prompts are identified by a key and ordered by priority class first.
+ *          Within the class, the order depends on the policy:
+ *              - FIFO:     in the order of arrival;
+ *              - Fair:     round-robin between the edge devices, so that one
+ *                          device with many prompts does not starve others;
+ *              - Shortest: the shortest prompt first, the prompts are grouped
+ *                          in buckets of power of two cost and served in arrival
+ *                          order within the bucket.
+ *          Push, pop and remove take constant time. Removed prompts stay in the
+ *          queues and are skipped when popped. The scheduler measures the time the prompts wait in the
+ *          queue for every policy.
+ *          The scheduler is not thread safe.
+ **/
+class AgentScheduler
+{
+//////////////////////////////////////////////////////////////////////////
+// Internal types and constants
+//////////////////////////////////////////////////////////////////////////
+public:
+    //!< The scheduling policy within the priority class.
+    enum ePolicy : uint32_t
+    {
+          PolicyFifo        = 0 //!< First in, first out.
+        , PolicyFair            //!< Round-robin between edge devices.
+        , PolicyShortest        //!< Shortest prompt first.
+        , PolicyCount           //!< The number of policies.
+    };
+
+    static constexpr uint32_t   PRIORITY_COUNT  { 3u };     //!< The number of priority classes, zero is the highest.
+    static constexpr uint32_t   COST_BUCKETS    { 16u };    //!< The number of cost buckets of the shortest first policy.
+    static constexpr uint32_t   WAIT_SAMPLES    { 1024u };  //!< The number of the last measured queue waits per policy.
+
+    //!< The statistics of the queue wait of a policy, in microseconds.
+    struct sWaitStats
+    {
+        uint32_t    count   { 0u }; //!< The number of measured waits.
+        uint64_t    p50     { 0u }; //!< The median wait.
+        uint64_t    p99     { 0u }; //!< The 99th percentile of wait.
+    };
+
+private:
+    using Clock     = std::chrono::steady_clock;
+
+    //!< The queued prompt.
+    struct sEntry
+    {
+        uint32_t            key     { 0u };         //!< The key of the prompt.
+        uint32_t            agentId { 0u };         //!< The ID of the edge device.
+        uint32_t            priority{ 0u };         //!< The priority class.
+        uint32_t            cost    { 0u };         //!< The estimated cost of the prompt.
+        uint64_t            order   { 0u };         //!< The order of arrival.
+        Clock::time_point   queued  { };            //!< The time of arrival.
+    };
+
+    using Queue     = std::deque<sEntry>;
+
+    //!< The queues of the priority class.
+    struct sClass
+    {
+        uint32_t                                stored  { 0u }; //!< The number of stored entries, including removed.
+        Queue                                   fifo    { };    //!< The entries of FIFO policy.
+        std::unordered_map<uint32_t, Queue>     agents  { };    //!< The entries of fair policy per edge device.
+        std::deque<uint32_t>                    ring    { };    //!< The round-robin order of edge devices of fair policy.
+        std::array<Queue, COST_BUCKETS>         buckets { };    //!< The entries of shortest first policy per cost bucket.
+    };
+
+    //!< The last measured queue waits of the policy.
+    struct sWaits
+    {
+        std::vector<uint64_t>   samples { };    //!< The ring of measured waits in microseconds.
+        uint32_t                next    { 0u }; //!< The position of the next sample.
+    };
+
+//////////////////////////////////////////////////////////////////////////
+// Constructor / Destructor
+//////////////////////////////////////////////////////////////////////////
+public:
+    explicit AgentScheduler(AgentScheduler::ePolicy policy = AgentScheduler::PolicyFair);
+    ~AgentScheduler(void) = default;
+
+//////////////////////////////////////////////////////////////////////////
+// Attributes and operations
+//////////////////////////////////////////////////////////////////////////
+public:
+
+    /**
+     * \brief   Sets the scheduling policy. The queued prompts are reordered by the new policy.
+     **/
+    void setPolicy(AgentScheduler::ePolicy policy);
+
+    /**
+     * \brief   Returns the active scheduling policy.
+     **/
+    inline AgentScheduler::ePolicy getPolicy(void) const;
+
+    /**
+     * \brief   Queues the prompt.
+     * \param   key         The unique key of the prompt.
+     * \param   agentId     The ID of the edge device, which sent the prompt.
+     * \param   priority    The priority class, zero is the highest.
+     * \param   cost        The estimated cost of the prompt, for example the number of tokens.
+     **/
+    void push(uint32_t key, uint32_t agentId, uint32_t priority, uint32_t cost);
+
+    /**
+     * \brief   Removes the next prompt to dispatch from the queue.
+     * \param   key     On output contains the key of the prompt.
+     * \return  Returns true if the queue was not empty.
+     **/
+    bool pop(uint32_t& key);
+
+    /**
+     * \brief   Removes the queued prompt.
+     * \param   key     The key of the prompt to remove.
+     **/
+    void remove(uint32_t key);
+
+    /**
+     * \brief   Returns the number of queued prompts.
+     **/
+    inline uint32_t getSize(void) const;
+
+    /**
+     * \brief   Returns true if no prompt is queued.
+     **/
+    inline bool isEmpty(void) const;
+
+    /**
+     * \brief   Returns the statistics of the queue wait of the prompts scheduled by the policy.
+     **/
+    AgentScheduler::sWaitStats getWaitStats(AgentScheduler::ePolicy policy) const;
+
+    /**
+     * \brief   Returns the human readable name of the policy.
+     **/
+    static const char* getString(AgentScheduler::ePolicy policy);
+
+//////////////////////////////////////////////////////////////////////////
+// Hidden methods
+//////////////////////////////////////////////////////////////////////////
+private:
+
+    //!< Adds the entry to the queues of the active policy.
+    void _enqueue(const sEntry& entry);
+
+    //!< Takes the next stored entry of the priority class, including removed. Returns false if empty.
+    bool _dequeue(sClass& queues, sEntry& entry);
+
+    //!< Returns the cost bucket of the entry.
+    static uint32_t _bucket(uint32_t cost);
+
+    //!< Saves the queue wait of the entry.
+    void _measure(const sEntry& entry);
+
+//////////////////////////////////////////////////////////////////////////
+// Member variables
+//////////////////////////////////////////////////////////////////////////
+private:
+    ePolicy                                     mPolicy;    //!< The active policy.
+    std::array<sClass, PRIORITY_COUNT>          mClasses;   //!< The queues per priority class.
+    std::unordered_map<uint32_t, uint64_t>      mQueued;    //!< The keys and the order of arrival of the queued prompts.
+    uint64_t                                    mOrder;     //!< The order of the last arrival.
+    std::array<sWaits, PolicyCount>             mWaits;     //!< The measured queue waits per policy.
+
+//////////////////////////////////////////////////////////////////////////
+// Forbidden calls
+//////////////////////////////////////////////////////////////////////////
+private:
+    DECLARE_NOCOPY_NOMOVE(AgentScheduler);
+};
+
+//////////////////////////////////////////////////////////////////////////
+// Inline methods
+//////////////////////////////////////////////////////////////////////////
+
+inline AgentScheduler::ePolicy AgentScheduler::getPolicy(void) const
+{
+    return mPolicy;
+}
+
+inline uint32_t AgentScheduler::getSize(void) const
+{
+    return static_cast<uint32_t>(mQueued.size());
+}
+
+inline bool AgentScheduler::isEmpty(void) const
+{
+    return mQueued.empty();
+}
+
+#endif // MULTIEDGE_AIAGENT_AGENTSCHEDULER_HPP
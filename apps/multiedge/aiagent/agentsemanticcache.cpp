@@ -0,0 +1,183 @@
+﻿/************************************************************************
+ * This file is part of the Areg Edge AI project powered by AREG SDK.
+ * The project contains multiple examples of using Edge AI based on Areg communication framework.
+ *
+ *  Areg Edge AI is available as free and open-source software under the MIT License.
+ *
+ *  For detailed licensing terms, please refer to the LICENSE file included
+ *  with this distribution or contact us at info[at]areg.tech.
+ *
+ *  \copyright   © 2025 Aregtech UG. All rights reserved.
+ *  \file        multiedge/aiagent/agentsemanticcache.cpp
+ *  \ingroup     Areg Edge AI, AI Multi Edge Device Agent
+ *  \author      Artak Avetyan
+ *  \brief       Edge AI Agent cache of the replies of similar prompts.
+ *
+ ************************************************************************/
+#include "multiedge/aiagent/agentsemanticcache.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+#if defined(__AVX2__) && defined(__FMA__)
+    #include <immintrin.h>
+    #define AGENT_SIMD_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+    #include <xmmintrin.h>
+    #define AGENT_SIMD_SSE
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #include <arm_neon.h>
+    #define AGENT_SIMD_NEON
+#endif
+
+namespace
+{
+#if defined(AGENT_SIMD_AVX2) || defined(AGENT_SIMD_SSE)
+    //!< Returns the sum of 4 floats of the register.
+    inline float _sum4(__m128 value)
+    {
+        __m128 shuffle  = _mm_shuffle_ps(value, value, _MM_SHUFFLE(2, 3, 0, 1));
+        __m128 sum      = _mm_add_ps(value, shuffle);
+        shuffle         = _mm_movehl_ps(shuffle, sum);
+        sum             = _mm_add_ss(sum, shuffle);
+        return _mm_cvtss_f32(sum);
+    }
+#endif
+
+    //!< The estimated memory of the node of the list in bytes.
+    constexpr uint64_t  ENTRY_OVERHEAD  { 64u };
+}
+
+AgentSemanticCache::AgentSemanticCache(void)
+    : mEntries      ( )
+    , mThreshold    (0.0f)
+    , mBudget       (DEF_BUDGET)
+    , mMemory       (0u)
+    , mHits         (0u)
+    , mMisses       (0u)
+    , mLookupTime   (0u)
+{
+}
+
+void AgentSemanticCache::setSimilarity(uint32_t similarity)
+{
+    mThreshold = static_cast<float>(std::min(similarity, MAX_SIMILARITY)) / static_cast<float>(MAX_SIMILARITY);
+}
+
+void AgentSemanticCache::setBudget(uint64_t budget)
+{
+    mBudget = budget;
+    _evict(mBudget);
+}
+
+bool AgentSemanticCache::find(const AgentResponseCache::sProfile& profile, const std::vector<float>& embedding, SharedText& reply)
+{
+    const std::chrono::steady_clock::time_point start{ std::chrono::steady_clock::now() };
+    ListEntries::iterator best = mEntries.end();
+    float bestSimilarity{ mThreshold };
+    for (ListEntries::iterator pos = mEntries.begin(); pos != mEntries.end(); ++ pos)
+    {
+        if ((pos->embedding.size() != embedding.size()) || ((pos->profile == profile) == false))
+            continue;
+
+        const float value = AgentSemanticCache::similarity(pos->embedding.data(), embedding.data(), static_cast<uint32_t>(embedding.size()));
+        if (value >= bestSimilarity)
+        {
+            bestSimilarity  = value;
+            best            = pos;
+        }
+    }
+
+    if (best != mEntries.end())
+    {
+        mEntries.splice(mEntries.begin(), mEntries, best);
+        reply = best->reply;
+        ++ mHits;
+    }
+    else
+    {
+        ++ mMisses;
+    }
+
+    mLookupTime += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+    return (best != mEntries.end());
+}
+
+void AgentSemanticCache::store(const AgentResponseCache::sProfile& profile, const std::vector<float>& embedding, const SharedText& reply)
+{
+    if ((isEnabled() == false) || embedding.empty())
+        return;
+
+    const uint64_t size = ENTRY_OVERHEAD + embedding.size() * sizeof(float) + reply->getLength() + profile.model.getLength() + profile.adapter.getLength();
+    if (size > mBudget)
+        return;
+
+    _evict(mBudget - size);
+    mEntries.push_front(sEmbedEntry{ profile, embedding, reply, size });
+    mMemory += size;
+}
+
+void AgentSemanticCache::clear(void)
+{
+    mEntries.clear();
+    mMemory = 0u;
+}
+
+float AgentSemanticCache::similarity(const float* left, const float* right, uint32_t count)
+{
+    uint32_t i{ 0u };
+    float result{ 0.0f };
+
+#if defined(AGENT_SIMD_AVX2)
+    // Two accumulators hide the latency of the fused multiply-add.
+    __m256 sum0 = _mm256_setzero_ps();
+    __m256 sum1 = _mm256_setzero_ps();
+    for ( ; i + 16u <= count; i += 16u)
+    {
+        sum0 = _mm256_fmadd_ps(_mm256_loadu_ps(left + i)     , _mm256_loadu_ps(right + i)     , sum0);
+        sum1 = _mm256_fmadd_ps(_mm256_loadu_ps(left + i + 8u), _mm256_loadu_ps(right + i + 8u), sum1);
+    }
+
+    sum0 = _mm256_add_ps(sum0, sum1);
+    result = _sum4(_mm_add_ps(_mm256_castps256_ps128(sum0), _mm256_extractf128_ps(sum0, 1)));
+#elif defined(AGENT_SIMD_SSE)
+    __m128 sum0 = _mm_setzero_ps();
+    __m128 sum1 = _mm_setzero_ps();
+    for ( ; i + 8u <= count; i += 8u)
+    {
+        sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_loadu_ps(left + i)     , _mm_loadu_ps(right + i)));
+        sum1 = _mm_add_ps(sum1, _mm_mul_ps(_mm_loadu_ps(left + i + 4u), _mm_loadu_ps(right + i + 4u)));
+    }
+
+    result = _sum4(_mm_add_ps(sum0, sum1));
+#elif defined(AGENT_SIMD_NEON)
+    float32x4_t sum0 = vdupq_n_f32(0.0f);
+    float32x4_t sum1 = vdupq_n_f32(0.0f);
+    for ( ; i + 8u <= count; i += 8u)
+    {
+        sum0 = vmlaq_f32(sum0, vld1q_f32(left + i)     , vld1q_f32(right + i));
+        sum1 = vmlaq_f32(sum1, vld1q_f32(left + i + 4u), vld1q_f32(right + i + 4u));
+    }
+
+    sum0 = vaddq_f32(sum0, sum1);
+    const float32x2_t half = vadd_f32(vget_low_f32(sum0), vget_high_f32(sum0));
+    result = vget_lane_f32(vpadd_f32(half, half), 0);
+#endif
+
+    // The remaining dimensions, or all of them without the vector instructions.
+    for ( ; i < count; ++ i)
+    {
+        result += left[i] * right[i];
+    }
+
+    return result;
+}
+
+void AgentSemanticCache::_evict(uint64_t budget)
+{
+    while ((mMemory > budget) && (mEntries.empty() == false))
+    {
+        mMemory -= mEntries.back().size;
+        mEntries.pop_back();
+    }
+}
@@ -0,0 +1,219 @@
+﻿#ifndef MULTIEDGE_AIAGENT_AGENTSEMANTICCACHE_HPP
+#define MULTIEDGE_AIAGENT_AGENTSEMANTICCACHE_HPP
+/************************************************************************
+ * This file is part of the Areg Edge AI project powered by AREG SDK.
+ * The project contains multiple examples of using Edge AI based on Areg communication framework.
+ *
+ *  Areg Edge AI is available as free and open-source software under the MIT License.
+ *
+ *  For detailed licensing terms, please refer to the LICENSE file included
+ *  with this distribution or contact us at info[at]areg.tech.
+ *
+ *  \copyright   © 2025 Aregtech UG. All rights reserved.
+ *  \file        multiedge/aiagent/agentsemanticcache.hpp
+ *  \ingroup     Areg Edge AI, AI Multi Edge Device Agent
+ *  \author      Artak Avetyan
+ *  \brief       Edge AI Agent cache of the replies of similar prompts.
+ *
+ ************************************************************************/
+
+/************************************************************************
+ * Includes
+ ************************************************************************/
+
+#include "areg/base/GEGlobal.h"
+#include "areg/base/String.hpp"
+#include "multiedge/aiagent/agentresponsecache.hpp"
+
+#include <list>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////
+// AgentSemanticCache class declaration
+//////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief   The cache of the replies of the stateless prompts found by the
+ *          meaning of the prompt. The operators often ask the same question
+ *          with other words, which the exact cache of the replies misses.
+ *          The prompt is compared with the recent prompts by the cosine
+ *          similarity of their embeddings, the reply of the most similar
+ *          prompt is taken if the similarity passes the threshold. Only the
+ *          prompts processed with the same profile are compared. The memory
+ *          of the cache is limited, the least recently used replies are evicted.
+ *          The cache is not thread safe.
+ **/
+class AgentSemanticCache
+{
+//////////////////////////////////////////////////////////////////////////
+// Internal types and constants
+//////////////////////////////////////////////////////////////////////////
+public:
+    static constexpr uint32_t   MAX_SIMILARITY  { 100u };   //!< The maximum similarity in percent to take the cached reply.
+    static constexpr uint32_t   MIN_SIMILARITY  { 0u };     //!< The minimum similarity in percent, zero disables the cache.
+    static constexpr uint32_t   DEF_SIMILARITY  { 0u };     //!< The default similarity in percent, the cache is disabled.
+    static constexpr uint64_t   DEF_BUDGET      { 32u * 1024u * 1024u }; //!< The default memory budget of the cache in bytes.
+
+private:
+    //!< The cached reply of the prompt.
+    struct sEmbedEntry
+    {
+        AgentResponseCache::sProfile    profile     { };    //!< The profile of processing the prompt.
+        std::vector<float>              embedding   { };    //!< The normalized embedding of the prompt.
+        SharedText                      reply       { };    //!< The reply of the model shared with the response.
+        uint64_t                        size        { 0u }; //!< The estimated memory of the entry in bytes.
+    };
+
+    //!< The list of entries, the most recently used is at the front.
+    using ListEntries   = std::list<sEmbedEntry>;
+
+//////////////////////////////////////////////////////////////////////////
+// Constructor / Destructor
+//////////////////////////////////////////////////////////////////////////
+public:
+    AgentSemanticCache(void);
+    ~AgentSemanticCache(void) = default;
+
+//////////////////////////////////////////////////////////////////////////
+// Attributes and operations
+//////////////////////////////////////////////////////////////////////////
+public:
+
+    /**
+     * \brief   Sets the minimum similarity of the prompts to take the cached reply.
+     * \param   similarity  The similarity in percent. Zero disables the cache.
+     **/
+    void setSimilarity(uint32_t similarity);
+
+    /**
+     * \brief   Sets the memory budget of the cache. The least recently used replies
+     *          are evicted if the cache exceeds the new budget.
+     * \param   budget      The memory budget in bytes.
+     **/
+    void setBudget(uint64_t budget);
+
+    /**
+     * \brief   Returns true if the cache is enabled.
+     **/
+    inline bool isEnabled(void) const;
+
+    /**
+     * \brief   Returns the number of cached replies.
+     **/
+    inline uint32_t getSize(void) const;
+
+    /**
+     * \brief   Returns the number of prompts replied from the cache.
+     **/
+    inline uint64_t getHits(void) const;
+
+    /**
+     * \brief   Returns the number of searched prompts, which are not found in the cache.
+     **/
+    inline uint64_t getMisses(void) const;
+
+    /**
+     * \brief   Returns the share of the searched prompts replied from the cache.
+     **/
+    inline double getHitRate(void) const;
+
+    /**
+     * \brief   Returns the average time to search the prompt in microseconds.
+     **/
+    inline double getLookupTime(void) const;
+
+    /**
+     * \brief   Searches the reply of the most similar prompt processed with the profile and counts the hit or the miss.
+     * \param   profile     The profile of processing the prompt.
+     * \param   embedding   The normalized embedding of the prompt.
+     * \param   reply       On output contains the cached reply shared with the cache, if found.
+     * \return  Returns true if the reply is found.
+     **/
+    bool find(const AgentResponseCache::sProfile& profile, const std::vector<float>& embedding, SharedText& reply);
+
+    /**
+     * \brief   Caches the reply of the prompt processed with the profile.
+     * \param   profile     The profile of processing the prompt.
+     * \param   embedding   The normalized embedding of the prompt.
+     * \param   reply       The reply of the model, the cache keeps the shared text.
+     **/
+    void store(const AgentResponseCache::sProfile& profile, const std::vector<float>& embedding, const SharedText& reply);
+
+    /**
+     * \brief   Removes all cached replies. The counters are not reset.
+     **/
+    void clear(void);
+
+    /**
+     * \brief   Returns the cosine similarity of two vectors normalized to the unit length,
+     *          which is their dot product. Computed with the vector instructions of the CPU.
+     * \param   left    The first vector.
+     * \param   right   The second vector.
+     * \param   count   The number of dimensions of the vectors.
+     **/
+    static float similarity(const float* left, const float* right, uint32_t count);
+
+//////////////////////////////////////////////////////////////////////////
+// Hidden methods
+//////////////////////////////////////////////////////////////////////////
+private:
+
+    //!< Evicts the least recently used entries until the cache fits into the budget.
+    void _evict(uint64_t budget);
+
+//////////////////////////////////////////////////////////////////////////
+// Member variables
+//////////////////////////////////////////////////////////////////////////
+private:
+    ListEntries mEntries;       //!< The cached replies.
+    float       mThreshold;     //!< The minimum similarity to take the cached reply, zero if disabled.
+    uint64_t    mBudget;        //!< The memory budget of the cache in bytes.
+    uint64_t    mMemory;        //!< The estimated memory of the cached replies in bytes.
+    uint64_t    mHits;          //!< The number of prompts replied from the cache.
+    uint64_t    mMisses;        //!< The number of prompts not found in the cache.
+    uint64_t    mLookupTime;    //!< The total time of the searches in microseconds.
+
+//////////////////////////////////////////////////////////////////////////
+// Forbidden calls
+//////////////////////////////////////////////////////////////////////////
+private:
+    DECLARE_NOCOPY_NOMOVE(AgentSemanticCache);
+};
+
+//////////////////////////////////////////////////////////////////////////
+// Inline methods
+//////////////////////////////////////////////////////////////////////////
+
+inline bool AgentSemanticCache::isEnabled(void) const
+{
+    return (mThreshold > 0.0f) && (mBudget != 0u);
+}
+
+inline uint32_t AgentSemanticCache::getSize(void) const
+{
+    return static_cast<uint32_t>(mEntries.size());
+}
+
+inline uint64_t AgentSemanticCache::getHits(void) const
+{
+    return mHits;
+}
+
+inline uint64_t AgentSemanticCache::getMisses(void) const
+{
+    return mMisses;
+}
+
+inline double AgentSemanticCache::getHitRate(void) const
+{
+    const uint64_t lookups = mHits + mMisses;
+    return (lookups != 0u ? static_cast<double>(mHits) / static_cast<double>(lookups) : 0.0);
+}
+
+inline double AgentSemanticCache::getLookupTime(void) const
+{
+    const uint64_t lookups = mHits + mMisses;
+    return (lookups != 0u ? static_cast<double>(mLookupTime) / static_cast<double>(lookups) : 0.0);
+}
+
+#endif // MULTIEDGE_AIAGENT_AGENTSEMANTICCACHE_HPP
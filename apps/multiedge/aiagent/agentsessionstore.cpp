@@ -0,0 +1,270 @@
+﻿/************************************************************************
+ * This file is part of the Areg Edge AI project powered by AREG SDK.
+ * The project contains multiple examples of using Edge AI based on Areg communication framework.
+ *
+ *  Areg Edge AI is available as free and open-source software under the MIT License.
+ *
+ *  For detailed licensing terms, please refer to the LICENSE file included
+ *  with this distribution or contact us at info[at]areg.tech.
+ *
+ *  \copyright   © 2025 Aregtech UG. All rights reserved.
+ *  \file        multiedge/aiagent/agentsessionstore.cpp
+ *  \ingroup     Areg Edge AI, AI Multi Edge Device Agent
+ *  \author      Artak Avetyan
+ *  \brief       Edge AI Agent store of the KV states of idle conversations.
+ *
+ ************************************************************************/
+#include "multiedge/aiagent/agentsessionstore.hpp"
+#include "areg/logging/GELog.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+DEF_LOG_SCOPE(multiedge_aiagent_AgentSessionStore_save);
+DEF_LOG_SCOPE(multiedge_aiagent_AgentSessionStore_restore);
+DEF_LOG_SCOPE(multiedge_aiagent_AgentSessionStore__evict);
+DEF_LOG_SCOPE(multiedge_aiagent_AgentSessionStore__evictFiles);
+
+AgentSessionStore::AgentSessionStore(void)
+    : mSessions ( )
+    , mIndex    ( )
+    , mStored   ( )
+    , mDirectory( )
+    , mBudget   (0u)
+    , mSize     (0u)
+    , mDiskBudget(0u)
+    , mDiskSize (0u)
+    , mUseStamp (0u)
+{
+}
+
+AgentSessionStore::~AgentSessionStore(void)
+{
+    clear();
+}
+
+void AgentSessionStore::setBudget(uint64_t budget)
+{
+    mBudget = budget;
+    _evict(mBudget);
+}
+
+void AgentSessionStore::setDirectory(const String& directory, uint64_t diskBudget)
+{
+    mDiskBudget = diskBudget;
+    if (directory == mDirectory)
+    {
+        _evictFiles(0u);
+        return;
+    }
+
+    _removeFiles();
+    mDirectory = directory;
+    if (mDirectory.isEmpty() == false)
+    {
+        std::error_code err;
+        std::filesystem::create_directories(mDirectory.getData(), err);
+    }
+}
+
+bool AgentSessionStore::save(llama_context* ctx, llama_seq_id seqId, uint64_t conversation, llama_pos nPast, llama_token lastToken)
+{
+    LOG_SCOPE(multiedge_aiagent_AgentSessionStore_save);
+    remove(conversation);
+
+    sSession session;
+    session.conversation= conversation;
+    session.nPast       = nPast;
+    session.lastToken   = lastToken;
+    session.state.resize(llama_state_seq_get_size(ctx, seqId));
+    if (session.state.empty() || (llama_state_seq_get_data(ctx, session.state.data(), session.state.size(), seqId) != session.state.size()))
+    {
+        LOG_ERR("Failed to save KV state of the sequence [ %d ]", seqId);
+        return false;
+    }
+
+    const uint64_t size = session.state.size();
+    if (size > mBudget)
+    {
+        // Does not fit into memory at all, goes directly to the directory.
+        return _writeFile(session);
+    }
+
+    _evict(mBudget - size);
+    mSessions.push_front(std::move(session));
+    mIndex[conversation] = mSessions.begin();
+    mSize += size;
+    LOG_DBG("Saved KV state of conversation [ %llx ], [ %d ] tokens, [ %llu ] bytes"
+                , static_cast<unsigned long long>(conversation), nPast, static_cast<unsigned long long>(size));
+    return true;
+}
+
+llama_pos AgentSessionStore::restore(llama_context* ctx, llama_seq_id seqId, uint64_t conversation, llama_token& lastToken)
+{
+    LOG_SCOPE(multiedge_aiagent_AgentSessionStore_restore);
+
+    sSession session;
+    MapSessions::iterator pos = mIndex.find(conversation);
+    if (pos != mIndex.end())
+    {
+        session = std::move(*pos->second);
+        mSize -= session.state.size();
+        mSessions.erase(pos->second);
+        mIndex.erase(pos);
+    }
+    else if ((mStored.find(conversation) == mStored.end()) || (_readFile(conversation, session) == false))
+    {
+        return 0;
+    }
+
+    if (llama_state_seq_set_data(ctx, session.state.data(), session.state.size(), seqId) == 0)
+    {
+        LOG_ERR("Failed to restore KV state of conversation [ %llx ]", static_cast<unsigned long long>(conversation));
+        llama_memory_seq_rm(llama_get_memory(ctx), seqId, -1, -1);
+        return 0;
+    }
+
+    LOG_DBG("Restored KV state of conversation [ %llx ], [ %d ] tokens", static_cast<unsigned long long>(conversation), session.nPast);
+    lastToken = session.lastToken;
+    return session.nPast;
+}
+
+void AgentSessionStore::remove(uint64_t conversation)
+{
+    MapSessions::iterator pos = mIndex.find(conversation);
+    if (pos != mIndex.end())
+    {
+        mSize -= pos->second->state.size();
+        mSessions.erase(pos->second);
+        mIndex.erase(pos);
+    }
+
+    MapStored::iterator stored = mStored.find(conversation);
+    if (stored != mStored.end())
+    {
+        std::error_code err;
+        std::filesystem::remove(_filePath(conversation), err);
+        mDiskSize -= stored->second.size;
+        mStored.erase(stored);
+    }
+}
+
+void AgentSessionStore::clear(void)
+{
+    mSessions.clear();
+    mIndex.clear();
+    mSize = 0u;
+    _removeFiles();
+}
+
+void AgentSessionStore::_evict(uint64_t budget)
+{
+    LOG_SCOPE(multiedge_aiagent_AgentSessionStore__evict);
+    while ((mSize > budget) && (mSessions.empty() == false))
+    {
+        sSession& session = mSessions.back();
+        if (_writeFile(session) == false)
+        {
+            LOG_WARN("Dropped KV state of idle conversation [ %llx ]", static_cast<unsigned long long>(session.conversation));
+        }
+
+        mSize -= session.state.size();
+        mIndex.erase(session.conversation);
+        mSessions.pop_back();
+    }
+}
+
+void AgentSessionStore::_removeFiles(void)
+{
+    std::error_code err;
+    for (const auto& entry : mStored)
+    {
+        std::filesystem::remove(_filePath(entry.first), err);
+    }
+
+    mStored.clear();
+    mDiskSize = 0u;
+    if (mDirectory.isEmpty() == false)
+    {
+        // Deleted only if empty, the directories of the other stores may be nested.
+        std::filesystem::remove(mDirectory.getData(), err);
+    }
+}
+
+void AgentSessionStore::_evictFiles(uint64_t size)
+{
+    LOG_SCOPE(multiedge_aiagent_AgentSessionStore__evictFiles);
+    while ((mStored.empty() == false) && ((mDiskSize + size) > mDiskBudget))
+    {
+        MapStored::iterator oldest = std::min_element(mStored.begin(), mStored.end(), [](const MapStored::value_type& lhs, const MapStored::value_type& rhs)
+                                        { return (lhs.second.lastUse < rhs.second.lastUse); });
+        LOG_WARN("Deleted KV state of idle conversation [ %llx ] exceeding the disk budget", static_cast<unsigned long long>(oldest->first));
+        std::error_code err;
+        std::filesystem::remove(_filePath(oldest->first), err);
+        mDiskSize -= oldest->second.size;
+        mStored.erase(oldest);
+    }
+}
+
+bool AgentSessionStore::_writeFile(const sSession& session)
+{
+    const uint64_t size{ sizeof(session.nPast) + sizeof(session.lastToken) + session.state.size() };
+    if (mDirectory.isEmpty() || (size > mDiskBudget))
+        return false;
+
+    _evictFiles(size);
+    std::ofstream file(_filePath(session.conversation), std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&session.nPast), sizeof(session.nPast));
+    file.write(reinterpret_cast<const char*>(&session.lastToken), sizeof(session.lastToken));
+    file.write(reinterpret_cast<const char*>(session.state.data()), static_cast<std::streamsize>(session.state.size()));
+    if (file.good() == false)
+    {
+        LOG_ERR("Failed to write KV state of conversation [ %llx ] to the directory", static_cast<unsigned long long>(session.conversation));
+        file.close();
+        std::error_code err;
+        std::filesystem::remove(_filePath(session.conversation), err);
+        return false;
+    }
+
+    mStored[session.conversation] = sStoredFile{ size, ++ mUseStamp };
+    mDiskSize += size;
+    return true;
+}
+
+bool AgentSessionStore::_readFile(uint64_t conversation, sSession& session)
+{
+    const std::string path{ _filePath(conversation) };
+    MapStored::iterator stored = mStored.find(conversation);
+    if (stored != mStored.end())
+    {
+        mDiskSize -= stored->second.size;
+        mStored.erase(stored);
+    }
+
+    std::error_code err;
+    const uintmax_t size = std::filesystem::file_size(path, err);
+    bool result{ false };
+    constexpr uintmax_t header{ sizeof(session.nPast) + sizeof(session.lastToken) };
+    if ((err.value() == 0) && (size > header))
+    {
+        std::ifstream file(path, std::ios::binary);
+        session.conversation = conversation;
+        session.state.resize(static_cast<size_t>(size - header));
+        file.read(reinterpret_cast<char*>(&session.nPast), sizeof(session.nPast));
+        file.read(reinterpret_cast<char*>(&session.lastToken), sizeof(session.lastToken));
+        file.read(reinterpret_cast<char*>(session.state.data()), static_cast<std::streamsize>(session.state.size()));
+        result = file.good();
+    }
+
+    std::filesystem::remove(path, err);
+    return result;
+}
+
+std::string AgentSessionStore::_filePath(uint64_t conversation) const
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.kvs", static_cast<unsigned long long>(conversation));
+    return (std::filesystem::path(mDirectory.getData()) / name).string();
+}
@@ -0,0 +1,198 @@
+﻿#ifndef MULTIEDGE_AIAGENT_AGENTSESSIONSTORE_HPP
+#define MULTIEDGE_AIAGENT_AGENTSESSIONSTORE_HPP
+/************************************************************************
+ * This file is part of the Areg Edge AI project powered by AREG SDK.
+ * The project contains multiple examples of using Edge AI based on Areg communication framework.
+ *
+ *  Areg Edge AI is available as free and open-source software under the MIT License.
+ *
+ *  For detailed licensing terms, please refer to the LICENSE file included
+ *  with this distribution or contact us at info[at]areg.tech.
+ *
+ *  \copyright   © 2025 Aregtech UG. All rights reserved.
+ *  \file        multiedge/aiagent/agentsessionstore.hpp
+ *  \ingroup     Areg Edge AI, AI Multi Edge Device Agent
+ *  \author      Artak Avetyan
+ *  \brief       Edge AI Agent store of the KV states of idle conversations.
+ *
+ ************************************************************************/
+
+/************************************************************************
+ * Includes
+ ************************************************************************/
+
+#include "areg/base/GEGlobal.h"
+#include "areg/base/String.hpp"
+#include "llama.h"
+
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////
+// AgentSessionStore class declaration
+//////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief   The store of the KV states of conversations, which do not hold
+ *          a sequence of the decoding context. When the sequence of an idle
+ *          conversation is needed for another prompt, the KV state of the
+ *          conversation is moved to the store, and it is restored when the
+ *          next turn of the conversation arrives. The store has a memory
+ *          budget, the least recently used states are written to the
+ *          directory, if it is set, or dropped otherwise. The directory
+ *          has a disk budget, the least recently written states exceeding
+ *          it are deleted. The directory should not be shared with other
+ *          processes, the files are named by the keys of the conversations.
+ *          The states are valid only for the model they are created with,
+ *          the store must be cleared when the model changes.
+ *          The store is not thread safe.
+ **/
+class AgentSessionStore
+{
+//////////////////////////////////////////////////////////////////////////
+// Internal types and constants
+//////////////////////////////////////////////////////////////////////////
+private:
+    //!< The saved KV state of the conversation.
+    struct sSession
+    {
+        uint64_t                conversation{ 0u }; //!< The key of the conversation.
+        llama_pos               nPast       { 0 };  //!< The number of tokens in the KV state.
+        llama_token             lastToken   { LLAMA_TOKEN_NULL };   //!< The last token of the reply, which is not in the KV state.
+        std::vector<uint8_t>    state       { };    //!< The serialized KV state of the sequence.
+    };
+
+    //!< The list of sessions, the most recently used is at the front.
+    using ListSessions  = std::list<sSession>;
+    //!< The map of the conversation keys and the sessions in memory.
+    using MapSessions   = std::map<uint64_t, ListSessions::iterator>;
+    //!< The state written to the directory.
+    struct sStoredFile
+    {
+        uint64_t                size        { 0u }; //!< The size of the file in bytes.
+        uint64_t                lastUse     { 0u }; //!< The stamp of writing the file to delete the oldest one.
+    };
+
+    //!< The map of the conversation keys and the states written to the directory.
+    using MapStored     = std::map<uint64_t, sStoredFile>;
+
+//////////////////////////////////////////////////////////////////////////
+// Constructor / Destructor
+//////////////////////////////////////////////////////////////////////////
+public:
+    AgentSessionStore(void);
+    ~AgentSessionStore(void);
+
+//////////////////////////////////////////////////////////////////////////
+// Attributes and operations
+//////////////////////////////////////////////////////////////////////////
+public:
+
+    /**
+     * \brief   Sets the memory budget of the store. The least recently used states
+     *          are evicted if the store exceeds the new budget.
+     * \param   budget  The maximum size in bytes of the states in memory.
+     **/
+    void setBudget(uint64_t budget);
+
+    /**
+     * \brief   Sets the directory to write the evicted states. If the directory changes,
+     *          the states written to the previous directory are deleted.
+     * \param   directory   The path to the directory. Empty to drop the evicted states.
+     * \param   diskBudget  The maximum size in bytes of the states written to the directory.
+     **/
+    void setDirectory(const String& directory, uint64_t diskBudget);
+
+    /**
+     * \brief   Saves the KV state of the conversation sequence.
+     * \param   ctx             The context to save the state.
+     * \param   seqId           The ID of the sequence to save.
+     * \param   conversation    The key of the conversation.
+     * \param   nPast           The number of tokens in the sequence.
+     * \param   lastToken       The last token of the reply, which is not decoded yet. LLAMA_TOKEN_NULL if none.
+     * \return  Returns true if the state is saved in memory or in the directory.
+     **/
+    bool save(llama_context* ctx, llama_seq_id seqId, uint64_t conversation, llama_pos nPast, llama_token lastToken);
+
+    /**
+     * \brief   Restores the KV state of the conversation into the empty sequence
+     *          and removes it from the store.
+     * \param   ctx             The context to restore the state.
+     * \param   seqId           The ID of the sequence to restore the state.
+     * \param   conversation    The key of the conversation.
+     * \param   lastToken       On output, the last token of the reply, which is not decoded yet. LLAMA_TOKEN_NULL if none.
+     * \return  Returns the number of tokens restored in the sequence. Zero if nothing restored.
+     **/
+    llama_pos restore(llama_context* ctx, llama_seq_id seqId, uint64_t conversation, llama_token& lastToken);
+
+    /**
+     * \brief   Removes the state of the conversation from the store.
+     **/
+    void remove(uint64_t conversation);
+
+    /**
+     * \brief   Removes all states from memory and from the directory.
+     **/
+    void clear(void);
+
+    /**
+     * \brief   Returns the size in bytes of the states in memory.
+     **/
+    inline uint64_t getSize(void) const;
+
+//////////////////////////////////////////////////////////////////////////
+// Hidden methods
+//////////////////////////////////////////////////////////////////////////
+private:
+
+    //!< Evicts the least recently used states until the store fits into budget.
+    void _evict(uint64_t budget);
+
+    //!< Deletes all states written to the directory and the directory, if it is empty.
+    void _removeFiles(void);
+
+    //!< Deletes the least recently written states until the state of the given size fits the disk budget.
+    void _evictFiles(uint64_t size);
+
+    //!< Writes the state to the directory. Returns true if succeeded.
+    bool _writeFile(const sSession& session);
+
+    //!< Reads the state of the conversation from the directory and deletes the file.
+    bool _readFile(uint64_t conversation, sSession& session);
+
+    //!< Returns the path of the file to store the state of the conversation.
+    std::string _filePath(uint64_t conversation) const;
+
+//////////////////////////////////////////////////////////////////////////
+// Member variables
+//////////////////////////////////////////////////////////////////////////
+private:
+    ListSessions    mSessions;  //!< The states in memory.
+    MapSessions     mIndex;     //!< The index of the states in memory.
+    MapStored       mStored;    //!< The conversations stored in the directory.
+    String          mDirectory; //!< The directory to write evicted states.
+    uint64_t        mBudget;    //!< The memory budget in bytes.
+    uint64_t        mSize;      //!< The size of the states in memory.
+    uint64_t        mDiskBudget;//!< The disk budget in bytes.
+    uint64_t        mDiskSize;  //!< The size of the states in the directory.
+    uint64_t        mUseStamp;  //!< The stamp of the last written state.
+
+//////////////////////////////////////////////////////////////////////////
+// Forbidden calls
+//////////////////////////////////////////////////////////////////////////
+private:
+    DECLARE_NOCOPY_NOMOVE(AgentSessionStore);
+};
+
+//////////////////////////////////////////////////////////////////////////
+// Inline methods
+//////////////////////////////////////////////////////////////////////////
+
+inline uint64_t AgentSessionStore::getSize(void) const
+{
+    return mSize;
+}
+
+#endif // MULTIEDGE_AIAGENT_AGENTSESSIONSTORE_HPP
@@ -0,0 +1,109 @@
+﻿/************************************************************************
+ * This file is part of the Areg Edge AI project powered by AREG SDK.
+ * The project contains multiple examples of using Edge AI based on Areg communication framework.
+ *
+ *  Areg Edge AI is available as free and open-source software under the MIT License.
+ *
+ *  For detailed licensing terms, please refer to the LICENSE file included
+ *  with this distribution or contact us at info[at]areg.tech.
+ *
+ *  \copyright   © 2025 Aregtech UG. All rights reserved.
+ *  \file        multiedge/aiagent/agentstatistics.cpp
+ *  \ingroup     Areg Edge AI, AI Multi Edge Device Agent
+ *  \author      Artak Avetyan
+ *  \brief       Edge AI Agent per-phase latency statistics of processed texts.
+ *
+ ************************************************************************/
+#include "multiedge/aiagent/agentstatistics.hpp"
+
+#include <algorithm>
+
+namespace
+{
+    //!< The number of microseconds in second.
+    constexpr uint64_t  MICROS_IN_SEC   { 1000000u };
+
+    //!< Returns the number of tokens per second.
+    inline uint32_t _rate(uint64_t tokens, uint64_t time)
+    {
+        return (time != 0u ? static_cast<uint32_t>(tokens * MICROS_IN_SEC / time) : 0u);
+    }
+}
+
+AgentStatistics::AgentStatistics(void)
+    : mSamples  ( )
+    , mNext     (0u)
+{
+    mSamples.reserve(WINDOW_SIZE);
+}
+
+void AgentStatistics::addSample(const AgentStatistics::sSample& sample)
+{
+    if (mSamples.size() < WINDOW_SIZE)
+    {
+        mSamples.push_back(sample);
+    }
+    else
+    {
+        mSamples[mNext] = sample;
+    }
+
+    mNext = (mNext + 1u) % WINDOW_SIZE;
+}
+
+NEMultiEdge::sTextLatency AgentStatistics::getLatency(void) const
+{
+    NEMultiEdge::sTextLatency result;
+    result.texts        = static_cast<uint32_t>(mSamples.size());
+    result.queueWait    = _phaseLatency(PhaseQueue);
+    result.tokenize     = _phaseLatency(PhaseTokenize);
+    result.prefill      = _phaseLatency(PhasePrefill);
+    result.firstToken   = _phaseLatency(PhaseFirstToken);
+    result.decode       = _phaseLatency(PhaseDecode);
+    result.response     = _phaseLatency(PhaseResponse);
+
+    uint64_t prefillTokens{ 0u }, prefillTime{ 0u }, decodeTokens{ 0u }, decodeTime{ 0u };
+    for (const sSample& sample : mSamples)
+    {
+        prefillTokens   += sample.prefillTokens;
+        prefillTime     += sample.phases[PhasePrefill];
+        decodeTokens    += sample.decodeTokens;
+        decodeTime      += sample.phases[PhaseDecode];
+        result.draftTokens   += sample.draftTokens;
+        result.acceptedTokens+= sample.acceptTokens;
+    }
+
+    result.prefillRate  = _rate(prefillTokens, prefillTime);
+    result.decodeRate   = _rate(decodeTokens, decodeTime);
+    return result;
+}
+
+void AgentStatistics::clear(void)
+{
+    mSamples.clear();
+    mNext = 0u;
+}
+
+NEMultiEdge::sPhaseLatency AgentStatistics::_phaseLatency(AgentStatistics::ePhase phase) const
+{
+    NEMultiEdge::sPhaseLatency result;
+    if (mSamples.empty())
+        return result;
+
+    std::vector<uint64_t> values;
+    values.reserve(mSamples.size());
+    uint64_t sum{ 0u };
+    for (const sSample& sample : mSamples)
+    {
+        values.push_back(sample.phases[phase]);
+        sum += sample.phases[phase];
+    }
+
+    const size_t last = values.size() - 1u;
+    std::nth_element(values.begin(), values.begin() + (last * 50u) / 100u, values.end());
+    result.median   = static_cast<uint32_t>(values[(last * 50u) / 100u]);
+    std::nth_element(values.begin(), values.begin() + (last * 99u) / 100u, values.end());
+    result.tail     = static_cast<uint32_t>(values[(last * 99u) / 100u]);
+    result.average  = static_cast<uint32_t>(sum / values.size());
+    return result;
+}
@@ -0,0 +1,136 @@
+﻿#ifndef MULTIEDGE_AIAGENT_AGENTSTATISTICS_HPP
+#define MULTIEDGE_AIAGENT_AGENTSTATISTICS_HPP
+/************************************************************************
+ * This file is part of the Areg Edge AI project powered by AREG SDK.
+ * The project contains multiple examples of using Edge AI based on Areg communication framework.
+ *
+ *  Areg Edge AI is available as free and open-source software under the MIT License.
+ *
+ *  For detailed licensing terms, please refer to the LICENSE file included
+ *  with this distribution or contact us at info[at]areg.tech.
+ *
+ *  \copyright   © 2025 Aregtech UG. All rights reserved.
+ *  \file        multiedge/aiagent/agentstatistics.hpp
+ *  \ingroup     Areg Edge AI, AI Multi Edge Device Agent
+ *  \author      Artak Avetyan
+ *  \brief       Edge AI Agent per-phase latency statistics of processed texts.
+ *
+ ************************************************************************/
+
+/************************************************************************
+ * Includes
+ ************************************************************************/
+
+#include "areg/base/GEGlobal.h"
+#include "multiedge/resources/NEMultiEdge.hpp"
+
+#include <array>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////
+// AgentStatistics class declaration
+//////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief   The rolling statistics of the latency of processing the texts.
+ *          Every processed text adds a sample with the time of each phase,
+ *          the statistics are computed over the last samples: the average,
+ *          the median and the 99th percentile per phase, and the prefill
+ *          and decode token rates, and the tokens proposed and accepted by
+ *          the speculative decoding. The statistics are not thread safe.
+ **/
+class AgentStatistics
+{
+//////////////////////////////////////////////////////////////////////////
+// Internal types and constants
+//////////////////////////////////////////////////////////////////////////
+public:
+    //!< The phases of processing the text.
+    enum ePhase : uint32_t
+    {
+          PhaseQueue        = 0 //!< Waiting in the queues of the provider and the engine.
+        , PhaseTokenize         //!< Tokenizing the prompt.
+        , PhasePrefill          //!< Decoding the prompt and sampling the first token.
+        , PhaseFirstToken       //!< From receiving the request until the first piece of the reply.
+        , PhaseDecode           //!< Generating the rest of the reply.
+        , PhaseResponse         //!< Serializing and sending the response.
+        , PhaseCount            //!< The number of phases.
+    };
+
+    static constexpr uint32_t   WINDOW_SIZE { 256u };   //!< The number of the last samples to compute the statistics.
+
+    //!< The measured processing of the text, the times are in microseconds.
+    struct sSample
+    {
+        std::array<uint64_t, PhaseCount>    phases          { };    //!< The time of each phase.
+        uint32_t                            prefillTokens   { 0u }; //!< The number of decoded prompt tokens.
+        uint32_t                            decodeTokens    { 0u }; //!< The number of tokens generated after the first.
+        uint32_t                            draftTokens     { 0u }; //!< The number of tokens proposed by the speculative decoding.
+        uint32_t                            acceptTokens    { 0u }; //!< The number of proposed tokens accepted by the target model.
+    };
+
+//////////////////////////////////////////////////////////////////////////
+// Constructor / Destructor
+//////////////////////////////////////////////////////////////////////////
+public:
+    AgentStatistics(void);
+    ~AgentStatistics(void) = default;
+
+//////////////////////////////////////////////////////////////////////////
+// Attributes and operations
+//////////////////////////////////////////////////////////////////////////
+public:
+
+    /**
+     * \brief   Adds the sample of the processed text. The oldest sample is
+     *          replaced when the window is full.
+     **/
+    void addSample(const AgentStatistics::sSample& sample);
+
+    /**
+     * \brief   Computes the statistics of the samples in the window.
+     **/
+    NEMultiEdge::sTextLatency getLatency(void) const;
+
+    /**
+     * \brief   Returns the number of samples in the window.
+     **/
+    inline uint32_t getCount(void) const;
+
+    /**
+     * \brief   Removes all samples.
+     **/
+    void clear(void);
+
+//////////////////////////////////////////////////////////////////////////
+// Hidden methods
+//////////////////////////////////////////////////////////////////////////
+private:
+
+    //!< Computes the average, median and tail of the phase.
+    NEMultiEdge::sPhaseLatency _phaseLatency(AgentStatistics::ePhase phase) const;
+
+//////////////////////////////////////////////////////////////////////////
+// Member variables
+//////////////////////////////////////////////////////////////////////////
+private:
+    std::vector<sSample>    mSamples;   //!< The ring of the last samples.
+    uint32_t                mNext;      //!< The position of the next sample.
+
+//////////////////////////////////////////////////////////////////////////
+// Forbidden calls
+//////////////////////////////////////////////////////////////////////////
+private:
+    DECLARE_NOCOPY_NOMOVE(AgentStatistics);
+};
+
+//////////////////////////////////////////////////////////////////////////
+// Inline methods
+//////////////////////////////////////////////////////////////////////////
+
+inline uint32_t AgentStatistics::getCount(void) const
+{
+    return static_cast<uint32_t>(mSamples.size());
+}
+
+#endif // MULTIEDGE_AIAGENT_AGENTSTATISTICS_HPP
@@ -0,0 +1,77 @@
+﻿#ifndef MULTIEDGE_AIAGENT_AGENTTEXT_HPP
+#define MULTIEDGE_AIAGENT_AGENTTEXT_HPP
+/************************************************************************
+ * This file is part of the Areg Edge AI project powered by AREG SDK.
+ * The project contains multiple examples of using Edge AI based on Areg communication framework.
+ *
+ *  Areg Edge AI is available as free and open-source software under the MIT License.
+ *
+ *  For detailed licensing terms, please refer to the LICENSE file included
+ *  with this distribution or contact us at info[at]areg.tech.
+ *
+ *  \copyright   © 2025 Aregtech UG. All rights reserved.
+ *  \file        multiedge/aiagent/agenttext.hpp
+ *  \ingroup     Areg Edge AI, AI Multi Edge Device Agent
+ *  \author      Artak Avetyan
+ *  \brief       Edge AI Agent text of the prompts and replies shared by the threads.
+ *
+ ************************************************************************/
+
+/************************************************************************
+ * Includes
+ ************************************************************************/
+
+#include "areg/base/GEGlobal.h"
+#include "areg/base/String.hpp"
+
+#include <memory>
+
+//////////////////////////////////////////////////////////////////////////
+// SharedText type declaration
+//////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief   The immutable UTF-8 text shared by the reference counter. The prompt
+ *          is copied once from the request of the service, the reply is moved
+ *          from the engine. The threads, the caches and the GUI share the same
+ *          text, the GUI converts it only to display. The text is never nullptr.
+ **/
+using SharedText = std::shared_ptr<const String>;
+
+//////////////////////////////////////////////////////////////////////////
+// SharedText helper methods
+//////////////////////////////////////////////////////////////////////////
+
+namespace NEAgentText
+{
+    //!< Creates the shared text taking the content of the string.
+    inline SharedText makeText(String&& text);
+
+    //!< Creates the shared text copying the string.
+    inline SharedText makeText(const String& text);
+
+    //!< Returns the shared empty text.
+    inline const SharedText& emptyText(void);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Inline methods
+//////////////////////////////////////////////////////////////////////////
+
+inline SharedText NEAgentText::makeText(String&& text)
+{
+    return std::make_shared<const String>(std::move(text));
+}
+
+inline SharedText NEAgentText::makeText(const String& text)
+{
+    return std::make_shared<const String>(text);
+}
+
+inline const SharedText& NEAgentText::emptyText(void)
+{
+    static const SharedText _empty{ std::make_shared<const String>() };
+    return _empty;
+}
+
+#endif // MULTIEDGE_AIAGENT_AGENTTEXT_HPP
@@ -0,0 +1,132 @@
+﻿/************************************************************************
+ * This file is part of the Areg Edge AI project powered by AREG SDK.
+ * The project contains multiple examples of using Edge AI based on Areg communication framework.
+ *
+ *  Areg Edge AI is available as free and open-source software under the MIT License.
+ *
+ *  For detailed licensing terms, please refer to the LICENSE file included
+ *  with this distribution or contact us at info[at]areg.tech.
+ *
+ *  \copyright   © 2025 Aregtech UG. All rights reserved.
+ *  \file        multiedge/aiagent/agenttokenizer.cpp
+ *  \ingroup     Areg Edge AI, AI Multi Edge Device Agent
+ *  \author      Artak Avetyan
+ *  \brief       Edge AI Agent tokenizer of the prompts.
+ *
+ ************************************************************************/
+#include "multiedge/aiagent/agenttokenizer.hpp"
+#include "areg/logging/GELog.h"
+
+#include <algorithm>
+#include <limits>
+
+DEF_LOG_SCOPE(multiedge_aiagent_AgentTokenizer_openVocab);
+
+AgentTokenizer::AgentTokenizer(void)
+    : mVocabs   ( )
+    , mBuffer   ( )
+{
+}
+
+AgentTokenizer::~AgentTokenizer(void)
+{
+    clear();
+}
+
+llama_model* AgentTokenizer::openVocab(const String& modelPath)
+{
+    LOG_SCOPE(multiedge_aiagent_AgentTokenizer_openVocab);
+
+    llama_model_params params = llama_model_default_params();
+    params.vocab_only   = true;
+    params.use_mmap     = true;
+
+    llama_model* result = llama_model_load_from_file(modelPath.getString(), params);
+    if (result == nullptr)
+    {
+        LOG_ERR("Failed to load vocabulary of model [ %s ]", modelPath.getString());
+    }
+
+    return result;
+}
+
+bool AgentTokenizer::tokenize(const llama_vocab* vocab, const String& text, std::vector<llama_token>& tokens, bool addBos, bool parseSpecial)
+{
+    tokens.clear();
+    if ((vocab == nullptr) || text.isEmpty())
+        return false;
+
+    // Every token has at least one byte, only the BOS and EOS tokens are added.
+    tokens.resize(static_cast<size_t>(text.getLength()) + 2u);
+    int32_t count = llama_tokenize(vocab, text.getString(), static_cast<int32_t>(text.getLength()), tokens.data(), static_cast<int32_t>(tokens.size()), addBos, parseSpecial);
+    if ((count < 0) && (count != std::numeric_limits<int32_t>::min()))
+    {
+        tokens.resize(static_cast<size_t>(-count));
+        count = llama_tokenize(vocab, text.getString(), static_cast<int32_t>(text.getLength()), tokens.data(), static_cast<int32_t>(tokens.size()), addBos, parseSpecial);
+    }
+
+    if (count <= 0)
+    {
+        LOG_ERR("Failed to tokenize the text, returned value %d", count);
+        tokens.clear();
+        return false;
+    }
+
+    tokens.resize(static_cast<size_t>(count));
+    return true;
+}
+
+void AgentTokenizer::addVocab(const String& name, llama_model* vocab)
+{
+    if (vocab == nullptr)
+        return;
+
+    ListVocabs::iterator pos = std::find_if(mVocabs.begin(), mVocabs.end(), [&name](const sVocab& entry) { return (entry.name == name); });
+    if (pos != mVocabs.end())
+    {
+        llama_model_free(pos->model);
+        mVocabs.erase(pos);
+    }
+    else if (mVocabs.size() >= MAX_VOCABS)
+    {
+        LOG_DBG("Releasing the least recently used vocabulary of model [ %s ]", mVocabs.front().name.getString());
+        llama_model_free(mVocabs.front().model);
+        mVocabs.erase(mVocabs.begin());
+    }
+
+    mVocabs.push_back(sVocab{ name, vocab });
+}
+
+bool AgentTokenizer::hasVocab(const String& name) const
+{
+    return std::any_of(mVocabs.begin(), mVocabs.end(), [&name](const sVocab& entry) { return (entry.name == name); });
+}
+
+void AgentTokenizer::clear(void)
+{
+    for (sVocab& entry : mVocabs)
+    {
+        llama_model_free(entry.model);
+    }
+
+    mVocabs.clear();
+}
+
+bool AgentTokenizer::tokenize(const String& name, const String& prompt, std::vector<llama_token>& tokens)
+{
+    ListVocabs::iterator pos = std::find_if(mVocabs.begin(), mVocabs.end(), [&name](const sVocab& entry) { return (entry.name == name); });
+    if (pos == mVocabs.end())
+        return false;
+
+    if (pos != mVocabs.end() - 1)
+    {
+        std::rotate(pos, pos + 1, mVocabs.end());
+    }
+
+    // The buffer keeps its capacity, the prompt gets the list of the exact size.
+    if (tokenize(llama_model_get_vocab(mVocabs.back().model), prompt, mBuffer, false, true) == false)
+        return false;
+
+    tokens.assign(mBuffer.begin(), mBuffer.end());
+    return true;
+}
@@ -0,0 +1,138 @@
+﻿#ifndef MULTIEDGE_AIAGENT_AGENTTOKENIZER_HPP
+#define MULTIEDGE_AIAGENT_AGENTTOKENIZER_HPP
+/************************************************************************
+ * This file is part of the Areg Edge AI project powered by AREG SDK.
+ * The project contains multiple examples of using Edge AI based on Areg communication framework.
+ *
+ *  Areg Edge AI is available as free and open-source software under the MIT License.
+ *
+ *  For detailed licensing terms, please refer to the LICENSE file included
+ *  with this distribution or contact us at info[at]areg.tech.
+ *
+ *  \copyright   © 2025 Aregtech UG. All rights reserved.
+ *  \file        multiedge/aiagent/agenttokenizer.hpp
+ *  \ingroup     Areg Edge AI, AI Multi Edge Device Agent
+ *  \author      Artak Avetyan
+ *  \brief       Edge AI Agent tokenizer of the prompts.
+ *
+ ************************************************************************/
+
+/************************************************************************
+ * Includes
+ ************************************************************************/
+
+#include "areg/base/GEGlobal.h"
+#include "areg/base/String.hpp"
+#include "llama.h"
+
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////
+// AgentTokenizer class declaration
+//////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief   The tokenizer of the prompts before they are dispatched to the worker
+ *          thread, so that the tokenization does not delay the decoding and the
+ *          scheduler knows the number of tokens of the prompt. The tokenizer holds
+ *          the vocabularies of the models loaded without the weights, the least
+ *          recently used vocabulary is released if there are too many. The text
+ *          is tokenized in one pass to the reusable buffer. The tokenizer is not
+ *          thread safe, the vocabularies are loaded in any thread by openVocab().
+ **/
+class AgentTokenizer
+{
+//////////////////////////////////////////////////////////////////////////
+// Internal types and constants
+//////////////////////////////////////////////////////////////////////////
+public:
+    static constexpr uint32_t   MAX_VOCABS  { 8u };     //!< The maximum number of vocabularies held by the tokenizer.
+
+private:
+    //!< The vocabulary of the model.
+    struct sVocab
+    {
+        String          name    { };        //!< The file name of the model.
+        llama_model*    model   { nullptr };//!< The model loaded without the weights.
+    };
+
+    //!< The vocabularies, the most recently used is the last.
+    using ListVocabs = std::vector<sVocab>;
+
+//////////////////////////////////////////////////////////////////////////
+// Constructor / Destructor
+//////////////////////////////////////////////////////////////////////////
+public:
+    AgentTokenizer(void);
+    ~AgentTokenizer(void);
+
+//////////////////////////////////////////////////////////////////////////
+// Attributes and operations
+//////////////////////////////////////////////////////////////////////////
+public:
+
+    /**
+     * \brief   Loads the vocabulary of the model without the weights. Does not access
+     *          the tokenizer and can be called in any thread.
+     * \param   modelPath   The absolute path to the GGUF model file.
+     * \return  Returns the loaded vocabulary or nullptr if failed. The caller owns the model.
+     **/
+    static llama_model* openVocab(const String& modelPath);
+
+    /**
+     * \brief   Tokenizes the text in one pass. The tokens are written directly to the list
+     *          sized for the longest result, the list is resized only if the text has more
+     *          tokens than bytes, which happens only with the special tokens added.
+     * \param   vocab           The vocabulary of the model.
+     * \param   text            The text to tokenize.
+     * \param   tokens          On output contains the tokens of the text.
+     * \param   addBos          Flag, indicating to add the BOS token, if the model uses it.
+     * \param   parseSpecial    Flag, indicating to parse the special tokens in the text.
+     * \return  Returns true if the text is tokenized and has at least one token.
+     **/
+    static bool tokenize(const llama_vocab* vocab, const String& text, std::vector<llama_token>& tokens, bool addBos, bool parseSpecial);
+
+    /**
+     * \brief   Adds the vocabulary of the model. The vocabulary of the same name is replaced.
+     * \param   name    The file name of the model.
+     * \param   vocab   The vocabulary loaded by openVocab(). The tokenizer takes the ownership.
+     **/
+    void addVocab(const String& name, llama_model* vocab);
+
+    /**
+     * \brief   Returns true if the vocabulary of the model is loaded.
+     * \param   name    The file name of the model.
+     **/
+    bool hasVocab(const String& name) const;
+
+    /**
+     * \brief   Releases all vocabularies.
+     **/
+    void clear(void);
+
+    /**
+     * \brief   Tokenizes the prompt by the vocabulary of the model without the BOS token,
+     *          the BOS token is added by the engine when the prompt starts the sequence.
+     * \param   name    The file name of the model to process the prompt.
+     * \param   prompt  The text of the prompt to tokenize.
+     * \param   tokens  On output contains the tokens of the prompt.
+     * \return  Returns true if the prompt is tokenized. Returns false if the vocabulary
+     *          of the model is not loaded or the tokenization failed.
+     **/
+    bool tokenize(const String& name, const String& prompt, std::vector<llama_token>& tokens);
+
+//////////////////////////////////////////////////////////////////////////
+// Member variables
+//////////////////////////////////////////////////////////////////////////
+private:
+    ListVocabs                  mVocabs;    //!< The loaded vocabularies.
+    std::vector<llama_token>    mBuffer;    //!< The reusable buffer of the tokens.
+
+//////////////////////////////////////////////////////////////////////////
+// Forbidden calls
+//////////////////////////////////////////////////////////////////////////
+private:
+    DECLARE_NOCOPY_NOMOVE(AgentTokenizer);
+};
+
+#endif // MULTIEDGE_AIAGENT_AGENTTOKENIZER_HPP
@@ -26,24 +26,21 @@
 #include "multiedge/aiagent/agentprovider.hpp"
 #include "multiedge/aiagent/agentchathistory.hpp"
 #include "multiedge/aiagent/agentprocessor.hpp"
+#include "multiedge/aiagent/agentresponsecache.hpp"
+#include "multiedge/aiagent/agentsemanticcache.hpp"
 
 #include <QDir>
 #include <QFileDialog>
 #include <QListWidgetItem>
+#include <QMessageBox>
+#include <QSignalBlocker>
 #include <QString>
+#include <algorithm>
 #include <any>
 
-BEGIN_MODEL(NEMultiEdgeSettings::MODEL_PROVIDER.data())
-    BEGIN_REGISTER_THREAD(NEMultiEdgeSettings::AGENT_THREAD.data())
-        BEGIN_REGISTER_COMPONENT(NEMultiEdgeSettings::SERVICE_PROVIDER.data(), AgentProvider)
-            REGISTER_IMPLEMENT_SERVICE(NEMultiEdge::ServiceName, NEMultiEdge::InterfaceVersion)
-            REGISTER_WORKER_THREAD(NEMultiEdgeSettings::WORKER_THREAD.data(), NEMultiEdgeSettings::CONSUMER_NAME.data())
-        END_REGISTER_COMPONENT(NEMultiEdgeSettings::SERVICE_PROVIDER.data())
-    END_REGISTER_THREAD(NEMultiEdgeSettings::AGENT_THREAD.data())
-END_MODEL(NEMultiEdgeSettings::MODEL_PROVIDER.data())
-
 AIAgent::AIAgent(QWidget *parent)
     : QDialog   (parent)
+    , IEAgentHost( )
     , ui        (new Ui::AIAgent)
     , mAddress  (QString::fromStdString(NEMultiEdgeSettings::ROUTER_ADDRESS.data()))
     , mPort     (NEMultiEdgeSettings::ROUTER_PORT)
@@ -51,6 +48,10 @@ AIAgent::AIAgent(QWidget *parent)
     , mModelDir ( )
     , mAIModelName( )
     , mAIModelPath( )
+    , mDraftModelName( )
+    , mDraftModelPath( )
+    , mEmbedModelName( )
+    , mEmbedModelPath( )
 {
     ui->setupUi(this);
     setupData();
@@ -64,6 +65,45 @@ AIAgent::~AIAgent()
     delete ui;
 }
 
+String AIAgent::getActiveModelPath(void) const
+{
+    return String(mAIModelPath.toStdString());
+}
+
+String AIAgent::getDraftModelPath(void) const
+{
+    return String(mDraftModelPath.toStdString());
+}
+
+String AIAgent::getEmbedModelPath(void) const
+{
+    return String(mEmbedModelPath.toStdString());
+}
+
+void AIAgent::onProviderStarted(AgentProvider& provider)
+{
+    connect(&provider, &AgentProvider::signalServiceStarted    , this, &AIAgent::slotServiceStarted    , Qt::ConnectionType::QueuedConnection);
+    connect(&provider, &AgentProvider::signalActiveModelChanged, this, &AIAgent::slotActiveModelChanged, Qt::ConnectionType::QueuedConnection);
+    connect(&provider, &AgentProvider::signalActiveModelFailed , this, &AIAgent::slotActiveModelFailed , Qt::ConnectionType::QueuedConnection);
+    connect(&provider, &AgentProvider::signalQueueSize         , this, &AIAgent::slotAgentQueueSize    , Qt::ConnectionType::QueuedConnection);
+    connect(&provider, &AgentProvider::signalEdgeAgent         , this, &AIAgent::slotAgentType         , Qt::ConnectionType::QueuedConnection);
+    connect(&provider, &AgentProvider::signalTextRequested     , this, &AIAgent::slotTextRequested     , Qt::ConnectionType::QueuedConnection);
+    connect(&provider, &AgentProvider::signalTextProcessed     , this, &AIAgent::slotTextProcessed     , Qt::ConnectionType::QueuedConnection);
+    connect(&provider, &AgentProvider::signalQueueWait         , this, &AIAgent::slotQueueWait         , Qt::ConnectionType::QueuedConnection);
+}
+
+void AIAgent::onProviderStopped(AgentProvider& provider)
+{
+    disconnect(&provider, &AgentProvider::signalServiceStarted    , this, &AIAgent::slotServiceStarted);
+    disconnect(&provider, &AgentProvider::signalActiveModelChanged, this, &AIAgent::slotActiveModelChanged);
+    disconnect(&provider, &AgentProvider::signalActiveModelFailed , this, &AIAgent::slotActiveModelFailed );
+    disconnect(&provider, &AgentProvider::signalQueueSize         , this, &AIAgent::slotAgentQueueSize);
+    disconnect(&provider, &AgentProvider::signalEdgeAgent         , this, &AIAgent::slotAgentType     );
+    disconnect(&provider, &AgentProvider::signalTextRequested     , this, &AIAgent::slotTextRequested );
+    disconnect(&provider, &AgentProvider::signalTextProcessed     , this, &AIAgent::slotTextProcessed );
+    disconnect(&provider, &AgentProvider::signalQueueWait         , this, &AIAgent::slotQueueWait     );
+}
+
 void AIAgent::slotServiceStarted(bool isStarted)
 {
 }
@@ -78,6 +118,20 @@ void AIAgent::slotActiveModelChanged(QString modelName)
     ctrlActiveModel()->setText(modelName);
 }
 
+void AIAgent::slotActiveModelFailed(QString modelPath)
+{
+    // The selected model is not active, the model to restart with is the one still active.
+    const QString activeName(ctrlActiveModel()->text());
+    QFileInfo fi(mModelDir, activeName);
+    if ((activeName != "N/A") && fi.exists())
+    {
+        mAIModelName = activeName;
+        mAIModelPath = fi.absoluteFilePath();
+    }
+
+    QMessageBox::warning(this, tr("Model Activation"), tr("Failed to load model %1, the active model is %2.").arg(QFileInfo(modelPath).fileName(), activeName));
+}
+
 void AIAgent::slotAgentType(NEMultiEdge::eEdgeAgent EdgeAgent)
 {
     const QString _agents[]
@@ -91,7 +145,7 @@ void AIAgent::slotAgentType(NEMultiEdge::eEdgeAgent EdgeAgent)
     ui->TxtAgentType->setText(_agents[static_cast<int>(EdgeAgent)]);
 }
 
-void AIAgent::slotTextRequested(uint32_t sessionId, uint32_t seqId, uint32_t id, QString question, uint64_t stamp)
+void AIAgent::slotTextRequested(uint32_t sessionId, uint32_t seqId, uint32_t id, SharedText question, uint64_t stamp)
 {
     if (mModel != nullptr)
     {
@@ -99,7 +153,7 @@ void AIAgent::slotTextRequested(uint32_t sessionId, uint32_t seqId, uint32_t id,
     }
 }
 
-void AIAgent::slotTextProcessed(uint32_t sessionId, uint32_t seqId, uint32_t id, QString reply, uint64_t stamp)
+void AIAgent::slotTextProcessed(uint32_t sessionId, uint32_t seqId, uint32_t id, SharedText reply, uint64_t stamp)
 {
     if (mModel != nullptr)
     {
@@ -107,6 +161,11 @@ void AIAgent::slotTextProcessed(uint32_t sessionId, uint32_t seqId, uint32_t id,
     }
 }
 
+void AIAgent::slotQueueWait(uint64_t waitMedian, uint64_t waitTail)
+{
+    ui->TxtQueueWait->setText(QString("%1 / %2 ms").arg(waitMedian / 1000u).arg(waitTail / 1000u));
+}
+
 void AIAgent::slotVideoProcessed(uint32_t sessionId, uint32_t seqId, uint32_t id, SharedBuffer video)
 {
 }
@@ -233,6 +292,9 @@ void AIAgent::onModelLocationClicked(bool clicked)
             {
                 listModels->setCurrentItem(items[0]);
             }
+
+            setDraftModels(models);
+            setEmbeddingModels(models);
         }
     }
 }
@@ -281,6 +343,35 @@ void AIAgent::onTableSelChanged(const QModelIndex &index)
     ctrlDisplay()->setPlainText(msg);
 }
 
+void AIAgent::onDraftChanged(int index)
+{
+    // The first entry disables the speculative decoding.
+    QString draftName = (index > 0 ? ui->CmbDraft->itemText(index) : QString());
+    QFileInfo fi(mModelDir, draftName);
+    mDraftModelName = draftName;
+    mDraftModelPath = (draftName.isEmpty() == false) && fi.exists() ? fi.absoluteFilePath() : QString();
+    AgentProvider::activateDraft(mDraftModelPath);
+}
+
+void AIAgent::onEmbeddingChanged(int index)
+{
+    // The first entry computes the embeddings by the active model.
+    QString embedName = (index > 0 ? ui->CmbEmbedding->itemText(index) : QString());
+    QFileInfo fi(mModelDir, embedName);
+    mEmbedModelName = embedName;
+    mEmbedModelPath = (embedName.isEmpty() == false) && fi.exists() ? fi.absoluteFilePath() : QString();
+    AgentProvider::activateEmbedder(mEmbedModelPath, getSimilarity());
+}
+
+void AIAgent::onPolicyChanged(int index)
+{
+    if (index >= 0)
+    {
+        ui->TxtQueueWait->setText("N/A");
+        AgentProvider::setSchedulingPolicy(static_cast<AgentScheduler::ePolicy>(index));
+    }
+}
+
 void AIAgent::setupData(void)
 {
     ConnectionConfiguration config(NERemoteService::eRemoteServices::ServiceRouter, NERemoteService::eConnectionTypes::ConnectTcpip);
@@ -296,16 +387,51 @@ void AIAgent::setupData(void)
     ui->TxtQueueSize->setText("N/A");
     ui->TxtAgentType->setText("N/A");
     ui->TxtModelDir->setText("N/A");
+    ui->TxtQueueWait->setText("N/A");
+
+    for (uint32_t i = 0; i < static_cast<uint32_t>(AgentScheduler::PolicyCount); ++ i)
+    {
+        ui->CmbPolicy->addItem(AgentScheduler::getString(static_cast<AgentScheduler::ePolicy>(i)));
+    }
+
+    ui->CmbPolicy->setCurrentIndex(static_cast<int>(AgentScheduler::PolicyFair));
+
+    for (uint32_t i = 0; i < static_cast<uint32_t>(AgentContextPool::CacheCount); ++ i)
+    {
+        ui->CmbCacheK->addItem(AgentContextPool::getString(static_cast<AgentContextPool::eCacheType>(i)));
+        ui->CmbCacheV->addItem(AgentContextPool::getString(static_cast<AgentContextPool::eCacheType>(i)));
+    }
+
+    for (uint32_t i = 0; i < static_cast<uint32_t>(AgentContextPool::FlashCount); ++ i)
+    {
+        ui->CmbFlashAttn->addItem(AgentContextPool::getString(static_cast<AgentContextPool::eFlashAttention>(i)));
+    }
+
+    ui->CmbCacheK->setCurrentIndex(static_cast<int>(AgentContextPool::CacheF16));
+    ui->CmbCacheV->setCurrentIndex(static_cast<int>(AgentContextPool::CacheF16));
+    ui->CmbFlashAttn->setCurrentIndex(static_cast<int>(AgentContextPool::FlashAuto));
     
     ui->TxtLength->setValidator(    new QIntValidator(AgentProcessor::MIN_CHARS   , AgentProcessor::MAX_CHARS         , this));
     ui->TxtTokens->setValidator(    new QIntValidator(AgentProcessor::MIN_TOKENS  , AgentProcessor::MAX_TOKENS        , this));
     ui->TxtBatching->setValidator(  new QIntValidator(AgentProcessor::MIN_BATCHING, AgentProcessor::MAX_BATCHING      , this));
     ui->TxtThreads->setValidator(   new QIntValidator(AgentProcessor::MIN_THREADS , AgentProcessor::optThreadCount()  , this));
+    ui->TxtCache->setValidator(     new QIntValidator(AgentProcessor::MIN_CACHE_MB, AgentProcessor::MAX_CACHE_MB      , this));
+    ui->TxtSessions->setValidator(  new QIntValidator(AgentProcessor::MIN_SESSION_MB, AgentProcessor::MAX_SESSION_MB  , this));
+    ui->TxtContext->setValidator(   new QIntValidator(AgentProcessor::MIN_CONTEXT_MB, AgentProcessor::MAX_CONTEXT_MB  , this));
+    ui->TxtModels->setValidator(    new QIntValidator(AgentProcessor::MIN_MODELS_MB , AgentProcessor::MAX_MODELS_MB   , this));
+    ui->TxtReplies->setValidator(   new QIntValidator(AgentResponseCache::MIN_ENTRIES, AgentResponseCache::MAX_ENTRIES, this));
+    ui->TxtSimilarity->setValidator(new QIntValidator(AgentSemanticCache::MIN_SIMILARITY, AgentSemanticCache::MAX_SIMILARITY, this));
     
     ui->TxtLength->setText(QString::number(AgentProcessor::DEF_CHARS));
     ui->TxtTokens->setText(QString::number(AgentProcessor::DEF_TOKENS));
     ui->TxtBatching->setText(QString::number(AgentProcessor::DEF_BATCHING));
     ui->TxtThreads->setText(QString::number(AgentProcessor::defThreadCount()));
+    ui->TxtCache->setText(QString::number(AgentProcessor::DEF_CACHE_MB));
+    ui->TxtSessions->setText(QString::number(AgentProcessor::DEF_SESSION_MB));
+    ui->TxtContext->setText(QString::number(AgentProcessor::DEF_CONTEXT_MB));
+    ui->TxtModels->setText(QString::number(AgentProcessor::DEF_MODELS_MB));
+    ui->TxtReplies->setText(QString::number(AgentResponseCache::DEF_ENTRIES));
+    ui->TxtSimilarity->setText(QString::number(AgentSemanticCache::DEF_SIMILARITY));
     
     mModel = new AgentChatHistory(this);
     ctrlTable()->setModel(mModel);
@@ -337,6 +463,8 @@ void AIAgent::setupWidgets(void)
     QStringList list = scanTextLlamaModels(QString());
     ctrlLocation()->setText(mModelDir);
     listModels->addItems(list);
+    setDraftModels(list);
+    setEmbeddingModels(list);
     if (list.isEmpty() == false)
     {
         listModels->setCurrentRow(0);
@@ -369,12 +497,16 @@ void AIAgent::setupSignals(void)
     connect(ctrlModels()    , &QListWidget::currentRowChanged, this, &AIAgent::onModelsRowChanged);
     connect(ctrlTable()     , &QTableView::activated        , this , &AIAgent::onTableSelChanged);
     connect(ctrlTable()     , &QTableView::doubleClicked    , this , &AIAgent::onTableSelChanged);
-    connect(ui->BtnAnswer   , &QRadioButton::toggled, this, [this](bool checked){if (checked) setTemperature(0.00f, 0.00f);});
-    connect(ui->BtnPrecise  , &QRadioButton::toggled, this, [this](bool checked){if (checked) setTemperature(0.10f, 0.12f);});
-    connect(ui->BtnBalanced , &QRadioButton::toggled, this, [this](bool checked){if (checked) setTemperature(0.30f, 0.10f);});
-    connect(ui->BtnConvers  , &QRadioButton::toggled, this, [this](bool checked){if (checked) setTemperature(0.50f, 0.08f);});
-    connect(ui->BtnCreative , &QRadioButton::toggled, this, [this](bool checked){if (checked) setTemperature(0.75f, 0.06f);});
-    connect(ui->BtnExperim  , &QRadioButton::toggled, this, [this](bool checked){if (checked) setTemperature(1.00f, 0.05f);});
+    connect(ui->CmbPolicy   , &QComboBox::currentIndexChanged, this, &AIAgent::onPolicyChanged);
+    connect(ui->CmbDraft    , &QComboBox::currentIndexChanged, this, &AIAgent::onDraftChanged);
+    connect(ui->CmbEmbedding, &QComboBox::currentIndexChanged, this, &AIAgent::onEmbeddingChanged);
+    // The precise profiles mostly repeat the phrases of the prompt and speculate the tokens by the prompt lookup.
+    connect(ui->BtnAnswer   , &QRadioButton::toggled, this, [this](bool checked){if (checked) setTemperature(0.00f, 0.00f, true );});
+    connect(ui->BtnPrecise  , &QRadioButton::toggled, this, [this](bool checked){if (checked) setTemperature(0.10f, 0.12f, true );});
+    connect(ui->BtnBalanced , &QRadioButton::toggled, this, [this](bool checked){if (checked) setTemperature(0.30f, 0.10f, true );});
+    connect(ui->BtnConvers  , &QRadioButton::toggled, this, [this](bool checked){if (checked) setTemperature(0.50f, 0.08f, false);});
+    connect(ui->BtnCreative , &QRadioButton::toggled, this, [this](bool checked){if (checked) setTemperature(0.75f, 0.06f, false);});
+    connect(ui->BtnExperim  , &QRadioButton::toggled, this, [this](bool checked){if (checked) setTemperature(1.00f, 0.05f, false);});
 }
 
 bool AIAgent::routerConnect(void)
@@ -391,7 +523,7 @@ bool AIAgent::routerConnect(void)
         {
             mModel->resetHistory();
             ctrlTab()->setCurrentIndex(1);
-            if (ComponentLoader::setComponentData(NEMultiEdgeSettings::SERVICE_PROVIDER.data(), std::make_any<AIAgent *>(this)))
+            if (ComponentLoader::setComponentData(NEMultiEdgeSettings::SERVICE_PROVIDER.data(), std::make_any<IEAgentHost *>(static_cast<IEAgentHost *>(this))))
             {
                 QListWidgetItem * item = ctrlModels()->currentItem();
                 if (item != nullptr)
@@ -468,9 +600,65 @@ QStringList AIAgent::scanTextLlamaModels(const QString& modelPath)
     }
 }
 
-void AIAgent::setTemperature(float newTemp, float newMinP)
+void AIAgent::setDraftModels(const QStringList& models)
+{
+    // The draft is selected from the same directory as the main model.
+    QComboBox* cmbDraft = ui->CmbDraft;
+    int index{ 0 };
+    {
+        QSignalBlocker blocker(cmbDraft);
+        cmbDraft->clear();
+        cmbDraft->addItem(tr("None"));
+        cmbDraft->addItems(models);
+        index = mDraftModelName.isEmpty() ? 0 : std::max(cmbDraft->findText(mDraftModelName, Qt::MatchExactly), 0);
+        cmbDraft->setCurrentIndex(index);
+    }
+
+    QFileInfo fi(mModelDir, mDraftModelName);
+    if ((index == 0) || (fi.exists() == false))
+    {
+        mDraftModelName.clear();
+        mDraftModelPath.clear();
+    }
+    else
+    {
+        mDraftModelPath = fi.absoluteFilePath();
+    }
+
+    AgentProvider::activateDraft(mDraftModelPath);
+}
+
+void AIAgent::setEmbeddingModels(const QStringList& models)
 {
-    AgentProvider::setTemperature(newTemp, newMinP);
+    // The embedding model is selected from the same directory as the main model.
+    QComboBox* cmbEmbedding = ui->CmbEmbedding;
+    int index{ 0 };
+    {
+        QSignalBlocker blocker(cmbEmbedding);
+        cmbEmbedding->clear();
+        cmbEmbedding->addItem(tr("Active"));
+        cmbEmbedding->addItems(models);
+        index = mEmbedModelName.isEmpty() ? 0 : std::max(cmbEmbedding->findText(mEmbedModelName, Qt::MatchExactly), 0);
+        cmbEmbedding->setCurrentIndex(index);
+    }
+
+    QFileInfo fi(mModelDir, mEmbedModelName);
+    if ((index == 0) || (fi.exists() == false))
+    {
+        mEmbedModelName.clear();
+        mEmbedModelPath.clear();
+    }
+    else
+    {
+        mEmbedModelPath = fi.absoluteFilePath();
+    }
+
+    AgentProvider::activateEmbedder(mEmbedModelPath, getSimilarity());
+}
+
+void AIAgent::setTemperature(float newTemp, float newMinP, bool lookup)
+{
+    AgentProvider::setTemperature(newTemp, newMinP, lookup);
 }
 
 float AIAgent::getTemperature(void) const
@@ -509,6 +697,11 @@ float AIAgent::getProbability(void) const
     return 0.50f;
 }
 
+bool AIAgent::getPromptLookup(void) const
+{
+    return (ui->BtnAnswer->isChecked() || ui->BtnPrecise->isChecked() || ui->BtnBalanced->isChecked());
+}
+
 void AIAgent::disconnectAgent(void)
 {
     routerDisconnect();
@@ -574,3 +767,117 @@ uint32_t AIAgent::getThreads(void) const
         return res;
     }
 }
+
+uint32_t AIAgent::getCacheSize(void) const
+{
+    bool ok{false};
+    uint32_t res = ui->TxtCache->text().toUInt(&ok);
+    if (ok)
+    {
+        return res;
+    }
+    else
+    {
+        ui->TxtCache->setText(QString::number(AgentProcessor::DEF_CACHE_MB));
+        return AgentProcessor::DEF_CACHE_MB;
+    }
+}
+
+uint32_t AIAgent::getSessionSize(void) const
+{
+    bool ok{false};
+    uint32_t res = ui->TxtSessions->text().toUInt(&ok);
+    if (ok)
+    {
+        return res;
+    }
+    else
+    {
+        ui->TxtSessions->setText(QString::number(AgentProcessor::DEF_SESSION_MB));
+        return AgentProcessor::DEF_SESSION_MB;
+    }
+}
+
+uint32_t AIAgent::getContextSize(void) const
+{
+    bool ok{false};
+    uint32_t res = ui->TxtContext->text().toUInt(&ok);
+    if (ok)
+    {
+        return res;
+    }
+    else
+    {
+        ui->TxtContext->setText(QString::number(AgentProcessor::DEF_CONTEXT_MB));
+        return AgentProcessor::DEF_CONTEXT_MB;
+    }
+}
+
+uint32_t AIAgent::getModelsSize(void) const
+{
+    bool ok{false};
+    uint32_t res = ui->TxtModels->text().toUInt(&ok);
+    if (ok)
+    {
+        return res;
+    }
+    else
+    {
+        ui->TxtModels->setText(QString::number(AgentProcessor::DEF_MODELS_MB));
+        return AgentProcessor::DEF_MODELS_MB;
+    }
+}
+
+uint32_t AIAgent::getSimilarity(void) const
+{
+    bool ok{false};
+    uint32_t res = ui->TxtSimilarity->text().toUInt(&ok);
+    if (ok)
+    {
+        return res;
+    }
+    else
+    {
+        ui->TxtSimilarity->setText(QString::number(AgentSemanticCache::DEF_SIMILARITY));
+        return AgentSemanticCache::DEF_SIMILARITY;
+    }
+}
+
+uint32_t AIAgent::getReplyCache(void) const
+{
+    bool ok{false};
+    uint32_t res = ui->TxtReplies->text().toUInt(&ok);
+    if (ok)
+    {
+        return res;
+    }
+    else
+    {
+        ui->TxtReplies->setText(QString::number(AgentResponseCache::DEF_ENTRIES));
+        return AgentResponseCache::DEF_ENTRIES;
+    }
+}
+
+AgentContextPool::eCacheType AIAgent::getCacheTypeK(void) const
+{
+    int index = ui->CmbCacheK->currentIndex();
+    return ((index >= 0) && (index < static_cast<int>(AgentContextPool::CacheCount)) ? static_cast<AgentContextPool::eCacheType>(index) : AgentContextPool::CacheF16);
+}
+
+AgentContextPool::eCacheType AIAgent::getCacheTypeV(void) const
+{
+    int index = ui->CmbCacheV->currentIndex();
+    return ((index >= 0) && (index < static_cast<int>(AgentContextPool::CacheCount)) ? static_cast<AgentContextPool::eCacheType>(index) : AgentContextPool::CacheF16);
+}
+
+AgentContextPool::eFlashAttention AIAgent::getFlashAttention(void) const
+{
+    int index = ui->CmbFlashAttn->currentIndex();
+    return ((index >= 0) && (index < static_cast<int>(AgentContextPool::FlashCount)) ? static_cast<AgentContextPool::eFlashAttention>(index) : AgentContextPool::FlashAuto);
+}
+
+AgentScheduler::ePolicy AIAgent::getSchedulingPolicy(void) const
+{
+    int index = ui->CmbPolicy->currentIndex();
+    return ((index >= 0) && (index < static_cast<int>(AgentScheduler::PolicyCount)) ? static_cast<AgentScheduler::ePolicy>(index) : AgentScheduler::PolicyFair);
+}
@@ -24,6 +24,9 @@
 
 #include <QList>
 #include "multiedge/resources/NEMultiEdge.hpp"
+#include "multiedge/aiagent/agenthost.hpp"
+#include "multiedge/aiagent/agentscheduler.hpp"
+#include "multiedge/aiagent/agenttext.hpp"
 QT_BEGIN_NAMESPACE
 namespace Ui {
 class AIAgent;
@@ -41,6 +44,7 @@ class QTabWidget;
 class QWidget;
 
 class AIAgent : public QDialog
+              , public IEAgentHost
 {
     Q_OBJECT
 
@@ -48,19 +52,49 @@ public:
     AIAgent(QWidget *parent = nullptr);
     ~AIAgent();
     
-    inline QString getActiveModelPath(void) const;
+    virtual String getActiveModelPath(void) const override;
 
-    uint32_t getTextLength(void) const;
+    virtual String getDraftModelPath(void) const override;
 
-    uint32_t getTokens(void) const;
+    virtual String getEmbedModelPath(void) const override;
 
-    uint32_t getBatching(void) const;
+    virtual uint32_t getSimilarity(void) const override;
 
-    uint32_t getThreads(void) const;
+    virtual uint32_t getTextLength(void) const override;
 
-    float getTemperature(void) const;
+    virtual uint32_t getTokens(void) const override;
 
-    float getProbability(void) const;
+    virtual uint32_t getBatching(void) const override;
+
+    virtual uint32_t getThreads(void) const override;
+
+    virtual uint32_t getCacheSize(void) const override;
+
+    virtual uint32_t getSessionSize(void) const override;
+
+    virtual uint32_t getContextSize(void) const override;
+
+    virtual uint32_t getModelsSize(void) const override;
+
+    virtual uint32_t getReplyCache(void) const override;
+
+    virtual AgentContextPool::eCacheType getCacheTypeK(void) const override;
+
+    virtual AgentContextPool::eCacheType getCacheTypeV(void) const override;
+
+    virtual AgentContextPool::eFlashAttention getFlashAttention(void) const override;
+
+    virtual AgentScheduler::ePolicy getSchedulingPolicy(void) const override;
+
+    virtual float getTemperature(void) const override;
+
+    virtual float getProbability(void) const override;
+
+    virtual bool getPromptLookup(void) const override;
+
+    virtual void onProviderStarted(AgentProvider& provider) override;
+
+    virtual void onProviderStopped(AgentProvider& provider) override;
 
     void disconnectAgent(void);
     
@@ -71,12 +105,16 @@ public slots:
     void slotAgentQueueSize(uint32_t queueSize);
     
     void slotActiveModelChanged(QString modelName);
+
+    void slotActiveModelFailed(QString modelPath);
     
     void slotAgentType(NEMultiEdge::eEdgeAgent EdgeAgent);
 
-    void slotTextRequested(uint32_t sessionId, uint32_t seqId, uint32_t id, QString question, uint64_t stamp);
+    void slotTextRequested(uint32_t sessionId, uint32_t seqId, uint32_t id, SharedText question, uint64_t stamp);
     
-    void slotTextProcessed(uint32_t sessionId, uint32_t seqId, uint32_t id, QString reply, uint64_t stamp);
+    void slotTextProcessed(uint32_t sessionId, uint32_t seqId, uint32_t id, SharedText reply, uint64_t stamp);
+
+    void slotQueueWait(uint64_t waitMedian, uint64_t waitTail);
     
     void slotVideoProcessed(uint32_t sessionId, uint32_t seqId, uint32_t id, SharedBuffer video);
     
@@ -112,6 +150,12 @@ private slots:
     void onModelsRowChanged(int currentRow);
     
     void onTableSelChanged(const QModelIndex &index);
+
+    void onPolicyChanged(int index);
+
+    void onDraftChanged(int index);
+
+    void onEmbeddingChanged(int index);
     
 private:
     void setupData(void);
@@ -124,10 +168,14 @@ private:
     
     void routerDisconnect(void);
     
-    void setTemperature(float newTemp, float newMinP);
+    void setTemperature(float newTemp, float newMinP, bool lookup);
     
     QStringList scanTextLlamaModels(const QString& modelPath);
 
+    void setDraftModels(const QStringList& models);
+
+    void setEmbeddingModels(const QStringList& models);
+
 private:
     Ui::AIAgent*        ui;
     QString             mAddress;
@@ -136,11 +184,10 @@ private:
     QString             mModelDir;
     QString             mAIModelName;
     QString             mAIModelPath;
+    QString             mDraftModelName;
+    QString             mDraftModelPath;
+    QString             mEmbedModelName;
+    QString             mEmbedModelPath;
 };
 
-inline QString AIAgent::getActiveModelPath(void) const
-{
-    return mAIModelPath;
-}
-
 #endif // MULTIEDGE_AIAGENT_AIAGENT_HPP
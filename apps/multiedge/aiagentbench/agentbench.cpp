@@ -0,0 +1,366 @@
+﻿/************************************************************************
+ * This file is part of the Areg Edge AI project powered by AREG SDK.
+ * The project contains multiple examples of using Edge AI based on Areg communication framework.
+ *
+ *  Areg Edge AI is available as free and open-source software under the MIT License.
+ *
+ *  For detailed licensing terms, please refer to the LICENSE file included
+ *  with this distribution or contact us at info[at]areg.tech.
+ *
+ *  \copyright   © 2025 Aregtech UG. All rights reserved.
+ *  \file        multiedge/aiagentbench/agentbench.cpp
+ *  \ingroup     Areg Edge AI, AI Multi Edge Device Agent
+ *  \author      Artak Avetyan
+ *  \brief       Edge AI Agent headless benchmark of the inference path.
+ *
+ ************************************************************************/
+#include "multiedge/aiagentbench/agentbench.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <numeric>
+
+namespace
+{
+    //!< The number of bytes in megabyte.
+    constexpr uint64_t  BYTES_IN_MB { 1024u * 1024u };
+
+    //!< The number of microseconds in second.
+    constexpr double    MICROS_IN_SEC { 1000000.0 };
+}
+
+AgentBench::AgentBench(const AgentBench::sOptions& options)
+    : IEAgentEngineListener ( )
+    , mOptions  (options)
+    , mEngine   (static_cast<IEAgentEngineListener &>(*this))
+    , mPrompts  ( )
+    , mRequests ( )
+{
+}
+
+bool AgentBench::run(void)
+{
+    if (loadPrompts() == false)
+    {
+        std::fprintf(stderr, "No prompts to replay in the corpus [ %s ]\n", mOptions.promptFile.getString());
+        return false;
+    }
+
+    std::fprintf(stderr, "Loading model [ %s ]\n", mOptions.modelPath.getString());
+    if (mEngine.loadModel(mOptions.modelPath) == false)
+    {
+        std::fprintf(stderr, "Failed to load model [ %s ]\n", mOptions.modelPath.getString());
+        return false;
+    }
+
+    if ((mOptions.draftPath.isEmpty() == false) && (mEngine.loadDraft(mOptions.draftPath) == false))
+    {
+        std::fprintf(stderr, "Failed to load draft model [ %s ] or its vocabulary differs\n", mOptions.draftPath.getString());
+        mEngine.freeModel();
+        return false;
+    }
+
+    mEngine.setSampling(mOptions.temperature, mOptions.probability);
+    mEngine.setPromptLookup(mOptions.lookup);
+    mEngine.setCacheBudget(static_cast<uint64_t>(mOptions.cacheSize) * BYTES_IN_MB);
+    mEngine.setContextBudget(static_cast<uint64_t>(mOptions.contextSize) * BYTES_IN_MB);
+    mEngine.setSessionLimits(0u, 0u, String());
+
+    std::vector<sResult> results;
+    for (const sKvCache& kvCache : mOptions.kvCaches)
+    {
+        for (AgentContextPool::eFlashAttention flashAttn : mOptions.flashModes)
+        {
+            if ((kvCache.typeV != AgentContextPool::CacheF16) && (flashAttn == AgentContextPool::FlashOff))
+            {
+                std::fprintf(stderr, "Skipping KV cache [ %s / %s ] without flash attention, the quantized values require it\n"
+                                , AgentContextPool::getString(kvCache.typeK), AgentContextPool::getString(kvCache.typeV));
+                continue;
+            }
+
+            sweep(kvCache, flashAttn, results);
+        }
+    }
+
+    mEngine.freeModel();
+    mEngine.freeDraft();
+    return writeResults(results);
+}
+
+void AgentBench::onTextFragment(uint32_t sessionId, const String& /*fragment*/)
+{
+    if ((sessionId < mRequests.size()) && (mRequests[sessionId].hasToken == false))
+    {
+        mRequests[sessionId].firstToken = Clock::now();
+        mRequests[sessionId].hasToken   = true;
+    }
+}
+
+void AgentBench::onTextReplied(uint32_t sessionId, const SharedText& reply, const IEAgentEngineListener::sTextStats& stats)
+{
+    if (sessionId < mRequests.size())
+    {
+        sRequest& request = mRequests[sessionId];
+        request.replied     = Clock::now();
+        request.isReplied   = true;
+        request.isEmpty     = reply->isEmpty();
+        request.stats       = stats;
+    }
+}
+
+void AgentBench::onModelSwitched(const String& /*modelPath*/)
+{
+    // The benchmark loads the model synchronously, the models are not switched.
+}
+
+bool AgentBench::loadPrompts(void)
+{
+    mPrompts.clear();
+    std::ifstream file(mOptions.promptFile.getString());
+    std::string line;
+    while (std::getline(file, line))
+    {
+        String prompt(line);
+        prompt.trimAll();
+        if ((prompt.isEmpty() == false) && (prompt.getString()[0] != '#'))
+        {
+            mPrompts.push_back(NEAgentText::makeText(std::move(prompt)));
+        }
+    }
+
+    return (mPrompts.empty() == false);
+}
+
+double AgentBench::replay(uint32_t count)
+{
+    mRequests.assign(count, sRequest{ });
+    const Clock::time_point start{ Clock::now() };
+    for (uint32_t i = 0; i < count; ++ i)
+    {
+        mRequests[i].sent = Clock::now();
+        mEngine.queuePrompt(i, AgentEngine::NO_CONVERSATION, String(), mPrompts[i % mPrompts.size()]);
+    }
+
+    while (mEngine.hasWork())
+    {
+        mEngine.decodeStep();
+    }
+
+    return _millis(start, Clock::now());
+}
+
+void AgentBench::sweep(const AgentBench::sKvCache& kvCache, AgentContextPool::eFlashAttention flashAttn, std::vector<AgentBench::sResult>& results)
+{
+    mEngine.setKvCache(kvCache.typeK, kvCache.typeV, flashAttn);
+    for (uint32_t textLimit : mOptions.textLimits)
+    {
+        for (uint32_t batching : mOptions.batching)
+        {
+            for (uint32_t threads : mOptions.threads)
+            {
+                std::fprintf(stderr, "Measuring text limit [ %u ], batching [ %u ], threads [ %u ], KV cache [ %s / %s ], flash attention [ %s ]\n"
+                                , textLimit, batching, threads, AgentContextPool::getString(kvCache.typeK), AgentContextPool::getString(kvCache.typeV)
+                                , AgentContextPool::getString(flashAttn));
+                results.push_back(measure(textLimit, batching, threads, 0u));
+                sResult& result = results.back();
+                result.kvCache   = kvCache;
+                result.flashAttn = flashAttn;
+                std::fprintf(stderr, "    replied [ %u ], failed [ %u ], prefill [ %.1f ] tok/s, decode [ %.1f ] tok/s, latency p50 [ %.1f ] ms, p99 [ %.1f ] ms, KV cache [ %.1f ] MB\n"
+                                , result.requests, result.failed, result.prefillRate, result.decodeRate, result.latency.p50, result.latency.p99
+                                , static_cast<double>(result.kvMemory) / static_cast<double>(BYTES_IN_MB));
+
+                if ((mEngine.isDraftLoaded() || mOptions.lookup) && (mOptions.draftTokens != 0u))
+                {
+                    // The same configuration with the speculation, compared with the measured baseline.
+                    const double baseRate = result.decodeRate;
+                    std::fprintf(stderr, "Measuring the same with [ %u ] %s tokens\n", mOptions.draftTokens, mOptions.lookup ? "lookup" : "draft");
+                    results.push_back(measure(textLimit, batching, threads, mOptions.draftTokens));
+                    sResult& speculated = results.back();
+                    speculated.kvCache   = kvCache;
+                    speculated.flashAttn = flashAttn;
+                    speculated.speedup = (baseRate > 0.0 ? speculated.decodeRate / baseRate : 0.0);
+                    std::fprintf(stderr, "    replied [ %u ], failed [ %u ], decode [ %.1f ] tok/s, acceptance [ %.1f ] %%, speedup [ %.2f ], latency p50 [ %.1f ] ms, p99 [ %.1f ] ms\n"
+                                    , speculated.requests, speculated.failed, speculated.decodeRate, _acceptance(speculated) * 100.0
+                                    , speculated.speedup, speculated.latency.p50, speculated.latency.p99);
+                }
+            }
+        }
+    }
+}
+
+AgentBench::sResult AgentBench::measure(uint32_t textLimit, uint32_t batching, uint32_t threads, uint32_t draftLimit)
+{
+    sResult result;
+    result.textLimit    = textLimit;
+    result.batching     = batching;
+    result.threads      = threads;
+    result.draftLimit   = draftLimit;
+
+    mEngine.setLimits(textLimit, mOptions.tokenLimit, batching, threads, mOptions.sequences);
+    mEngine.setDraftLimit(draftLimit);
+    // The first prompt warms up the context and the caches of the system, it is not measured.
+    replay(1u);
+
+    std::vector<double> firstToken;
+    std::vector<double> latency;
+    uint64_t prefillTokens{ 0u };
+    uint64_t prefillTime{ 0u };
+    uint64_t decodeTokens{ 0u };
+    uint64_t decodeTime{ 0u };
+    for (uint32_t i = 0; i < mOptions.repeat; ++ i)
+    {
+        result.wallTime += replay(static_cast<uint32_t>(mPrompts.size()));
+        result.contextSize = std::max(result.contextSize, mEngine.getContextSize());
+        for (const sRequest& request : mRequests)
+        {
+            if (request.isReplied == false)
+                continue;
+
+            ++ result.requests;
+            result.failed += request.isEmpty ? 1u : 0u;
+            latency.push_back(_millis(request.sent, request.replied));
+            if (request.hasToken)
+            {
+                firstToken.push_back(_millis(request.sent, request.firstToken));
+            }
+
+            const IEAgentEngineListener::sTextStats& stats = request.stats;
+            result.promptTokens += stats.promptTokens;
+            result.cachedTokens += stats.cachedTokens;
+            result.genTokens    += stats.generatedTokens;
+            result.draftTokens  += stats.draftTokens;
+            result.acceptTokens += stats.acceptedTokens;
+            prefillTokens       += stats.promptTokens - stats.cachedTokens;
+            prefillTime         += stats.prefillTime;
+            // The first token is sampled at the end of the prefill.
+            decodeTokens        += (stats.generatedTokens > 1u ? stats.generatedTokens - 1u : 0u);
+            decodeTime          += stats.decodeTime;
+        }
+    }
+
+    result.prefillRate  = (prefillTime != 0u ? static_cast<double>(prefillTokens) * MICROS_IN_SEC / static_cast<double>(prefillTime) : 0.0);
+    result.decodeRate   = (decodeTime  != 0u ? static_cast<double>(decodeTokens)  * MICROS_IN_SEC / static_cast<double>(decodeTime)  : 0.0);
+    result.throughput   = (result.wallTime > 0.0 ? static_cast<double>(result.genTokens) * 1000.0 / result.wallTime : 0.0);
+    result.firstToken   = _percentiles(firstToken);
+    result.latency      = _percentiles(latency);
+    result.kvMemory     = mEngine.estimateMemory(result.contextSize * mOptions.sequences);
+    return result;
+}
+
+bool AgentBench::writeResults(const std::vector<AgentBench::sResult>& results) const
+{
+    FILE* out = mOptions.outputFile.isEmpty() ? stdout : std::fopen(mOptions.outputFile.getString(), "w");
+    if (out == nullptr)
+    {
+        std::fprintf(stderr, "Failed to open the output file [ %s ]\n", mOptions.outputFile.getString());
+        return false;
+    }
+
+    std::fprintf(out, "{\n");
+    std::fprintf(out, "  \"model\": \"%s\",\n", _escape(mOptions.modelPath.getData()).c_str());
+    std::fprintf(out, "  \"draft\": \"%s\",\n", _escape(mOptions.draftPath.getData()).c_str());
+    std::fprintf(out, "  \"lookup\": %s,\n", mOptions.lookup ? "true" : "false");
+    std::fprintf(out, "  \"corpus\": \"%s\",\n", _escape(mOptions.promptFile.getData()).c_str());
+    std::fprintf(out, "  \"prompts\": %u,\n", static_cast<uint32_t>(mPrompts.size()));
+    std::fprintf(out, "  \"repeat\": %u,\n", mOptions.repeat);
+    std::fprintf(out, "  \"tokens\": %u,\n", mOptions.tokenLimit);
+    std::fprintf(out, "  \"sequences\": %u,\n", mOptions.sequences);
+    std::fprintf(out, "  \"cache_mb\": %u,\n", mOptions.cacheSize);
+    std::fprintf(out, "  \"context_mb\": %u,\n", mOptions.contextSize);
+    std::fprintf(out, "  \"temperature\": %.2f,\n", mOptions.temperature);
+    std::fprintf(out, "  \"probability\": %.2f,\n", mOptions.probability);
+    std::fprintf(out, "  \"results\": [");
+    for (size_t i = 0; i < results.size(); ++ i)
+    {
+        const sResult& result = results[i];
+        std::fprintf(out, "%s\n    {\n", i == 0 ? "" : ",");
+        std::fprintf(out, "      \"text_limit\": %u,\n", result.textLimit);
+        std::fprintf(out, "      \"batching\": %u,\n", result.batching);
+        std::fprintf(out, "      \"threads\": %u,\n", result.threads);
+        std::fprintf(out, "      \"draft_limit\": %u,\n", result.draftLimit);
+        std::fprintf(out, "      \"context_size\": %u,\n", result.contextSize);
+        std::fprintf(out, "      \"kv_keys\": \"%s\",\n", AgentContextPool::getString(result.kvCache.typeK));
+        std::fprintf(out, "      \"kv_values\": \"%s\",\n", AgentContextPool::getString(result.kvCache.typeV));
+        std::fprintf(out, "      \"flash_attn\": \"%s\",\n", AgentContextPool::getString(result.flashAttn));
+        std::fprintf(out, "      \"kv_cache_mb\": %.3f,\n", static_cast<double>(result.kvMemory) / static_cast<double>(BYTES_IN_MB));
+        std::fprintf(out, "      \"requests\": %u,\n", result.requests);
+        std::fprintf(out, "      \"failed\": %u,\n", result.failed);
+        std::fprintf(out, "      \"prompt_tokens\": %llu,\n", static_cast<unsigned long long>(result.promptTokens));
+        std::fprintf(out, "      \"cached_tokens\": %llu,\n", static_cast<unsigned long long>(result.cachedTokens));
+        std::fprintf(out, "      \"generated_tokens\": %llu,\n", static_cast<unsigned long long>(result.genTokens));
+        std::fprintf(out, "      \"wall_ms\": %.3f,\n", result.wallTime);
+        std::fprintf(out, "      \"prefill_tps\": %.3f,\n", result.prefillRate);
+        std::fprintf(out, "      \"decode_tps\": %.3f,\n", result.decodeRate);
+        std::fprintf(out, "      \"throughput_tps\": %.3f,\n", result.throughput);
+        if (result.draftLimit != 0u)
+        {
+            std::fprintf(out, "      \"draft_tokens\": %llu,\n", static_cast<unsigned long long>(result.draftTokens));
+            std::fprintf(out, "      \"accepted_tokens\": %llu,\n", static_cast<unsigned long long>(result.acceptTokens));
+            std::fprintf(out, "      \"acceptance\": %.4f,\n", _acceptance(result));
+            std::fprintf(out, "      \"speedup\": %.3f,\n", result.speedup);
+        }
+
+        std::fprintf(out, "      \"ttft_ms\": { \"mean\": %.3f, \"p50\": %.3f, \"p95\": %.3f, \"p99\": %.3f },\n"
+                        , result.firstToken.mean, result.firstToken.p50, result.firstToken.p95, result.firstToken.p99);
+        std::fprintf(out, "      \"latency_ms\": { \"mean\": %.3f, \"p50\": %.3f, \"p95\": %.3f, \"p99\": %.3f }\n"
+                        , result.latency.mean, result.latency.p50, result.latency.p95, result.latency.p99);
+        std::fprintf(out, "    }");
+    }
+
+    std::fprintf(out, "\n  ]\n}\n");
+    const bool ok = (std::ferror(out) == 0);
+    if (out != stdout)
+    {
+        std::fclose(out);
+    }
+
+    return ok;
+}
+
+AgentBench::sPercentiles AgentBench::_percentiles(std::vector<double>& values)
+{
+    sPercentiles result;
+    if (values.empty())
+        return result;
+
+    std::sort(values.begin(), values.end());
+    const size_t last = values.size() - 1u;
+    result.mean = std::accumulate(values.begin(), values.end(), 0.0) / static_cast<double>(values.size());
+    result.p50  = values[(last * 50u) / 100u];
+    result.p95  = values[(last * 95u) / 100u];
+    result.p99  = values[(last * 99u) / 100u];
+    return result;
+}
+
+std::string AgentBench::_escape(const std::string& text)
+{
+    std::string result;
+    result.reserve(text.size());
+    for (char ch : text)
+    {
+        switch (ch)
+        {
+        case '"':
+            result += "\\\"";
+            break;
+        case '\\':
+            result += "\\\\";
+            break;
+        case '\n':
+            result += "\\n";
+            break;
+        case '\t':
+            result += "\\t";
+            break;
+        default:
+            if (static_cast<unsigned char>(ch) >= 0x20u)
+            {
+                result += ch;
+            }
+            break;
+        }
+    }
+
+    return result;
+}
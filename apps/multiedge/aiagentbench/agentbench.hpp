@@ -0,0 +1,227 @@
+﻿#ifndef MULTIEDGE_AIAGENTBENCH_AGENTBENCH_HPP
+#define MULTIEDGE_AIAGENTBENCH_AGENTBENCH_HPP
+/************************************************************************
+ * This file is part of the Areg Edge AI project powered by AREG SDK.
+ * The project contains multiple examples of using Edge AI based on Areg communication framework.
+ *
+ *  Areg Edge AI is available as free and open-source software under the MIT License.
+ *
+ *  For detailed licensing terms, please refer to the LICENSE file included
+ *  with this distribution or contact us at info[at]areg.tech.
+ *
+ *  \copyright   © 2025 Aregtech UG. All rights reserved.
+ *  \file        multiedge/aiagentbench/agentbench.hpp
+ *  \ingroup     Areg Edge AI, AI Multi Edge Device Agent
+ *  \author      Artak Avetyan
+ *  \brief       Edge AI Agent headless benchmark of the inference path.
+ *
+ ************************************************************************/
+
+/************************************************************************
+ * Includes
+ ************************************************************************/
+
+#include "areg/base/GEGlobal.h"
+#include "areg/base/String.hpp"
+#include "multiedge/aiagent/agentengine.hpp"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////
+// AgentBench class declaration
+//////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief   The headless benchmark of the LLM inference. Loads the model and
+ *          replays the prompt corpus through the same batching engine, which
+ *          serves the edge devices in the AI agent. Every combination of text
+ *          limit, batching and threads is measured separately, all prompts of
+ *          the corpus are queued at once as if sent by the edge devices
+ *          simultaneously. If the draft model or the prompt lookup is set,
+ *          every configuration is measured without and with the speculative
+ *          decoding to report the acceptance rate and the speedup. Every data type
+ *          of the KV cache and mode of the flash attention repeats the measurements
+ *          to report the memory of the KV cache with the throughput. The results are written as JSON.
+ **/
+class AgentBench : private IEAgentEngineListener
+{
+//////////////////////////////////////////////////////////////////////////
+// Internal types and constants
+//////////////////////////////////////////////////////////////////////////
+public:
+    //!< The data types of the KV cache to measure.
+    struct sKvCache
+    {
+        AgentContextPool::eCacheType    typeK   { AgentContextPool::CacheF16 }; //!< The data type of the keys.
+        AgentContextPool::eCacheType    typeV   { AgentContextPool::CacheF16 }; //!< The data type of the values.
+    };
+
+    //!< The options of the benchmark.
+    struct sOptions
+    {
+        String                  modelPath   { };        //!< The path to the GGUF model file.
+        String                  draftPath   { };        //!< The path to the GGUF draft model file. Empty to measure without speculation.
+        String                  promptFile  { };        //!< The path to the prompt corpus, one prompt per line.
+        String                  outputFile  { };        //!< The path to the JSON file of results. Empty to print on the console.
+        std::vector<uint32_t>   textLimits  { };        //!< The text limits to measure.
+        std::vector<uint32_t>   batching    { };        //!< The batch sizes to measure.
+        std::vector<uint32_t>   threads     { };        //!< The thread counts to measure.
+        std::vector<sKvCache>   kvCaches    { };        //!< The data types of the KV cache to measure.
+        std::vector<AgentContextPool::eFlashAttention> flashModes { }; //!< The modes of the flash attention to measure.
+        uint32_t                tokenLimit  { 0u };     //!< The maximum number of tokens to generate per reply.
+        uint32_t                sequences   { 0u };     //!< The number of parallel decoded sequences.
+        uint32_t                repeat      { 1u };     //!< The number of times to replay the corpus per configuration.
+        uint32_t                cacheSize   { 0u };     //!< The budget of the prompt prefix cache in megabytes.
+        uint32_t                contextSize { 0u };     //!< The budget of the KV cache of the context larger than default in megabytes.
+        uint32_t                draftTokens { 0u };     //!< The maximum number of draft tokens per decoding step.
+        bool                    lookup      { false };  //!< Flag, indicating to speculate by the prompt lookup instead of the draft model.
+        float                   temperature { 0.0f };   //!< The sampling temperature.
+        float                   probability { 0.0f };   //!< The min-p sampling probability.
+    };
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    //!< The measured prompt.
+    struct sRequest
+    {
+        Clock::time_point                   sent        { };        //!< The time the prompt is queued.
+        Clock::time_point                   firstToken  { };        //!< The time the first piece of reply is received.
+        Clock::time_point                   replied     { };        //!< The time the reply is received.
+        bool                                hasToken    { false };  //!< Flag, indicating that the first piece is received.
+        bool                                isReplied   { false };  //!< Flag, indicating that the reply is received.
+        bool                                isEmpty     { true };   //!< Flag, indicating that the reply is empty.
+        IEAgentEngineListener::sTextStats   stats       { };        //!< The statistics reported by the engine.
+    };
+
+    //!< The percentiles of the measured values in milliseconds.
+    struct sPercentiles
+    {
+        double  mean    { 0.0 };
+        double  p50     { 0.0 };
+        double  p95     { 0.0 };
+        double  p99     { 0.0 };
+    };
+
+    //!< The results of the single configuration.
+    struct sResult
+    {
+        uint32_t        textLimit   { 0u };     //!< The measured text limit.
+        uint32_t        batching    { 0u };     //!< The measured batch size.
+        uint32_t        threads     { 0u };     //!< The measured number of threads.
+        uint32_t        draftLimit  { 0u };     //!< The measured number of draft tokens per step, zero without speculation.
+        uint32_t        contextSize { 0u };     //!< The largest context per sequence chosen by the engine.
+        sKvCache        kvCache     { };        //!< The measured data types of the KV cache.
+        AgentContextPool::eFlashAttention flashAttn { AgentContextPool::FlashAuto }; //!< The measured mode of the flash attention.
+        uint64_t        kvMemory    { 0u };     //!< The estimated size of the KV cache of the largest context in bytes.
+        uint32_t        requests    { 0u };     //!< The number of replied prompts.
+        uint32_t        failed      { 0u };     //!< The number of prompts replied with empty text.
+        uint64_t        promptTokens{ 0u };     //!< The total number of prompt tokens.
+        uint64_t        cachedTokens{ 0u };     //!< The total number of prompt tokens restored from the cache.
+        uint64_t        genTokens   { 0u };     //!< The total number of generated tokens.
+        uint64_t        draftTokens { 0u };     //!< The total number of tokens proposed by the draft model or by the prompt lookup.
+        uint64_t        acceptTokens{ 0u };     //!< The total number of proposed tokens accepted by the target model.
+        double          wallTime    { 0.0 };    //!< The time to process all prompts in milliseconds.
+        double          prefillRate { 0.0 };    //!< The prefill tokens per second.
+        double          decodeRate  { 0.0 };    //!< The decode tokens per second.
+        double          throughput  { 0.0 };    //!< The generated tokens per second of the wall time.
+        double          speedup     { 0.0 };    //!< The decode rate relative to the same configuration without speculation.
+        sPercentiles    firstToken  { };        //!< The time to the first token.
+        sPercentiles    latency     { };        //!< The end-to-end latency.
+    };
+
+//////////////////////////////////////////////////////////////////////////
+// Constructor / Destructor
+//////////////////////////////////////////////////////////////////////////
+public:
+    explicit AgentBench(const AgentBench::sOptions& options);
+    virtual ~AgentBench(void) = default;
+
+//////////////////////////////////////////////////////////////////////////
+// Attributes and operations
+//////////////////////////////////////////////////////////////////////////
+public:
+
+    /**
+     * \brief   Loads the prompt corpus and the model, measures all configurations and writes the results.
+     * \return  Returns true if all configurations are measured and the results are written.
+     **/
+    bool run(void);
+
+//////////////////////////////////////////////////////////////////////////
+// IEAgentEngineListener overrides
+//////////////////////////////////////////////////////////////////////////
+private:
+
+    virtual void onTextFragment(uint32_t sessionId, const String& fragment) override;
+
+    virtual void onTextReplied(uint32_t sessionId, const SharedText& reply, const IEAgentEngineListener::sTextStats& stats) override;
+
+    virtual void onModelSwitched(const String& modelPath) override;
+
+//////////////////////////////////////////////////////////////////////////
+// Hidden methods
+//////////////////////////////////////////////////////////////////////////
+private:
+
+    //!< Reads the prompts of the corpus. Empty lines and lines starting with '#' are skipped.
+    bool loadPrompts(void);
+
+    //!< Queues the prompts and runs the decoding steps until all prompts are replied. Returns the wall time in milliseconds.
+    double replay(uint32_t count);
+
+    //!< Measures all combinations of text limit, batching and threads with the KV cache in use.
+    void sweep(const AgentBench::sKvCache& kvCache, AgentContextPool::eFlashAttention flashAttn, std::vector<AgentBench::sResult>& results);
+
+    //!< Measures the configuration.
+    AgentBench::sResult measure(uint32_t textLimit, uint32_t batching, uint32_t threads, uint32_t draftLimit);
+
+    //!< Writes the results as JSON to the output file or to the console.
+    bool writeResults(const std::vector<AgentBench::sResult>& results) const;
+
+    //!< Computes the mean and percentiles of the values.
+    static AgentBench::sPercentiles _percentiles(std::vector<double>& values);
+
+    //!< Returns the text escaped as JSON string.
+    static std::string _escape(const std::string& text);
+
+    //!< Returns the share of the proposed tokens accepted by the target model.
+    static inline double _acceptance(const AgentBench::sResult& result);
+
+    //!< Returns the time in milliseconds between two time points.
+    static inline double _millis(const Clock::time_point& from, const Clock::time_point& to);
+
+//////////////////////////////////////////////////////////////////////////
+// Member variables
+//////////////////////////////////////////////////////////////////////////
+private:
+    sOptions                mOptions;   //!< The options of the benchmark.
+    AgentEngine             mEngine;    //!< The measured engine.
+    std::vector<SharedText> mPrompts;   //!< The prompts of the corpus.
+    std::vector<sRequest>   mRequests;  //!< The measured prompts of the running replay.
+
+//////////////////////////////////////////////////////////////////////////
+// Forbidden calls
+//////////////////////////////////////////////////////////////////////////
+private:
+    AgentBench(void) = delete;
+    DECLARE_NOCOPY_NOMOVE(AgentBench);
+};
+
+//////////////////////////////////////////////////////////////////////////
+// Inline methods
+//////////////////////////////////////////////////////////////////////////
+
+inline double AgentBench::_acceptance(const AgentBench::sResult& result)
+{
+    return (result.draftTokens != 0u ? static_cast<double>(result.acceptTokens) / static_cast<double>(result.draftTokens) : 0.0);
+}
+
+inline double AgentBench::_millis(const Clock::time_point& from, const Clock::time_point& to)
+{
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+#endif // MULTIEDGE_AIAGENTBENCH_AGENTBENCH_HPP
@@ -0,0 +1,255 @@
+﻿/************************************************************************
+ * This file is part of the Areg Edge AI project powered by AREG SDK.
+ * The project contains multiple examples of using Edge AI based on Areg communication framework.
+ *
+ *  Areg Edge AI is available as free and open-source software under the MIT License.
+ *
+ *  For detailed licensing terms, please refer to the LICENSE file included
+ *  with this distribution or contact us at info[at]areg.tech.
+ *
+ *  \copyright   © 2025 Aregtech UG. All rights reserved.
+ *  \file        multiedge/aiagentbench/main.cpp
+ *  \ingroup     Areg Edge AI, AI Multi Edge Device Agent
+ *  \author      Artak Avetyan
+ *  \brief       Edge AI Agent headless benchmark of the inference path.
+ *
+ ************************************************************************/
+
+/************************************************************************
+ * Includes
+ ************************************************************************/
+#include "multiedge/aiagentbench/agentbench.hpp"
+#include "multiedge/aiagent/agentprocessor.hpp"
+#include "multiedge/resources/NECommandLine.hpp"
+#include "areg/appbase/Application.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include "llama.h"
+
+namespace
+{
+    //!< Returns the number of available cores.
+    uint32_t _coreCount(void)
+    {
+        const uint32_t cores = std::thread::hardware_concurrency();
+        return std::max(cores, AgentProcessor::MIN_THREADS);
+    }
+
+    //!< Prints the usage of the application.
+    void _printUsage(const char* app)
+    {
+        std::fprintf(stderr
+                    , "Usage: %s --model=<file.gguf> --prompts=<corpus.txt> [options]\n"
+                      "Options:\n"
+                      "  --draft=<file.gguf>    Draft model to measure the speculative decoding against the baseline.\n"
+                      "  --draft-tokens=<n>     Draft tokens per decoding step, default %u.\n"
+                      "  --lookup=<on|off>      Speculate by the prompt lookup instead of the draft model, default off.\n"
+                      "  --output=<file.json>   Write the results to the file instead of the console.\n"
+                      "  --text=<n[,n...]>      Text limits to measure, default %u.\n"
+                      "  --batch=<n[,n...]>     Batch sizes to measure, default %u.\n"
+                      "  --threads=<n[,n...]>   Thread counts to measure, default %u.\n"
+                      "  --tokens=<n>           Maximum tokens to generate per reply, default %u.\n"
+                      "  --sequences=<n>        Parallel decoded sequences, default %u.\n"
+                      "  --repeat=<n>           Replays of the corpus per configuration, default 1.\n"
+                      "  --cache=<mb>           Prompt prefix cache budget in megabytes, default 0.\n"
+                      "  --context=<mb>         KV cache budget of the contexts larger than default in megabytes, default %u.\n"
+                      "  --kv=<k[/v][,...]>     KV cache data types to measure (f16, q8_0, q4_0), keys/values, default f16.\n"
+                      "  --flash=<m[,m...]>     Flash attention modes to measure (auto, on, off), default auto.\n"
+                      "  --temperature=<t>      Sampling temperature, default 0.30.\n"
+                      "  --minp=<p>             Sampling min-p probability, default 0.10.\n"
+                    , app
+                    , AgentDraft::DEF_TOKENS
+                    , AgentProcessor::DEF_CHARS
+                    , AgentProcessor::DEF_BATCHING
+                    , std::min(_coreCount(), AgentProcessor::MAX_THREADS)
+                    , AgentProcessor::DEF_TOKENS
+                    , AgentEngine::DEF_SEQUENCES
+                    , AgentProcessor::DEF_CONTEXT_MB);
+    }
+
+    //!< Parses the comma separated list of numbers, each value is clamped to the range.
+    std::vector<uint32_t> _parseList(const char* value, uint32_t minValue, uint32_t maxValue)
+    {
+        std::vector<uint32_t> result;
+        while ((value != nullptr) && (*value != '\0'))
+        {
+            char* end{ nullptr };
+            const unsigned long num = std::strtoul(value, &end, 10);
+            if (end == value)
+                break;
+
+            result.push_back(std::clamp(static_cast<uint32_t>(num), minValue, maxValue));
+            value = (*end == ',') ? end + 1 : end;
+        }
+
+        return result;
+    }
+
+    //!< Compares the first characters of the strings ignoring the case.
+    bool _equalNoCase(const char* lhs, const char* rhs, size_t count)
+    {
+        for (size_t i = 0; i < count; ++ i)
+        {
+            if (std::tolower(static_cast<unsigned char>(lhs[i])) != std::tolower(static_cast<unsigned char>(rhs[i])))
+                return false;
+            else if (lhs[i] == '\0')
+                break;
+        }
+
+        return true;
+    }
+
+    //!< Parses the name of the data type of the KV cache. Returns the end of the name or nullptr if unknown.
+    const char* _parseCacheType(const char* value, AgentContextPool::eCacheType& type)
+    {
+        for (uint32_t i = 0; i < static_cast<uint32_t>(AgentContextPool::CacheCount); ++ i)
+        {
+            const char* name = AgentContextPool::getString(static_cast<AgentContextPool::eCacheType>(i));
+            const size_t len = std::strlen(name);
+            if (_equalNoCase(value, name, len))
+            {
+                type = static_cast<AgentContextPool::eCacheType>(i);
+                return value + len;
+            }
+        }
+
+        return nullptr;
+    }
+
+    //!< Parses the comma separated list of KV cache data types, the types of keys and values are separated by '/'.
+    std::vector<AgentBench::sKvCache> _parseKvList(const char* value)
+    {
+        std::vector<AgentBench::sKvCache> result;
+        while ((value != nullptr) && (*value != '\0'))
+        {
+            AgentBench::sKvCache kvCache;
+            const char* end = _parseCacheType(value, kvCache.typeK);
+            if (end == nullptr)
+                return std::vector<AgentBench::sKvCache>();
+
+            kvCache.typeV = kvCache.typeK;
+            if ((*end == '/') && ((end = _parseCacheType(end + 1, kvCache.typeV)) == nullptr))
+                return std::vector<AgentBench::sKvCache>();
+
+            result.push_back(kvCache);
+            value = (*end == ',') ? end + 1 : end;
+        }
+
+        return result;
+    }
+
+    //!< Parses the comma separated list of the modes of the flash attention.
+    std::vector<AgentContextPool::eFlashAttention> _parseFlashList(const char* value)
+    {
+        std::vector<AgentContextPool::eFlashAttention> result;
+        while ((value != nullptr) && (*value != '\0'))
+        {
+            const char* end = std::strchr(value, ',');
+            const size_t len = (end != nullptr ? static_cast<size_t>(end - value) : std::strlen(value));
+            uint32_t i = 0;
+            for ( ; i < static_cast<uint32_t>(AgentContextPool::FlashCount); ++ i)
+            {
+                const char* name = AgentContextPool::getString(static_cast<AgentContextPool::eFlashAttention>(i));
+                if ((std::strlen(name) == len) && _equalNoCase(value, name, len))
+                    break;
+            }
+
+            if (i == static_cast<uint32_t>(AgentContextPool::FlashCount))
+                return std::vector<AgentContextPool::eFlashAttention>();
+
+            result.push_back(static_cast<AgentContextPool::eFlashAttention>(i));
+            value = (end != nullptr) ? end + 1 : value + len;
+        }
+
+        return result;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    AgentBench::sOptions options;
+    options.textLimits  = { AgentProcessor::DEF_CHARS };
+    options.batching    = { AgentProcessor::DEF_BATCHING };
+    options.threads     = { std::min(_coreCount(), AgentProcessor::MAX_THREADS) };
+    options.tokenLimit  = AgentProcessor::DEF_TOKENS;
+    options.sequences   = AgentEngine::DEF_SEQUENCES;
+    options.draftTokens = AgentDraft::DEF_TOKENS;
+    options.contextSize = AgentProcessor::DEF_CONTEXT_MB;
+    options.kvCaches    = { AgentBench::sKvCache{ } };
+    options.flashModes  = { AgentContextPool::FlashAuto };
+    // The greedy sampling stops on the first sentence, the balanced profile generates the complete reply.
+    options.temperature = 0.30f;
+    options.probability = 0.10f;
+
+    for (int i = 1; i < argc; ++ i)
+    {
+        const char* arg = argv[i];
+        const char* value{ nullptr };
+        if ((value = NECommandLine::optionValue(arg, "--model")) != nullptr)
+            options.modelPath = value;
+        else if ((value = NECommandLine::optionValue(arg, "--draft")) != nullptr)
+            options.draftPath = value;
+        else if ((value = NECommandLine::optionValue(arg, "--draft-tokens")) != nullptr)
+            options.draftTokens = NECommandLine::numberValue(value, AgentDraft::MIN_TOKENS, AgentDraft::MAX_TOKENS);
+        else if ((value = NECommandLine::optionValue(arg, "--lookup")) != nullptr)
+            options.lookup = (std::strcmp(value, "on") == 0);
+        else if ((value = NECommandLine::optionValue(arg, "--prompts")) != nullptr)
+            options.promptFile = value;
+        else if ((value = NECommandLine::optionValue(arg, "--output")) != nullptr)
+            options.outputFile = value;
+        else if ((value = NECommandLine::optionValue(arg, "--text")) != nullptr)
+            options.textLimits = _parseList(value, AgentProcessor::MIN_CHARS, AgentProcessor::MAX_CHARS);
+        else if ((value = NECommandLine::optionValue(arg, "--batch")) != nullptr)
+            options.batching = _parseList(value, AgentProcessor::MIN_BATCHING, AgentProcessor::MAX_BATCHING);
+        else if ((value = NECommandLine::optionValue(arg, "--threads")) != nullptr)
+            options.threads = _parseList(value, AgentProcessor::MIN_THREADS, _coreCount());
+        else if ((value = NECommandLine::optionValue(arg, "--tokens")) != nullptr)
+            options.tokenLimit = NECommandLine::numberValue(value, AgentProcessor::MIN_TOKENS, AgentProcessor::MAX_TOKENS);
+        else if ((value = NECommandLine::optionValue(arg, "--sequences")) != nullptr)
+            options.sequences = NECommandLine::numberValue(value, AgentEngine::MIN_SEQUENCES, AgentEngine::MAX_SEQUENCES);
+        else if ((value = NECommandLine::optionValue(arg, "--repeat")) != nullptr)
+            options.repeat = NECommandLine::numberValue(value, 1u);
+        else if ((value = NECommandLine::optionValue(arg, "--cache")) != nullptr)
+            options.cacheSize = NECommandLine::numberValue(value, AgentProcessor::MIN_CACHE_MB, AgentProcessor::MAX_CACHE_MB);
+        else if ((value = NECommandLine::optionValue(arg, "--context")) != nullptr)
+            options.contextSize = NECommandLine::numberValue(value, AgentProcessor::MIN_CONTEXT_MB, AgentProcessor::MAX_CONTEXT_MB);
+        else if ((value = NECommandLine::optionValue(arg, "--kv")) != nullptr)
+            options.kvCaches = _parseKvList(value);
+        else if ((value = NECommandLine::optionValue(arg, "--flash")) != nullptr)
+            options.flashModes = _parseFlashList(value);
+        else if ((value = NECommandLine::optionValue(arg, "--temperature")) != nullptr)
+            options.temperature = std::clamp(std::strtof(value, nullptr), AgentProcessor::MIN_TEMPERATURE, AgentProcessor::MAX_TEMPERATURE);
+        else if ((value = NECommandLine::optionValue(arg, "--minp")) != nullptr)
+            options.probability = std::clamp(std::strtof(value, nullptr), AgentProcessor::MIN_PROBABILITY, AgentProcessor::MAX_PROBABILITY);
+        else
+        {
+            _printUsage(argv[0]);
+            return (std::strcmp(arg, "--help") == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+        }
+    }
+
+    if (options.modelPath.isEmpty() || options.promptFile.isEmpty() || options.textLimits.empty() || options.batching.empty() || options.threads.empty() || options.kvCaches.empty() || options.flashModes.empty())
+    {
+        _printUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // Only logging is needed, the benchmark does not communicate.
+    Application::initApplication(true, false, false, false);
+    // Load backends once per process.
+    ggml_backend_load_all();
+
+    bool result{ false };
+    {
+        AgentBench bench(options);
+        result = bench.run();
+    }
+
+    Application::releaseApplication();
+    return (result ? EXIT_SUCCESS : EXIT_FAILURE);
+}
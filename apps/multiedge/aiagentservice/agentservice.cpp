@@ -0,0 +1,344 @@
+﻿/************************************************************************
+ * This file is part of the Areg Edge AI project powered by AREG SDK.
+ * The project contains multiple examples of using Edge AI based on Areg communication framework.
+ *
+ *  Areg Edge AI is available as free and open-source software under the MIT License.
+ *
+ *  For detailed licensing terms, please refer to the LICENSE file included
+ *  with this distribution or contact us at info[at]areg.tech.
+ *
+ *  \copyright   © 2025 Aregtech UG. All rights reserved.
+ *  \file        multiedge/aiagentservice/agentservice.cpp
+ *  \ingroup     Areg Edge AI, AI Multi Edge Device Agent
+ *  \author      Artak Avetyan
+ *  \brief       Edge AI Agent headless service host.
+ *
+ ************************************************************************/
+#include "multiedge/aiagentservice/agentservice.hpp"
+#include "multiedge/aiagent/agentprocessor.hpp"
+#include "multiedge/aiagent/agentprovider.hpp"
+#include "multiedge/aiagent/agentresponsecache.hpp"
+#include "multiedge/aiagent/agentsemanticcache.hpp"
+#include "areg/appbase/Application.hpp"
+#include "areg/logging/GELog.h"
+#include "areg/persist/ConfigManager.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+DEF_LOG_SCOPE(multiedge_aiagentservice_AgentService_loadConfig);
+DEF_LOG_SCOPE(multiedge_aiagentservice_AgentService_onProviderStarted);
+
+AgentService::AgentService(void)
+    : IEAgentHost   ( )
+    , mStarted      (Clock::now())
+    , mModelPath    ( )
+    , mDraftPath    ( )
+    , mEmbedPath    ( )
+    , mSimilarity   (AgentSemanticCache::DEF_SIMILARITY)
+    // The same defaults as the precise profile and the limits of the GUI agent.
+    , mTemperature  (PROFILES[1].temperature)
+    , mProbability  (PROFILES[1].probability)
+    , mLookup       (PROFILES[1].lookup)
+    , mTextLength   (AgentProcessor::DEF_CHARS)
+    , mTokens       (AgentProcessor::DEF_TOKENS)
+    , mBatching     (AgentProcessor::DEF_BATCHING)
+    , mThreads      (AgentProcessor::defThreadCount())
+    , mCacheSize    (AgentProcessor::DEF_CACHE_MB)
+    , mSessionSize  (AgentProcessor::DEF_SESSION_MB)
+    , mContextSize  (AgentProcessor::DEF_CONTEXT_MB)
+    , mModelsSize   (AgentProcessor::DEF_MODELS_MB)
+    , mReplyCache   (AgentResponseCache::DEF_ENTRIES)
+    , mCacheTypeK   (AgentContextPool::CacheF16)
+    , mCacheTypeV   (AgentContextPool::CacheF16)
+    , mFlashAttn    (AgentContextPool::FlashAuto)
+    , mPolicy       (AgentScheduler::PolicyFair)
+    , mConnection   ( )
+    , mFailure      ( )
+{
+}
+
+bool AgentService::loadConfig(void)
+{
+    LOG_SCOPE(multiedge_aiagentservice_AgentService_loadConfig);
+
+    const ConfigManager& config = Application::getConfigManager();
+    if (config.isConfigured() == false)
+    {
+        LOG_ERR("The application is not configured, the service uses the default settings");
+        return false;
+    }
+
+    // The properties 'aiagent::*::<name>' or 'aiagent::<module>::<name>' of this module.
+    const String section(CONFIG_SECTION);
+    for (const std::string_view& name : PROPERTIES)
+    {
+        const String property(name);
+        const Property* entry = config.getModuleProperty(section, property);
+        if (entry == nullptr)
+            continue;
+
+        const String value(entry->getValue().getString());
+        if (setProperty(property, value))
+        {
+            LOG_DBG("Configuration property [ %s ] = [ %s ]", property.getString(), value.getString());
+        }
+        else
+        {
+            LOG_WARN("Ignoring invalid value [ %s ] of configuration property [ %s ]", value.getString(), property.getString());
+        }
+    }
+
+    return true;
+}
+
+String AgentService::getActiveModelPath(void) const
+{
+    return mModelPath;
+}
+
+String AgentService::getDraftModelPath(void) const
+{
+    return mDraftPath;
+}
+
+String AgentService::getEmbedModelPath(void) const
+{
+    return mEmbedPath;
+}
+
+uint32_t AgentService::getSimilarity(void) const
+{
+    return mSimilarity;
+}
+
+float AgentService::getTemperature(void) const
+{
+    return mTemperature;
+}
+
+float AgentService::getProbability(void) const
+{
+    return mProbability;
+}
+
+bool AgentService::getPromptLookup(void) const
+{
+    return mLookup;
+}
+
+uint32_t AgentService::getTextLength(void) const
+{
+    return mTextLength;
+}
+
+uint32_t AgentService::getTokens(void) const
+{
+    return mTokens;
+}
+
+uint32_t AgentService::getBatching(void) const
+{
+    return mBatching;
+}
+
+uint32_t AgentService::getThreads(void) const
+{
+    return mThreads;
+}
+
+uint32_t AgentService::getCacheSize(void) const
+{
+    return mCacheSize;
+}
+
+uint32_t AgentService::getSessionSize(void) const
+{
+    return mSessionSize;
+}
+
+uint32_t AgentService::getContextSize(void) const
+{
+    return mContextSize;
+}
+
+uint32_t AgentService::getModelsSize(void) const
+{
+    return mModelsSize;
+}
+
+uint32_t AgentService::getReplyCache(void) const
+{
+    return mReplyCache;
+}
+
+AgentContextPool::eCacheType AgentService::getCacheTypeK(void) const
+{
+    return mCacheTypeK;
+}
+
+AgentContextPool::eCacheType AgentService::getCacheTypeV(void) const
+{
+    return mCacheTypeV;
+}
+
+AgentContextPool::eFlashAttention AgentService::getFlashAttention(void) const
+{
+    return mFlashAttn;
+}
+
+AgentScheduler::ePolicy AgentService::getSchedulingPolicy(void) const
+{
+    return mPolicy;
+}
+
+void AgentService::onProviderStarted(AgentProvider& provider)
+{
+    LOG_SCOPE(multiedge_aiagentservice_AgentService_onProviderStarted);
+    LOG_INFO("Edge AI agent service started, activating model [ %s ]", mModelPath.getString());
+
+    // Direct connection, the notification is triggered in the thread of the provider.
+    mConnection = QObject::connect(&provider, &AgentProvider::signalActiveModelChanged, [this](QString modelName)
+        {
+            const double elapsed = std::chrono::duration<double, std::milli>(Clock::now() - mStarted).count();
+            std::fprintf(stderr, "Edge AI agent is ready with model [ %s ] in [ %.1f ] ms\n", modelName.toUtf8().constData(), elapsed);
+        });
+
+    mFailure = QObject::connect(&provider, &AgentProvider::signalActiveModelFailed, [](QString modelPath)
+        {
+            std::fprintf(stderr, "Edge AI agent failed to load model [ %s ]\n", modelPath.toUtf8().constData());
+        });
+}
+
+void AgentService::onProviderStopped(AgentProvider& /*provider*/)
+{
+    QObject::disconnect(mConnection);
+    QObject::disconnect(mFailure);
+}
+
+bool AgentService::setProperty(const String& name, const String& value)
+{
+    const std::string& prop = name.getData();
+    const char* text = value.getString();
+    if (prop == "model")
+    {
+        mModelPath = value;
+    }
+    else if (prop == "draft")
+    {
+        mDraftPath = value;
+    }
+    else if (prop == "embedding")
+    {
+        mEmbedPath = value;
+    }
+    else if (prop == "similarity")
+    {
+        mSimilarity = std::clamp(static_cast<uint32_t>(std::strtoul(text, nullptr, 10)), AgentSemanticCache::MIN_SIMILARITY, AgentSemanticCache::MAX_SIMILARITY);
+    }
+    else if (prop == "profile")
+    {
+        const sProfile* end = std::end(PROFILES);
+        const sProfile* pos = std::find_if(std::begin(PROFILES), end, [&value](const sProfile& profile) { return (value.getData() == profile.name); });
+        if (pos == end)
+            return false;
+
+        mTemperature = pos->temperature;
+        mProbability = pos->probability;
+        mLookup      = pos->lookup;
+    }
+    else if (prop == "temperature")
+    {
+        mTemperature = std::clamp(std::strtof(text, nullptr), AgentProcessor::MIN_TEMPERATURE, AgentProcessor::MAX_TEMPERATURE);
+    }
+    else if (prop == "minp")
+    {
+        mProbability = std::clamp(std::strtof(text, nullptr), AgentProcessor::MIN_PROBABILITY, AgentProcessor::MAX_PROBABILITY);
+    }
+    else if (prop == "lookup")
+    {
+        if ((value.getData() == "on") || (value.getData() == "true"))
+            mLookup = true;
+        else if ((value.getData() == "off") || (value.getData() == "false"))
+            mLookup = false;
+        else
+            return false;
+    }
+    else if (prop == "text")
+    {
+        mTextLength = std::clamp(static_cast<uint32_t>(std::strtoul(text, nullptr, 10)), AgentProcessor::MIN_CHARS, AgentProcessor::MAX_CHARS);
+    }
+    else if (prop == "tokens")
+    {
+        mTokens = std::clamp(static_cast<uint32_t>(std::strtoul(text, nullptr, 10)), AgentProcessor::MIN_TOKENS, AgentProcessor::MAX_TOKENS);
+    }
+    else if (prop == "batch")
+    {
+        mBatching = std::clamp(static_cast<uint32_t>(std::strtoul(text, nullptr, 10)), AgentProcessor::MIN_BATCHING, AgentProcessor::MAX_BATCHING);
+    }
+    else if (prop == "threads")
+    {
+        mThreads = std::clamp(static_cast<uint32_t>(std::strtoul(text, nullptr, 10)), AgentProcessor::MIN_THREADS, AgentProcessor::optThreadCount());
+    }
+    else if (prop == "cache")
+    {
+        mCacheSize = std::clamp(static_cast<uint32_t>(std::strtoul(text, nullptr, 10)), AgentProcessor::MIN_CACHE_MB, AgentProcessor::MAX_CACHE_MB);
+    }
+    else if (prop == "sessions")
+    {
+        mSessionSize = std::clamp(static_cast<uint32_t>(std::strtoul(text, nullptr, 10)), AgentProcessor::MIN_SESSION_MB, AgentProcessor::MAX_SESSION_MB);
+    }
+    else if (prop == "context")
+    {
+        mContextSize = std::clamp(static_cast<uint32_t>(std::strtoul(text, nullptr, 10)), AgentProcessor::MIN_CONTEXT_MB, AgentProcessor::MAX_CONTEXT_MB);
+    }
+    else if (prop == "models")
+    {
+        mModelsSize = std::clamp(static_cast<uint32_t>(std::strtoul(text, nullptr, 10)), AgentProcessor::MIN_MODELS_MB, AgentProcessor::MAX_MODELS_MB);
+    }
+    else if (prop == "replies")
+    {
+        mReplyCache = std::clamp(static_cast<uint32_t>(std::strtoul(text, nullptr, 10)), AgentResponseCache::MIN_ENTRIES, AgentResponseCache::MAX_ENTRIES);
+    }
+    else if ((prop == "kvkeys") || (prop == "kvvalues"))
+    {
+        AgentContextPool::eCacheType& type = (prop == "kvkeys" ? mCacheTypeK : mCacheTypeV);
+        if (value.getData() == "f16")
+            type = AgentContextPool::CacheF16;
+        else if (value.getData() == "q8_0")
+            type = AgentContextPool::CacheQ8;
+        else if (value.getData() == "q4_0")
+            type = AgentContextPool::CacheQ4;
+        else
+            return false;
+    }
+    else if (prop == "flash")
+    {
+        if (value.getData() == "auto")
+            mFlashAttn = AgentContextPool::FlashAuto;
+        else if ((value.getData() == "on") || (value.getData() == "true"))
+            mFlashAttn = AgentContextPool::FlashOn;
+        else if ((value.getData() == "off") || (value.getData() == "false"))
+            mFlashAttn = AgentContextPool::FlashOff;
+        else
+            return false;
+    }
+    else if (prop == "policy")
+    {
+        if (value.getData() == "fifo")
+            mPolicy = AgentScheduler::PolicyFifo;
+        else if (value.getData() == "fair")
+            mPolicy = AgentScheduler::PolicyFair;
+        else if (value.getData() == "shortest")
+            mPolicy = AgentScheduler::PolicyShortest;
+        else
+            return false;
+    }
+    else
+    {
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,232 @@
+﻿#ifndef MULTIEDGE_AIAGENTSERVICE_AGENTSERVICE_HPP
+#define MULTIEDGE_AIAGENTSERVICE_AGENTSERVICE_HPP
+/************************************************************************
+ * This file is part of the Areg Edge AI project powered by AREG SDK.
+ * The project contains multiple examples of using Edge AI based on Areg communication framework.
+ *
+ *  Areg Edge AI is available as free and open-source software under the MIT License.
+ *
+ *  For detailed licensing terms, please refer to the LICENSE file included
+ *  with this distribution or contact us at info[at]areg.tech.
+ *
+ *  \copyright   © 2025 Aregtech UG. All rights reserved.
+ *  \file        multiedge/aiagentservice/agentservice.hpp
+ *  \ingroup     Areg Edge AI, AI Multi Edge Device Agent
+ *  \author      Artak Avetyan
+ *  \brief       Edge AI Agent headless service host.
+ *
+ ************************************************************************/
+
+/************************************************************************
+ * Includes
+ ************************************************************************/
+
+#include "areg/base/GEGlobal.h"
+#include "areg/base/String.hpp"
+#include "multiedge/aiagent/agenthost.hpp"
+
+#include <QMetaObject>
+#include <chrono>
+#include <string_view>
+
+//////////////////////////////////////////////////////////////////////////
+// AgentService class declaration
+//////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief   The headless host of the Edge AI Agent service provider. It has no
+ *          windows, the model and the settings are read from the configuration
+ *          of Areg, so that they are placed in areg.init, for example:
+ *              aiagent::*::model    = ./models/llama/text/model.gguf
+ *              aiagent::*::profile  = balanced
+ *              aiagent::*::threads  = 8
+ *          The supported properties are 'model', 'draft', 'profile', 'temperature', 'minp',
+ *          'lookup', 'text', 'tokens', 'batch', 'threads', 'cache', 'sessions', 'context', 'models',
+ *          'replies', 'embedding', 'similarity', 'kvkeys', 'kvvalues', 'flash' and 'policy'.
+ *          Missing properties keep the default values of the GUI agent.
+ **/
+class AgentService : public IEAgentHost
+{
+//////////////////////////////////////////////////////////////////////////
+// Internal types and constants
+//////////////////////////////////////////////////////////////////////////
+public:
+    //!< The section of the configuration properties of the service.
+    static constexpr std::string_view   CONFIG_SECTION  { "aiagent" };
+
+    //!< The properties of the service in the configuration. The profile is set before the sampling properties it overrides.
+    static constexpr std::string_view   PROPERTIES[]
+    {
+          "model"   , "draft"   , "embedding", "similarity", "profile" , "temperature", "minp"   , "lookup"
+        , "text"    , "tokens"  , "batch"    , "threads"   , "cache"   , "sessions"   , "context", "models"
+        , "replies" , "kvkeys"  , "kvvalues" , "flash"     , "policy"
+    };
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    //!< The sampling profile, the same as the profiles of the GUI agent.
+    struct sProfile
+    {
+        std::string_view    name;           //!< The name of the profile in the configuration.
+        float               temperature;    //!< The sampling temperature.
+        float               probability;    //!< The min-p sampling probability.
+        bool                lookup;         //!< Flag, indicating that the prompt lookup speculates the tokens.
+    };
+
+    //!< The sampling profiles.
+    static constexpr sProfile   PROFILES[]
+    {
+          { "answer"        , 0.00f, 0.00f, true  }
+        , { "precise"       , 0.10f, 0.12f, true  }
+        , { "balanced"      , 0.30f, 0.10f, true  }
+        , { "conversational", 0.50f, 0.08f, false }
+        , { "creative"      , 0.75f, 0.06f, false }
+        , { "experimental"  , 1.00f, 0.05f, false }
+    };
+
+//////////////////////////////////////////////////////////////////////////
+// Constructor / Destructor
+//////////////////////////////////////////////////////////////////////////
+public:
+    AgentService(void);
+    virtual ~AgentService(void) = default;
+
+//////////////////////////////////////////////////////////////////////////
+// Attributes and operations
+//////////////////////////////////////////////////////////////////////////
+public:
+
+    /**
+     * \brief   Reads the settings of the service from the configuration of the application,
+     *          which is read by Areg on initialization. The missing properties keep the defaults.
+     * \return  Returns true if the application is configured.
+     **/
+    bool loadConfig(void);
+
+    /**
+     * \brief   Sets the path to the model file to activate on start.
+     **/
+    inline void setModelPath(const String& modelPath);
+
+    /**
+     * \brief   Sets the path to the draft model file of the speculative decoding.
+     **/
+    inline void setDraftPath(const String& draftPath);
+
+//////////////////////////////////////////////////////////////////////////
+// IEAgentHost overrides
+//////////////////////////////////////////////////////////////////////////
+public:
+
+    virtual String getActiveModelPath(void) const override;
+
+    virtual String getDraftModelPath(void) const override;
+
+    virtual String getEmbedModelPath(void) const override;
+
+    virtual uint32_t getSimilarity(void) const override;
+
+    virtual float getTemperature(void) const override;
+
+    virtual float getProbability(void) const override;
+
+    virtual bool getPromptLookup(void) const override;
+
+    virtual uint32_t getTextLength(void) const override;
+
+    virtual uint32_t getTokens(void) const override;
+
+    virtual uint32_t getBatching(void) const override;
+
+    virtual uint32_t getThreads(void) const override;
+
+    virtual uint32_t getCacheSize(void) const override;
+
+    virtual uint32_t getSessionSize(void) const override;
+
+    virtual uint32_t getContextSize(void) const override;
+
+    virtual uint32_t getModelsSize(void) const override;
+
+    virtual uint32_t getReplyCache(void) const override;
+
+    virtual AgentContextPool::eCacheType getCacheTypeK(void) const override;
+
+    virtual AgentContextPool::eCacheType getCacheTypeV(void) const override;
+
+    virtual AgentContextPool::eFlashAttention getFlashAttention(void) const override;
+
+    virtual AgentScheduler::ePolicy getSchedulingPolicy(void) const override;
+
+    /**
+     * \brief   Triggered when the service provider starts. Reports the service ready
+     *          with the time since start as soon as the model is activated.
+     * \param   provider    The started service provider.
+     **/
+    virtual void onProviderStarted(AgentProvider& provider) override;
+
+    /**
+     * \brief   Triggered when the service provider stops.
+     * \param   provider    The stopped service provider.
+     **/
+    virtual void onProviderStopped(AgentProvider& provider) override;
+
+//////////////////////////////////////////////////////////////////////////
+// Hidden methods
+//////////////////////////////////////////////////////////////////////////
+private:
+
+    //!< Sets the value of the property. Returns false if the property is unknown.
+    bool setProperty(const String& name, const String& value);
+
+//////////////////////////////////////////////////////////////////////////
+// Member variables
+//////////////////////////////////////////////////////////////////////////
+private:
+    const Clock::time_point mStarted;       //!< The time the service is started.
+    String                  mModelPath;     //!< The path to the model file.
+    String                  mDraftPath;     //!< The path to the draft model file of the speculative decoding.
+    String                  mEmbedPath;     //!< The path to the embedding model file of the semantic cache.
+    uint32_t                mSimilarity;    //!< The minimum similarity of the prompts in percent to reply from the semantic cache.
+    float                   mTemperature;   //!< The sampling temperature.
+    float                   mProbability;   //!< The min-p sampling probability.
+    bool                    mLookup;        //!< Flag, indicating that the prompt lookup speculates the tokens.
+    uint32_t                mTextLength;    //!< The maximum length of the text.
+    uint32_t                mTokens;        //!< The maximum number of tokens to generate.
+    uint32_t                mBatching;      //!< The batch size.
+    uint32_t                mThreads;       //!< The number of threads to decode.
+    uint32_t                mCacheSize;     //!< The budget of the prompt prefix cache in megabytes.
+    uint32_t                mSessionSize;   //!< The budget of the conversation states in megabytes.
+    uint32_t                mContextSize;   //!< The budget of the KV cache of the context larger than default in megabytes.
+    uint32_t                mModelsSize;    //!< The memory budget of the loaded models in megabytes.
+    uint32_t                mReplyCache;    //!< The maximum number of cached replies of the repeated prompts.
+    AgentContextPool::eCacheType        mCacheTypeK;    //!< The data type of the keys in the KV cache.
+    AgentContextPool::eCacheType        mCacheTypeV;    //!< The data type of the values in the KV cache.
+    AgentContextPool::eFlashAttention   mFlashAttn;     //!< The mode of the flash attention.
+    AgentScheduler::ePolicy mPolicy;        //!< The policy to schedule the queued text prompts.
+    QMetaObject::Connection mConnection;    //!< The connection to the notification of activated model.
+    QMetaObject::Connection mFailure;       //!< The connection to the notification of the model failed to activate.
+
+//////////////////////////////////////////////////////////////////////////
+// Forbidden calls
+//////////////////////////////////////////////////////////////////////////
+private:
+    DECLARE_NOCOPY_NOMOVE(AgentService);
+};
+
+//////////////////////////////////////////////////////////////////////////
+// Inline methods
+//////////////////////////////////////////////////////////////////////////
+
+inline void AgentService::setModelPath(const String& modelPath)
+{
+    mModelPath = modelPath;
+}
+
+inline void AgentService::setDraftPath(const String& draftPath)
+{
+    mDraftPath = draftPath;
+}
+
+#endif // MULTIEDGE_AIAGENTSERVICE_AGENTSERVICE_HPP
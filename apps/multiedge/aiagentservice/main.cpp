@@ -0,0 +1,146 @@
+﻿/************************************************************************
+ * This file is part of the Areg Edge AI project powered by AREG SDK.
+ * The project contains multiple examples of using Edge AI based on Areg communication framework.
+ *
+ *  Areg Edge AI is available as free and open-source software under the MIT License.
+ *
+ *  For detailed licensing terms, please refer to the LICENSE file included
+ *  with this distribution or contact us at info[at]areg.tech.
+ *
+ *  \copyright   © 2025 Aregtech UG. All rights reserved.
+ *  \file        multiedge/aiagentservice/main.cpp
+ *  \ingroup     Areg Edge AI, AI Multi Edge Device Agent
+ *  \author      Artak Avetyan
+ *  \brief       Edge AI Agent headless service.
+ *
+ ************************************************************************/
+
+/************************************************************************
+ * Includes
+ ************************************************************************/
+#include "multiedge/aiagentservice/agentservice.hpp"
+#include "multiedge/resources/NECommandLine.hpp"
+#include "multiedge/resources/NEMultiEdgeSettings.hpp"
+#include "areg/appbase/Application.hpp"
+#include "areg/component/ComponentLoader.hpp"
+#include "areg/ipc/ConnectionConfiguration.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include "llama.h"
+
+namespace
+{
+    //!< The default configuration file, the properties of the service are set in areg.init.
+    constexpr std::string_view  DEF_CONFIG      { "./config/areg.init" };
+    //!< The interval to check the request to quit.
+    constexpr std::chrono::milliseconds QUIT_INTERVAL   { 200 };
+
+    //!< Flag, indicating that the service is requested to quit.
+    std::atomic_bool    _quit{ false };
+
+    //!< Requests the service to quit on termination signal.
+    void _signalQuit(int /*signal*/)
+    {
+        _quit = true;
+    }
+
+    //!< Prints the usage of the application.
+    void _printUsage(const char* app)
+    {
+        std::fprintf(stderr
+                    , "Usage: %s [options]\n"
+                      "Options:\n"
+                      "  --config=<file>        The configuration file with 'aiagent::*::<property>' entries, default %s.\n"
+                      "  --model=<file.gguf>    The model to activate, overrides the configuration.\n"
+                      "  --draft=<file.gguf>    The draft model of the speculative decoding, overrides the configuration.\n"
+                    , app
+                    , DEF_CONFIG.data());
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    String config(DEF_CONFIG);
+    String model;
+    String draft;
+    for (int i = 1; i < argc; ++ i)
+    {
+        const char* arg = argv[i];
+        const char* value{ nullptr };
+        if ((value = NECommandLine::optionValue(arg, "--config")) != nullptr)
+            config = value;
+        else if ((value = NECommandLine::optionValue(arg, "--model")) != nullptr)
+            model = value;
+        else if ((value = NECommandLine::optionValue(arg, "--draft")) != nullptr)
+            draft = value;
+        else
+        {
+            _printUsage(argv[0]);
+            return (std::strcmp(arg, "--help") == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+        }
+    }
+
+    // The configuration is read by Areg, the service reads its properties from the configuration manager.
+    Application::initApplication(true, true, false, true, false, config.getString());
+    // Load backends once per process.
+    ggml_backend_load_all();
+
+    AgentService service;
+    if (service.loadConfig() == false)
+    {
+        std::fprintf(stderr, "Failed to read the configuration [ %s ], using defaults\n", config.getString());
+    }
+
+    if (model.isEmpty() == false)
+    {
+        service.setModelPath(model);
+    }
+
+    if (draft.isEmpty() == false)
+    {
+        service.setDraftPath(draft);
+    }
+
+    if (service.getActiveModelPath().isEmpty())
+    {
+        std::fprintf(stderr, "No model is set, the service replies empty texts until the model is configured\n");
+    }
+
+    String address(NEMultiEdgeSettings::ROUTER_ADDRESS);
+    uint16_t port{ NEMultiEdgeSettings::ROUTER_PORT };
+    ConnectionConfiguration connection(NERemoteService::eRemoteServices::ServiceRouter, NERemoteService::eConnectionTypes::ConnectTcpip);
+    if (connection.isConfigured())
+    {
+        address = connection.getConnectionAddress();
+        port    = static_cast<uint16_t>(connection.getConnectionPort());
+    }
+
+    bool result{ false };
+    if (Application::startMessageRouting(address.getString(), port))
+    {
+        std::signal(SIGINT , &_signalQuit);
+        std::signal(SIGTERM, &_signalQuit);
+        VERIFY(ComponentLoader::setComponentData(NEMultiEdgeSettings::SERVICE_PROVIDER.data(), std::make_any<IEAgentHost *>(static_cast<IEAgentHost *>(&service))));
+        result = Application::loadModel(NEMultiEdgeSettings::MODEL_PROVIDER.data());
+        while (result && (_quit == false))
+        {
+            std::this_thread::sleep_for(QUIT_INTERVAL);
+        }
+
+        Application::unloadModel(NEMultiEdgeSettings::MODEL_PROVIDER.data());
+        Application::stopMessageRouting();
+    }
+    else
+    {
+        std::fprintf(stderr, "Failed to connect to the router [ %s:%u ]\n", address.getString(), static_cast<uint32_t>(port));
+    }
+
+    Application::releaseApplication();
+    return (result ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -229,6 +229,15 @@ bool AgentChatHistory::addResponse(const QString& reply, uint32_t seqId)
     
 bool AgentChatHistory::addResponse(const QString& reply, uint32_t seqId, uint64_t when)
 {
+    int32_t row = findReply(seqId);
+    if (row >= 0)
+    {
+        // The reply was streamed, replace the text by the complete reply.
+        mHistory[row].chatMessage = reply;
+        setReplied(findEntry(seqId, row - 1), row);
+        return true;
+    }
+
     sChatEntry entry{eChatSource::SourceEdgeAi, reply, when, eMessageStatus::StatusReplied, seqId};
     int32_t idx  = static_cast<int32_t>(seqId * 2);
     int32_t size = static_cast<int32_t>(mHistory.size());
@@ -244,7 +253,15 @@ bool AgentChatHistory::addResponse(const QString& reply, uint32_t seqId, uint64_
         idx = findEntry(seqId, idx);
         if (idx >= 0)
         {
-            mHistory[idx].chatStatus = eMessageStatus::StatusReplied;
+            if (mHistory[idx].chatStatus == eMessageStatus::StatusCanceled)
+            {
+                entry.chatStatus = eMessageStatus::StatusCanceled;
+            }
+            else
+            {
+                mHistory[idx].chatStatus = eMessageStatus::StatusReplied;
+            }
+
             if ((idx + 1) == size)
             {
                 beginInsertRows(QModelIndex(), mSequence, mSequence);
@@ -270,6 +287,41 @@ bool AgentChatHistory::addResponse(const QString& reply, uint32_t seqId, uint64_
     return (entry.chatStatus == eMessageStatus::StatusReplied);
 }
 
+bool AgentChatHistory::addFragment(const QString& fragment, uint32_t seqId, bool isFinal, uint64_t when)
+{
+    int32_t row = findReply(seqId);
+    if (row >= 0)
+    {
+        sChatEntry& entry = mHistory[row];
+        if (entry.chatStatus != eMessageStatus::StatusPending)
+            return false;
+
+        entry.chatMessage += fragment;
+        QModelIndex idx = index(row, static_cast<int>(eChatColumn::ColumnMessage));
+        emit dataChanged(idx, idx);
+    }
+    else if (fragment.isEmpty() == false)
+    {
+        int32_t request = findEntry(seqId, static_cast<int32_t>(seqId * 2));
+        if ((request < 0) || (mHistory[request].chatSource != eChatSource::SourceHuman))
+            return false;
+
+        // The first fragment creates the reply row, the timestamp shows the time to the first token.
+        row = request + 1;
+        beginInsertRows(QModelIndex(), row, row);
+        sChatEntry entry{eChatSource::SourceEdgeAi, fragment, when, eMessageStatus::StatusPending, seqId};
+        mHistory.insert(mHistory.begin() + row, entry);
+        endInsertRows();
+    }
+
+    if (isFinal && (row >= 0))
+    {
+        setReplied(findEntry(seqId, row - 1), row);
+    }
+
+    return (row >= 0);
+}
+
 void AgentChatHistory::addFailure(const QString& text)
 {
     beginInsertRows(QModelIndex(), mSequence, mSequence);
@@ -278,6 +330,27 @@ void AgentChatHistory::addFailure(const QString& text)
     endInsertRows();
 }
 
+std::vector<uint32_t> AgentChatHistory::cancelPending(void)
+{
+    std::vector<uint32_t> result;
+    for (int32_t i = 0; i < static_cast<int32_t>(mHistory.size()); ++ i)
+    {
+        sChatEntry& entry = mHistory[i];
+        if (entry.chatStatus == eMessageStatus::StatusPending)
+        {
+            if (entry.chatSource == eChatSource::SourceHuman)
+            {
+                result.push_back(entry.chatId);
+            }
+
+            entry.chatStatus = eMessageStatus::StatusCanceled;
+            emit dataChanged(index(i, 0), index(i, static_cast<int>(eChatColumn::ColumnCount) - 1));
+        }
+    }
+
+    return result;
+}
+
 void AgentChatHistory::resetHistory(void)
 {
     beginResetModel();
@@ -308,3 +381,31 @@ int AgentChatHistory::findEntry(uint32_t seqId, int32_t startAt)
     
     return -1;
 }
+
+int AgentChatHistory::findReply(uint32_t seqId) const
+{
+    for (int32_t i = static_cast<int32_t>(mHistory.size()) - 1; i >= 0; -- i)
+    {
+        const sChatEntry& entry = mHistory[i];
+        if (entry.chatId == seqId)
+        {
+            return ((entry.chatSource == eChatSource::SourceEdgeAi) && (entry.chatStatus != eMessageStatus::StatusError) ? i : -1);
+        }
+    }
+
+    return -1;
+}
+
+void AgentChatHistory::setReplied(int request, int reply)
+{
+    // The canceled request remains canceled, the reply contains the text generated before canceling.
+    const bool canceled = (request >= 0) && (mHistory[request].chatStatus == eMessageStatus::StatusCanceled);
+    if ((request >= 0) && (canceled == false))
+    {
+        mHistory[request].chatStatus = eMessageStatus::StatusReplied;
+        emit dataChanged(index(request, 0), index(request, static_cast<int>(eChatColumn::ColumnCount) - 1));
+    }
+
+    mHistory[reply].chatStatus = canceled ? eMessageStatus::StatusCanceled : eMessageStatus::StatusReplied;
+    emit dataChanged(index(reply, 0), index(reply, static_cast<int>(eChatColumn::ColumnCount) - 1));
+}
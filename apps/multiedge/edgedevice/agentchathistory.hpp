@@ -80,9 +80,13 @@ public:
     bool addResponse(const QString& reply, uint32_t seqId);
     
     bool addResponse(const QString& reply, uint32_t seqId, uint64_t when);
+
+    bool addFragment(const QString& fragment, uint32_t seqId, bool isFinal, uint64_t when);
         
     void addFailure(const QString& text);
 
+    std::vector<uint32_t> cancelPending(void);
+
     void resetHistory(void);
 
     const QString & getRowMessage(int row) const;
@@ -106,6 +110,10 @@ private:
     
     int findEntry(uint32_t seqId, int32_t startAt);
 
+    int findReply(uint32_t seqId) const;
+
+    void setReplied(int request, int reply);
+
 private:
     ChatHistory mHistory;
     uint32_t    mSequence;
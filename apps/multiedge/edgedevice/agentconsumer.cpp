@@ -32,18 +32,23 @@
 
 DEF_LOG_SCOPE(multiedge_edgedevice_AgentConsumer_processText);
 DEF_LOG_SCOPE(multiedge_edgedevice_AgentConsumer_processVideo);
+DEF_LOG_SCOPE(multiedge_edgedevice_AgentConsumer_cancelText);
 DEF_LOG_SCOPE(multiedge_edgedevice_AgentConsumer_serviceConnected);
 DEF_LOG_SCOPE(multiedge_edgedevice_AgentConsumer_onActiveModelUpdate);
 DEF_LOG_SCOPE(multiedge_edgedevice_AgentConsumer_onQueueSizeUpdate);
+DEF_LOG_SCOPE(multiedge_edgedevice_AgentConsumer_onAvailableModelsUpdate);
+DEF_LOG_SCOPE(multiedge_edgedevice_AgentConsumer_onAvailableAdaptersUpdate);
+DEF_LOG_SCOPE(multiedge_edgedevice_AgentConsumer_onTextLatencyUpdate);
 DEF_LOG_SCOPE(multiedge_edgedevice_AgentConsumer_onEdgeAgentUpdate);
 DEF_LOG_SCOPE(multiedge_edgedevice_AgentConsumer_responseProcessText);
 DEF_LOG_SCOPE(multiedge_edgedevice_AgentConsumer_responseProcessVideo);
+DEF_LOG_SCOPE(multiedge_edgedevice_AgentConsumer_responseStreamText);
 DEF_LOG_SCOPE(multiedge_edgedevice_AgentConsumer_requestProcessTextFailed);
 DEF_LOG_SCOPE(multiedge_edgedevice_AgentConsumer_requestProcessVideoFailed);
 
 String AgentConsumer::mConsumerName;
 
-bool AgentConsumer::processText(uint32_t id, const QString& text)
+bool AgentConsumer::processText(uint32_t id, const QString& text, const QString& modelName, const QString& adapterName)
 {
     LOG_SCOPE(multiedge_edgedevice_AgentConsumer_processText);
     
@@ -51,7 +56,9 @@ bool AgentConsumer::processText(uint32_t id, const QString& text)
     if ((comp != nullptr) && comp->isConnected())
     {
         LOG_DBG("Sending text to agent consumer, id: %u", id);
-        comp->requestProcessText(id, comp->mConsumerId, String(text.toStdString()));
+        comp->requestProcessText(id, comp->mConsumerId, comp->mConversationId, NEMultiEdge::eTextPriority::PriorityNormal, String(modelName.toStdString()), String(adapterName.toStdString()), String(text.toStdString()));
+        // The fragments of the reply are sent only to this device, the next one is requested after each response.
+        comp->requestStreamText(id, comp->mConsumerId);
         return true;
     }
 
@@ -59,6 +66,21 @@ bool AgentConsumer::processText(uint32_t id, const QString& text)
     return false;
 }
 
+bool AgentConsumer::cancelText(uint32_t id)
+{
+    LOG_SCOPE(multiedge_edgedevice_AgentConsumer_cancelText);
+    
+    AgentConsumer* comp = AgentConsumer::getService();
+    if ((comp != nullptr) && comp->isConnected())
+    {
+        LOG_DBG("Canceling text processing, id: %u", id);
+        comp->requestCancelText(id, comp->mConsumerId);
+        return true;
+    }
+
+    return false;
+}
+
 bool AgentConsumer::processVideo(uint32_t id, const QString& cmdText, const SharedBuffer& video)
 {
     LOG_SCOPE(multiedge_edgedevice_AgentConsumer_processVideo);
@@ -100,6 +122,7 @@ AgentConsumer::AgentConsumer(const NERegistry::ComponentEntry& entry, ComponentT
     , MultiEdgeClientBase(entry.mDependencyServices[0].mRoleName, owner)
     , QObject            ( )
     , mConsumerId        (static_cast<uint32_t>(NEMath::CHECKSUM_IGNORE))
+    , mConversationId    (0u)
     , mEdgeDevice        (std::any_cast<EdgeDevice *>(entry.getComponentData()))
 {
     ASSERT(mEdgeDevice != nullptr);
@@ -125,24 +148,37 @@ bool AgentConsumer::serviceConnected(NEService::eServiceConnection status, Proxy
         
         notifyOnActiveModelUpdate(isConnected);
         notifyOnQueueSizeUpdate(isConnected);
+        notifyOnAvailableModelsUpdate(isConnected);
+        notifyOnAvailableAdaptersUpdate(isConnected);
         notifyOnEdgeAgentUpdate(isConnected);
+        notifyOnTextLatencyUpdate(isConnected);
         mConsumerId = isConnected ? NEMath::crc32Calculate(getRoleName().getString()) : static_cast<uint32_t>(NEMath::CHECKSUM_IGNORE);
+        // The chat history is reset on connection, start new conversation. Zero means no conversation.
+        mConversationId = isConnected ? (mConversationId % 0xFFFFFFFFu) + 1u : mConversationId;
         
         ASSERT(mEdgeDevice != nullptr);
         if (isConnected)
         {
             connect(this, &AgentConsumer::signalActiveModelChanged   , mEdgeDevice, &EdgeDevice::slotActiveModelChanged    , Qt::ConnectionType::QueuedConnection);
             connect(this, &AgentConsumer::signalAgentQueueSize       , mEdgeDevice, &EdgeDevice::slotAgentQueueSize        , Qt::ConnectionType::QueuedConnection);
+            connect(this, &AgentConsumer::signalAvailableModels      , mEdgeDevice, &EdgeDevice::slotAvailableModels       , Qt::ConnectionType::QueuedConnection);
+            connect(this, &AgentConsumer::signalAvailableAdapters    , mEdgeDevice, &EdgeDevice::slotAvailableAdapters     , Qt::ConnectionType::QueuedConnection);
             connect(this, &AgentConsumer::signalAgentType            , mEdgeDevice, &EdgeDevice::slotAgentType             , Qt::ConnectionType::QueuedConnection);
+            connect(this, &AgentConsumer::signalTextLatency          , mEdgeDevice, &EdgeDevice::slotTextLatency           , Qt::ConnectionType::QueuedConnection);
             connect(this, &AgentConsumer::signalTextProcessed        , mEdgeDevice, &EdgeDevice::slotTextProcessed         , Qt::ConnectionType::QueuedConnection);
+            connect(this, &AgentConsumer::signalTextFragment         , mEdgeDevice, &EdgeDevice::slotTextFragment          , Qt::ConnectionType::QueuedConnection);
             connect(this, &AgentConsumer::signalVideoProcessed       , mEdgeDevice, &EdgeDevice::slotVideoProcessed        , Qt::ConnectionType::QueuedConnection);
             connect(this, &AgentConsumer::signalAgentProcessingFailed, mEdgeDevice, &EdgeDevice::slotAgentProcessingFailed , Qt::ConnectionType::QueuedConnection);
         }
         else
         {
             disconnect(this, &AgentConsumer::signalActiveModelChanged   , mEdgeDevice, &EdgeDevice::slotActiveModelChanged);
+            disconnect(this, &AgentConsumer::signalAvailableModels      , mEdgeDevice, &EdgeDevice::slotAvailableModels);
+            disconnect(this, &AgentConsumer::signalAvailableAdapters    , mEdgeDevice, &EdgeDevice::slotAvailableAdapters);
             disconnect(this, &AgentConsumer::signalAgentType            , mEdgeDevice, &EdgeDevice::slotAgentType);
+            disconnect(this, &AgentConsumer::signalTextLatency          , mEdgeDevice, &EdgeDevice::slotTextLatency);
             disconnect(this, &AgentConsumer::signalTextProcessed        , mEdgeDevice, &EdgeDevice::slotTextProcessed);
+            disconnect(this, &AgentConsumer::signalTextFragment         , mEdgeDevice, &EdgeDevice::slotTextFragment);
             disconnect(this, &AgentConsumer::signalVideoProcessed       , mEdgeDevice, &EdgeDevice::slotVideoProcessed);
             disconnect(this, &AgentConsumer::signalAgentProcessingFailed, mEdgeDevice, &EdgeDevice::slotAgentProcessingFailed);
         }
@@ -169,6 +205,40 @@ void AgentConsumer::onQueueSizeUpdate(unsigned int QueueSize, NEService::eDataSt
     emit signalAgentQueueSize(state == NEService::eDataStateType::DataIsOK ? QueueSize : 0u);
 }
 
+void AgentConsumer::onAvailableModelsUpdate(const NEMultiEdge::ModelList& AvailableModels, NEService::eDataStateType state)
+{
+    LOG_SCOPE(multiedge_edgedevice_AgentConsumer_onAvailableModelsUpdate);
+    LOG_DBG("Available models update, models: %u, state: %s", AvailableModels.getSize(), NEService::getString(state));
+
+    QStringList models;
+    if (state == NEService::eDataStateType::DataIsOK)
+    {
+        for (uint32_t i = 0; i < AvailableModels.getSize(); ++ i)
+        {
+            models.append(QString::fromStdString(AvailableModels[i].getData()));
+        }
+    }
+
+    emit signalAvailableModels(models);
+}
+
+void AgentConsumer::onAvailableAdaptersUpdate(const NEMultiEdge::ModelList& AvailableAdapters, NEService::eDataStateType state)
+{
+    LOG_SCOPE(multiedge_edgedevice_AgentConsumer_onAvailableAdaptersUpdate);
+    LOG_DBG("Available adapters update, adapters: %u, state: %s", AvailableAdapters.getSize(), NEService::getString(state));
+
+    QStringList adapters;
+    if (state == NEService::eDataStateType::DataIsOK)
+    {
+        for (uint32_t i = 0; i < AvailableAdapters.getSize(); ++ i)
+        {
+            adapters.append(QString::fromStdString(AvailableAdapters[i].getData()));
+        }
+    }
+
+    emit signalAvailableAdapters(adapters);
+}
+
 void AgentConsumer::onEdgeAgentUpdate(NEMultiEdge::eEdgeAgent EdgeAgent, NEService::eDataStateType state)
 {
     LOG_SCOPE(multiedge_edgedevice_AgentConsumer_onEdgeAgentUpdate);
@@ -177,15 +247,47 @@ void AgentConsumer::onEdgeAgentUpdate(NEMultiEdge::eEdgeAgent EdgeAgent, NEServi
     emit signalAgentType(state == NEService::eDataStateType::DataIsOK ? EdgeAgent : NEMultiEdge::eEdgeAgent::AgentUnknown);
 }
 
-void AgentConsumer::responseProcessText(unsigned int sessionId, unsigned int agentId, const String& textReplied)
+void AgentConsumer::onTextLatencyUpdate(const NEMultiEdge::sTextLatency& TextLatency, NEService::eDataStateType state)
+{
+    LOG_SCOPE(multiedge_edgedevice_AgentConsumer_onTextLatencyUpdate);
+    LOG_DBG("Text latency update, texts: %u, state: %s", TextLatency.texts, NEService::getString(state));
+
+    QString latency;
+    if ((state == NEService::eDataStateType::DataIsOK) && (TextLatency.texts != 0u))
+    {
+        // The times are in microseconds, display in milliseconds as median / 99th percentile.
+        latency = QString("Last %1 texts, median / p99 in ms\n"
+                          "Queue wait: %2 / %3\n"
+                          "First token: %4 / %5\n"
+                          "Decode: %6 / %7\n"
+                          "Prefill: %8 tokens/s\n"
+                          "Decode: %9 tokens/s\n"
+                          "Speculation: %10 of %11 tokens accepted")
+                    .arg(TextLatency.texts)
+                    .arg(TextLatency.queueWait.median / 1000u).arg(TextLatency.queueWait.tail / 1000u)
+                    .arg(TextLatency.firstToken.median / 1000u).arg(TextLatency.firstToken.tail / 1000u)
+                    .arg(TextLatency.decode.median / 1000u).arg(TextLatency.decode.tail / 1000u)
+                    .arg(TextLatency.prefillRate)
+                    .arg(TextLatency.decodeRate)
+                    .arg(TextLatency.acceptedTokens).arg(TextLatency.draftTokens);
+    }
+
+    emit signalTextLatency(latency);
+}
+
+void AgentConsumer::responseProcessText(unsigned int sessionId, unsigned int agentId, const String& textReplied, NEMultiEdge::eTextResult textResult)
 {
     LOG_SCOPE(multiedge_edgedevice_AgentConsumer_responseProcessText);
     ASSERT(agentId == mConsumerId);
 
     if (agentId == mConsumerId)
     {
-        LOG_DBG("Received text reply, sessionId: %u, agentId: %u", sessionId, agentId);
+        LOG_DBG("Received text reply, sessionId: %u, agentId: %u, result: %s", sessionId, agentId, NEMultiEdge::getString(textResult));
         emit signalTextProcessed(sessionId, QString::fromStdString(textReplied.getData()), DateTime::getNow() );
+        if (textResult == NEMultiEdge::eTextResult::TextFailed)
+        {
+            emit signalAgentProcessingFailed(NEMultiEdge::eEdgeAgent::AgentLLM, NEService::eResultType::RequestError);
+        }
     }
     else
     {
@@ -211,6 +313,17 @@ void AgentConsumer::responseProcessVideo(unsigned int sessionId, unsigned int ag
     }
 }
 
+void AgentConsumer::responseStreamText(unsigned int sessionId, unsigned int agentId, unsigned int sequenceNr, const String& textFragment, bool isFinal)
+{
+    LOG_SCOPE(multiedge_edgedevice_AgentConsumer_responseStreamText);
+    LOG_DBG("Received text fragment, sessionId: %u, sequence: %u, final: %s", sessionId, sequenceNr, isFinal ? "true" : "false");
+    emit signalTextFragment(sessionId, sequenceNr, QString::fromStdString(textFragment.getData()), isFinal, DateTime::getNow());
+    if ((isFinal == false) && isConnected())
+    {
+        requestStreamText(sessionId, agentId);
+    }
+}
+
 void AgentConsumer::requestProcessTextFailed(NEService::eResultType FailureReason)
 {
     LOG_SCOPE(multiedge_edgedevice_AgentConsumer_requestProcessTextFailed);
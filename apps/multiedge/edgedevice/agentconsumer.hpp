@@ -28,6 +28,7 @@
 
 #include "areg/component/NERegistry.hpp"
 #include <QString>
+#include <QStringList>
 #include <string_view>
 
 class EdgeDevice;
@@ -44,10 +45,12 @@ class AgentConsumer : public QObject
 //////////////////////////////////////////////////////////////////////////
 public:
 
-    static bool processText(uint32_t id, const QString& text);
+    static bool processText(uint32_t id, const QString& text, const QString& modelName, const QString& adapterName);
 
     static bool processVideo(uint32_t id, const QString& cmdText, const SharedBuffer& video);
 
+    static bool cancelText(uint32_t id);
+
     static NERegistry::Model createModel(const QString& name, EdgeDevice * context);
     
     static AgentConsumer* getService(void);
@@ -64,13 +67,21 @@ signals:
     void signalServiceConnected(bool isConnected);
     
     void signalActiveModelChanged(QString modelName);
+
+    void signalAvailableModels(QStringList models);
+
+    void signalAvailableAdapters(QStringList adapters);
     
     void signalAgentQueueSize(uint32_t queueSize);
 
+    void signalTextLatency(QString latency);
+
     void signalAgentType(NEMultiEdge::eEdgeAgent EdgeAgent);
 
     void signalTextProcessed(uint32_t id, QString reply, uint64_t stamp);
 
+    void signalTextFragment(uint32_t id, uint32_t sequenceNr, QString fragment, bool isFinal, uint64_t stamp);
+
     void signalVideoProcessed(uint32_t id, SharedBuffer video);
 
     void signalAgentProcessingFailed(NEMultiEdge::eEdgeAgent agent, NEService::eResultType reason);
@@ -114,6 +125,28 @@ protected:
      **/
     virtual void onQueueSizeUpdate( unsigned int QueueSize, NEService::eDataStateType state ) override;
 
+    /**
+     * \brief   Triggered, when AvailableModels attribute is updated. The function contains
+     *          attribute value and validation flag. When notification is enabled,
+     *          the method should be overwritten in derived class.
+     *          Attributes AvailableModels description:
+     *          The names of the models the edge device can set to process the text.
+     * \param   AvailableModels The value of AvailableModels attribute.
+     * \param   state           The data validation flag.
+     **/
+    virtual void onAvailableModelsUpdate( const NEMultiEdge::ModelList & AvailableModels, NEService::eDataStateType state ) override;
+
+    /**
+     * \brief   Triggered, when AvailableAdapters attribute is updated. The function contains
+     *          attribute value and validation flag. When notification is enabled,
+     *          the method should be overwritten in derived class.
+     *          Attributes AvailableAdapters description:
+     *          The names of the LoRA adapters of the active model the edge device can set to process the text.
+     * \param   AvailableAdapters   The value of AvailableAdapters attribute.
+     * \param   state               The data validation flag.
+     **/
+    virtual void onAvailableAdaptersUpdate( const NEMultiEdge::ModelList & AvailableAdapters, NEService::eDataStateType state ) override;
+
     /**
      * \brief   Triggered, when EdgeAgent attribute is updated. The function contains
      *          attribute value and validation flag. When notification is enabled,
@@ -125,6 +158,17 @@ protected:
      **/
     virtual void onEdgeAgentUpdate( NEMultiEdge::eEdgeAgent EdgeAgent, NEService::eDataStateType state ) override;
 
+    /**
+     * \brief   Triggered, when TextLatency attribute is updated. The function contains
+     *          attribute value and validation flag. When notification is enabled,
+     *          the method should be overwritten in derived class.
+     *          Attributes TextLatency description:
+     *          The rolling latency statistics of processing the texts.
+     * \param   TextLatency The value of TextLatency attribute.
+     * \param   state       The data validation flag.
+     **/
+    virtual void onTextLatencyUpdate( const NEMultiEdge::sTextLatency & TextLatency, NEService::eDataStateType state ) override;
+
 /************************************************************************
  * Responses
  ************************************************************************/
@@ -136,9 +180,10 @@ protected:
      * \param   sessionId   A unique ID of the session set by the edge device, received from request.
      * \param   agentId     The ID of edge device received in request, it is sent back to the edge device to confirm target device that the request is processed.
      * \param   textReplied The text replied by the Edge AI.
+     * \param   textResult  The result of processing the text.
      * \see     requestProcessText
      **/
-    virtual void responseProcessText( unsigned int sessionId, unsigned int agentId, const String & textReplied );
+    virtual void responseProcessText( unsigned int sessionId, unsigned int agentId, const String & textReplied, NEMultiEdge::eTextResult textResult );
 
     /**
      * \brief   Response callback.
@@ -152,6 +197,19 @@ protected:
      **/
     virtual void responseProcessVideo(unsigned int sessionId, unsigned int agentId, const SharedBuffer& dataVideo);
 
+    /**
+     * \brief   Response callback.
+     *          Response sent from Edge AI only to the edge device, which requested to stream the text. It contains the partial text of the reply generated since the previous response. The complete reply is still sent by the ProcessText response.
+     *          The next fragment is requested, until the final marker is received.
+     * \param   sessionId       A unique ID of the session set by the edge device, received from request.
+     * \param   agentId         The ID of edge device received in request.
+     * \param   sequenceNr      The sequence number of the fragment within the session, starting from zero.
+     * \param   textFragment    The partial text of the reply to append. Empty in the final marker.
+     * \param   isFinal         Flag, indicating the final marker of the stream. No more fragments of the session follow it.
+     * \see     requestStreamText
+     **/
+    virtual void responseStreamText( unsigned int sessionId, unsigned int agentId, unsigned int sequenceNr, const String & textFragment, bool isFinal ) override;
+
     /**
      * \brief   Overwrite to handle error of ProcessText request call.
      * \param   FailureReason   The failure reason value of request call.
@@ -167,6 +225,7 @@ protected:
 private:
     static String   mConsumerName;  //!< The service name of the Agent Consumer
     uint32_t        mConsumerId;    //!< The unique ID of the consumer within the network.
+    uint32_t        mConversationId;//!< The ID of the conversation, which context is kept by the Edge AI.
     EdgeDevice*     mEdgeDevice;    //!< The pointer to the main dialog window.
 };
 
@@ -60,12 +60,38 @@ void EdgeDevice::slotActiveModelChanged(const QString modelName)
     }
 }
 
+void EdgeDevice::slotAvailableModels(QStringList models)
+{
+    // The first entry routes the questions to the active model of the Edge AI.
+    const QString selected{ ctrlModel()->currentIndex() > 0 ? ctrlModel()->currentText() : QString() };
+    ctrlModel()->clear();
+    ctrlModel()->addItem(tr("Active"));
+    ctrlModel()->addItems(models);
+    const int index{ selected.isEmpty() ? -1 : ctrlModel()->findText(selected) };
+    ctrlModel()->setCurrentIndex(index > 0 ? index : 0);
+}
+
+void EdgeDevice::slotAvailableAdapters(QStringList adapters)
+{
+    // The first entry processes the questions by the model without adapter.
+    const QString selected{ ctrlAdapter()->currentIndex() > 0 ? ctrlAdapter()->currentText() : QString() };
+    ctrlAdapter()->clear();
+    ctrlAdapter()->addItem(tr("None"));
+    ctrlAdapter()->addItems(adapters);
+    const int index{ selected.isEmpty() ? -1 : ctrlAdapter()->findText(selected) };
+    ctrlAdapter()->setCurrentIndex(index > 0 ? index : 0);
+}
 
 void EdgeDevice::slotAgentQueueSize(uint32_t queueSize)
 {
     ui->TxtQueueSize->setText(QString::number(queueSize));
 }
 
+void EdgeDevice::slotTextLatency(QString latency)
+{
+    ui->TxtQueueSize->setToolTip(latency);
+}
+
 void EdgeDevice::slotAgentType(NEMultiEdge::eEdgeAgent EdgeAgent)
 {
     const QString _agents[]
@@ -87,6 +113,14 @@ void EdgeDevice::slotTextProcessed(uint32_t id, QString reply, uint64_t stamp)
     }
 }
 
+void EdgeDevice::slotTextFragment(uint32_t id, uint32_t sequenceNr, QString fragment, bool isFinal, uint64_t stamp)
+{
+    if (mModel != nullptr)
+    {
+        mModel->addFragment(fragment, id, isFinal, stamp);
+    }
+}
+
 void EdgeDevice::slotVideoProcessed(uint32_t id, SharedBuffer video)
 {
 }
@@ -106,6 +140,7 @@ void EdgeDevice::slotServiceAvailable(bool isConnected)
 {
     ctrlQuestion()->setEnabled(false);
     ctrlSend()->setEnabled(isConnected);
+    ctrlCancel()->setEnabled(isConnected);
     if (isConnected)
     {
         ctrlTab()->setCurrentIndex(1);
@@ -158,6 +193,11 @@ inline QToolButton* EdgeDevice::ctrlSend(void) const
     return ui->BtnSend;
 }
 
+inline QToolButton* EdgeDevice::ctrlCancel(void) const
+{
+    return ui->BtnCancel;
+}
+
 inline QPushButton* EdgeDevice::ctrlClose(void) const
 {
     return ui->BtnClose;
@@ -173,6 +213,16 @@ inline QLineEdit* EdgeDevice::ctrlActiveModel(void) const
     return ui->TxtActiveModel;
 }
 
+inline QComboBox* EdgeDevice::ctrlModel(void) const
+{
+    return ui->CmbModel;
+}
+
+inline QComboBox* EdgeDevice::ctrlAdapter(void) const
+{
+    return ui->CmbAdapter;
+}
+
 inline QPlainTextEdit* EdgeDevice::ctrlDisplay(void) const
 {
     return ui->TxtDisplay;
@@ -220,6 +270,9 @@ void EdgeDevice::setupWidgets(void)
 
     ctrlQuestion()->setEnabled(false);
     ctrlSend()->setEnabled(false);
+    ctrlCancel()->setEnabled(false);
+    ctrlModel()->addItem(tr("Active"));
+    ctrlAdapter()->addItem(tr("None"));
     ctrlTab()->setCurrentIndex(0);
     
     Qt::WindowFlags flags = windowFlags();
@@ -233,6 +286,7 @@ void EdgeDevice::setupSignals(void)
     connect(ctrlClose()  , &QPushButton::clicked, this, [this](bool checked) {routerDisconnect(); close(); });
     connect(ctrlConnect(), &QPushButton::clicked, this, &EdgeDevice::onConnectClicked);
     connect(ctrlSend()   , &QPushButton::clicked, this, &EdgeDevice::onSendQuestion);
+    connect(ctrlCancel() , &QPushButton::clicked, this, &EdgeDevice::onCancelQuestions);
     connect(ctrlTable()  , &QTableView::activated    , this, &EdgeDevice::onTableSelChanged);
     connect(ctrlTable()  , &QTableView::doubleClicked, this, &EdgeDevice::onTableSelChanged);
 }
@@ -305,7 +359,9 @@ void EdgeDevice::onSendQuestion(bool checked)
     if ((question.isEmpty() == false) && (mModel != nullptr))
     {
         uint32_t id = mModel->addRequest(question);
-        if (AgentConsumer::processText(id, question) == false)
+        const QString modelName{ ctrlModel()->currentIndex() > 0 ? ctrlModel()->currentText() : QString() };
+        const QString adapterName{ ctrlAdapter()->currentIndex() > 0 ? ctrlAdapter()->currentText() : QString() };
+        if (AgentConsumer::processText(id, question, modelName, adapterName) == false)
         {
             mModel->addFailure("Failed to send response to process question");
         }
@@ -315,6 +371,18 @@ void EdgeDevice::onSendQuestion(bool checked)
     ctrlQuestion()->setFocus();
 }
 
+void EdgeDevice::onCancelQuestions(bool checked)
+{
+    if (mModel != nullptr)
+    {
+        const std::vector<uint32_t> pending = mModel->cancelPending();
+        for (uint32_t id : pending)
+        {
+            AgentConsumer::cancelText(id);
+        }
+    }
+}
+
 void EdgeDevice::onTableSelChanged(const QModelIndex &index)
 {
     if (index.isValid() == false)
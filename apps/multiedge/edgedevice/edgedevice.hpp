@@ -30,6 +30,7 @@ class EdgeDevice;
 QT_END_NAMESPACE
 
 class AgentChatHistory;
+class QComboBox;
 class QPushButton;
 class QPlainTextEdit;
 class QLineEdit;
@@ -53,13 +54,21 @@ public slots:
     void slotServiceAvailable(bool isConnected);
     
     void slotActiveModelChanged(const QString modelName);
+
+    void slotAvailableModels(QStringList models);
+
+    void slotAvailableAdapters(QStringList adapters);
     
     void slotAgentQueueSize(uint32_t queueSize);
+
+    void slotTextLatency(QString latency);
     
     void slotAgentType(NEMultiEdge::eEdgeAgent EdgeAgent);
     
     void slotTextProcessed(uint32_t id, QString reply, uint64_t stamp);
     
+    void slotTextFragment(uint32_t id, uint32_t sequenceNr, QString fragment, bool isFinal, uint64_t stamp);
+    
     void slotVideoProcessed(uint32_t id, SharedBuffer video);
     
     void slotAgentProcessingFailed(NEMultiEdge::eEdgeAgent agent, NEService::eResultType reason);
@@ -75,9 +84,12 @@ private:
     inline QTableView* ctrlTable(void) const;
     inline QPlainTextEdit* ctrlQuestion(void) const;
     inline QToolButton* ctrlSend(void) const;
+    inline QToolButton* ctrlCancel(void) const;
     inline QPushButton* ctrlClose(void) const;
     inline QTabWidget* ctrlTab(void) const;
     inline QLineEdit* ctrlActiveModel(void) const;
+    inline QComboBox* ctrlModel(void) const;
+    inline QComboBox* ctrlAdapter(void) const;
     inline QPlainTextEdit* ctrlDisplay(void) const;
     
 private slots:
@@ -86,6 +98,8 @@ private slots:
     
     void onSendQuestion(bool checked);
     
+    void onCancelQuestions(bool checked);
+    
     void onTableSelChanged(const QModelIndex &index);
     
 private:
@@ -0,0 +1,190 @@
+﻿/************************************************************************
+ * This file is part of the Areg Edge AI project powered by AREG SDK.
+ * The project contains multiple examples of using Edge AI based on Areg communication framework.
+ *
+ *  Areg Edge AI is available as free and open-source software under the MIT License.
+ *
+ *  For detailed licensing terms, please refer to the LICENSE file included
+ *  with this distribution or contact us at info[at]areg.tech.
+ *
+ *  \copyright   © 2025 Aregtech UG. All rights reserved.
+ *  \file        multiedge/edgeload/loadclient.cpp
+ *  \ingroup     Areg Edge AI, Edge Device Load Generator
+ *  \author      Artak Avetyan
+ *  \brief       The simulated edge device of the load generator.
+ *
+ ************************************************************************/
+
+/************************************************************************
+ * Includes
+ ************************************************************************/
+
+#include "multiedge/edgeload/loadclient.hpp"
+#include "multiedge/resources/NEMultiEdgeSettings.hpp"
+#include "areg/base/NEMath.hpp"
+#include "areg/component/ComponentThread.hpp"
+#include "areg/logging/GELog.h"
+
+#include <algorithm>
+#include <string>
+
+DEF_LOG_SCOPE(multiedge_edgeload_LoadClient_serviceConnected);
+DEF_LOG_SCOPE(multiedge_edgeload_LoadClient_responseProcessText);
+DEF_LOG_SCOPE(multiedge_edgeload_LoadClient_requestProcessTextFailed);
+
+namespace
+{
+    //!< The number of milliseconds in second.
+    constexpr uint32_t  MILLIS_IN_SEC   { 1000u };
+    //!< The timeout to check the concurrency when the requests are sent as soon as possible.
+    constexpr uint32_t  IDLE_TIMEOUT    { 1u };
+}
+
+NERegistry::Model LoadClient::createModel(const String& name, LoadStatistics& stats)
+{
+    const LoadStatistics::sOptions& options = stats.getOptions();
+    NERegistry::Model model(LoadClient::MODEL_NAME);
+    const uint32_t threads = std::clamp(options.threads, 1u, std::max(options.clients, 1u));
+    for (uint32_t i = 0; i < threads; ++ i)
+    {
+        const String threadName(std::string(LoadClient::THREAD_NAME) + std::to_string(i));
+        NERegistry::ComponentThreadEntry& thread = model.addThread(threadName);
+        // The devices are distributed round-robin between threads.
+        for (uint32_t j = i; j < options.clients; j += threads)
+        {
+            const String roleName(name.getData() + "_" + std::to_string(j));
+            NERegistry::ComponentEntry& component = thread.addComponent<LoadClient>(roleName);
+            component.addDependencyService(NEMultiEdgeSettings::SERVICE_PROVIDER);
+            component.setComponentData(std::make_any<LoadStatistics *>(&stats));
+        }
+    }
+
+    return model;
+}
+
+LoadClient::LoadClient(const NERegistry::ComponentEntry& entry, ComponentThread& owner)
+    : Component          (entry, owner)
+    , MultiEdgeClientBase(entry.mDependencyServices[0].mRoleName, owner)
+    , IETimerConsumer    ( )
+    , mStats             (*std::any_cast<LoadStatistics *>(entry.getComponentData()))
+    , mTimer             (self(), entry.mRoleName)
+    , mPending           ( )
+    , mConsumerId        (static_cast<uint32_t>(NEMath::CHECKSUM_IGNORE))
+    , mSent              (0u)
+    , mCompleted         (false)
+{
+}
+
+bool LoadClient::serviceConnected(NEService::eServiceConnection status, ProxyBase& proxy)
+{
+    LOG_SCOPE(multiedge_edgeload_LoadClient_serviceConnected);
+
+    bool result = MultiEdgeClientBase::serviceConnected(status, proxy);
+    if (result)
+    {
+        bool isConnected(status == NEService::eServiceConnection::ServiceConnected);
+        LOG_DBG("Simulated edge device [ %s ] connection status: %s", getRoleName().getString(), NEService::getString(status));
+        mStats.clientConnected(isConnected);
+        if (isConnected)
+        {
+            mConsumerId = NEMath::crc32Calculate(getRoleName().getString());
+            const uint32_t rate = mStats.getOptions().rate;
+            mTimer.startTimer(rate != 0u ? std::max(MILLIS_IN_SEC / rate, 1u) : IDLE_TIMEOUT, Timer::CONTINUOUSLY);
+            sendNext();
+        }
+        else
+        {
+            mTimer.stopTimer();
+            // The replies of the requests in progress are lost.
+            for (size_t i = 0; i < mPending.size(); ++ i)
+            {
+                mStats.requestFailed();
+            }
+
+            mPending.clear();
+            mSent = mStats.getOptions().requests;
+            checkCompleted();
+        }
+    }
+
+    return result;
+}
+
+void LoadClient::responseProcessText(unsigned int sessionId, unsigned int agentId, const String& /*textReplied*/, NEMultiEdge::eTextResult textResult)
+{
+    LOG_SCOPE(multiedge_edgeload_LoadClient_responseProcessText);
+
+    ListPending::iterator pos = mPending.find(sessionId);
+    if ((agentId == mConsumerId) && (pos != mPending.end()))
+    {
+        if (textResult == NEMultiEdge::eTextResult::TextFailed)
+        {
+            mStats.requestFailed();
+        }
+        else
+        {
+            mStats.requestReplied(pos->second);
+        }
+
+        mPending.erase(pos);
+        // Without the rate limit the next request is sent as soon as the reply is received.
+        if (mStats.getOptions().rate == 0u)
+        {
+            sendNext();
+        }
+
+        checkCompleted();
+    }
+    else
+    {
+        LOG_WARN("Ignoring unexpected reply, sessionId: %u, agentId: %u", sessionId, agentId);
+    }
+}
+
+void LoadClient::requestProcessTextFailed(NEService::eResultType FailureReason)
+{
+    LOG_SCOPE(multiedge_edgeload_LoadClient_requestProcessTextFailed);
+    LOG_ERR("Simulated edge device [ %s ] failed to process text, reason: %s", getRoleName().getString(), NEService::getString(FailureReason));
+
+    // The failure has no session ID, the oldest request in progress is considered as failed.
+    mStats.requestFailed();
+    if (mPending.empty() == false)
+    {
+        mPending.erase(mPending.begin());
+    }
+
+    checkCompleted();
+}
+
+void LoadClient::processTimer(Timer& /*timer*/)
+{
+    sendNext();
+}
+
+void LoadClient::sendNext(void)
+{
+    const LoadStatistics::sOptions& options = mStats.getOptions();
+    while (isConnected() && (mSent < options.requests) && (mPending.size() < options.concurrency))
+    {
+        const uint32_t sessionId = ++ mSent;
+        const String& prompt = options.prompts[sessionId % options.prompts.size()];
+        mPending[sessionId] = LoadStatistics::Clock::now();
+        mStats.requestSent();
+        // Every request is a single turn, the provider does not keep the context.
+        requestProcessText(sessionId, mConsumerId, 0u, NEMultiEdge::eTextPriority::PriorityNormal, options.modelName, options.adapterName, prompt);
+
+        // The rate limited devices send one request per timeout.
+        if (options.rate != 0u)
+            break;
+    }
+}
+
+void LoadClient::checkCompleted(void)
+{
+    if ((mCompleted == false) && (mSent >= mStats.getOptions().requests) && mPending.empty())
+    {
+        mCompleted = true;
+        mTimer.stopTimer();
+        mStats.clientCompleted();
+    }
+}
@@ -0,0 +1,169 @@
+﻿#ifndef MULTIEDGE_EDGELOAD_LOADCLIENT_HPP
+#define MULTIEDGE_EDGELOAD_LOADCLIENT_HPP
+/************************************************************************
+ * This file is part of the Areg Edge AI project powered by AREG SDK.
+ * The project contains multiple examples of using Edge AI based on Areg communication framework.
+ *
+ *  Areg Edge AI is available as free and open-source software under the MIT License.
+ *
+ *  For detailed licensing terms, please refer to the LICENSE file included
+ *  with this distribution or contact us at info[at]areg.tech.
+ *
+ *  \copyright   © 2025 Aregtech UG. All rights reserved.
+ *  \file        multiedge/edgeload/loadclient.hpp
+ *  \ingroup     Areg Edge AI, Edge Device Load Generator
+ *  \author      Artak Avetyan
+ *  \brief       The simulated edge device of the load generator.
+ *
+ ************************************************************************/
+
+/************************************************************************
+ * Includes
+ ************************************************************************/
+
+#include "areg/base/GEGlobal.h"
+#include "areg/component/Component.hpp"
+#include "areg/component/IETimerConsumer.hpp"
+#include "areg/component/NERegistry.hpp"
+#include "areg/component/Timer.hpp"
+#include "multiedge/resources/MultiEdgeClientBase.hpp"
+#include "multiedge/edgeload/loadstatistics.hpp"
+
+#include <map>
+
+//////////////////////////////////////////////////////////////////////////
+// LoadClient class declaration
+//////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief   The simulated edge device. Each device is a separate component
+ *          with the unique role name and the own proxy of the Edge AI
+ *          service, so that the provider sees as many edge devices as
+ *          configured. When the service is connected, the device sends the
+ *          text requests paced by the timer, keeps the configured number of
+ *          requests in progress and measures the time from sending the
+ *          request until receiving the response.
+ **/
+class LoadClient    : public Component
+                    , public MultiEdgeClientBase
+                    , private IETimerConsumer
+{
+//////////////////////////////////////////////////////////////////////////
+// Internal types and constants
+//////////////////////////////////////////////////////////////////////////
+public:
+    //!< The name of the model of simulated edge devices.
+    static constexpr std::string_view   MODEL_NAME  { "EdgeLoad" };
+
+    //!< The prefix of the names of threads to run the simulated edge devices.
+    static constexpr std::string_view   THREAD_NAME { "EdgeLoadThread" };
+
+private:
+    //!< The requests in progress, where the key is the session ID and the value is the time the request was sent.
+    using ListPending   = std::map<uint32_t, LoadStatistics::Clock::time_point>;
+
+//////////////////////////////////////////////////////////////////////////
+// Static methods
+//////////////////////////////////////////////////////////////////////////
+public:
+
+    /**
+     * \brief   Creates the model of the simulated edge devices. The devices are
+     *          evenly distributed between the configured number of threads.
+     * \param   name    The unique prefix of the role names of simulated edge devices.
+     * \param   stats   The options of the load generator and the statistics to collect.
+     **/
+    static NERegistry::Model createModel(const String& name, LoadStatistics& stats);
+
+//////////////////////////////////////////////////////////////////////////
+// Constructor / Destructor
+//////////////////////////////////////////////////////////////////////////
+public:
+    LoadClient(const NERegistry::ComponentEntry& entry, ComponentThread& owner);
+    virtual ~LoadClient(void) = default;
+
+//////////////////////////////////////////////////////////////////////////
+// Overrides
+//////////////////////////////////////////////////////////////////////////
+protected:
+    /**
+     * \brief   Triggered when receives service provider connected / disconnected event.
+     *          On connection starts sending requests, on disconnection the requests
+     *          in progress are counted as failed and the device completes.
+     * \param   status  The service connection status.
+     * \param   proxy   The Service Interface Proxy object, which is notifying service connection.
+     * \return  Return true if this service connect notification was relevant to client object.
+     **/
+    virtual bool serviceConnected( NEService::eServiceConnection status, ProxyBase & proxy ) override;
+
+    /**
+     * \brief   Response callback.
+     *          Response sent from Edge AI to the edge device as a result of request to process a text.
+     * \param   sessionId   A unique ID of the session set by the edge device, received from request.
+     * \param   agentId     The ID of edge device received in request.
+     * \param   textReplied The text replied by the Edge AI.
+     * \param   textResult  The result of processing the text. The failed texts are counted as failed requests.
+     * \see     requestProcessText
+     **/
+    virtual void responseProcessText( unsigned int sessionId, unsigned int agentId, const String & textReplied, NEMultiEdge::eTextResult textResult ) override;
+
+    /**
+     * \brief   Overwrite to handle error of ProcessText request call.
+     * \param   FailureReason   The failure reason value of request call.
+     **/
+    virtual void requestProcessTextFailed( NEService::eResultType FailureReason ) override;
+
+//////////////////////////////////////////////////////////////////////////
+// IETimerConsumer overrides
+//////////////////////////////////////////////////////////////////////////
+private:
+
+    /**
+     * \brief   Triggered when the pacing timer is expired. Sends the next request if allowed.
+     * \param   timer   The timer object that is expired.
+     **/
+    virtual void processTimer( Timer & timer ) override;
+
+//////////////////////////////////////////////////////////////////////////
+// Hidden methods
+//////////////////////////////////////////////////////////////////////////
+private:
+
+    //!< Sends the next request if not all requests are sent and the number of requests in progress is below the concurrency.
+    void sendNext(void);
+
+    //!< Completes the device if all requests are sent and replied.
+    void checkCompleted(void);
+
+    //!< Returns the object as timer consumer.
+    inline IETimerConsumer& self(void);
+
+//////////////////////////////////////////////////////////////////////////
+// Member variables
+//////////////////////////////////////////////////////////////////////////
+private:
+    LoadStatistics& mStats;     //!< The options of the load generator and the collected statistics.
+    Timer           mTimer;     //!< The timer to pace the requests.
+    ListPending     mPending;   //!< The requests in progress.
+    uint32_t        mConsumerId;//!< The unique ID of the simulated edge device within the network.
+    uint32_t        mSent;      //!< The number of sent requests.
+    bool            mCompleted; //!< Flag, indicating that the device has completed.
+
+//////////////////////////////////////////////////////////////////////////
+// Forbidden calls
+//////////////////////////////////////////////////////////////////////////
+private:
+    LoadClient(void) = delete;
+    DECLARE_NOCOPY_NOMOVE(LoadClient);
+};
+
+//////////////////////////////////////////////////////////////////////////
+// Inline methods
+//////////////////////////////////////////////////////////////////////////
+
+inline IETimerConsumer& LoadClient::self(void)
+{
+    return static_cast<IETimerConsumer&>(*this);
+}
+
+#endif // MULTIEDGE_EDGELOAD_LOADCLIENT_HPP
@@ -0,0 +1,141 @@
+﻿/************************************************************************
+ * This file is part of the Areg Edge AI project powered by AREG SDK.
+ * The project contains multiple examples of using Edge AI based on Areg communication framework.
+ *
+ *  Areg Edge AI is available as free and open-source software under the MIT License.
+ *
+ *  For detailed licensing terms, please refer to the LICENSE file included
+ *  with this distribution or contact us at info[at]areg.tech.
+ *
+ *  \copyright   © 2025 Aregtech UG. All rights reserved.
+ *  \file        multiedge/edgeload/loadstatistics.cpp
+ *  \ingroup     Areg Edge AI, Edge Device Load Generator
+ *  \author      Artak Avetyan
+ *  \brief       Edge device load generator options and statistics.
+ *
+ ************************************************************************/
+#include "multiedge/edgeload/loadstatistics.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <numeric>
+
+LoadStatistics::LoadStatistics(const LoadStatistics::sOptions& options)
+    : mOptions  (options)
+    , mLock     ( )
+    , mLatency  ( )
+    , mStart    ( )
+    , mEnd      ( )
+    , mSent     (0u)
+    , mFailed   (0u)
+    , mCompleted(0u)
+    , mConnected(0u)
+{
+    mLatency.reserve(static_cast<size_t>(options.clients) * options.requests);
+}
+
+void LoadStatistics::requestSent(void)
+{
+    std::lock_guard<std::mutex> lock(mLock);
+    if (mSent ++ == 0u)
+    {
+        mStart = Clock::now();
+    }
+}
+
+void LoadStatistics::requestReplied(const Clock::time_point& sent)
+{
+    const Clock::time_point now{ Clock::now() };
+    std::lock_guard<std::mutex> lock(mLock);
+    mLatency.push_back(std::chrono::duration<double, std::milli>(now - sent).count());
+    mEnd = now;
+}
+
+void LoadStatistics::requestFailed(void)
+{
+    std::lock_guard<std::mutex> lock(mLock);
+    ++ mFailed;
+}
+
+void LoadStatistics::clientCompleted(void)
+{
+    ++ mCompleted;
+}
+
+void LoadStatistics::clientConnected(bool isConnected)
+{
+    if (isConnected)
+    {
+        ++ mConnected;
+    }
+    else
+    {
+        -- mConnected;
+    }
+}
+
+bool LoadStatistics::writeReport(bool isTimeout) const
+{
+    std::vector<double> latency;
+    uint64_t sent{ 0u };
+    uint64_t failed{ 0u };
+    double wallTime{ 0.0 };
+    do
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+        latency = mLatency;
+        sent    = mSent;
+        failed  = mFailed;
+        wallTime= (latency.empty() ? 0.0 : std::chrono::duration<double, std::milli>(mEnd - mStart).count());
+    } while (false);
+
+    FILE* out = mOptions.outputFile.isEmpty() ? stdout : std::fopen(mOptions.outputFile.getString(), "w");
+    if (out == nullptr)
+    {
+        std::fprintf(stderr, "Failed to open the output file [ %s ]\n", mOptions.outputFile.getString());
+        return false;
+    }
+
+    const sPercentiles stats{ _percentiles(latency) };
+    std::fprintf(out, "{\n");
+    std::fprintf(out, "  \"clients\": %u,\n", mOptions.clients);
+    std::fprintf(out, "  \"threads\": %u,\n", mOptions.threads);
+    std::fprintf(out, "  \"requests_per_client\": %u,\n", mOptions.requests);
+    std::fprintf(out, "  \"concurrency\": %u,\n", mOptions.concurrency);
+    std::fprintf(out, "  \"rate\": %u,\n", mOptions.rate);
+    std::fprintf(out, "  \"model\": \"%s\",\n", mOptions.modelName.getString());
+    std::fprintf(out, "  \"adapter\": \"%s\",\n", mOptions.adapterName.getString());
+    std::fprintf(out, "  \"timeout\": %s,\n", isTimeout ? "true" : "false");
+    std::fprintf(out, "  \"sent\": %llu,\n", static_cast<unsigned long long>(sent));
+    std::fprintf(out, "  \"replied\": %llu,\n", static_cast<unsigned long long>(latency.size()));
+    std::fprintf(out, "  \"failed\": %llu,\n", static_cast<unsigned long long>(failed));
+    std::fprintf(out, "  \"wall_ms\": %.3f,\n", wallTime);
+    std::fprintf(out, "  \"throughput_rps\": %.3f,\n", wallTime > 0.0 ? static_cast<double>(latency.size()) * 1000.0 / wallTime : 0.0);
+    std::fprintf(out, "  \"latency_ms\": { \"mean\": %.3f, \"p50\": %.3f, \"p95\": %.3f, \"p99\": %.3f, \"max\": %.3f }\n"
+                    , stats.mean, stats.p50, stats.p95, stats.p99, stats.max);
+    std::fprintf(out, "}\n");
+
+    const bool ok = (std::ferror(out) == 0);
+    if (out != stdout)
+    {
+        std::fclose(out);
+    }
+
+    return ok;
+}
+
+LoadStatistics::sPercentiles LoadStatistics::_percentiles(std::vector<double> values)
+{
+    sPercentiles result;
+    if (values.empty())
+        return result;
+
+    std::sort(values.begin(), values.end());
+    const size_t last = values.size() - 1u;
+    result.mean = std::accumulate(values.begin(), values.end(), 0.0) / static_cast<double>(values.size());
+    result.p50  = values[(last * 50u) / 100u];
+    result.p95  = values[(last * 95u) / 100u];
+    result.p99  = values[(last * 99u) / 100u];
+    result.max  = values[last];
+    return result;
+}
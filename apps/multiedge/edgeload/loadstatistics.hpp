@@ -0,0 +1,186 @@
+﻿#ifndef MULTIEDGE_EDGELOAD_LOADSTATISTICS_HPP
+#define MULTIEDGE_EDGELOAD_LOADSTATISTICS_HPP
+/************************************************************************
+ * This file is part of the Areg Edge AI project powered by AREG SDK.
+ * The project contains multiple examples of using Edge AI based on Areg communication framework.
+ *
+ *  Areg Edge AI is available as free and open-source software under the MIT License.
+ *
+ *  For detailed licensing terms, please refer to the LICENSE file included
+ *  with this distribution or contact us at info[at]areg.tech.
+ *
+ *  \copyright   © 2025 Aregtech UG. All rights reserved.
+ *  \file        multiedge/edgeload/loadstatistics.hpp
+ *  \ingroup     Areg Edge AI, Edge Device Load Generator
+ *  \author      Artak Avetyan
+ *  \brief       Edge device load generator options and statistics.
+ *
+ ************************************************************************/
+
+/************************************************************************
+ * Includes
+ ************************************************************************/
+
+#include "areg/base/GEGlobal.h"
+#include "areg/base/String.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////
+// LoadStatistics class declaration
+//////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief   The options of the load generator and the statistics collected
+ *          by all simulated edge devices. The simulated devices run in
+ *          different threads, the statistics are thread safe.
+ **/
+class LoadStatistics
+{
+//////////////////////////////////////////////////////////////////////////
+// Internal types and constants
+//////////////////////////////////////////////////////////////////////////
+public:
+    using Clock = std::chrono::steady_clock;
+
+    //!< The options of the load generator.
+    struct sOptions
+    {
+        String                  address     { };        //!< The IP address of the router.
+        uint16_t                port        { 0u };     //!< The port of the router.
+        String                  outputFile  { };        //!< The path to the JSON file of results. Empty to print on the console.
+        std::vector<String>     prompts     { };        //!< The prompts to send, used round-robin.
+        String                  modelName   { };        //!< The name of the model to process the prompts. Empty for the active model.
+        String                  adapterName { };        //!< The name of the LoRA adapter to process the prompts. Empty for none.
+        uint32_t                clients     { 0u };     //!< The number of simulated edge devices.
+        uint32_t                threads     { 0u };     //!< The number of threads to run the simulated devices.
+        uint32_t                requests    { 0u };     //!< The number of requests to send per device.
+        uint32_t                concurrency { 0u };     //!< The maximum number of requests in progress per device.
+        uint32_t                rate        { 0u };     //!< The requests per second per device. Zero to send as soon as a reply is received.
+        uint32_t                timeout     { 0u };     //!< The maximum duration of the run in seconds.
+    };
+
+    //!< The mean, the percentiles and the maximum of latency in milliseconds.
+    struct sPercentiles
+    {
+        double  mean    { 0.0 };
+        double  p50     { 0.0 };
+        double  p95     { 0.0 };
+        double  p99     { 0.0 };
+        double  max     { 0.0 };
+    };
+
+//////////////////////////////////////////////////////////////////////////
+// Constructor / Destructor
+//////////////////////////////////////////////////////////////////////////
+public:
+    explicit LoadStatistics(const LoadStatistics::sOptions& options);
+    ~LoadStatistics(void) = default;
+
+//////////////////////////////////////////////////////////////////////////
+// Attributes and operations
+//////////////////////////////////////////////////////////////////////////
+public:
+
+    /**
+     * \brief   Returns the options of the load generator.
+     **/
+    inline const LoadStatistics::sOptions& getOptions(void) const;
+
+    /**
+     * \brief   Notifies that the request is sent. The first sent request starts the measuring.
+     **/
+    void requestSent(void);
+
+    /**
+     * \brief   Saves the latency of the replied request.
+     * \param   sent    The time the request was sent.
+     **/
+    void requestReplied(const Clock::time_point& sent);
+
+    /**
+     * \brief   Counts the failed request.
+     **/
+    void requestFailed(void);
+
+    /**
+     * \brief   Notifies that the simulated device has sent all requests and received all replies.
+     **/
+    void clientCompleted(void);
+
+    /**
+     * \brief   Returns true if all simulated devices are completed.
+     **/
+    inline bool isCompleted(void) const;
+
+    /**
+     * \brief   Returns the number of simulated devices connected to the service provider.
+     **/
+    inline uint32_t getConnected(void) const;
+
+    /**
+     * \brief   Changes the number of connected devices.
+     * \param   isConnected     Flag, indicating whether the device is connected or disconnected.
+     **/
+    void clientConnected(bool isConnected);
+
+    /**
+     * \brief   Writes the report as JSON to the output file or to the console.
+     * \param   isTimeout   Flag, indicating that the run is stopped by timeout.
+     * \return  Returns true if the report is written.
+     **/
+    bool writeReport(bool isTimeout) const;
+
+//////////////////////////////////////////////////////////////////////////
+// Hidden methods
+//////////////////////////////////////////////////////////////////////////
+private:
+
+    //!< Computes the mean, percentiles and maximum of the values.
+    static LoadStatistics::sPercentiles _percentiles(std::vector<double> values);
+
+//////////////////////////////////////////////////////////////////////////
+// Member variables
+//////////////////////////////////////////////////////////////////////////
+private:
+    const sOptions          mOptions;   //!< The options of the load generator.
+    mutable std::mutex      mLock;      //!< The lock of the statistics.
+    std::vector<double>     mLatency;   //!< The latency of replied requests in milliseconds.
+    Clock::time_point       mStart;     //!< The time of the first sent request.
+    Clock::time_point       mEnd;       //!< The time of the last reply.
+    uint64_t                mSent;      //!< The number of sent requests.
+    uint64_t                mFailed;    //!< The number of failed requests.
+    std::atomic_uint32_t    mCompleted; //!< The number of completed devices.
+    std::atomic_uint32_t    mConnected; //!< The number of connected devices.
+
+//////////////////////////////////////////////////////////////////////////
+// Forbidden calls
+//////////////////////////////////////////////////////////////////////////
+private:
+    LoadStatistics(void) = delete;
+    DECLARE_NOCOPY_NOMOVE(LoadStatistics);
+};
+
+//////////////////////////////////////////////////////////////////////////
+// Inline methods
+//////////////////////////////////////////////////////////////////////////
+
+inline const LoadStatistics::sOptions& LoadStatistics::getOptions(void) const
+{
+    return mOptions;
+}
+
+inline bool LoadStatistics::isCompleted(void) const
+{
+    return (mCompleted.load() >= mOptions.clients);
+}
+
+inline uint32_t LoadStatistics::getConnected(void) const
+{
+    return mConnected.load();
+}
+
+#endif // MULTIEDGE_EDGELOAD_LOADSTATISTICS_HPP
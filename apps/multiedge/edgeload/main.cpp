@@ -0,0 +1,227 @@
+﻿/************************************************************************
+ * This file is part of the Areg Edge AI project powered by AREG SDK.
+ * The project contains multiple examples of using Edge AI based on Areg communication framework.
+ *
+ *  Areg Edge AI is available as free and open-source software under the MIT License.
+ *
+ *  For detailed licensing terms, please refer to the LICENSE file included
+ *  with this distribution or contact us at info[at]areg.tech.
+ *
+ *  \copyright   © 2025 Aregtech UG. All rights reserved.
+ *  \file        multiedge/edgeload/main.cpp
+ *  \ingroup     Areg Edge AI, Edge Device Load Generator
+ *  \author      Artak Avetyan
+ *  \brief       The headless load generator simulating many edge devices.
+ *
+ ************************************************************************/
+
+/************************************************************************
+ * Includes
+ ************************************************************************/
+#include "multiedge/edgeload/loadclient.hpp"
+#include "multiedge/edgeload/loadstatistics.hpp"
+#include "multiedge/edgeload/mockprovider.hpp"
+#include "multiedge/resources/NECommandLine.hpp"
+#include "multiedge/resources/NEMultiEdgeSettings.hpp"
+#include "areg/appbase/Application.hpp"
+#include "areg/base/NEUtilities.hpp"
+#include "areg/component/ComponentLoader.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <thread>
+
+//////////////////////////////////////////////////////////////////////////
+// The model of the mock Edge AI service provider.
+//////////////////////////////////////////////////////////////////////////
+BEGIN_MODEL(NEMultiEdgeSettings::MODEL_PROVIDER.data())
+    BEGIN_REGISTER_THREAD(NEMultiEdgeSettings::AGENT_THREAD.data())
+        BEGIN_REGISTER_COMPONENT(NEMultiEdgeSettings::SERVICE_PROVIDER.data(), MockProvider)
+            REGISTER_IMPLEMENT_SERVICE(NEMultiEdge::ServiceName, NEMultiEdge::InterfaceVersion)
+        END_REGISTER_COMPONENT(NEMultiEdgeSettings::SERVICE_PROVIDER.data())
+    END_REGISTER_THREAD(NEMultiEdgeSettings::AGENT_THREAD.data())
+END_MODEL(NEMultiEdgeSettings::MODEL_PROVIDER.data())
+
+namespace
+{
+    //!< The default number of simulated edge devices.
+    constexpr uint32_t  DEF_CLIENTS     { 16u };
+    //!< The default number of threads to run the simulated edge devices.
+    constexpr uint32_t  DEF_THREADS     { 4u };
+    //!< The default number of requests per simulated edge device.
+    constexpr uint32_t  DEF_REQUESTS    { 100u };
+    //!< The default maximum duration of the run in seconds.
+    constexpr uint32_t  DEF_TIMEOUT     { 300u };
+    //!< The default prompt, if no prompt corpus is set.
+    constexpr std::string_view  DEF_PROMPT  { "Explain in one sentence what an edge device is." };
+    //!< The interval to check the completion of the run.
+    constexpr std::chrono::milliseconds CHECK_INTERVAL  { 100 };
+
+    //!< Prints the usage of the application.
+    void _printUsage(const char* app)
+    {
+        std::fprintf(stderr
+                    , "Usage: %s [options]\n"
+                      "Options:\n"
+                      "  --mode=<client|mock>   Simulate edge devices or run the mock Edge AI provider, default client.\n"
+                      "  --address=<ip>         The IP address of the router, default %s.\n"
+                      "  --port=<n>             The port of the router, default %u.\n"
+                      "  --clients=<n>          The number of simulated edge devices, default %u.\n"
+                      "  --threads=<n>          The number of threads to run the edge devices, default %u.\n"
+                      "  --requests=<n>         The number of requests per edge device, default %u.\n"
+                      "  --concurrency=<n>      The requests in progress per edge device, default 1.\n"
+                      "  --rate=<n>             The requests per second per edge device, default 0 to send on reply.\n"
+                      "  --prompts=<file.txt>   The prompt corpus, one prompt per line.\n"
+                      "  --model=<name>         The name of the model to process the prompts, default the active model.\n"
+                      "  --adapter=<name>       The name of the LoRA adapter to process the prompts, default none.\n"
+                      "  --output=<file.json>   Write the results to the file instead of the console.\n"
+                      "  --timeout=<sec>        The maximum duration of the run, default %u.\n"
+                    , app
+                    , NEMultiEdgeSettings::ROUTER_ADDRESS.data()
+                    , static_cast<uint32_t>(NEMultiEdgeSettings::ROUTER_PORT)
+                    , DEF_CLIENTS
+                    , DEF_THREADS
+                    , DEF_REQUESTS
+                    , DEF_TIMEOUT);
+    }
+
+    //!< Reads the prompts of the corpus. Empty lines and lines starting with '#' are skipped.
+    bool _loadPrompts(const char* fileName, std::vector<String>& prompts)
+    {
+        std::ifstream file(fileName);
+        std::string line;
+        while (std::getline(file, line))
+        {
+            String prompt(line);
+            prompt.trimAll();
+            if ((prompt.isEmpty() == false) && (prompt.getString()[0] != '#'))
+            {
+                prompts.push_back(prompt);
+            }
+        }
+
+        return (prompts.empty() == false);
+    }
+
+    //!< Runs the mock Edge AI service provider until the Enter key is pressed.
+    bool _runMock(const LoadStatistics::sOptions& options)
+    {
+        if (Application::startMessageRouting(options.address.getString(), options.port) == false)
+        {
+            std::fprintf(stderr, "Failed to connect to the router [ %s:%u ]\n", options.address.getString(), static_cast<uint32_t>(options.port));
+            return false;
+        }
+
+        bool result = Application::loadModel(NEMultiEdgeSettings::MODEL_PROVIDER.data());
+        if (result)
+        {
+            std::fprintf(stderr, "The mock Edge AI provider is running, press Enter to quit...\n");
+            std::getchar();
+            Application::unloadModel(NEMultiEdgeSettings::MODEL_PROVIDER.data());
+        }
+
+        Application::stopMessageRouting();
+        return result;
+    }
+
+    //!< Runs the simulated edge devices until all are completed or the timeout is expired.
+    bool _runClients(const LoadStatistics::sOptions& options)
+    {
+        if (Application::startMessageRouting(options.address.getString(), options.port) == false)
+        {
+            std::fprintf(stderr, "Failed to connect to the router [ %s:%u ]\n", options.address.getString(), static_cast<uint32_t>(options.port));
+            return false;
+        }
+
+        LoadStatistics stats(options);
+        const String name{ NEUtilities::generateName(LoadClient::MODEL_NAME.data()) };
+        NERegistry::Model model = LoadClient::createModel(name, stats);
+        VERIFY(ComponentLoader::addModelUnique(model));
+
+        bool isTimeout{ false };
+        bool result = Application::loadModel(LoadClient::MODEL_NAME.data());
+        if (result)
+        {
+            std::fprintf(stderr, "Simulating [ %u ] edge devices, [ %u ] requests each...\n", options.clients, options.requests);
+            const LoadStatistics::Clock::time_point deadline{ LoadStatistics::Clock::now() + std::chrono::seconds(options.timeout) };
+            while ((stats.isCompleted() == false) && (isTimeout == false))
+            {
+                std::this_thread::sleep_for(CHECK_INTERVAL);
+                isTimeout = (LoadStatistics::Clock::now() >= deadline);
+            }
+
+            Application::unloadModel(LoadClient::MODEL_NAME.data());
+        }
+
+        Application::stopMessageRouting();
+        ComponentLoader::removeComponentModel(LoadClient::MODEL_NAME);
+        return (result && stats.writeReport(isTimeout) && (isTimeout == false));
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    LoadStatistics::sOptions options;
+    options.address     = NEMultiEdgeSettings::ROUTER_ADDRESS;
+    options.port        = NEMultiEdgeSettings::ROUTER_PORT;
+    options.clients     = DEF_CLIENTS;
+    options.threads     = DEF_THREADS;
+    options.requests    = DEF_REQUESTS;
+    options.concurrency = 1u;
+    options.rate        = 0u;
+    options.timeout     = DEF_TIMEOUT;
+    bool isMock{ false };
+
+    for (int i = 1; i < argc; ++ i)
+    {
+        const char* arg = argv[i];
+        const char* value{ nullptr };
+        if ((value = NECommandLine::optionValue(arg, "--mode")) != nullptr)
+            isMock = (std::strcmp(value, "mock") == 0);
+        else if ((value = NECommandLine::optionValue(arg, "--address")) != nullptr)
+            options.address = value;
+        else if ((value = NECommandLine::optionValue(arg, "--port")) != nullptr)
+            options.port = static_cast<uint16_t>(std::strtoul(value, nullptr, 10));
+        else if ((value = NECommandLine::optionValue(arg, "--clients")) != nullptr)
+            options.clients = NECommandLine::numberValue(value, 1u);
+        else if ((value = NECommandLine::optionValue(arg, "--threads")) != nullptr)
+            options.threads = NECommandLine::numberValue(value, 1u);
+        else if ((value = NECommandLine::optionValue(arg, "--requests")) != nullptr)
+            options.requests = NECommandLine::numberValue(value, 1u);
+        else if ((value = NECommandLine::optionValue(arg, "--concurrency")) != nullptr)
+            options.concurrency = NECommandLine::numberValue(value, 1u);
+        else if ((value = NECommandLine::optionValue(arg, "--rate")) != nullptr)
+            options.rate = NECommandLine::numberValue(value, 0u);
+        else if ((value = NECommandLine::optionValue(arg, "--timeout")) != nullptr)
+            options.timeout = NECommandLine::numberValue(value, 1u);
+        else if ((value = NECommandLine::optionValue(arg, "--output")) != nullptr)
+            options.outputFile = value;
+        else if ((value = NECommandLine::optionValue(arg, "--model")) != nullptr)
+            options.modelName = value;
+        else if ((value = NECommandLine::optionValue(arg, "--adapter")) != nullptr)
+            options.adapterName = value;
+        else if (((value = NECommandLine::optionValue(arg, "--prompts")) != nullptr) && _loadPrompts(value, options.prompts))
+            continue;
+        else
+        {
+            _printUsage(argv[0]);
+            return (std::strcmp(arg, "--help") == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+        }
+    }
+
+    if (options.prompts.empty())
+    {
+        options.prompts.push_back(String(DEF_PROMPT));
+    }
+
+    // Logging and messaging, the router connection is started with the options.
+    Application::initApplication(true, true, false);
+    const bool result = isMock ? _runMock(options) : _runClients(options);
+    Application::releaseApplication();
+
+    return (result ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,86 @@
+﻿/************************************************************************
+ * This file is part of the Areg Edge AI project powered by AREG SDK.
+ * The project contains multiple examples of using Edge AI based on Areg communication framework.
+ *
+ *  Areg Edge AI is available as free and open-source software under the MIT License.
+ *
+ *  For detailed licensing terms, please refer to the LICENSE file included
+ *  with this distribution or contact us at info[at]areg.tech.
+ *
+ *  \copyright   © 2025 Aregtech UG. All rights reserved.
+ *  \file        multiedge/edgeload/mockprovider.cpp
+ *  \ingroup     Areg Edge AI, Edge Device Load Generator
+ *  \author      Artak Avetyan
+ *  \brief       The mock Edge AI service provider without inference.
+ *
+ ************************************************************************/
+
+/************************************************************************
+ * Includes
+ ************************************************************************/
+
+#include "multiedge/edgeload/mockprovider.hpp"
+#include "areg/base/SharedBuffer.hpp"
+#include "areg/logging/GELog.h"
+
+DEF_LOG_SCOPE(multiedge_edgeload_MockProvider_startupServiceInterface);
+DEF_LOG_SCOPE(multiedge_edgeload_MockProvider_requestProcessText);
+DEF_LOG_SCOPE(multiedge_edgeload_MockProvider_requestProcessVideo);
+DEF_LOG_SCOPE(multiedge_edgeload_MockProvider_requestCancelText);
+DEF_LOG_SCOPE(multiedge_edgeload_MockProvider_requestStreamText);
+DEF_LOG_SCOPE(multiedge_edgeload_MockProvider_requestComputeEmbedding);
+
+MockProvider::MockProvider(const NERegistry::ComponentEntry& entry, ComponentThread& owner)
+    : Component     (entry, owner)
+    , MultiEdgeStub (static_cast<Component &>(self()))
+    , mReply        (MockProvider::REPLY_TEXT)
+{
+}
+
+void MockProvider::startupServiceInterface(Component& holder)
+{
+    LOG_SCOPE(multiedge_edgeload_MockProvider_startupServiceInterface);
+
+    MultiEdgeStub::startupServiceInterface(holder);
+    setActiveModel(String(MockProvider::MODEL_NAME));
+    NEMultiEdge::ModelList models;
+    models.add(String(MockProvider::MODEL_NAME));
+    setAvailableModels(models);
+    setAvailableAdapters(NEMultiEdge::ModelList());
+    setEdgeAgent(NEMultiEdge::AgentLLM);
+    setQueueSize(0);
+}
+
+void MockProvider::requestProcessText(unsigned int sessionId, unsigned int agentId, unsigned int /*conversationId*/, NEMultiEdge::eTextPriority /*priority*/, const String& /*modelName*/, const String& /*adapterName*/, const String& /*textProcess*/)
+{
+    LOG_SCOPE(multiedge_edgeload_MockProvider_requestProcessText);
+    LOG_DBG("Replying text request, sessionId: %u, agentId: %u", sessionId, agentId);
+    responseProcessText(sessionId, agentId, mReply, NEMultiEdge::eTextResult::TextCompleted);
+}
+
+void MockProvider::requestProcessVideo(unsigned int sessionId, bool agentId, const String& /*cmdText*/, const SharedBuffer& dataVideo)
+{
+    LOG_SCOPE(multiedge_edgeload_MockProvider_requestProcessVideo);
+    responseProcessVideo(sessionId, agentId, dataVideo);
+}
+
+void MockProvider::requestCancelText(unsigned int sessionId, unsigned int agentId)
+{
+    LOG_SCOPE(multiedge_edgeload_MockProvider_requestCancelText);
+    LOG_DBG("Nothing to cancel, sessionId: %u, agentId: %u", sessionId, agentId);
+}
+
+void MockProvider::requestStreamText(unsigned int sessionId, unsigned int agentId)
+{
+    LOG_SCOPE(multiedge_edgeload_MockProvider_requestStreamText);
+    LOG_DBG("Nothing to stream, sessionId: %u, agentId: %u", sessionId, agentId);
+    responseStreamText(sessionId, agentId, 0u, String(), true);
+}
+
+void MockProvider::requestComputeEmbedding(unsigned int sessionId, unsigned int agentId, const String& /*textEmbed*/)
+{
+    LOG_SCOPE(multiedge_edgeload_MockProvider_requestComputeEmbedding);
+    LOG_DBG("Replying embedding request, sessionId: %u, agentId: %u", sessionId, agentId);
+    float vector[MockProvider::EMBED_SIZE]{ 1.0f };
+    responseComputeEmbedding(sessionId, agentId, MockProvider::EMBED_SIZE, SharedBuffer(reinterpret_cast<const unsigned char*>(vector), static_cast<unsigned int>(sizeof(vector))));
+}
@@ -0,0 +1,145 @@
+﻿#ifndef MULTIEDGE_EDGELOAD_MOCKPROVIDER_HPP
+#define MULTIEDGE_EDGELOAD_MOCKPROVIDER_HPP
+/************************************************************************
+ * This file is part of the Areg Edge AI project powered by AREG SDK.
+ * The project contains multiple examples of using Edge AI based on Areg communication framework.
+ *
+ *  Areg Edge AI is available as free and open-source software under the MIT License.
+ *
+ *  For detailed licensing terms, please refer to the LICENSE file included
+ *  with this distribution or contact us at info[at]areg.tech.
+ *
+ *  \copyright   © 2025 Aregtech UG. All rights reserved.
+ *  \file        multiedge/edgeload/mockprovider.hpp
+ *  \ingroup     Areg Edge AI, Edge Device Load Generator
+ *  \author      Artak Avetyan
+ *  \brief       The mock Edge AI service provider without inference.
+ *
+ ************************************************************************/
+
+/************************************************************************
+ * Includes
+ ************************************************************************/
+
+#include "areg/base/GEGlobal.h"
+#include "areg/component/Component.hpp"
+#include "multiedge/resources/MultiEdgeStub.hpp"
+
+//////////////////////////////////////////////////////////////////////////
+// MockProvider class declaration
+//////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief   The mock of the Edge AI service provider. It is registered with the
+ *          same role name as the AI agent and replies every text request
+ *          immediately with the canned text. Running the load generator
+ *          against the mock measures only the overhead of the Areg messaging.
+ **/
+class MockProvider  : public Component
+                    , public MultiEdgeStub
+{
+//////////////////////////////////////////////////////////////////////////
+// Internal types and constants
+//////////////////////////////////////////////////////////////////////////
+public:
+    //!< The name of the active model reported by the mock.
+    static constexpr std::string_view   MODEL_NAME  { "mock" };
+
+    //!< The canned reply of the mock.
+    static constexpr std::string_view   REPLY_TEXT  { "This is a reply of the mock Edge AI agent." };
+
+    //!< The dimension of the canned embedding of the mock.
+    static constexpr uint32_t           EMBED_SIZE  { 8u };
+
+//////////////////////////////////////////////////////////////////////////
+// Constructor / Destructor
+//////////////////////////////////////////////////////////////////////////
+public:
+    MockProvider(const NERegistry::ComponentEntry& entry, ComponentThread& owner);
+    virtual ~MockProvider(void) = default;
+
+//////////////////////////////////////////////////////////////////////////
+// MultiEdge Interface Requests
+//////////////////////////////////////////////////////////////////////////
+public:
+
+    /**
+     * \brief   Request call.
+     *          The request sent by edge device to process the text. Replied immediately with the canned text.
+     * \param   sessionId       A unique ID of the session to distinguish the requests. The ID is sent back by the response.
+     * \param   agentId         The ID of edge device. It is sent back to the edge device.
+     * \param   conversationId  The ID of the conversation set by the edge device. Ignored by the mock.
+     * \param   priority        The priority class of the text. Ignored by the mock.
+     * \param   modelName       The name of the model to process the text. Ignored by the mock.
+     * \param   adapterName     The name of the LoRA adapter to process the text. Ignored by the mock.
+     * \param   textProcess     The text to process. Ignored by the mock.
+     * \see     responseProcessText
+     **/
+    virtual void requestProcessText(unsigned int sessionId, unsigned int agentId, unsigned int conversationId, NEMultiEdge::eTextPriority priority, const String& modelName, const String& adapterName, const String& textProcess) override;
+
+    /**
+     * \brief   Request call.
+     *          Process a video data. Replied immediately with the received data.
+     * \param   sessionId   An ID set by edge device to process video.
+     * \param   agentId     The ID of edge device.
+     * \param   cmdText     A command as a string to request to process video data.
+     * \param   dataVideo   A binary buffer of video data to process.
+     * \see     responseProcessVideo
+     **/
+    virtual void requestProcessVideo(unsigned int sessionId, bool agentId, const String& cmdText, const SharedBuffer& dataVideo) override;
+
+    /**
+     * \brief   Request call.
+     *          Cancels the processing of the text. The mock replies immediately, nothing to cancel.
+     * \param   sessionId   The ID of the session set by the edge device in the request to process the text.
+     * \param   agentId     The ID of edge device set in the request to process the text.
+     **/
+    virtual void requestCancelText(unsigned int sessionId, unsigned int agentId) override;
+
+    /**
+     * \brief   Request call.
+     *          Streams the reply of the text. The mock does not stream, replies immediately the final marker.
+     * \param   sessionId   The ID of the session set by the edge device in the request to process the text.
+     * \param   agentId     The ID of edge device set in the request to process the text.
+     * \see     responseStreamText
+     **/
+    virtual void requestStreamText(unsigned int sessionId, unsigned int agentId) override;
+
+    /**
+     * \brief   Request call.
+     *          Computes the embedding of the text. Replied immediately with the canned unit vector.
+     * \param   sessionId   A unique ID of the session to distinguish the requests. The ID is sent back by the response.
+     * \param   agentId     The ID of edge device. It is sent back to the edge device.
+     * \param   textEmbed   The text to compute the embedding. Ignored by the mock.
+     * \see     responseComputeEmbedding
+     **/
+    virtual void requestComputeEmbedding(unsigned int sessionId, unsigned int agentId, const String& textEmbed) override;
+
+//////////////////////////////////////////////////////////////////////////
+// StubBase overrides. Triggered by Component on startup.
+//////////////////////////////////////////////////////////////////////////
+protected:
+
+    /**
+     * \brief   This function is triggered by Component when starts up.
+     *          Sets the attributes of the service.
+     * \param   holder  The holder component of service interface of Stub,
+     *                  which started up.
+     **/
+    virtual void startupServiceInterface( Component & holder ) override;
+
+//////////////////////////////////////////////////////////////////////////
+// Member variables
+//////////////////////////////////////////////////////////////////////////
+private:
+    const String    mReply;     //!< The canned reply.
+
+//////////////////////////////////////////////////////////////////////////
+// Forbidden calls
+//////////////////////////////////////////////////////////////////////////
+private:
+    MockProvider(void) = delete;
+    DECLARE_NOCOPY_NOMOVE(MockProvider);
+};
+
+#endif // MULTIEDGE_EDGELOAD_MOCKPROVIDER_HPP
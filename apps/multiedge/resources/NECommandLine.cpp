@@ -0,0 +1,36 @@
+﻿/************************************************************************
+ * This file is part of the Areg Edge AI project powered by AREG SDK.
+ * The project contains multiple examples of using Edge AI based on Areg communication framework.
+ *
+ *  Areg Edge AI is available as free and open-source software under the MIT License.
+ *
+ *  For detailed licensing terms, please refer to the LICENSE file included
+ *  with this distribution or contact us at info[at]areg.tech.
+ *
+ *  \copyright   © 2025 Aregtech UG. All rights reserved.
+ *  \file        multiedge/resources/NECommandLine.cpp
+ *  \ingroup     Areg Edge AI
+ *  \author      Artak Avetyan
+ *  \brief       The options of the command line of the console applications.
+ *
+ ************************************************************************/
+
+/************************************************************************
+ * Includes
+ ************************************************************************/
+#include "multiedge/resources/NECommandLine.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+const char* NECommandLine::optionValue(const char* arg, const char* name)
+{
+    const size_t len = std::strlen(name);
+    return ((std::strncmp(arg, name, len) == 0) && (arg[len] == '=') ? arg + len + 1 : nullptr);
+}
+
+uint32_t NECommandLine::numberValue(const char* value, uint32_t minValue, uint32_t maxValue)
+{
+    return std::clamp(static_cast<uint32_t>(std::strtoul(value, nullptr, 10)), minValue, maxValue);
+}
@@ -0,0 +1,45 @@
+﻿#ifndef MULTIEDGE_RESOURCES_NECOMMANDLINE_HPP
+#define MULTIEDGE_RESOURCES_NECOMMANDLINE_HPP
+/************************************************************************
+ * This file is part of the Areg Edge AI project powered by AREG SDK.
+ * The project contains multiple examples of using Edge AI based on Areg communication framework.
+ *
+ *  Areg Edge AI is available as free and open-source software under the MIT License.
+ *
+ *  For detailed licensing terms, please refer to the LICENSE file included
+ *  with this distribution or contact us at info[at]areg.tech.
+ *
+ *  \copyright   © 2025 Aregtech UG. All rights reserved.
+ *  \file        multiedge/resources/NECommandLine.hpp
+ *  \ingroup     Areg Edge AI
+ *  \author      Artak Avetyan
+ *  \brief       The options of the command line of the console applications.
+ *
+ ************************************************************************/
+
+/************************************************************************
+ * Includes
+ ************************************************************************/
+#include <cstdint>
+#include <limits>
+
+namespace NECommandLine
+{
+    /**
+     * \brief   Returns the value of the option '<name>=<value>'.
+     * \param   arg     The argument of the command line.
+     * \param   name    The name of the option, for example '--model'.
+     * \return  Returns the value of the option if the argument matches the name, otherwise nullptr.
+     **/
+    const char* optionValue(const char* arg, const char* name);
+
+    /**
+     * \brief   Returns the number of the option value clamped to the range.
+     * \param   value       The value of the option.
+     * \param   minValue    The minimum number.
+     * \param   maxValue    The maximum number.
+     **/
+    uint32_t numberValue(const char* value, uint32_t minValue, uint32_t maxValue = std::numeric_limits<uint32_t>::max());
+}
+
+#endif // MULTIEDGE_RESOURCES_NECOMMANDLINE_HPP
@@ -31,6 +31,9 @@ namespace NEMultiEdgeSettings
     constexpr std::string_view SERVICE_CONSUMER { "EdgeAIConsumer" };       //!< The edge AI service consumer name.
     constexpr std::string_view WORKER_THREAD    { "AIEdgeWorker" };         //!< The name of the edge ai worker thread.
     constexpr std::string_view CONSUMER_NAME    { "AIEdgeWorkerConsumer" }; //!< The name of the edge ai worker thread consumer.
+    constexpr std::string_view LOADER_THREAD    { "AIEdgeLoader" };         //!< The name of the edge ai thread to load models.
+    constexpr std::string_view LOADER_CONSUMER  { "AIEdgeLoaderConsumer" }; //!< The name of the edge ai model loader thread consumer.
+    constexpr std::string_view ADAPTER_SUFFIX   { "-lora" };                //!< The suffix of the directory of LoRA adapters next to the model, named as the model file without extension.
     constexpr std::string_view ROUTER_ADDRESS   { "127.0.0.1" };            //!< The IP-address of the router service.
     constexpr uint16_t         ROUTER_PORT      { 8181 };                   //!< The port of the router service.
 }